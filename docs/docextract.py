@@ -62,7 +62,7 @@ def process_code (txt, lines):
       rapicorn_debug_items_set.add (m[0])
   # RAPICORN_KEY_DEBUG (keys, ...)
   global rapicorn_debug_keys, rapicorn_debug_keys_set
-  pattern = r'\b RAPICORN_KEY_DEBUG \s* \( \s* ' + cstring + r' \s* , \s* [^;] *? \)'
+  pattern = r'\b RAPICORN_KEY_DEBUG (?:_LITERAL)? \s* \( \s* ' + cstring + r' \s* , \s* [^;] *? \)'
   matches = re.findall (pattern, txt, re.MULTILINE | re.VERBOSE)
   for m in matches:
     if not m in rapicorn_debug_keys_set:
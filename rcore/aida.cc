@@ -2,6 +2,8 @@
 #include "aida.hh"
 #include "aidaprops.hh"
 #include "thread.hh"
+#include "trace.hh"
+#include "metrics.hh"
 #include "regex.hh"
 #include "config/config.h"      // HAVE_SYS_EVENTFD_H
 #include "randomhash.hh"        // random_nonce
@@ -25,7 +27,6 @@
 #include <stdexcept>
 #include <deque>
 #include <unordered_map>
-#include <unordered_set>
 
 // == Auxillary macros ==
 #ifndef __GNUC__
@@ -33,7 +34,7 @@
 #endif
 #define AIDA_CPP_PASTE2i(a,b)                   a ## b // indirection required to expand __LINE__ etc
 #define AIDA_CPP_PASTE2(a,b)                    AIDA_CPP_PASTE2i (a,b)
-#define GCLOG(...)                              RAPICORN_KEY_DEBUG ("GCStats", __VA_ARGS__)
+#define GCLOG(...)                              RAPICORN_KEY_DEBUG_LITERAL ("GCStats", __VA_ARGS__)
 #define AIDA_MESSAGES_ENABLED()                 rapicorn_debug_check ("AidaMsg")
 #define AIDA_MESSAGE(...)                       RAPICORN_KEY_DEBUG ("AidaMsg", __VA_ARGS__)
 
@@ -79,6 +80,30 @@ msgid_is (uint64 msgid, MessageId check_id)
   return msgid_mask (msgid) == check_id;
 }
 
+/// Static name for Trace events of a message.
+static const char*
+msgid_trace_name (uint64 msgid)
+{
+  switch (msgid_mask (msgid))
+    {
+    case MSGID_CALL_ONEWAY:             return "Aida::CALL_ONEWAY";
+    case MSGID_EMIT_ONEWAY:             return "Aida::EMIT_ONEWAY";
+    case MSGID_CONNECT:                 return "Aida::CONNECT";
+    case MSGID_CALL_TWOWAY:             return "Aida::CALL_TWOWAY";
+    case MSGID_EMIT_TWOWAY:             return "Aida::EMIT_TWOWAY";
+    case MSGID_DISCONNECT:              return "Aida::DISCONNECT";
+    case MSGID_CONNECT_RESULT:          return "Aida::CONNECT_RESULT";
+    case MSGID_CALL_RESULT:             return "Aida::CALL_RESULT";
+    case MSGID_EMIT_RESULT:             return "Aida::EMIT_RESULT";
+    case MSGID_META_HELLO:              return "Aida::META_HELLO";
+    case MSGID_META_WELCOME:            return "Aida::META_WELCOME";
+    case MSGID_META_GARBAGE_SWEEP:      return "Aida::META_GARBAGE_SWEEP";
+    case MSGID_META_GARBAGE_REPORT:     return "Aida::META_GARBAGE_REPORT";
+    case MSGID_META_SEEN_GARBAGE:       return "Aida::META_SEEN_GARBAGE";
+    default:                            return "Aida::message";
+    }
+}
+
 // == EnumInfo ==
 EnumInfo::EnumInfo (const String &enum_name, bool isflags, uint32_t n_values, const EnumValue *values) :
   enum_name_ (enum_name), values_ (values), n_values_ (n_values), flags_ (isflags)
@@ -335,6 +360,74 @@ ImplicitBase::~ImplicitBase()
 // == Any ==
 RAPICORN_STATIC_ASSERT (sizeof (std::string) <= sizeof (Any)); // assert big enough Any impl
 
+/* STRING, SEQUENCE and RECORD payloads are shared between copies of an Any and only
+ * copied before modifications, NULL payloads represent empty values.
+ */
+template<class T>
+struct Any::Shared {
+  std::atomic<uint32> refs;
+  T                   value;    // immutable while shared
+  explicit      Shared  (const T &v) : refs (1), value (v) {}
+  bool          unique  () const        { return refs.load (std::memory_order_acquire) == 1; }
+  static Shared*
+  ref (Shared *shared)
+  {
+    if (shared)
+      shared->refs.fetch_add (1, std::memory_order_relaxed);
+    return shared;
+  }
+  static void
+  unref (Shared *shared)
+  {
+    if (shared && shared->refs.fetch_sub (1, std::memory_order_acq_rel) == 1)
+      delete shared;
+  }
+  static const T&
+  get (const Shared *shared)
+  {
+    static const T &empty = *new T(); // leaked, used by static destructors
+    return shared ? shared->value : empty;
+  }
+  static T&
+  modify (Shared *&shared)      // make payload writable, copies shared payloads
+  {
+    if (!shared || !shared->unique())
+      {
+        Shared *old = shared;
+        shared = new Shared (get (old));
+        unref (old);
+      }
+    return shared->value;
+  }
+};
+
+const String&
+Any::vstring () const
+{
+  return Shared<String>::get (u_.sstring);
+}
+
+const Any::AnyVector&
+Any::vanys () const
+{
+  return Shared<AnyVector>::get (u_.sanys);
+}
+
+const Any::FieldVector&
+Any::vfields () const
+{
+  return Shared<FieldVector>::get (u_.sfields);
+}
+
+template<class L> static inline void
+relocate_local (L &dest, L &src)
+{
+  dest.ltype = src.ltype;
+  if (src.ltype)
+    src.ltype->relocate (dest, src);
+  src.ltype = NULL;
+}
+
 Any::Any (const Any &clone) :
   Any()
 {
@@ -366,13 +459,17 @@ Any::operator= (const Any &clone)
   type_kind_ = clone.type_kind_;
   switch (kind())
     {
-    case STRING:        new (&u_.vstring()) String (clone.u_.vstring());                             break;
+    case STRING:        u_.sstring = Shared<String>::ref (clone.u_.sstring);                         break;
     case ANY:           u_.vany = clone.u_.vany ? new Any (*clone.u_.vany) : NULL;                   break;
-    case SEQUENCE:      new (&u_.vanys()) AnyVector (clone.u_.vanys());                              break;
-    case RECORD:        new (&u_.vfields()) FieldVector (clone.u_.vfields());                        break;
+    case SEQUENCE:      u_.sanys = Shared<AnyVector>::ref (clone.u_.sanys);                          break;
+    case RECORD:        u_.sfields = Shared<FieldVector>::ref (clone.u_.sfields);                    break;
     case INSTANCE:      new (&u_.ibase()) ImplicitBaseP (clone.u_.ibase());                          break;
     case REMOTE:        new (&u_.rhandle()) ARemoteHandle (clone.u_.rhandle());                      break;
-    case LOCAL:         u_.pholder = clone.u_.pholder ? clone.u_.pholder->clone() : NULL;            break;
+    case LOCAL:
+      u_.vlocal.ltype = clone.u_.vlocal.ltype;
+      if (u_.vlocal.ltype)
+        u_.vlocal.ltype->copy (u_.vlocal, clone.u_.vlocal);
+      break;
     case TRANSITION:    // u_.vint64 = clone.u_.vint64;
     default:            u_ = clone.u_;                                                               break;
     }
@@ -386,13 +483,20 @@ swap_any_unions (TypeKind kind, U &u, U &v)
     {
     case UNTYPED: case BOOL: case ENUM: case INT32: case INT64: case FLOAT64:
     case TRANSITION:    std::swap (u, v);                     break;
-    case STRING:        std::swap (u.vstring(), v.vstring()); break;
-    case SEQUENCE:      std::swap (u.vanys(), v.vanys());     break;
-    case RECORD:        std::swap (u.vfields(), v.vfields()); break;
+    case STRING:        std::swap (u.sstring, v.sstring);     break;
+    case SEQUENCE:      std::swap (u.sanys, v.sanys);         break;
+    case RECORD:        std::swap (u.sfields, v.sfields);     break;
     case INSTANCE:      std::swap (u.ibase(), v.ibase());     break;
     case REMOTE:        std::swap (u.rhandle(), v.rhandle()); break;
-    case LOCAL:         std::swap (u.pholder, v.pholder);     break;
     case ANY:           std::swap (u.vany, v.vany);           break;
+    case LOCAL:
+      {
+        decltype (u.vlocal) tmp;
+        relocate_local (tmp, u.vlocal);
+        relocate_local (u.vlocal, v.vlocal);
+        relocate_local (v.vlocal, tmp);
+      }
+      break;
     default:            AIDA_ASSERT_RETURN_UNREACHED();       break;
     }
 }
@@ -423,13 +527,16 @@ Any::clear()
 {
   switch (kind())
     {
-    case STRING:        u_.vstring().~String();                 break;
+    case STRING:        Shared<String>::unref (u_.sstring);     break;
     case ANY:           delete u_.vany;                         break;
-    case SEQUENCE:      u_.vanys().~AnyVector();                break;
-    case RECORD:        u_.vfields().~FieldVector();            break;
+    case SEQUENCE:      Shared<AnyVector>::unref (u_.sanys);    break;
+    case RECORD:        Shared<FieldVector>::unref (u_.sfields); break;
     case INSTANCE:      u_.ibase().~ImplicitBaseP();            break;
     case REMOTE:        u_.rhandle().~ARemoteHandle();          break;
-    case LOCAL:         delete u_.pholder;                      break;
+    case LOCAL:
+      if (u_.vlocal.ltype)
+        u_.vlocal.ltype->destroy (u_.vlocal);
+      break;
     case TRANSITION: ;
     default: ;
     }
@@ -450,12 +557,13 @@ Any::rekind (TypeKind _kind)
   type_kind_ = _kind;
   switch (_kind)
     {
-    case STRING:   new (&u_.vstring()) String();        break;
+    case STRING:   u_.sstring = NULL;                   break;
     case ANY:      u_.vany = NULL;                      break;
-    case SEQUENCE: new (&u_.vanys()) AnyVector();       break;
-    case RECORD:   new (&u_.vfields()) FieldVector();   break;
+    case SEQUENCE: u_.sanys = NULL;                     break;
+    case RECORD:   u_.sfields = NULL;                   break;
     case INSTANCE: new (&u_.ibase()) ImplicitBaseP();   break;
     case REMOTE:   new (&u_.rhandle()) ARemoteHandle(); break;
+    case LOCAL:    u_.vlocal.ltype = NULL;              break;
     default:                                            break;
     }
 }
@@ -536,7 +644,7 @@ Any::repr (const String &field_name) const
   if (kind() == ANY)
     s += u_.vany ? u_.vany->repr() : Any().repr();
   else if (kind() == STRING)
-    s += Rapicorn::string_to_cquote (u_.vstring());
+    s += Rapicorn::string_to_cquote (vstring());
   else
     s += to_string();
   s += " }";
@@ -553,9 +661,9 @@ Any::to_string() const
     case BOOL: case ENUM: case INT32:
     case INT64:      s += string_format ("%d", u_.vint64);                                                      break;
     case FLOAT64:    s += string_format ("%.17g", u_.vdouble);                                                  break;
-    case STRING:     s += u_.vstring();                                                                         break;
-    case SEQUENCE:   s += any_vector_to_string (&u_.vanys());                                                   break;
-    case RECORD:     s += any_vector_to_string (&u_.vfields());                                                 break;
+    case STRING:     s += vstring();                                                                         break;
+    case SEQUENCE:   s += any_vector_to_string (&vanys());                                                   break;
+    case RECORD:     s += any_vector_to_string (&vfields());                                                 break;
     case INSTANCE:   s += string_format ("((ImplicitBase*) %p)", u_.ibase().get());                             break;
     case REMOTE:     s += string_format ("(RemoteHandle (orbid=0x#%08x))", u_.rhandle().__aida_orbid__());      break;
     case TRANSITION: s += string_format ("(Any (TRANSITION, orbid=0x#%08x))", u_.vint64);                       break;
@@ -584,11 +692,11 @@ Any::operator== (const Any &clone) const
     case TRANSITION: case BOOL: case ENUM: case INT32: // chain
     case INT64:    if (u_.vint64 != clone.u_.vint64) return false;                                       break;
     case FLOAT64:  if (u_.vdouble != clone.u_.vdouble) return false;                                     break;
-    case STRING:   if (u_.vstring() != clone.u_.vstring()) return false;                                 break;
+    case STRING:   if (u_.sstring != clone.u_.sstring && vstring() != clone.vstring()) return false; break;
     case SEQUENCE:
-      return u_.vanys() == clone.u_.vanys();
+      return vanys() == clone.vanys();
     case RECORD:
-      return u_.vfields() == clone.u_.vfields();
+      return vfields() == clone.vfields();
     case ANY:
       if (!u_.vany || !clone.u_.vany)
         return u_.vany == clone.u_.vany;
@@ -599,10 +707,12 @@ Any::operator== (const Any &clone) const
     case REMOTE:
       return u_.rhandle().__aida_orbid__() == clone.u_.rhandle().__aida_orbid__();
     case LOCAL:
-      if (!u_.pholder || !clone.u_.pholder)
-        return u_.pholder == clone.u_.pholder;
-      else
-        return *u_.pholder == *clone.u_.pholder;
+      if (!u_.vlocal.ltype || !clone.u_.vlocal.ltype)
+        return u_.vlocal.ltype == clone.u_.vlocal.ltype;
+      if (u_.vlocal.ltype != clone.u_.vlocal.ltype &&   // types may be instantiated in several libraries
+          u_.vlocal.ltype->type != clone.u_.vlocal.ltype->type)
+        return false;
+      return u_.vlocal.ltype->equals (u_.vlocal, clone.u_.vlocal);
     default:
       AIDA_ASSERT_RETURN_UNREACHED (false);
       return false;
@@ -617,10 +727,11 @@ Any::operator!= (const Any &clone) const
 }
 
 void
-Any::hold (PlaceHolder *ph)
+Any::hold (LocalValue &value)
 {
-  ensure (LOCAL);
-  u_.pholder = ph;
+  clear();
+  type_kind_ = LOCAL;
+  relocate_local (u_.vlocal, value);
 }
 
 bool
@@ -630,9 +741,9 @@ Any::get_bool () const
     {
     case TRANSITION: case BOOL: case ENUM: case INT32:
     case INT64:         return u_.vint64 != 0;
-    case STRING:        return !u_.vstring().empty();
-    case SEQUENCE:      return !u_.vanys().empty();
-    case RECORD:        return !u_.vfields().empty();
+    case STRING:        return !vstring().empty();
+    case SEQUENCE:      return !vanys().empty();
+    case RECORD:        return !vfields().empty();
     case INSTANCE:      return u_.ibase().get() != NULL;
     case REMOTE:        return u_.rhandle().__aida_orbid__() != 0;
     default: ;
@@ -655,9 +766,9 @@ Any::as_int64 () const
     case BOOL: case ENUM: case INT32:
     case INT64:         return u_.vint64;
     case FLOAT64:       return u_.vdouble;
-    case STRING:        return u_.vstring().size();
-    case SEQUENCE:      return u_.vanys().size();
-    case RECORD:        return u_.vfields().size();
+    case STRING:        return vstring().size();
+    case SEQUENCE:      return vanys().size();
+    case RECORD:        return vfields().size();
     default:            return 0;
     }
 }
@@ -716,7 +827,7 @@ Any::get_string () const
     case ENUM: case INT32:
     case INT64:         return string_format ("%i", u_.vint64);
     case FLOAT64:       return string_from_double (u_.vdouble);
-    case STRING:        return u_.vstring();
+    case STRING:        return vstring();
     default: ;
     }
   return "";
@@ -726,46 +837,49 @@ void
 Any::set_string (const std::string &value)
 {
   ensure (STRING);
-  u_.vstring().assign (value);
+  if (u_.sstring && u_.sstring->unique())
+    Shared<String>::modify (u_.sstring).assign (value);
+  else
+    {
+      Shared<String> *old = u_.sstring;
+      u_.sstring = new Shared<String> (value);
+      Shared<String>::unref (old);
+    }
 }
 
 const Any::AnyVector*
 Any::get_seq () const
 {
-  if (kind() == SEQUENCE)
-    return &u_.vanys();
-  static const AnyVector empty;
-  return &empty;
+  return &(kind() == SEQUENCE ? vanys() : Shared<AnyVector>::get (NULL));
 }
 
 void
 Any::set_seq (const AnyVector *seq)
 {
   ensure (SEQUENCE);
-  if (seq != &u_.vanys())
+  if (seq != &vanys())
     {
-      AnyVector tmp (*seq); // beware of internal references, copy before freeing
-      std::swap (tmp, u_.vanys());
+      Shared<AnyVector> *old = u_.sanys; // beware of internal references, copy before freeing
+      u_.sanys = seq->empty() ? NULL : new Shared<AnyVector> (*seq);
+      Shared<AnyVector>::unref (old);
     }
 }
 
 const Any::FieldVector*
 Any::get_rec () const
 {
-  if (kind() == RECORD && !u_.vfields().empty())
-    return &u_.vfields();
-  static const FieldVector empty;
-  return &empty;
+  return &(kind() == RECORD ? vfields() : Shared<FieldVector>::get (NULL));
 }
 
 void
 Any::set_rec (const FieldVector *rec)
 {
   ensure (RECORD);
-  if (rec != &u_.vfields())
+  if (rec != &vfields())
     {
-      FieldVector tmp (*rec); // beware of internal references, copy before freeing
-      std::swap (tmp, u_.vfields());
+      Shared<FieldVector> *old = u_.sfields; // beware of internal references, copy before freeing
+      u_.sfields = rec->empty() ? NULL : new Shared<FieldVector> (*rec);
+      Shared<FieldVector>::unref (old);
     }
 }
 
@@ -822,18 +936,43 @@ Any::set_any (const Any *value)
     }
 }
 
+// Check if to_transition() or from_transition() need to modify elements, plain data stays shared.
+template<class V> static bool
+any_vector_has_references (const V &vector)
+{
+  for (const Any &any : vector)
+    switch (any.kind())
+      {
+      case UNTYPED: case BOOL: case ENUM: case INT32: case INT64: case FLOAT64: case STRING: case LOCAL:
+        break;
+      case SEQUENCE:
+        if (any_vector_has_references (any.get<const Any::AnyVector&>()))
+          return true;
+        break;
+      case RECORD:
+        if (any_vector_has_references (any.get<const Any::FieldVector&>()))
+          return true;
+        break;
+      default:  // ANY, INSTANCE, REMOTE, TRANSITION
+        return true;
+      }
+  return false;
+}
+
 void
 Any::to_transition (BaseConnection &base_connection)
 {
   switch (kind())
     {
     case SEQUENCE:
-      for (size_t i = 0; i < u_.vanys().size(); i++)
-        u_.vanys()[i].to_transition (base_connection);
+      if (any_vector_has_references (vanys()))
+        for (auto &any : Shared<AnyVector>::modify (u_.sanys))
+          any.to_transition (base_connection);
       break;
     case RECORD:
-      for (size_t i = 0; i < u_.vfields().size(); i++)
-        u_.vfields()[i].to_transition (base_connection);
+      if (any_vector_has_references (vfields()))
+        for (auto &field : Shared<FieldVector>::modify (u_.sfields))
+          field.to_transition (base_connection);
       break;
     case ANY:
       if (u_.vany)
@@ -894,12 +1033,14 @@ Any::from_transition (BaseConnection &base_connection)
       ServerConnection *server_connection;
       ClientConnection *client_connection;
     case SEQUENCE:
-      for (size_t i = 0; i < u_.vanys().size(); i++)
-        u_.vanys()[i].from_transition (base_connection);
+      if (any_vector_has_references (vanys()))
+        for (auto &any : Shared<AnyVector>::modify (u_.sanys))
+          any.from_transition (base_connection);
       break;
     case RECORD:
-      for (size_t i = 0; i < u_.vfields().size(); i++)
-        u_.vfields()[i].from_transition (base_connection);
+      if (any_vector_has_references (vfields()))
+        for (auto &field : Shared<FieldVector>::modify (u_.sfields))
+          field.from_transition (base_connection);
       break;
     case ANY:
       if (u_.vany)
@@ -1537,40 +1678,61 @@ private:
 
 
 // == TransportChannel ==
+static Metrics::Counter &aida_messages_sent = Metrics::counter ("rapicorn_aida_messages_sent", "Number of Aida messages sent between connections");
+static Metrics::Counter &aida_messages_received = Metrics::counter ("rapicorn_aida_messages_received", "Number of Aida messages received by connections");
+
 class TransportChannel : public EventFd { // Channel for cross-thread ProtoMsg IO
-  MpScQueueF<ProtoMsg*> msg_queue;
-  ProtoMsg             *last_fb;
+  struct QueuedMsg {
+    ProtoMsg *fb;
+    uint64    flow_id;                          // pairs flow_send() with flow_receive() of the same message
+  };
+  MpScQueueF<QueuedMsg> msg_queue;
+  QueuedMsg             last_msg;
   enum Op { PEEK, POP, POP_BLOCKED };
   ProtoMsg*
   get_msg (const Op op)
   {
-    if (!last_fb)
+    if (!last_msg.fb)
       do
         {
           // fetch new messages
-          last_fb = msg_queue.pop();
-          if (!last_fb)
+          last_msg = msg_queue.pop();
+          if (!last_msg.fb)
             {
               flush();                          // flush stale wakeups, to allow blocking until an empty => full transition
-              last_fb = msg_queue.pop();        // retry, to ensure we've not just discarded a real wakeup
+              last_msg = msg_queue.pop();       // retry, to ensure we've not just discarded a real wakeup
             }
-          if (last_fb)
+          if (last_msg.fb)
             break;
           // no messages available
           if (op == POP_BLOCKED)
             pollin();
         }
       while (op == POP_BLOCKED);
-    ProtoMsg *fb = last_fb;
+    ProtoMsg *fb = last_msg.fb;
     if (op != PEEK) // advance
-      last_fb = NULL;
+      {
+        if (fb)
+          aida_messages_received.add();
+        if (RAPICORN_UNLIKELY (last_msg.flow_id) && fb)
+          Trace::flow_receive (msgid_trace_name (fb->first_id()), last_msg.flow_id);
+        last_msg = QueuedMsg();
+      }
     return fb; // may be NULL
   }
 public:
   void // takes pm ownership
   send_msg (ProtoMsg *pm, bool may_wakeup)
   {
-    const bool was_empty = msg_queue.push (pm);
+    static std::atomic<uint64> trace_flow_counter (0);
+    QueuedMsg qmsg = { pm, 0 };
+    if (RAPICORN_UNLIKELY (Trace::enabled()))
+      {
+        qmsg.flow_id = ++trace_flow_counter;    // unique across all channels and messages
+        Trace::flow_send (msgid_trace_name (pm->first_id()), qmsg.flow_id);
+      }
+    aida_messages_sent.add();
+    const bool was_empty = msg_queue.push (qmsg);
     if (may_wakeup && was_empty)
       wakeup();                                 // wakeups are needed to catch empty => full transition
   }
@@ -1580,7 +1742,7 @@ public:
   ~TransportChannel ()
   {}
   TransportChannel () :
-    last_fb (NULL)
+    last_msg()
   {
     const int create_wakeup_pipe_error = open();
     AIDA_ASSERT_RETURN (create_wakeup_pipe_error == 0);
@@ -1716,8 +1878,9 @@ ObjectMap<Instance>::instance_from_orbo (const OrbObjectP &orbo)
 
 // == ConnectionRegistry ==
 class ConnectionRegistry {
-  Mutex                        mutex_;
-  std::vector<BaseConnection*> connections_;
+  Mutex                                 mutex_;         // protects connections_, serializes writers
+  std::vector<BaseConnection*>          connections_;
+  RcuMap<std::string, ServerConnection*> servers_;      // lock-free protocol lookups
 public:
   void
   register_connection (BaseConnection &connection)
@@ -1730,6 +1893,9 @@ public:
     if (i == connections_.size())
       connections_.resize (i + 1);
     connections_[i] = &connection;
+    ServerConnection *scon = dynamic_cast<ServerConnection*> (&connection);
+    if (scon && !servers_.lookup (connection.protocol()))
+      servers_.insert (connection.protocol(), scon);    // first registration wins
   }
   void
   unregister_connection (BaseConnection &connection)
@@ -1744,22 +1910,25 @@ public:
           break;
         }
     AIDA_ASSERT_RETURN (connection_found_and_unregistered);
+    if (servers_.lookup (connection.protocol()) != &connection)
+      return;
+    // fall back to any remaining server for the same protocol
+    for (size_t i = 0; i < connections_.size(); i++)
+      if (connections_[i] && connections_[i]->protocol() == connection.protocol())
+        {
+          ServerConnection *scon = dynamic_cast<ServerConnection*> (connections_[i]);
+          if (scon)
+            {
+              servers_.insert (connection.protocol(), scon);
+              return;
+            }
+        }
+    servers_.erase (connection.protocol());
   }
   ServerConnection*
   server_connection_from_protocol (const String &protocol)
   {
-    ScopedLock<Mutex> sl (mutex_);
-    for (size_t i = 0; i < connections_.size(); i++)
-      {
-        BaseConnection *bcon = connections_[i];
-        if (bcon && protocol == bcon->protocol())
-          {
-            ServerConnection *scon = dynamic_cast<ServerConnection*> (bcon);
-            if (scon)
-              return scon;
-          }
-      }
-    return NULL; // unmatched
+    return servers_.lookup (protocol); // NULL if unmatched
   }
 };
 static DurableInstance<ConnectionRegistry> connection_registry; // keep ConnectionRegistry across static dtors
@@ -1824,6 +1993,17 @@ BaseConnection::remote_origin()
   AIDA_ASSERT_RETURN_UNREACHED (RemoteHandle());
 }
 
+// == Garbage Collection ==
+static const size_t gc_sweep_slice = 1024; // maximum number of client objects examined per GARBAGE_SWEEP
+static Metrics::Counter &gc_sweeps = Metrics::counter ("rapicorn_aida_gc_sweeps", "Number of garbage collection slices swept by Aida clients");
+static Metrics::Counter &gc_young_examined = Metrics::counter ("rapicorn_aida_gc_young_examined", "Number of young remote handles examined by garbage collection sweeps");
+static Metrics::Counter &gc_old_examined = Metrics::counter ("rapicorn_aida_gc_old_examined", "Number of old remote handles examined by garbage collection sweeps");
+static Metrics::Counter &gc_promoted = Metrics::counter ("rapicorn_aida_gc_promoted", "Number of remote handles promoted into the old generation");
+static Metrics::Counter &gc_purged = Metrics::counter ("rapicorn_aida_gc_purged", "Number of remote object references released by Aida servers");
+static Metrics::Counter &gc_retained = Metrics::counter ("rapicorn_aida_gc_retained", "Number of reported garbage objects retained due to concurrent reuse");
+static Metrics::Histogram &gc_sweep_latency = Metrics::histogram ("rapicorn_aida_gc_sweep_ns", "Duration of client garbage collection slices in nanoseconds");
+static Metrics::Histogram &gc_report_latency = Metrics::histogram ("rapicorn_aida_gc_report_ns", "Duration of server garbage report processing in nanoseconds");
+
 // == ClientConnectionImpl ==
 class ClientConnectionImpl : public ClientConnection {
   struct SignalHandler {
@@ -1839,6 +2019,9 @@ class ClientConnectionImpl : public ClientConnection {
   std::deque<ProtoMsg*>         event_queue_;           // messages pending for client
   typedef std::map<uint64, OrbObjectW> Id2OrboMap;
   Id2OrboMap                    id2orbo_map_;           // map server orbid -> OrbObjectP
+  std::vector<uint64>           young_orbids_;          // objects added to id2orbo_map_ since they were last swept
+  uint64                        old_sweep_orbid_;       // position of the incremental old generation sweep
+  size_t                        dead_orbos_;            // number of deleted ClientOrbObjects not yet reported
   std::vector<SignalHandler*>   signal_handlers_;
   UIntSet                       ehandler_set; // client event handler
   std::function<void (ClientConnection&)> notify_cb_;
@@ -1847,7 +2030,7 @@ class ClientConnectionImpl : public ClientConnection {
   SignalHandler*                signal_lookup (size_t handler_id);
 public:
   ClientConnectionImpl (const std::string &protocol, ServerConnection &server_connection) :
-    ClientConnection (protocol), blocking_for_sem_ (false), seen_garbage_ (false)
+    ClientConnection (protocol), old_sweep_orbid_ (0), dead_orbos_ (0), blocking_for_sem_ (false), seen_garbage_ (false)
   {
     assert (!server_connection.has_peer());
     signal_handlers_.push_back (NULL); // reserve 0 for NULL
@@ -1872,6 +2055,7 @@ public:
   }
   void                 notify_for_result ()             { if (blocking_for_sem_) sem_post (&transport_sem_); }
   void                 block_for_result  ()             { AIDA_ASSERT_RETURN (blocking_for_sem_); sem_wait (&transport_sem_); }
+  void                 gc_request        ();
   void                 gc_sweep          (const ProtoMsg *fb);
   virtual int          notify_fd         () override    { return transport_channel_.inputfd(); }
   virtual bool         pending           () override    { return !event_queue_.empty() || transport_channel_.has_msg(); }
@@ -1889,14 +2073,11 @@ public:
   void
   client_orb_object_deleting (ClientOrbObject &coo)
   {
+    dead_orbos_++;
     if (!seen_garbage_)
       {
-        seen_garbage_ = true;
-        ProtoMsg *fb = ProtoMsg::_new (3);
-        fb->add_header1 (MSGID_META_SEEN_GARBAGE, 0, 0);
         GCLOG ("ClientConnectionImpl: SEEN_GARBAGE (%016x)", coo.orbid());
-        ProtoMsg *fr = this->call_remote (fb); // takes over fb
-        assert (fr == NULL);
+        gc_request();
       }
   }
   class ClientOrbObject : public OrbObject {
@@ -1952,11 +2133,24 @@ void
 ClientConnectionImpl::pop_handle (ProtoReader &fr, RemoteHandle &rhandle)
 {
   const uint64 orbid = fr.pop_orbid();
-  OrbObjectP orbop = id2orbo_map_[orbid].lock();
-  if (AIDA_UNLIKELY (!orbop) && orbid)
+  OrbObjectP orbop;
+  if (AIDA_LIKELY (orbid))
     {
-      orbop = FriendAllocator<ClientOrbObject>::make_shared (orbid, *this);
-      id2orbo_map_[orbid] = orbop;
+      auto it = id2orbo_map_.lower_bound (orbid);
+      if (it != id2orbo_map_.end() && it->first == orbid)
+        {
+          orbop = it->second.lock();
+          if (AIDA_UNLIKELY (!orbop) && dead_orbos_)
+            dead_orbos_--;      // reused before its deletion was reported
+        }
+      else
+        it = id2orbo_map_.emplace_hint (it, orbid, OrbObjectW());
+      if (AIDA_UNLIKELY (!orbop))
+        {
+          orbop = FriendAllocator<ClientOrbObject>::make_shared (orbid, *this);
+          it->second = orbop;
+          young_orbids_.push_back (orbid);
+        }
     }
   (rhandle.*pmf_upgrade_from) (orbop);
 }
@@ -1967,30 +2161,84 @@ ClientConnectionImpl::notify_callback (const std::function<void (ClientConnectio
   notify_cb_ = cb;
 }
 
+void
+ClientConnectionImpl::gc_request ()
+{
+  seen_garbage_ = true;
+  ProtoMsg *fb = ProtoMsg::_new (3);
+  fb->add_header1 (MSGID_META_SEEN_GARBAGE, 0, 0);
+  ProtoMsg *fr = this->call_remote (fb); // takes over fb
+  assert (fr == NULL);
+}
+
+/* Garbage collection is generational and incremental. Most remote handles are short lived,
+ * so each sweep first examines the young objects received since the last sweep, survivors
+ * are promoted into the old generation. Old objects are only examined while deletions
+ * remain unaccounted for, continuing where the previous slice stopped. A sweep examines
+ * at most gc_sweep_slice objects, if deleted objects remain, another collection cycle is
+ * requested, so large collections are split into slices interleaved with other dispatches.
+ */
 void
 ClientConnectionImpl::gc_sweep (const ProtoMsg *fb)
 {
   ProtoReader fbr (*fb);
   const MessageId msgid = MessageId (fbr.pop_int64());
   assert (msgid_is (msgid, MSGID_META_GARBAGE_SWEEP));
+  Metrics::Histogram::Latency sweep_latency_scope (gc_sweep_latency);
   // collect expired object ids and send to server
   vector<uint64> trashids;
-  for (auto it = id2orbo_map_.begin(); it != id2orbo_map_.end();)
-    if (it->second.expired())
-      {
-        trashids.push_back (it->first);
-        it = id2orbo_map_.erase (it);
-      }
-    else
-      ++it;
+  size_t n_young = 0, n_old = 0;
+  while (n_young < gc_sweep_slice && !young_orbids_.empty())
+    {
+      const uint64 orbid = young_orbids_.back();
+      young_orbids_.pop_back();
+      n_young++;
+      auto it = id2orbo_map_.find (orbid);
+      if (it != id2orbo_map_.end() && it->second.expired())
+        {
+          trashids.push_back (orbid);
+          id2orbo_map_.erase (it);
+        }
+    }
+  const size_t n_young_trash = trashids.size();
+  dead_orbos_ -= MIN (dead_orbos_, n_young_trash);
+  if (dead_orbos_ && young_orbids_.empty())
+    {
+      const size_t n_entries = id2orbo_map_.size(), n_max = MIN (gc_sweep_slice - n_young, n_entries);
+      auto it = id2orbo_map_.lower_bound (old_sweep_orbid_);
+      while (n_old < n_max && dead_orbos_)
+        {
+          if (it == id2orbo_map_.end())
+            it = id2orbo_map_.begin();
+          n_old++;
+          if (it->second.expired())
+            {
+              trashids.push_back (it->first);
+              it = id2orbo_map_.erase (it);
+              dead_orbos_--;
+            }
+          else
+            ++it;
+        }
+      old_sweep_orbid_ = it != id2orbo_map_.end() ? it->first : 0;
+      if (n_old == n_entries)
+        dead_orbos_ = 0;        // all objects have been examined
+    }
+  gc_sweeps.add();
+  gc_young_examined.add (n_young);
+  gc_old_examined.add (n_old);
+  gc_promoted.add (n_young - n_young_trash);
   ProtoMsg *fr = ProtoMsg::_new (3 + 1 + trashids.size()); // header + length + items
   fr->add_header1 (MSGID_META_GARBAGE_REPORT, 0, 0); // header
   fr->add_int64 (trashids.size()); // length
   for (auto v : trashids)
     fr->add_int64 (v); // items
-  GCLOG ("ClientConnectionImpl: GARBAGE_REPORT: %u trash ids", trashids.size());
+  GCLOG ("ClientConnectionImpl: GARBAGE_REPORT: %u trash ids, examined: young=%u old=%u, pending: %u",
+         trashids.size(), n_young, n_old, dead_orbos_);
   post_peer_msg (fr);
   seen_garbage_ = false;
+  if (dead_orbos_)
+    gc_request();               // continue with the next slice
 }
 
 void
@@ -1998,6 +2246,7 @@ ClientConnectionImpl::dispatch ()
 {
   ProtoMsg *fb = pop();
   return_if (fb == NULL);
+  RAPICORN_TRACE_SCOPE ("Aida::ClientConnection::dispatch");
   ProtoScope client_connection_protocol_scope (*this);
   ProtoReader fbr (*fb);
   const MessageId msgid = MessageId (fbr.pop_int64());
@@ -2063,6 +2312,9 @@ ClientConnectionImpl::call_remote (ProtoMsg *fb)
       return NULL;
     }
   const MessageId resultid = MessageId (msgid_mask (msgid_as_result (callid)));
+  RAPICORN_TRACE_SCOPE ("Aida::ClientConnection::call_remote");
+  static Metrics::Histogram &call_latency = Metrics::histogram ("rapicorn_aida_call_latency_ns", "Round trip time of two-way Aida calls in nanoseconds");
+  Metrics::Histogram::Latency call_latency_scope (call_latency);
   blocking_for_sem_ = true; // results will notify semaphore
   post_peer_msg (fb);
   ProtoMsg *fr;
@@ -2220,7 +2472,10 @@ class ServerConnectionImpl : public ServerConnection {
   ObjectMap<ImplicitBase>  object_map_;         // map of all objects used remotely
   ImplicitBaseP            remote_origin_;
   std::unordered_map<size_t, EmitResultHandler> emit_result_map_;
-  std::unordered_set<OrbObjectP> live_remotes_, *sweep_remotes_;
+  struct RemoteRef { OrbObjectP orbop; uint64 epoch; };
+  std::unordered_map<uint64, RemoteRef> live_remotes_;  // references held for the client, with epoch of last export
+  uint64                   gc_epoch_;           // incremented with each GARBAGE_SWEEP
+  bool                     gc_sweeping_;
   RAPICORN_CLASS_NON_COPYABLE (ServerConnectionImpl);
   void                  start_garbage_collection ();
 public:
@@ -2247,22 +2502,22 @@ public:
 void
 ServerConnectionImpl::start_garbage_collection()
 {
-  if (sweep_remotes_)
+  if (gc_sweeping_)
     {
       assertion_failed (__FILE__, __LINE__, "duplicate garbage collection request should not occur");
       return;
     }
-  // GARBAGE_SWEEP
-  sweep_remotes_ = new std::unordered_set<OrbObjectP>();
-  sweep_remotes_->swap (live_remotes_);
+  // GARBAGE_SWEEP, objects exported from here on are retained even if reported
+  gc_sweeping_ = true;
+  gc_epoch_++;
   ProtoMsg *fb = ProtoMsg::_new (3);
   fb->add_header2 (MSGID_META_GARBAGE_SWEEP, 0, 0);
-  GCLOG ("ServerConnectionImpl: GARBAGE_SWEEP: %u candidates", sweep_remotes_->size());
+  GCLOG ("ServerConnectionImpl: GARBAGE_SWEEP: %u candidates", live_remotes_.size());
   post_peer_msg (fb);
 }
 
 ServerConnectionImpl::ServerConnectionImpl (const std::string &protocol) :
-  ServerConnection (protocol), remote_origin_ (NULL), sweep_remotes_ (NULL)
+  ServerConnection (protocol), remote_origin_ (NULL), gc_epoch_ (0), gc_sweeping_ (false)
 {
   connection_registry->register_connection (*this);
   const uint64 start_id = OrbObject::orbid_make (0,  // unused
@@ -2293,7 +2548,12 @@ ServerConnectionImpl::add_interface (ProtoMsg &fb, ImplicitBaseP ibase)
   OrbObjectP orbop = object_map_.orbo_from_instance (ibase);
   fb.add_orbid (orbop ? orbop->orbid() : 0);
   if (orbop)
-    live_remotes_.insert (orbop);
+    {
+      RemoteRef &rref = live_remotes_[orbop->orbid()];
+      if (!rref.orbop)
+        rref.orbop = orbop;
+      rref.epoch = gc_epoch_;
+    }
 }
 
 ImplicitBaseP
@@ -2314,6 +2574,7 @@ ServerConnectionImpl::dispatch ()
   ProtoMsg *fb = transport_channel_.fetch_msg();
   if (!fb)
     return;
+  RAPICORN_TRACE_SCOPE ("Aida::ServerConnection::dispatch");
   ProtoScope server_connection_protocol_scope (*this);
   ProtoReader fbr (*fb);
   const MessageId msgid = MessageId (fbr.pop_int64());
@@ -2365,26 +2626,30 @@ ServerConnectionImpl::dispatch ()
       }
       break;
     case MSGID_META_GARBAGE_REPORT:
-      if (sweep_remotes_)
+      if (gc_sweeping_)
         {
+          Metrics::Histogram::Latency report_latency_scope (gc_report_latency);
           const uint64 __attribute__ ((__unused__)) hashhigh = fbr.pop_int64(), hashlow = fbr.pop_int64();
-          const uint64 sweeps = sweep_remotes_->size();
           const uint64 n_ids = fbr.pop_int64();
-          std::unordered_set<uint64> trashids;
-          trashids.reserve (n_ids);
+          uint64 retain = 0, purge = 0;
           for (uint64 i = 0; i < n_ids; i++)
-            trashids.insert (fbr.pop_int64());
-          uint64 retain = 0;
-          for (auto orbop : *sweep_remotes_)
-            if (trashids.find (orbop->orbid()) == trashids.end())
-              {
-                live_remotes_.insert (orbop);   // retained objects
-                retain++;
-              }
-          delete sweep_remotes_;                // deletes references
-          sweep_remotes_ = NULL;
+            {
+              auto it = live_remotes_.find (fbr.pop_int64());
+              if (it == live_remotes_.end())
+                continue;
+              if (it->second.epoch >= gc_epoch_)
+                retain++;                       // exported again during the sweep
+              else
+                {
+                  live_remotes_.erase (it);     // deletes reference
+                  purge++;
+                }
+            }
+          gc_sweeping_ = false;
+          gc_purged.add (purge);
+          gc_retained.add (retain);
           GCLOG ("ServerConnectionImpl: GARBAGE_COLLECTED: considered=%u retained=%u purged=%u active=%u",
-                 sweeps, retain, sweeps - retain, live_remotes_.size());
+                 n_ids, retain, purge, live_remotes_.size());
         }
       break;
     case MSGID_EMIT_RESULT:
@@ -2461,61 +2726,42 @@ struct HashTypeHash {
   }
 };
 
-typedef std::unordered_map<TypeHash, DispatchFunc, HashTypeHash> DispatcherMap;
-static DispatcherMap                    *global_dispatcher_map = NULL;
-static pthread_mutex_t                   global_dispatcher_mutex = PTHREAD_MUTEX_INITIALIZER;
-static bool                              global_dispatcher_map_frozen = false;
+typedef RcuMap<TypeHash, DispatchFunc, HashTypeHash> DispatcherMap;
 
-static inline void
-ensure_dispatcher_map()
+static DispatcherMap&
+global_dispatcher_map()
 {
-  if (AIDA_UNLIKELY (global_dispatcher_map == NULL))
-    {
-      pthread_mutex_lock (&global_dispatcher_mutex);
-      if (!global_dispatcher_map)
-        global_dispatcher_map = new DispatcherMap();
-      pthread_mutex_unlock (&global_dispatcher_mutex);
-    }
+  static DispatcherMap &dispatcher_map = *new DispatcherMap(); // leaked, used by static ctors and across static dtors
+  return dispatcher_map;
 }
 
 DispatchFunc
 ServerConnection::find_method (uint64 hashhi, uint64 hashlo)
 {
   TypeHash typehash (hashhi, hashlo);
-#if 1 // avoid costly mutex locking
-  if (AIDA_UNLIKELY (global_dispatcher_map_frozen == false))
-    {
-      ensure_dispatcher_map();
-      global_dispatcher_map_frozen = true;
-    }
-  return (*global_dispatcher_map)[typehash]; // unknown hashes *shouldn't* happen, see assertion in caller
-#else
-  ensure_dispatcher_map();
-  pthread_mutex_lock (&global_dispatcher_mutex);
-  DispatchFunc dispatcher_func = (*global_dispatcher_map)[typehash];
-  pthread_mutex_unlock (&global_dispatcher_mutex);
-  return dispatcher_func;
-#endif
+  return global_dispatcher_map().lookup (typehash); // unknown hashes *shouldn't* happen, see assertion in caller
 }
 
 void
-ServerConnection::MethodRegistry::register_method (const MethodEntry &mentry)
-{
-  ensure_dispatcher_map();
-  assert_return (global_dispatcher_map_frozen == false);
-  pthread_mutex_lock (&global_dispatcher_mutex);
-  DispatcherMap::size_type size_before = global_dispatcher_map->size();
-  TypeHash typehash (mentry.hashhi, mentry.hashlo);
-  (*global_dispatcher_map)[typehash] = mentry.dispatcher;
-  DispatcherMap::size_type size_after = global_dispatcher_map->size();
-  pthread_mutex_unlock (&global_dispatcher_mutex);
+ServerConnection::MethodRegistry::register_methods (const MethodEntry *mentries, size_t n_mentries)
+{
+  const MethodEntry *collision = NULL;
+  global_dispatcher_map().update ([&] (DispatcherMap::Map &map) {
+      for (size_t i = 0; i < n_mentries && !collision; i++)
+        {
+          DispatchFunc &dispatcher = map[TypeHash (mentries[i].hashhi, mentries[i].hashlo)];
+          if (dispatcher)
+            collision = &mentries[i];
+          dispatcher = mentries[i].dispatcher;
+        }
+    });
   // simple hash collision check (sanity check, see below)
-  if (AIDA_UNLIKELY (size_before == size_after))
+  if (AIDA_UNLIKELY (collision))
     {
       errno = EKEYREJECTED;
       perror (string_format ("%s:%u: Aida::ServerConnection::MethodRegistry::register_method: "
                              "duplicate hash registration (%016x%016x)",
-                             __FILE__, __LINE__, mentry.hashhi, mentry.hashlo).c_str());
+                             __FILE__, __LINE__, collision->hashhi, collision->hashlo).c_str());
       abort();
     }
 }
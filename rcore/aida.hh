@@ -9,6 +9,8 @@
 #include <stdarg.h>
 #include <type_traits>
 #include <future>
+#include <atomic>
+#include <algorithm>
 #include <set>
 #include <map>
 
@@ -376,36 +378,48 @@ class Any /// Generic value type that can hold values of all other types.
     template<class V> inline
     AnyField (const std::string &_name, V &&value) : Any (::std::forward<V> (value)), name (_name) {}
   };
-  struct PlaceHolder {
-    virtual                      ~PlaceHolder() {}
-    virtual PlaceHolder*          clone      () const = 0;
-    virtual const std::type_info& type_info  () const = 0;
-    virtual bool                  operator== (const PlaceHolder&) const = 0;
+  struct LocalValue;
+  struct LocalType {            // Operations for a LOCAL value type, one static instance per type
+    const std::type_info &type;
+    void (*copy)     (LocalValue &dest, const LocalValue &src);
+    void (*relocate) (LocalValue &dest, LocalValue &src);
+    void (*destroy)  (LocalValue &value);
+    bool (*equals)   (const LocalValue &a, const LocalValue &b);
   };
-  template<class T> struct Holder : PlaceHolder {
-    explicit                      Holder    (const T &value) : value_ (value) {}
-    virtual PlaceHolder*          clone     () const { return new Holder (value_); }
-    virtual const std::type_info& type_info () const { return typeid (T); }
-    virtual bool                  operator== (const PlaceHolder &rhs) const
-    { const Holder *other = dynamic_cast<const Holder*> (&rhs); return other ? eq (this, other) : false; }
-    template<class Q = T> static typename std::enable_if<IsComparable<Q>::value, bool>::
-    type eq (const Holder *a, const Holder *b) { return a->value_ == b->value_; }
-    template<class Q = T> static typename std::enable_if<!IsComparable<Q>::value, bool>::
-    type eq (const Holder *a, const Holder *b) { return false; }
-    T value_;
+  struct LocalValue {           // LOCAL values are stored inline if small enough, on the heap otherwise
+    const LocalType *ltype;
+    union { void *ptr; int64 mem[AIDA_I64ELEMENTS (sizeof (String)) - 1]; }; // LocalValue fits into Any::u_
+  };
+  template<class T> struct LocalTypeT {
+    static constexpr bool inlined = sizeof (T) <= sizeof (LocalValue::mem) && alignof (T) <= alignof (int64) &&
+                                    ::std::is_nothrow_move_constructible<T>::value;
+    static T*   ptr      (const LocalValue &v)                  { return inlined ? (T*) v.mem : (T*) v.ptr; }
+    static void create   (LocalValue &v, const T &value)        { v.ltype = type(); if (inlined) new (v.mem) T (value); else v.ptr = new T (value); }
+    static void copy     (LocalValue &d, const LocalValue &s)   { create (d, *ptr (s)); }
+    static void relocate (LocalValue &d, LocalValue &s)
+    { if (inlined) { new (d.mem) T (::std::move (*ptr (s))); ptr (s)->~T(); } else d.ptr = s.ptr; }
+    static void destroy  (LocalValue &v)                        { if (inlined) ptr (v)->~T(); else delete ptr (v); }
+    template<class Q> static typename std::enable_if<IsComparable<Q>::value, bool>::
+    type eq (const Q *a, const Q *b) { return *a == *b; }
+    template<class Q> static typename std::enable_if<!IsComparable<Q>::value, bool>::
+    type eq (const Q *a, const Q *b) { return false; }
+    static bool equals   (const LocalValue &a, const LocalValue &b) { return eq (ptr (a), ptr (b)); }
+    static const LocalType*
+    type ()
+    {
+      static const LocalType ltype = { typeid (T), copy, relocate, destroy, equals };
+      return &ltype;
+    }
   };
   template<class Type> Type
   cast_holder () const
   {
-    if (kind() == LOCAL)
-      {
-        const std::type_info &tt = typeid (Type);
-        const std::type_info &ht = u_.pholder->type_info();
-        if (tt == ht)
-          return static_cast<Holder<Type>*> (u_.pholder)->value_;
-      }
+    if (kind() == LOCAL && u_.vlocal.ltype &&
+        (u_.vlocal.ltype == LocalTypeT<Type>::type() || u_.vlocal.ltype->type == typeid (Type)))
+      return *LocalTypeT<Type>::ptr (u_.vlocal);
     return Type();
   }
+  template<class T> struct Shared;      // Reference counted payload, shared between copies until modified
   ///@endcond
 public:
 #ifndef DOXYGEN
@@ -428,23 +442,21 @@ private:
   ///@cond
   typedef RemoteMember<RemoteHandle> ARemoteHandle;
   union {
-    uint64 vuint64; int64 vint64; double vdouble; Any *vany; PlaceHolder *pholder;
+    uint64 vuint64; int64 vint64; double vdouble; Any *vany; LocalValue vlocal;
     struct { int64 venum64; const EnumInfo *enum_info; };
+    Shared<String> *sstring; Shared<AnyVector> *sanys; Shared<FieldVector> *sfields;
     int64 dummy_[AIDA_I64ELEMENTS (MAX (MAX (sizeof (String), sizeof (std::vector<void*>)),
                                         MAX (sizeof (ImplicitBaseP), sizeof (ARemoteHandle))))];
-    FieldVector&         vfields () { return *(FieldVector*) this; static_assert (sizeof (FieldVector) <= sizeof (*this), ""); }
-    const FieldVector&   vfields () const { return *(const FieldVector*) this; }
-    AnyVector&           vanys   () { return *(AnyVector*) this; static_assert (sizeof (AnyVector) <= sizeof (*this), ""); }
-    const AnyVector&     vanys   () const { return *(const AnyVector*) this; }
-    String&              vstring () { return *(String*) this; static_assert (sizeof (String) <= sizeof (*this), ""); }
-    const String&        vstring () const { return *(const String*) this; }
     ImplicitBaseP&       ibase   () { return *(ImplicitBaseP*) this; static_assert (sizeof (ImplicitBaseP) <= sizeof (*this), ""); }
     const ImplicitBaseP& ibase   () const { return *(const ImplicitBaseP*) this; }
     ARemoteHandle&       rhandle () { return *(ARemoteHandle*) this; static_assert (sizeof (ARemoteHandle) <= sizeof (*this), ""); }
     const ARemoteHandle& rhandle () const { return *(const ARemoteHandle*) this; }
   } u_;
   ///@endcond
-  void    hold    (PlaceHolder*);
+  void    hold    (LocalValue &value);
+  const String&      vstring () const;
+  const AnyVector&   vanys   () const;
+  const FieldVector& vfields () const;
   void    ensure  (TypeKind _kind) { if (AIDA_LIKELY (kind() == _kind)) return; rekind (_kind); }
   void    rekind  (TypeKind _kind);
 public:
@@ -546,7 +558,7 @@ public:
   template<typename T, REQUIRES< IsImplicitBaseDerivedP<T>::value > = true>            void set (T v) { return set_ibase (v.get()); }
   template<typename T, REQUIRES< IsRemoteHandleDerived<T>::value > = true>             void set (T v) { return set_handle (v); }
   template<typename T, REQUIRES< std::is_base_of<Any, T>::value > = true>              void set (const T &v) { return set_any (&v); }
-  template<typename T, REQUIRES< IsLocalClass<T>::value > = true>                      void set (const T &v) { hold (new Holder<T> (v)); }
+  template<typename T, REQUIRES< IsLocalClass<T>::value > = true>                      void set (const T &v) { LocalValue l; LocalTypeT<T>::create (l, v); hold (l); }
   // convenience
   static Any          any_from_strings (const std::vector<std::string> &string_container);
   std::vector<String> any_to_strings   () const;
@@ -731,8 +743,8 @@ public:
   struct MethodRegistry    /// Registry structure for IPC method stubs.
   {
     template<size_t S> MethodRegistry  (const MethodEntry (&static_const_entries)[S])
-    { for (size_t i = 0; i < S; i++) register_method (static_const_entries[i]); }
-  private: static void register_method  (const MethodEntry &mentry);
+    { register_methods (static_const_entries, S); }
+  private: static void register_methods (const MethodEntry *mentries, size_t n_mentries);
   };
 };
 
@@ -123,6 +123,99 @@ struct HandlerLink {
   }
 };
 
+/// Generate a unique, non-0 handler connection ID.
+inline size_t
+handler_connection_id ()
+{
+  static std::atomic<size_t> last_id { 0 };
+  return ++last_id;
+}
+
+/** HandlerList stores signal handlers in place and supports modifications during emissions.
+ * Handlers connected during an emission are not invoked by that emission, handlers disconnected
+ * during an emission are deactivated and removed once the outermost emission finishes. The
+ * storage of running handlers is never moved or freed during emissions, if needed, the handler
+ * array is copied into a new buffer and the old buffer is retired until all emissions finished.
+ */
+template<class Function>
+struct HandlerList {
+  struct Handler {
+    size_t   id;                // 0 if disconnected
+    Function function;
+  };
+  static constexpr size_t DEFAULT_ID = ~size_t (0);     // id of a signal's default handler
+  std::vector<Handler>    handlers;
+  std::vector<std::vector<Handler>> retired;            // buffers in use by running emissions
+  uint                    emitting;                     // depth of running emissions
+  bool                    dirty;                        // deactivated handlers need removal
+  bool                    disposed;                     // signal has been destroyed
+  explicit HandlerList () : emitting (0), dirty (false), disposed (false) { handlers.reserve (2); }
+  size_t
+  add (const Function &callback, size_t id)
+  {
+    if (emitting && handlers.size() == handlers.capacity())
+      {
+        std::vector<Handler> grown;
+        grown.reserve (2 * handlers.size());
+        grown.insert (grown.end(), handlers.begin(), handlers.end()); // copy, running handlers stay in place
+        retired.push_back (std::move (handlers));
+        handlers.swap (grown);
+      }
+    handlers.push_back (Handler { id, callback });
+    return id;
+  }
+  bool
+  remove (size_t id)
+  {
+    for (size_t i = 0; i < handlers.size(); i++)
+      if (id == handlers[i].id)
+        {
+          if (emitting)
+            {
+              handlers[i].id = 0;       // deactivate, running handlers must not be destroyed
+              dirty = true;
+            }
+          else
+            handlers.erase (handlers.begin() + i);
+          return true;
+        }
+    return false;
+  }
+  void
+  dispose ()                            // destroy or defer destruction until emissions finished
+  {
+    if (!emitting)
+      {
+        delete this;
+        return;
+      }
+    for (auto &handler : handlers)
+      handler.id = 0;
+    disposed = true;
+  }
+  void
+  emission_done ()
+  {
+    if (--emitting)
+      return;
+    retired.clear();
+    if (disposed)
+      delete this;
+    else if (dirty)
+      {
+        dirty = false;
+        auto last = std::remove_if (handlers.begin(), handlers.end(), [] (const Handler &h) { return h.id == 0; });
+        handlers.erase (last, handlers.end());
+      }
+  }
+  class Emission {                      // guards a running emission
+    HandlerList &list_;
+  public:
+    explicit Emission (HandlerList &list) : list_ (list) { list_.emitting++; }
+    /*dtor*/ ~Emission ()                                 { list_.emission_done(); }
+  };
+};
+
 /// ProtoSignal template specialised for the callback signature and collector.
 template<class Collector, class R, class... Args>
 class ProtoSignal<R (Args...), Collector> : private CollectorInvocation<Collector, R (Args...)> {
@@ -130,93 +223,62 @@ protected:
   typedef std::function<R (Args...)>          CbFunction;
   typedef typename CbFunction::result_type    Result;
   typedef typename Collector::CollectorResult CollectorResult;
-  typedef HandlerLink<CbFunction>             SignalLink;
+  typedef HandlerList<CbFunction>             SignalHandlers;
 private:
-  SignalLink   *callback_ring_; // linked ring of callback nodes
+  SignalHandlers *handler_list_;        // allocated upon first connection
   /*copy-ctor*/ ProtoSignal (const ProtoSignal&) = delete;
   ProtoSignal&  operator=   (const ProtoSignal&) = delete;
-  void
-  ensure_ring ()
+  SignalHandlers&
+  ensure_handlers ()
   {
-    if (!callback_ring_)
-      {
-        callback_ring_ = new SignalLink (CbFunction()); // ref_count = 1
-        callback_ring_->incref(); // ref_count = 2, head of ring, can be deactivated but not removed
-        callback_ring_->next = callback_ring_; // ring head initialization
-        callback_ring_->prev = callback_ring_; // ring tail initialization
-      }
+    if (!handler_list_)
+      handler_list_ = new SignalHandlers();
+    return *handler_list_;
   }
 protected:
   /// ProtoSignal constructor, connects default callback if non-NULL.
   ProtoSignal (const CbFunction &method) :
-    callback_ring_ (NULL)
+    handler_list_ (NULL)
   {
     if (method != NULL)
-      {
-        ensure_ring();
-        callback_ring_->function = method;
-      }
+      ensure_handlers().add (method, SignalHandlers::DEFAULT_ID);
   }
   /// ProtoSignal destructor releases all resources associated with this signal.
   ~ProtoSignal ()
   {
-    if (callback_ring_)
-      {
-        while (callback_ring_->next != callback_ring_)
-          callback_ring_->next->unlink();
-        AIDA_ASSERT_RETURN (callback_ring_->ref_count >= 2);
-        callback_ring_->decref();
-        callback_ring_->decref();
-      }
+    if (handler_list_)
+      handler_list_->dispose();         // deferred if emissions are running
   }
 public:
   /// Operator to add a new function or lambda as signal handler, returns a handler connection ID.
-  size_t connect    (const CbFunction &cb)      { ensure_ring(); return callback_ring_->add_before (cb); }
+  size_t connect    (const CbFunction &cb)      { return ensure_handlers().add (cb, handler_connection_id()); }
   /// Operator to remove a signal handler through its connection ID, returns if a handler was removed.
-  bool   disconnect (size_t connection)         { return callback_ring_ ? callback_ring_->remove_sibling (connection) : false; }
-  /// Emit a signal, i.e. invoke all its callbacks and collect return types with the Collector.
+  bool
+  disconnect (size_t connection)
+  {
+    if (!handler_list_ || !connection || connection == SignalHandlers::DEFAULT_ID)
+      return false;
+    return handler_list_->remove (connection);
+  }
+  /** Emit a signal, i.e. invoke all its callbacks and collect return types with the Collector.
+   * Emissions need no allocations or reference counting, handler disconnection and signal
+   * destruction during emissions are deferred via SignalHandlers::Emission.
+   */
   CollectorResult
   emit (Args... args)
   {
-    // check if an emission is needed
     Collector collector;
-    if (!callback_ring_)
+    SignalHandlers *const list = handler_list_;
+    if (!list)
       return collector.result();
-    // capture and incref signal handler list
-    const bool have_link0 = callback_ring_->function != NULL;
-    size_t capacity = 1 * have_link0;
-    SignalLink *link;
-    for (link = callback_ring_->next; link != callback_ring_; link = link->next)
-      capacity++;       // capacity measuring is O(n), but we expect n to be small generally
-    SignalLink *links[capacity];
-    size_t nlinks = 0;
-    if (have_link0)
-      {
-        callback_ring_->incref();
-        links[nlinks++] = callback_ring_;
-      }
-    for (link = callback_ring_->next; link != callback_ring_; link = link->next)
+    const size_t n_handlers = list->handlers.size();    // ignore handlers connected during emission
+    typename SignalHandlers::Emission emission (*list);
+    for (size_t i = 0; i < n_handlers; i++)
       {
-        link->incref();
-        links[nlinks++] = link;
-      }
-    AIDA_ASSERT_RETURN (nlinks <= capacity, collector.result());
-    // walk signal handler list, invoke and decref
-    size_t i;
-    for (i = 0; i < nlinks; i++)
-      {
-        SignalLink *link = links[i];
-        if (link->function)
-          {
-            const bool continue_emission = this->invoke (collector, link->function, args...);
-            if (!continue_emission)
-              break;
-          }
-        link->decref();
+        const typename SignalHandlers::Handler &handler = list->handlers[i]; // handlers may be reallocated by connect()
+        if (handler.id && !this->invoke (collector, handler.function, args...))
+          break;
       }
-    for (; i < nlinks; i++)
-      links[i]->decref();       // continue decref after 'break'
-    // done
     return collector.result();
   }
 };
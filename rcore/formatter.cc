@@ -12,169 +12,6 @@
 namespace Rapicorn {
 namespace Lib {
 
-template<class... Args> static std::string
-system_string_printf (const char *format, Args... args)
-{
-  char *cstr = NULL;
-  int ret = asprintf (&cstr, format, args...);
-  if (ret >= 0 && cstr)
-    {
-      std::string result = cstr;
-      free (cstr);
-      return result;
-    }
-  return format;
-}
-
-static bool
-parse_unsigned_integer (const char **stringp, uint64_t *up)
-{ // '0' | [1-9] [0-9]* : <= 18446744073709551615
-  const char *p = *stringp;
-  // zero
-  if (*p == '0' && !(p[1] >= '0' && p[1] <= '9'))
-    {
-      *up = 0;
-      *stringp = p + 1;
-      return true;
-    }
-  // first digit
-  if (!(*p >= '1' && *p <= '9'))
-    return false;
-  uint64_t u = *p - '0';
-  p++;
-  // rest digits
-  while (*p >= '0' && *p <= '9')
-    {
-      const uint64_t last = u;
-      u = u * 10 + (*p - '0');
-      p++;
-      if (u < last) // overflow
-        return false;
-    }
-  *up = u;
-  *stringp = p;
-  return true;
-}
-
-static bool
-parse_positional (const char **stringp, uint64_t *ap)
-{ // [0-9]+ '$'
-  const char *p = *stringp;
-  uint64_t ui64 = 0;
-  if (parse_unsigned_integer (&p, &ui64) && *p == '$')
-    {
-      p++;
-      *ap = ui64;
-      *stringp = p;
-      return true;
-    }
-  return false;
-}
-
-const char*
-StringFormatter::parse_directive (const char **stringp, size_t *indexp, Directive *dirp)
-{ // '%' positional? [-+#0 '']* ([0-9]*|[*]positional?) ([.]([0-9]*|[*]positional?))? [hlLjztqZ]* [spmcCdiouXxFfGgEeAa]
-  const char *p = *stringp;
-  size_t index = *indexp;
-  Directive fdir;
-  // '%' directive start
-  if (*p != '%')
-    return "missing '%' at start";
-  p++;
-  // positional argument
-  uint64_t ui64 = -1;
-  if (parse_positional (&p, &ui64))
-    {
-      if (ui64 > 0 && ui64 <= 2147483647)
-        fdir.value_index = ui64;
-      else
-        return "invalid positional specification";
-    }
-  // flags
-  const char *flags = "-+#0 '";
-  while (strchr (flags, *p))
-    switch (*p)
-      {
-      case '-': fdir.adjust_left = true;        goto default_case;
-      case '+': fdir.add_sign = true;           goto default_case;
-      case '#': fdir.alternate_form = true;     goto default_case;
-      case '0': fdir.zero_padding = true;       goto default_case;
-      case ' ': fdir.add_space = true;          goto default_case;
-      case '\'': fdir.locale_grouping = true;   goto default_case;
-      default: default_case:
-        p++;
-        break;
-      }
-  // field width
-  ui64 = 0;
-  if (*p == '*')
-    {
-      p++;
-      if (parse_positional (&p, &ui64))
-        {
-          if (ui64 > 0 && ui64 <= 2147483647)
-            fdir.width_index = ui64;
-          else
-            return "invalid positional specification";
-        }
-      else
-        fdir.width_index = index++;
-      fdir.use_width = true;
-    }
-  else if (parse_unsigned_integer (&p, &ui64))
-    {
-      if (ui64 <= 2147483647)
-        fdir.field_width = ui64;
-      else
-        return "invalid field width specification";
-      fdir.use_width = true;
-    }
-  // precision
-  if (*p == '.')
-    {
-      fdir.use_precision = true;
-      p++;
-    }
-  if (*p == '*')
-    {
-      p++;
-      if (parse_positional (&p, &ui64))
-        {
-          if (ui64 > 0 && ui64 <= 2147483647)
-            fdir.precision_index = ui64;
-          else
-            return "invalid positional specification";
-        }
-      else
-        fdir.precision_index = index++;
-    }
-  else if (parse_unsigned_integer (&p, &ui64))
-    {
-      if (ui64 <= 2147483647)
-        fdir.precision = ui64;
-      else
-        return "invalid precision specification";
-    }
-  // modifiers
-  const char *modifiers = "hlLjztqZ";
-  while (strchr (modifiers, *p))
-    p++;
-  // conversion
-  const char *conversion = "dioucCspmXxEeFfGgAa%";
-  if (!strchr (conversion, *p))
-    return "missing conversion specifier";
-  if (fdir.value_index == 0 && !strchr ("m%", *p))
-    fdir.value_index = index++;
-  fdir.conversion = *p++;
-  if (fdir.conversion == 'C')   // %lc in SUSv2
-    fdir.conversion = 'c';
-  // success
-  *dirp = fdir;
-  *indexp = index;
-  *stringp = p;
-  return NULL; // OK
-}
-
 const StringFormatter::FormatArg&
 StringFormatter::format_arg (size_t nth)
 {
@@ -253,76 +90,188 @@ StringFormatter::arg_as_precision (size_t nth)
   return MAX (0, precision);
 }
 
-template<class Arg> std::string
-StringFormatter::render_arg (const Directive &dir, const char *modifier, Arg arg)
+void
+StringFormatter::Output::append (const char *s, size_t n)
+{
+  if (string)
+    string->append (s, n);
+  else if (length < size)
+    memcpy (buffer + length, s, MIN (n, size - length));
+  length += n;
+}
+
+void
+StringFormatter::Output::append (size_t n, char c)
+{
+  if (string)
+    string->append (n, c);
+  else if (length < size)
+    memset (buffer + length, c, MIN (n, size - length));
+  length += n;
+}
+
+void
+StringFormatter::Output::finish ()
+{
+  if (buffer && size)
+    buffer[MIN (length, size - 1)] = 0;
+}
+
+template<class Arg> void
+StringFormatter::render_arg (const Directive &dir, const char *modifier, Arg arg, Output &output)
 {
-  std::string result, format;
   const int field_width = !dir.use_width || !dir.width_index ? dir.field_width : arg_as_width (dir.width_index);
   const int field_precision = !dir.use_precision || !dir.precision_index ? MAX (0, dir.precision) : arg_as_precision (dir.precision_index);
   // format directive
-  format += '%';
+  char format[32], *f = format;
+  *f++ = '%';
   if (dir.adjust_left)
-    format += '-';
+    *f++ = '-';
   if (dir.add_sign)
-    format += '+';
+    *f++ = '+';
   if (dir.add_space)
-    format += ' ';
+    *f++ = ' ';
   if (dir.zero_padding && !dir.adjust_left&& strchr ("diouXx" "FfGgEeAa", dir.conversion))
-    format += '0';
+    *f++ = '0';
   if (dir.alternate_form && strchr ("oXx" "FfGgEeAa", dir.conversion))
-    format += '#';
+    *f++ = '#';
   if (dir.locale_grouping && strchr ("idu" "FfGg", dir.conversion))
-    format += '\'';
+    *f++ = '\'';
   if (dir.use_width)
-    format += '*';
+    *f++ = '*';
   if (dir.use_precision && strchr ("sm" "diouXx" "FfGgEeAa", dir.conversion)) // !cp
-    format += ".*";
-  if (modifier)
-    format += modifier;
-  format += dir.conversion;
+    {
+      *f++ = '.';
+      *f++ = '*';
+    }
+  for (const char *m = modifier; m && *m; m++)
+    *f++ = *m;
+  *f++ = dir.conversion;
+  *f = 0;
   // printf formatting
-  if (dir.use_width && dir.use_precision)
-    return system_string_printf (format.c_str(), field_width, field_precision, arg);
-  else if (dir.use_precision)
-    return system_string_printf (format.c_str(), field_precision, arg);
-  else if (dir.use_width)
-    return system_string_printf (format.c_str(), field_width, arg);
+  auto system_printf = [&] (char *buffer, size_t size) {
+    if (dir.use_width && dir.use_precision)
+      return snprintf (buffer, size, format, field_width, field_precision, arg);
+    else if (dir.use_precision)
+      return snprintf (buffer, size, format, field_precision, arg);
+    else if (dir.use_width)
+      return snprintf (buffer, size, format, field_width, arg);
+    else
+      return snprintf (buffer, size, format, arg);
+  };
+  char buffer[256];
+  const int n = system_printf (buffer, sizeof (buffer));
+  if (n < 0)
+    output.append (format, f - format);
+  else if (size_t (n) < sizeof (buffer))
+    output.append (buffer, n);
+  else
+    {
+      std::vector<char> large (n + 1);
+      system_printf (large.data(), large.size());
+      output.append (large.data(), n);
+    }
+}
+
+/// Render integer and character conversions without flags and precision directly, bypassing snprintf().
+void
+StringFormatter::render_integer (const Directive &dir, Output &output)
+{
+  const FormatArg &farg = format_arg (dir.value_index);
+  const bool is_signed = dir.conversion == 'd' || dir.conversion == 'i';
+  LLong value;
+  switch (farg.kind)
+    { // mimick the conversions applied by the "hh", "h", "", "l" and "ll" modifiers
+    case '1':   value = is_signed ? LLong (farg.i1) : LLong ((unsigned char) farg.i1);         break;
+    case '2':   value = is_signed ? LLong (farg.i2) : LLong ((unsigned short) farg.i2);        break;
+    case '4':   value = is_signed ? LLong (farg.i4) : LLong ((unsigned int) farg.i4);          break;
+    case '6':   value = is_signed ? LLong (farg.i6) : LLong ((unsigned long) farg.i6);         break;
+    case '8':   value = farg.i8;                                                                break;
+    default:    value = arg_as_longlong (dir.value_index);                                      break;
+    }
+  char digits[24], *const dend = digits + sizeof (digits), *d = dend;
+  bool negative = false;
+  if (dir.conversion == 'c')
+    *--d = (unsigned char) value;
   else
-    return system_string_printf (format.c_str(), arg);
+    {
+      ULLong u = value;
+      if (is_signed && value < 0)
+        {
+          negative = true;
+          u = ULLong (-(value + 1)) + 1;
+        }
+      if (dir.conversion == 'x' || dir.conversion == 'X')
+        {
+          const char *hexdigits = dir.conversion == 'x' ? "0123456789abcdef" : "0123456789ABCDEF";
+          do
+            *--d = hexdigits[u & 0xf];
+          while (u >>= 4);
+        }
+      else
+        do
+          *--d = '0' + u % 10;
+        while (u /= 10);
+    }
+  const size_t length = dend - d + negative;
+  const size_t field_width = !dir.use_width ? 0 : !dir.width_index ? dir.field_width : arg_as_width (dir.width_index);
+  const size_t padding = field_width > length ? field_width - length : 0;
+  if (padding && !dir.adjust_left && !(dir.zero_padding && dir.conversion != 'c'))
+    output.append (padding, ' ');
+  if (negative)
+    output.append ("-", 1);
+  if (padding && !dir.adjust_left && dir.zero_padding && dir.conversion != 'c')
+    output.append (padding, '0');
+  output.append (d, dend - d);
+  if (padding && dir.adjust_left)
+    output.append (padding, ' ');
 }
 
-std::string
-StringFormatter::render_directive (const Directive &dir)
+void
+StringFormatter::render_directive (const Directive &dir, Output &output)
 {
+  const bool plain = !dir.use_precision && !dir.add_sign && !dir.add_space && !dir.alternate_form && !dir.locale_grouping;
   switch (dir.conversion)
     {
     case 'm':
-      return render_arg (dir, "", int (0)); // dummy arg to silence compiler
+      return render_arg (dir, "", int (0), output); // dummy arg to silence compiler
     case 'p':
-      return render_arg (dir, "", arg_as_ptr (dir.value_index));
+      return render_arg (dir, "", arg_as_ptr (dir.value_index), output);
     case 's': // precision
-      return render_arg (dir, "", arg_as_chars (dir.value_index));
-    case 'c': case 'd': case 'i': case 'o': case 'u': case 'X': case 'x':
+      if (!dir.use_width && !dir.use_precision)
+        {
+          const char *chars = arg_as_chars (dir.value_index);
+          return output.append (chars, strlen (chars));
+        }
+      return render_arg (dir, "", arg_as_chars (dir.value_index), output);
+    case 'c':
+      if (plain && char_in (format_arg (dir.value_index).kind, "124"))
+        return render_integer (dir, output);
+      // fall through
+    case 'd': case 'i': case 'o': case 'u': case 'X': case 'x':
+      if (plain && dir.conversion != 'o' && dir.conversion != 'c')
+        return render_integer (dir, output);
       switch (format_arg (dir.value_index).kind)
         {
-        case '1':       return render_arg (dir, "hh", format_arg (dir.value_index).i1);
-        case '2':       return render_arg (dir, "h", format_arg (dir.value_index).i2);
-        case '4':       return render_arg (dir, "", format_arg (dir.value_index).i4);
-        case '6':       return render_arg (dir, "l", format_arg (dir.value_index).i6);
-        case '8':       return render_arg (dir, "ll", format_arg (dir.value_index).i8);
-        default:        return render_arg (dir, "ll", arg_as_longlong (dir.value_index));
+        case '1':       return render_arg (dir, "hh", format_arg (dir.value_index).i1, output);
+        case '2':       return render_arg (dir, "h", format_arg (dir.value_index).i2, output);
+        case '4':       return render_arg (dir, "", format_arg (dir.value_index).i4, output);
+        case '6':       return render_arg (dir, "l", format_arg (dir.value_index).i6, output);
+        case '8':       return render_arg (dir, "ll", format_arg (dir.value_index).i8, output);
+        default:        return render_arg (dir, "ll", arg_as_longlong (dir.value_index), output);
         }
     case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
       switch (format_arg (dir.value_index).kind)
         {
-        case 'f':       return render_arg (dir, "", format_arg (dir.value_index).f);
+        case 'f':       return render_arg (dir, "", format_arg (dir.value_index).f, output);
         case 'd':
-        default:        return render_arg (dir, "L", arg_as_ldouble (dir.value_index));
+        default:        return render_arg (dir, "L", arg_as_ldouble (dir.value_index), output);
         }
     case '%':
-      return "%";
+      return output.append ("%", 1);
     }
-  return std::string ("%") + dir.conversion;
+  output.append ("%", 1);
+  output.append (&dir.conversion, 1);
 }
 
 static inline size_t
@@ -339,83 +288,92 @@ upper_directive_count (const char *format)
   return n;
 }
 
-std::string
-StringFormatter::render_format (const size_t last, const char *format)
+/// Parsed format string, kept in a per-thread cache, trivially destructible so formatting works in static dtors.
+struct StringFormatter::ParsedFormat {
+  enum { MAX_SOURCE = 128, MAX_DIRECTIVES = 8 };
+  const char *format;
+  size_t      ndirs, argmaxref;
+  char        source[MAX_SOURCE];
+  Directive   directives[MAX_DIRECTIVES + 1];
+};
+
+void
+StringFormatter::render_format (const size_t last, const char *format, const Directive *fdirs, size_t ndirs,
+                                size_t argmaxref, Output &output)
 {
   assert (last == nargs_);
+  // recurring runtime format strings are parsed once per thread, literal formats at compile time
+  static thread_local ParsedFormat parsed_formats[16];
+  ParsedFormat &cached = parsed_formats[(uintptr_t (format) >> 3) % ARRAY_SIZE (parsed_formats)];
+  const bool cache_hit = !fdirs && cached.format == format && strcmp (cached.source, format) == 0;
   // allocate enough space to hold all directives possibly contained in format
-  const size_t max_dirs = 1 + upper_directive_count (format);
-  RAPICORN_DECLARE_VLA (Directive, fdirs, max_dirs); // Directive fdirs[max_dirs];
-  // parse format into Directive stack
-  size_t nextarg = 1, ndirs = 0;
-  const char *p = format;
-  while (*p)
+  const size_t max_dirs = fdirs ? 1 : 1 + (cache_hit ? cached.ndirs : upper_directive_count (format));
+  RAPICORN_DECLARE_VLA (Directive, pdirs, max_dirs); // Directive pdirs[max_dirs];
+  if (fdirs)
+    ;           // parsed at compile time
+  else if (cache_hit)
     {
-      do
+      ndirs = cached.ndirs;
+      argmaxref = cached.argmaxref;
+      std::copy (cached.directives, cached.directives + ndirs + 1, &pdirs[0]); // arg_transform_ may reenter
+      fdirs = &pdirs[0];
+    }
+  else
+    {
+      const ssize_t n = parse_format (format, &pdirs[0], &argmaxref);
+      if (n < 0)
+        return output.append (format, strlen (format));
+      ndirs = n;
+      if (ndirs <= ParsedFormat::MAX_DIRECTIVES && pdirs[ndirs].end < ParsedFormat::MAX_SOURCE)
         {
-          if (p[0] == '%')
-            break;
-          p++;
+          cached.format = format;
+          memcpy (cached.source, format, pdirs[ndirs].end + 1);
+          cached.ndirs = ndirs;
+          cached.argmaxref = argmaxref;
+          std::copy (&pdirs[0], &pdirs[0] + ndirs + 1, cached.directives);
         }
-      while (*p);
-      if (*p == 0)
-        break;
-      const size_t start = p - format;
-      const char *err = parse_directive (&p, &nextarg, &fdirs[ndirs]);
-      if (err)
-        return format_error (err, format, ndirs + 1);
-      fdirs[ndirs].start = start;
-      fdirs[ndirs].end = p - format;
-      ndirs++;
-      assert (ndirs < max_dirs);
+      fdirs = &pdirs[0];
     }
-  const size_t argcounter = nextarg - 1;
-  fdirs[ndirs].end = fdirs[ndirs].start = p - format;
   // check maximum argument reference and argument count
-  size_t argmaxref = argcounter;
-  for (size_t i = 0; i < ndirs; i++)
+  if (argmaxref != last)
     {
-      const Directive &fdir = fdirs[i];
-      argmaxref = MAX (argmaxref, fdir.value_index);
-      argmaxref = MAX (argmaxref, fdir.width_index);
-      argmaxref = MAX (argmaxref, fdir.precision_index);
+      format_error (argmaxref > last ? "too few arguments for format" : "too many arguments for format", format, 0);
+      return output.append (format, strlen (format));
     }
-  if (argmaxref > last)
-    return format_error ("too few arguments for format", format, 0);
-  if (argmaxref < last)
-    return format_error ("too many arguments for format", format, 0);
   // format pieces
-  std::string result;
-  p = format;
+  const char *p = format;
   for (size_t i = 0; i <= ndirs; i++)
     {
       const Directive &fdir = fdirs[i];
-      result += std::string (p, fdir.start - (p - format));
-      if (fdir.conversion)
+      output.append (p, fdir.start - (p - format));
+      if (fdir.conversion && arg_transform_)
         {
-          String rendered_arg = render_directive (fdir);
-          if (arg_transform_)
-            rendered_arg = arg_transform_ (rendered_arg);
-          result += rendered_arg;
+          std::string rendered_arg;
+          Output routput (rendered_arg);
+          render_directive (fdir, routput);
+          rendered_arg = arg_transform_ (rendered_arg);
+          output.append (rendered_arg.data(), rendered_arg.size());
         }
+      else if (fdir.conversion)
+        render_directive (fdir, output);
       p = format + fdir.end;
     }
-  return result;
 }
 
-std::string
-StringFormatter::locale_format (const size_t last, const char *format)
+void
+StringFormatter::locale_format (const size_t last, const char *format, const Directive *fdirs, size_t ndirs,
+                                size_t argmaxref, Output &output)
 {
   if (locale_context_ == CURRENT_LOCALE)
-    return render_format (last, format);
+    render_format (last, format, fdirs, ndirs, argmaxref, output);
   else
     {
       ScopedPosixLocale posix_locale_scope; // pushes POSIX locale for this scope
-      return render_format (last, format);
+      render_format (last, format, fdirs, ndirs, argmaxref, output);
     }
 }
 
-std::string
+void
 StringFormatter::format_error (const char *err, const char *format, size_t directive)
 {
   const char *cyan = "", *cred = "", *cyel = "", *crst = "";
@@ -434,7 +392,6 @@ StringFormatter::format_error (const char *err, const char *format, size_t direc
     fprintf (stderr, "%sStringFormatter: %sWARNING:%s%s %s in directive %zu:%s %s\n", cyan, cred, crst, cyel, err, directive, crst, format);
   else
     fprintf (stderr, "%sStringFormatter: %sWARNING:%s%s %s:%s %s\n", cyan, cred, crst, cyel, err, crst, format);
-  return format;
 }
 
 } // Lib
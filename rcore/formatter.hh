@@ -76,34 +76,76 @@ class StringFormatter {
     uint32_t adjust_left : 1, add_sign : 1, use_width : 1, use_precision : 1;
     uint32_t alternate_form : 1, zero_padding : 1, add_space : 1, locale_grouping : 1;
     uint32_t field_width, precision, start, end, value_index, width_index, precision_index;
-    Directive() :
+    constexpr Directive() :
       conversion (0), adjust_left (0), add_sign (0), use_width (0), use_precision (0),
       alternate_form (0), zero_padding (0), add_space (0), locale_grouping (0),
       field_width (0), precision (0), start (0), end (0), value_index (0), width_index (0), precision_index (0)
     {}
   };
+  /// Output sink, appends to a std::string or fills a fixed size buffer.
+  struct Output {
+    std::string *const string;
+    char        *const buffer;
+    const size_t       size;
+    size_t             length;
+    explicit Output   (std::string &s)         : string (&s), buffer (NULL), size (0), length (0) {}
+    explicit Output   (char *b, size_t bsize)  : string (NULL), buffer (b), size (bsize), length (0) {}
+    void     append   (const char *s, size_t n);
+    void     append   (size_t n, char c);
+    void     finish   ();
+  };
   typedef std::function<String (const String&)> ArgTransform;
   FormatArg          *const fargs_;
   const size_t        nargs_;
   const int           locale_context_;
   const ArgTransform &arg_transform_;
   vector<std::string> temporaries_;
-  static std::string            format_error     (const char *err, const char *format, size_t directive);
-  static const char*            parse_directive  (const char **stringp, size_t *indexp, Directive *dirp);
-  std::string                   locale_format    (size_t last, const char *format);
-  std::string                   render_format    (size_t last, const char *format);
-  std::string                   render_directive (const Directive &dir);
-  template<class A> std::string render_arg       (const Directive &dir, const char *modifier, A arg);
-  template<size_t N> inline std::string
-  intern_format (const char *format)
+  struct ParsedFormat;
+  static void                   format_error     (const char *err, const char *format, size_t directive);
+  static constexpr bool         char_in          (char c, const char *chars);
+  static constexpr bool         parse_unsigned_integer (const char **stringp, uint64_t *up);
+  static constexpr bool         parse_positional (const char **stringp, uint64_t *ap);
+  static constexpr const char*  parse_directive  (const char **stringp, size_t *indexp, Directive *dirp);
+  static constexpr ssize_t      parse_format     (const char *format, Directive *fdirs, size_t *argmaxrefp);
+  /// Literal format string, parsed into its directives at compile time, an invalid format fails constant evaluation.
+  template<size_t L>
+  class Literal {
+    friend class StringFormatter;
+    const char *format;
+    size_t      ndirs, argmaxref;
+    Directive   directives[L / 2 + 1];      // a directive spans at least 2 characters, plus tail
+  public:
+    constexpr
+    Literal (const char (&literal)[L]) :
+      format (literal), ndirs (0), argmaxref (0), directives()
+    {
+      const ssize_t n = parse_format (literal, directives, &argmaxref);
+      ndirs = n < 0 ? 0 : n;
+    }
+    constexpr size_t n_args () const { return argmaxref; }
+  };
+  void                          locale_format    (size_t last, const char *format, const Directive *fdirs, size_t ndirs,
+                                                  size_t argmaxref, Output &output);
+  void                          render_format    (size_t last, const char *format, const Directive *fdirs, size_t ndirs,
+                                                  size_t argmaxref, Output &output);
+  void                          render_directive (const Directive &dir, Output &output);
+  void                          render_integer   (const Directive &dir, Output &output);
+  template<class A> void        render_arg       (const Directive &dir, const char *modifier, A arg, Output &output);
+  template<size_t N> inline void
+  intern_format (Output &output, const char *format)
+  {
+    locale_format (N, format, NULL, 0, 0, output);
+  }
+  template<size_t N, size_t L> inline void
+  intern_format (Output &output, const Literal<L> &literal)
   {
-    return locale_format (N, format);
+    locale_format (N, literal.format, literal.directives, literal.ndirs, literal.argmaxref, output);
   }
-  template<size_t N, class A, class ...Args> inline std::string
-  intern_format (const char *format, const A &arg, const Args &...args)
+  template<size_t N, class F, class A, class ...Args> inline void
+  intern_format (Output &output, const F &format, const A &arg, const Args &...args)
   {
     assign (fargs_[N], arg);
-    return intern_format<N+1> (format, args...);
+    intern_format<N+1> (output, format, args...);
   }
   template<size_t N> inline constexpr
   StringFormatter (const ArgTransform &arg_transform, size_t nargs, FormatArg (&mem)[N], int lc) :
@@ -137,10 +179,240 @@ public:
     constexpr size_t N = sizeof... (Args);
     FormatArg mem[N ? N : 1];
     StringFormatter formatter (arg_transform, N, mem, LC);
-    return formatter.intern_format<0> (format, arguments...);
+    std::string result;
+    Output output (result);
+    formatter.intern_format<0> (output, format, arguments...);
+    return result;
+  }
+  /** Format like format() into @a buffer of @a size bytes, without allocating for the common conversions.
+   * The output is truncated if needed and always 0-terminated if @a size is non-zero, similar to snprintf().
+   * @returns The length of the untruncated output, excluding the terminating 0.
+   */
+  template<LocaleContext LC = POSIX_LOCALE, class ...Args>
+  static __attribute__ ((__format__ (printf, 3, 0), noinline)) size_t
+  format_to (char *buffer, size_t size, const char *format, const Args &...arguments)
+  {
+    constexpr size_t N = sizeof... (Args);
+    FormatArg mem[N ? N : 1];
+    const ArgTransform no_transform;
+    StringFormatter formatter (no_transform, N, mem, LC);
+    Output output (buffer, size);
+    formatter.intern_format<0> (output, format, arguments...);
+    output.finish();
+    return output.length;
+  }
+  /// Parse a literal @a format at compile time, for use with format_literal(), see RAPICORN_STRING_FORMAT().
+  template<size_t L> static constexpr Literal<L>
+  literal (const char (&format)[L])
+  {
+    return Literal<L> (format);
+  }
+  /// Format like format() with a compile-time parsed @a literal, @a ARGC is checked against the number of arguments.
+  template<size_t ARGC, LocaleContext LC = POSIX_LOCALE, size_t L, class ...Args>
+  static __attribute__ ((noinline)) std::string
+  format_literal (const ArgTransform &arg_transform, const Literal<L> &literal, const Args &...arguments)
+  {
+    constexpr size_t N = sizeof... (Args);
+    static_assert (ARGC == N, "StringFormatter: number of format arguments mismatches format directives");
+    FormatArg mem[N ? N : 1];
+    StringFormatter formatter (arg_transform, N, mem, LC);
+    std::string result;
+    Output output (result);
+    formatter.intern_format<0> (output, literal, arguments...);
+    return result;
   }
 };
 
+constexpr bool
+StringFormatter::char_in (char c, const char *chars)
+{
+  for (const char *p = chars; *p; p++)
+    if (*p == c)
+      return true;
+  return false; // unlike strchr(), never matches the 0-terminator
+}
+
+constexpr bool
+StringFormatter::parse_unsigned_integer (const char **stringp, uint64_t *up)
+{ // '0' | [1-9] [0-9]* : <= 18446744073709551615
+  const char *p = *stringp;
+  // zero
+  if (*p == '0' && !(p[1] >= '0' && p[1] <= '9'))
+    {
+      *up = 0;
+      *stringp = p + 1;
+      return true;
+    }
+  // first digit
+  if (!(*p >= '1' && *p <= '9'))
+    return false;
+  uint64_t u = *p - '0';
+  p++;
+  // rest digits
+  while (*p >= '0' && *p <= '9')
+    {
+      const uint64_t last = u;
+      u = u * 10 + (*p - '0');
+      p++;
+      if (u < last) // overflow
+        return false;
+    }
+  *up = u;
+  *stringp = p;
+  return true;
+}
+
+constexpr bool
+StringFormatter::parse_positional (const char **stringp, uint64_t *ap)
+{ // [0-9]+ '$'
+  const char *p = *stringp;
+  uint64_t ui64 = 0;
+  if (parse_unsigned_integer (&p, &ui64) && *p == '$')
+    {
+      p++;
+      *ap = ui64;
+      *stringp = p;
+      return true;
+    }
+  return false;
+}
+
+constexpr const char*
+StringFormatter::parse_directive (const char **stringp, size_t *indexp, Directive *dirp)
+{ // '%' positional? [-+#0 '']* ([0-9]*|[*]positional?) ([.]([0-9]*|[*]positional?))? [hlLjztqZ]* [spmcCdiouXxFfGgEeAa]
+  const char *p = *stringp;
+  size_t index = *indexp;
+  Directive fdir;
+  // '%' directive start
+  if (*p != '%')
+    return "missing '%' at start";
+  p++;
+  // positional argument
+  uint64_t ui64 = -1;
+  if (parse_positional (&p, &ui64))
+    {
+      if (ui64 > 0 && ui64 <= 2147483647)
+        fdir.value_index = ui64;
+      else
+        return "invalid positional specification";
+    }
+  // flags
+  for (; char_in (*p, "-+#0 '"); p++)
+    switch (*p)
+      {
+      case '-': fdir.adjust_left = true;        break;
+      case '+': fdir.add_sign = true;           break;
+      case '#': fdir.alternate_form = true;     break;
+      case '0': fdir.zero_padding = true;       break;
+      case ' ': fdir.add_space = true;          break;
+      case '\'': fdir.locale_grouping = true;   break;
+      }
+  // field width
+  ui64 = 0;
+  if (*p == '*')
+    {
+      p++;
+      if (parse_positional (&p, &ui64))
+        {
+          if (ui64 > 0 && ui64 <= 2147483647)
+            fdir.width_index = ui64;
+          else
+            return "invalid positional specification";
+        }
+      else
+        fdir.width_index = index++;
+      fdir.use_width = true;
+    }
+  else if (parse_unsigned_integer (&p, &ui64))
+    {
+      if (ui64 <= 2147483647)
+        fdir.field_width = ui64;
+      else
+        return "invalid field width specification";
+      fdir.use_width = true;
+    }
+  // precision
+  if (*p == '.')
+    {
+      fdir.use_precision = true;
+      p++;
+    }
+  if (*p == '*')
+    {
+      p++;
+      if (parse_positional (&p, &ui64))
+        {
+          if (ui64 > 0 && ui64 <= 2147483647)
+            fdir.precision_index = ui64;
+          else
+            return "invalid positional specification";
+        }
+      else
+        fdir.precision_index = index++;
+    }
+  else if (parse_unsigned_integer (&p, &ui64))
+    {
+      if (ui64 <= 2147483647)
+        fdir.precision = ui64;
+      else
+        return "invalid precision specification";
+    }
+  // modifiers
+  while (char_in (*p, "hlLjztqZ"))
+    p++;
+  // conversion
+  if (!char_in (*p, "dioucCspmXxEeFfGgAa%"))
+    return "missing conversion specifier";
+  if (fdir.value_index == 0 && !char_in (*p, "m%"))
+    fdir.value_index = index++;
+  fdir.conversion = *p++;
+  if (fdir.conversion == 'C')   // %lc in SUSv2
+    fdir.conversion = 'c';
+  // success
+  *dirp = fdir;
+  *indexp = index;
+  *stringp = p;
+  return NULL; // OK
+}
+
+/// Parse @a format into @a fdirs plus tail, returns the number of directives or -1 on errors (which fail constant evaluation).
+constexpr ssize_t
+StringFormatter::parse_format (const char *format, Directive *fdirs, size_t *argmaxrefp)
+{
+  size_t nextarg = 1, ndirs = 0;
+  const char *p = format;
+  while (*p)
+    {
+      while (*p && *p != '%')
+        p++;
+      if (*p == 0)
+        break;
+      const size_t start = p - format;
+      const char *err = parse_directive (&p, &nextarg, &fdirs[ndirs]);
+      if (err)
+        {
+          format_error (err, format, ndirs + 1);
+          return -1;
+        }
+      fdirs[ndirs].start = start;
+      fdirs[ndirs].end = p - format;
+      ndirs++;
+    }
+  fdirs[ndirs] = Directive();
+  fdirs[ndirs].end = fdirs[ndirs].start = p - format;
+  // determine maximum argument reference
+  size_t argmaxref = nextarg - 1;
+  for (size_t i = 0; i < ndirs; i++)
+    {
+      const Directive &fdir = fdirs[i];
+      argmaxref = MAX (argmaxref, fdir.value_index);
+      argmaxref = MAX (argmaxref, fdir.width_index);
+      argmaxref = MAX (argmaxref, fdir.precision_index);
+    }
+  *argmaxrefp = argmaxref;
+  return ndirs;
+}
+
 } // Lib
 } // Rapicorn
 
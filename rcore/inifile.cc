@@ -304,7 +304,12 @@ IniFile::load_ini (const String &inputname, const String &data)
           if (strchr (section.c_str(), '=') || strchr (key.c_str(), '.'))
             RAPICORN_DIAG ("%s:%d: invalid key name: %s.%s", inputname.c_str(), lineno, section.c_str(), k.c_str());
           else
-            sections_[section].push_back (k + "=" + text);
+            {
+              sections_[section].push_back (k + "=" + text);
+              const String dotpath = section + "." + k;
+              if (values_.find (dotpath) == values_.end())
+                values_[dotpath] = Value { text, cook_string (text) };
+            }
         }
       else if (skip_line (&p, &nextno, debugp))
         {
@@ -340,6 +345,7 @@ IniFile&
 IniFile::operator= (const IniFile &source)
 {
   sections_  = source.sections_;
+  values_    = source.values_;
   return *this;
 }
 
@@ -370,7 +376,7 @@ StringVector
 IniFile::sections () const
 {
   StringVector secs;
-  for (auto it : sections_)
+  for (const auto &it : sections_)
     secs.push_back (it.first);
   return secs;
 }
@@ -381,7 +387,7 @@ IniFile::attributes (const String &section) const
   StringVector opts;
   SectionMap::const_iterator cit = sections_.find (section);
   if (cit != sections_.end())
-    for (auto s : cit->second)
+    for (const auto &s : cit->second)
       opts.push_back (s.substr (0, s.find ('=')));
   return opts;
 }
@@ -389,21 +395,15 @@ IniFile::attributes (const String &section) const
 bool
 IniFile::has_attribute (const String &section, const String &key) const
 {
-  SectionMap::const_iterator cit = sections_.find (section);
-  if (cit == sections_.end())
-    return false;
-  for (auto s : cit->second)
-    if (s.size() > key.size() && s[key.size()] == '=' && memcmp (s.data(), key.data(), key.size()) == 0)
-      return true;
-  return false;
+  return values_.find (section + "." + key) != values_.end();
 }
 
 StringVector
 IniFile::raw_values () const
 {
   StringVector opts;
-  for (auto it : sections_)
-    for (auto s : it.second)
+  for (const auto &it : sections_)
+    for (const auto &s : it.second)
       opts.push_back (it.first + "." + s);
   return opts;
 }
@@ -411,23 +411,12 @@ IniFile::raw_values () const
 bool
 IniFile::has_raw_value (const String &dotpath, String *valuep) const
 {
-  const char *p = dotpath.c_str(), *d = strrchr (p, '.');
-  if (!d)
+  ValueIndex::const_iterator cit = values_.find (dotpath);
+  if (cit == values_.end())
     return false;
-  const String secname = String (p, d - p);
-  d++; // point to key
-  const StringVector &sv = section (secname);
-  if (!sv.size())
-    return false;
-  const size_t l = dotpath.size() - (d - p); // key length
-  for (auto kv : sv)
-    if (kv.size() > l && kv[l] == '=' && memcmp (kv.data(), d, l) == 0)
-      {
-        if (valuep)
-          *valuep = kv.substr (l + 1);
-        return true;
-      }
-  return false;
+  if (valuep)
+    *valuep = cit->second.raw;
+  return true;
 }
 
 String
@@ -480,18 +469,26 @@ IniFile::cook_string (const String &input)
 bool
 IniFile::has_value (const String &dotpath, String *valuep) const
 {
-  const bool hasit = has_raw_value (dotpath, valuep);
-  if (valuep && hasit)
-    *valuep = cook_string (*valuep);
-  return hasit;
+  ValueIndex::const_iterator cit = values_.find (dotpath);
+  if (cit == values_.end())
+    return false;
+  if (valuep)
+    *valuep = cit->second.cooked;
+  return true;
 }
 
 String
 IniFile::value_as_string (const String &dotpath) const
 {
-  String raw = raw_value (dotpath);
-  String v = cook_string (raw);
-  return v;
+  ValueIndex::const_iterator cit = values_.find (dotpath);
+  return cit != values_.end() ? cit->second.cooked : "";
+}
+
+void
+IniFile::merge_values (std::unordered_map<String,String> &values) const
+{
+  for (const auto &it : values_)
+    values.insert (std::make_pair (it.first, it.second.cooked)); // existing entries take precedence
 }
 
 
@@ -3,6 +3,7 @@
 #define __RAPICORN_INIFILE_HH__
 
 #include <rcore/resources.hh>
+#include <unordered_map>
 
 namespace Rapicorn {
 
@@ -10,7 +11,10 @@ namespace Rapicorn {
 /// Class to parse INI configuration file sections and values.
 class IniFile {
   typedef std::map<String,StringVector> SectionMap;
+  struct Value { String raw, cooked; };
+  typedef std::unordered_map<String,Value> ValueIndex;
   SectionMap                    sections_;
+  ValueIndex                    values_;       // section.attribute -> value, first definition wins
   void          load_ini        (const String &inputname, const String &data);
   //bool        set             (const String &section, const String &key, const String &value, const String &locale = "");
   //bool        del             (const String &section, const String &key, const String &locale = "*");
@@ -34,6 +38,7 @@ public:
   String        value_as_string (const String &dotpath) const;  ///< Retrieve value of section.attribute[locale].
   bool          has_value       (const String &dotpath,
                                  String *valuep = NULL) const;  ///< Check and possibly retrieve value if present.
+  void          merge_values    (std::unordered_map<String,String> &values) const; ///< Add values of dotpaths missing in @a values.
   static String cook_string     (const String &input_string);   ///< Unquote contents of @a input_string;
 };
 
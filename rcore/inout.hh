@@ -49,6 +49,7 @@ bool   debug_devel_check ();
 #define RAPICORN_FLIPPER(key, blurb,...)  Rapicorn::FlipperOption (key, bool (__VA_ARGS__))
 #define RAPICORN_DEBUG_OPTION(key, blurb) Rapicorn::DebugOption (key)
 #define RAPICORN_KEY_DEBUG(key,...)       do { if (RAPICORN_UNLIKELY (Rapicorn::_rapicorn_debug_check_cache)) Rapicorn::rapicorn_debug (key, RAPICORN_PRETTY_FILE, __LINE__, Rapicorn::string_format (__VA_ARGS__)); } while (0)
+#define RAPICORN_KEY_DEBUG_LITERAL(key,...) do { if (RAPICORN_UNLIKELY (Rapicorn::_rapicorn_debug_check_cache)) Rapicorn::rapicorn_debug (key, RAPICORN_PRETTY_FILE, __LINE__, RAPICORN_STRING_FORMAT (__VA_ARGS__)); } while (0)
 #define RAPICORN_FATAL(...)               do { Rapicorn::debug_fatal_message (RAPICORN_PRETTY_FILE, __LINE__, Rapicorn::string_format (__VA_ARGS__)); } while (0)
 #define RAPICORN_ASSERT(cond)             do { if (RAPICORN_LIKELY (cond)) break; Rapicorn::debug_fatal_assert (RAPICORN_PRETTY_FILE, __LINE__, #cond); } while (0)
 #define RAPICORN_ASSERT_RETURN(cond, ...) do { if (RAPICORN_LIKELY (cond)) break; Rapicorn::debug_assert (RAPICORN_PRETTY_FILE, __LINE__, #cond); return __VA_ARGS__; } while (0)
@@ -2,6 +2,8 @@
 #include <glib.h> // for g_main_context_*
 #include "loop.hh"
 #include "strings.hh"
+#include "trace.hh"
+#include "metrics.hh"
 #include <sys/poll.h>
 #include <errno.h>
 #include <unistd.h>
@@ -659,6 +661,9 @@ EventLoop::check_sources_Lm (LoopState &state, const QuickPfdArray &pfda)
   return dispatch_priority_ > UNDEFINED_PRIORITY;
 }
 
+static Metrics::Counter &loop_iterations = Metrics::counter ("rapicorn_loop_iterations", "Number of MainLoop iterations");
+static Metrics::Counter &loop_dispatches = Metrics::counter ("rapicorn_loop_dispatches", "Number of EventSource dispatches");
+
 void
 EventLoop::dispatch_source_Lm (LoopState &state)
 {
@@ -685,7 +690,10 @@ EventLoop::dispatch_source_Lm (LoopState &state)
       dispatch_source->was_dispatching_ = dispatch_source->dispatching_;
       dispatch_source->dispatching_ = true;
       main_mutex.unlock();
+      loop_dispatches.add();
+      Trace::begin ("EventLoop::dispatch");
       const bool keep_alive = dispatch_source->dispatch (state);
+      Trace::end ("EventLoop::dispatch");
       main_mutex.lock();
       dispatch_source->dispatching_ = dispatch_source->was_dispatching_;
       dispatch_source->was_dispatching_ = old_was_dispatching;
@@ -698,6 +706,7 @@ bool
 MainLoop::iterate_loops_Lm (LoopState &state, bool may_block, bool may_dispatch)
 {
   assert_return (state.phase == state.NONE, false);
+  loop_iterations.add();
   Mutex &main_mutex = main_loop_->mutex();
   int64 timeout_usecs = INT64_MAX;
   PollFD reserved_pfd_mem[7];   // store PollFD array in stack memory, to reduce malloc overhead
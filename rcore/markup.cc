@@ -12,6 +12,9 @@
 #include <vector>
 #include <stack>
 #include <cstring>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 namespace Rapicorn {
 
@@ -39,6 +42,47 @@ str_has_suffix (const String &str,
 }
 
 
+/* --- bulk scanning --- */
+/// Find the first byte in [p, end) that matches any of @a c1 .. @a c4, returns @a end if none is found.
+static inline const char*
+scan_for (const char *p, const char *end, char c1, char c2, char c3, char c4)
+{
+#ifdef __SSE2__
+  const __m128i v1 = _mm_set1_epi8 (c1), v2 = _mm_set1_epi8 (c2), v3 = _mm_set1_epi8 (c3), v4 = _mm_set1_epi8 (c4);
+  for (; end - p >= 16; p += 16)
+    {
+      const __m128i chunk = _mm_loadu_si128 ((const __m128i*) p);
+      const __m128i hits = _mm_or_si128 (_mm_or_si128 (_mm_cmpeq_epi8 (chunk, v1), _mm_cmpeq_epi8 (chunk, v2)),
+                                         _mm_or_si128 (_mm_cmpeq_epi8 (chunk, v3), _mm_cmpeq_epi8 (chunk, v4)));
+      const int mask = _mm_movemask_epi8 (hits);
+      if (mask)
+        return p + __builtin_ctz (mask);
+    }
+#endif
+  for (; p < end; p++)
+    if (*p == c1 || *p == c2 || *p == c3 || *p == c4)
+      return p;
+  return end;
+}
+
+/// Find the first byte >= 0x80 in [p, end), returns @a end for pure ASCII input.
+static inline const char*
+scan_non_ascii (const char *p, const char *end)
+{
+#ifdef __SSE2__
+  for (; end - p >= 16; p += 16)
+    {
+      const int mask = _mm_movemask_epi8 (_mm_loadu_si128 ((const __m128i*) p));
+      if (mask)
+        return p + __builtin_ctz (mask);
+    }
+#endif
+  for (; p < end; p++)
+    if (*p & 0x80)
+      return p;
+  return end;
+}
+
 /* --- usefull type aliases --- */
 typedef MarkupParser::Error     MarkupError;
 typedef MarkupParser::ErrorType MarkupErrorType;
@@ -554,6 +598,14 @@ unescape_text (MarkupParserContext *context,
   UnescapeContext ucontext;
   const char  *p;
   
+  /* fast path, the vast majority of texts and values need no unescaping or normalization */
+  const bool normalize_attribute = context->state == STATE_INSIDE_ATTRIBUTE_VALUE_SQ || context->state == STATE_INSIDE_ATTRIBUTE_VALUE_DQ;
+  if (scan_for (text, text_end, '&', '\r', normalize_attribute ? '\t' : '&', normalize_attribute ? '\n' : '&') == text_end)
+    {
+      unescaped->assign (text, text_end - text);
+      return true;
+    }
+  
   ucontext.context = context;
   ucontext.text = text;
   ucontext.text_end = text_end;
@@ -662,6 +714,58 @@ advance_char (MarkupParserContext *context)
   return true;
 }
 
+/// Move context->iter forward to @a target, with the line and char accounting of repeated advance_char() calls.
+static inline bool
+advance_to (MarkupParserContext *context,
+            const char          *target)
+{
+  if (target == context->iter)
+    return target != context->current_text_end;
+  // account for all characters between iter and target, exclusively
+  int lines = 0, chars = context->char_number;
+  const char *p = context->iter + 1;
+#ifdef __SSE2__
+  const __m128i newline = _mm_set1_epi8 ('\n'), topbits = _mm_set1_epi8 (char (0xc0)), continuation = _mm_set1_epi8 (char (0x80));
+  for (; target - p >= 16; p += 16)
+    {
+      const __m128i chunk = _mm_loadu_si128 ((const __m128i*) p);
+      const uint nl = _mm_movemask_epi8 (_mm_cmpeq_epi8 (chunk, newline));
+      const uint starts = ~_mm_movemask_epi8 (_mm_cmpeq_epi8 (_mm_and_si128 (chunk, topbits), continuation)) & 0xffff;
+      if (nl)
+        {
+          const uint last = 31 - __builtin_clz (nl);
+          lines += __builtin_popcount (nl);
+          chars = 1 + __builtin_popcount (starts & ~((2u << last) - 1));
+        }
+      else
+        chars += __builtin_popcount (starts);
+    }
+#endif
+  for (; p < target; p++)
+    if (*p == '\n')
+      {
+        lines++;
+        chars = 1;
+      }
+    else if ((*p & 0xc0) != 0x80)       // UTF-8 character start
+      chars++;
+  context->line_number += lines;
+  context->char_number = chars;
+  // step onto target like advance_char() does
+  context->iter = target;
+  context->char_number += 1;
+  context->line_number_after_newline = 0;
+  if (context->iter == context->current_text_end)
+    return false;
+  else if (*context->iter == '\n')
+    {
+      context->line_number += 1;
+      context->char_number = 1;
+      context->line_number_after_newline = 1;
+    }
+  return true;
+}
+
 static inline bool    
 xml_isspace (char c)
 {
@@ -762,6 +866,25 @@ find_current_text_end (MarkupParserContext *context)
 }
 
 
+/// Provide the text between context->start and context->iter, copying into partial_chunk only if it spans several buffers.
+static inline void
+current_chunk (MarkupParserContext *context,
+               const char         **chunk,
+               const char         **chunk_end)
+{
+  if (context->partial_chunk.empty())
+    {
+      *chunk = context->start;
+      *chunk_end = context->iter;
+    }
+  else
+    {
+      add_to_partial (context, context->start, context->iter);
+      *chunk = context->partial_chunk.data();
+      *chunk_end = *chunk + context->partial_chunk.size();
+    }
+}
+
 static void
 add_attribute (MarkupParserContext *context, const char *name)
 {
@@ -861,7 +984,10 @@ MarkupParser::parse (const char          *text,
   /* Validate UTF8 (must be done after we find the end, since
    * we could have a trailing incomplete char)
    */
-  if (!utf8_validate (String (context->current_text, context->current_text_len)))
+  const char *non_ascii;
+  non_ascii = scan_non_ascii (context->current_text, context->current_text_end);
+  if (non_ascii != context->current_text_end && // only validate from the first non-ASCII character on
+      !utf8_validate (non_ascii, context->current_text_end - non_ascii))
     {
       int  newlines = 0;
       const char  *p;
@@ -1031,9 +1157,10 @@ MarkupParser::parse (const char          *text,
               /* The name has ended. Combine it with the partial chunk
                * if any; push it on the stack; enter next state.
                */
-              add_to_partial (context, context->start, context->iter);
-              context->tag_stack.push (context->partial_chunk);
-              context->partial_chunk = "";
+              const char *name, *name_end;
+              current_chunk (context, &name, &name_end);
+              context->tag_stack.push (String (name, name_end));
+              context->partial_chunk.clear();
               
               context->state = STATE_BETWEEN_ATTRIBUTES;
               context->start = NULL;
@@ -1197,12 +1324,7 @@ MarkupParser::parse (const char          *text,
 		delim = '"';
 	      }
             
-	    do
-	      {
-		if (*context->iter == delim)
-		  break;
-	      }
-	    while (advance_char (context));
+            advance_to (context, scan_for (context->iter, context->current_text_end, delim, delim, delim, delim));
 	  }
           if (context->iter == context->current_text_end)
             {
@@ -1217,16 +1339,11 @@ MarkupParser::parse (const char          *text,
                * with the partial chunk if any; set it for the current
                * attribute.
                */
-              add_to_partial (context, context->start, context->iter);
-              String unescaped;
-              if (unescape_text (context,
-                                 context->partial_chunk.c_str(),
-                                 context->partial_chunk.c_str() + context->partial_chunk.size(),
-                                 &unescaped,
-                                 error))
+              const char *value, *value_end;
+              current_chunk (context, &value, &value_end);
+              if (unescape_text (context, value, value_end, &last_value (context), error))
                 {
                   /* success, advance past quote and set state. */
-                  last_value (context) = unescaped;
                   advance_char (context);
                   context->state = STATE_BETWEEN_ATTRIBUTES;
                   context->start = NULL;
@@ -1238,30 +1355,24 @@ MarkupParser::parse (const char          *text,
           
         case STATE_INSIDE_TEXT:
           /* Possible next states: AFTER_OPEN_ANGLE */
-          do
+          advance_to (context, scan_for (context->iter, context->current_text_end, '<', '<', '<', '<'));
+          
+          if (context->iter == context->current_text_end)
             {
-              if (*context->iter == '<')
-                break;
+              /* The text hasn't necessarily ended. Merge with
+               * partial chunk, leave state unchanged.
+               */
+              add_to_partial (context, context->start, context->iter);
             }
-          while (advance_char (context));
-          
-          /* The text hasn't necessarily ended. Merge with
-           * partial chunk, leave state unchanged.
-           */
-          
-          add_to_partial (context, context->start, context->iter);
-          
-          if (context->iter != context->current_text_end)
+          else
             {
               /* The text has ended at the open angle. Call the text
                * callback.
                */
+              const char *chunk, *chunk_end;
+              current_chunk (context, &chunk, &chunk_end);
               String unescaped;
-              if (unescape_text (context,
-                                 context->partial_chunk.c_str(),
-                                 context->partial_chunk.c_str() + context->partial_chunk.size(),
-                                 &unescaped,
-                                 error))
+              if (unescape_text (context, chunk, chunk_end, &unescaped, error))
                 {
                   error.line_number = context->line_number - context->line_number_after_newline;
                   error.char_number = context->char_number;
@@ -1384,7 +1495,7 @@ MarkupParser::parse (const char          *text,
 	  
         case STATE_INSIDE_PASSTHROUGH:
           /* Possible next state: AFTER_CLOSE_ANGLE */
-          do
+          while (advance_to (context, scan_for (context->iter, context->current_text_end, '<', '>', '<', '>')))
             {
 	      if (*context->iter == '<') 
 		context->balance++;
@@ -1403,8 +1514,9 @@ MarkupParser::parse (const char          *text,
 		       && context->balance == 0)) 
 		    break;
 		}
+              if (!advance_char (context))
+                break;
             }
-          while (advance_char (context));
           
           if (context->iter == context->current_text_end)
             {
@@ -0,0 +1,308 @@
+// This Source Code Form is licensed MPL-2.0: http://mozilla.org/MPL/2.0
+#include "metrics.hh"
+#include "thread.hh"
+#include "memory.hh"
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <map>
+
+namespace Rapicorn {
+namespace Metrics {
+
+// == Counter ==
+__thread uint _thread_shard = 0;
+
+uint
+_assign_thread_shard ()
+{
+  static std::atomic<uint> shard_counter { 0 };
+  _thread_shard = 1 + shard_counter++ % 0x7fffffff;    // distribute threads round robin, 0 means unassigned
+  return _thread_shard;
+}
+
+Counter::Counter (const String &name, const String &blurb) :
+  name_ (name), blurb_ (blurb)
+{
+  for (size_t i = 0; i < SHARDS; i++)
+    shards_[i].value = 0;
+}
+
+uint64
+Counter::value () const
+{
+  uint64 total = 0;
+  for (size_t i = 0; i < SHARDS; i++)
+    total += shards_[i].value.load (std::memory_order_relaxed);
+  return total;
+}
+
+// == Histogram ==
+Histogram::Histogram (const String &name, const String &blurb) :
+  name_ (name), blurb_ (blurb), count_ (0), sum_ (0), max_ (0)
+{
+  for (size_t i = 0; i < BUCKETS; i++)
+    buckets_[i] = 0;
+}
+
+uint
+Histogram::bucket_index (uint64 v)
+{
+  if (v < SUB_BUCKETS)
+    return v;                                           // exact buckets for small values
+  const uint e = 63 - __builtin_clzll (v);              // e >= SUB_BITS
+  const uint sub = (v >> (e - SUB_BITS)) & (SUB_BUCKETS - 1);
+  return (e - SUB_BITS + 1) * SUB_BUCKETS + sub;
+}
+
+uint64
+Histogram::bucket_start (uint index)
+{
+  if (index < SUB_BUCKETS)
+    return index;
+  const uint e = index / SUB_BUCKETS + SUB_BITS - 1, sub = index % SUB_BUCKETS;
+  return uint64 (SUB_BUCKETS + sub) << (e - SUB_BITS);
+}
+
+/// Add @a value to the histogram.
+void
+Histogram::record (uint64 value)
+{
+  buckets_[bucket_index (value)].fetch_add (1, std::memory_order_relaxed);
+  sum_.fetch_add (value, std::memory_order_relaxed);
+  uint64 m = max_.load (std::memory_order_relaxed);
+  while (value > m && !max_.compare_exchange_weak (m, value, std::memory_order_relaxed))
+    ;
+  count_.fetch_add (1, std::memory_order_relaxed);
+}
+
+/** Estimate the value below which a fraction @a q of all recorded values lies.
+ * The result is the midpoint of the bucket containing the quantile, clamped to max().
+ * For @a q == 1, max() is returned.
+ * Returns 0 if no values have been recorded.
+ */
+uint64
+Histogram::quantile (double q) const
+{
+  uint64 total = 0;
+  for (size_t i = 0; i < BUCKETS; i++)
+    total += buckets_[i].load (std::memory_order_relaxed);
+  if (!total)
+    return 0;
+  const uint64 rank = CLAMP (q, 0.0, 1.0) * (total - 1);
+  if (rank + 1 >= total)
+    return max();                                       // largest value is known exactly
+  uint64 seen = 0;
+  for (uint i = 0; i < BUCKETS; i++)
+    {
+      seen += buckets_[i].load (std::memory_order_relaxed);
+      if (seen > rank)
+        {
+          const uint64 start = bucket_start (i), width = i + 1 < BUCKETS ? bucket_start (i + 1) - start : start;
+          return MIN (start + (width - 1) / 2, max());
+        }
+    }
+  return max();
+}
+
+// == Registry ==
+static Mutex metrics_mutex;
+
+struct Registry {
+  std::map<String,Counter*>   counters;
+  std::map<String,Histogram*> histograms;
+};
+
+static Registry&
+registry ()
+{
+  static Registry &registry = *new Registry(); // leaked, metrics must outlive static destructors
+  return registry;
+}
+
+/// Retrieve the counter registered as @a name, it is created on first use.
+Counter&
+counter (const String &name, const String &blurb)
+{
+  ScopedLock<Mutex> locker (metrics_mutex);
+  Counter *&c = registry().counters[name];
+  if (!c)
+    {
+      uint8 *unaligned_mem; // leaked with the counter, shards must start on cache line boundaries
+      void *mem = aligned_alloc (sizeof (Counter), alignof (Counter), &unaligned_mem);
+      c = new (mem) Counter (name, blurb);
+    }
+  return *c;
+}
+
+/// Retrieve the histogram registered as @a name, it is created on first use.
+Histogram&
+histogram (const String &name, const String &blurb)
+{
+  ScopedLock<Mutex> locker (metrics_mutex);
+  Histogram *&h = registry().histograms[name];
+  if (!h)
+    h = new Histogram (name, blurb);
+  return *h;
+}
+
+/// Find a registered counter, returns NULL if @a name is unknown.
+Counter*
+find_counter (const String &name)
+{
+  ScopedLock<Mutex> locker (metrics_mutex);
+  auto it = registry().counters.find (name);
+  return it != registry().counters.end() ? it->second : NULL;
+}
+
+/// Find a registered histogram, returns NULL if @a name is unknown.
+Histogram*
+find_histogram (const String &name)
+{
+  ScopedLock<Mutex> locker (metrics_mutex);
+  auto it = registry().histograms.find (name);
+  return it != registry().histograms.end() ? it->second : NULL;
+}
+
+/** Render all metrics in plain text, one "name value" line per sample.
+ * The output follows the Prometheus text exposition format, histograms are
+ * reported as summaries with quantiles 0.5, 0.9, 0.99, 0.999 plus _max, _sum and _count.
+ */
+String
+text ()
+{
+  vector<const Counter*> counters;
+  vector<const Histogram*> histograms;
+  {
+    ScopedLock<Mutex> locker (metrics_mutex);
+    for (const auto &pair : registry().counters)
+      counters.push_back (pair.second);
+    for (const auto &pair : registry().histograms)
+      histograms.push_back (pair.second);
+  }
+  String s;
+  for (const Counter *c : counters)
+    {
+      if (!c->blurb().empty())
+        s += string_format ("# HELP %s %s\n", c->name(), c->blurb());
+      s += string_format ("# TYPE %s counter\n", c->name());
+      s += string_format ("%s %u\n", c->name(), c->value());
+    }
+  for (const Histogram *h : histograms)
+    {
+      if (!h->blurb().empty())
+        s += string_format ("# HELP %s %s\n", h->name(), h->blurb());
+      s += string_format ("# TYPE %s summary\n", h->name());
+      for (const char *q : { "0.5", "0.9", "0.99", "0.999" })
+        s += string_format ("%s{quantile=\"%s\"} %u\n", h->name(), q, h->quantile (string_to_double (q)));
+      s += string_format ("%s_max %u\n", h->name(), h->max());
+      s += string_format ("%s_sum %u\n", h->name(), h->sum());
+      s += string_format ("%s_count %u\n", h->name(), h->count());
+    }
+  return s;
+}
+
+// == Exporter ==
+static int          metrics_server_fd = -1;
+static String       metrics_server_path;
+static std::thread *metrics_server_thread = NULL;
+
+static void
+metrics_server_loop (int listen_fd)
+{
+  for (;;)
+    {
+      const int fd = accept (listen_fd, NULL, NULL);
+      if (fd < 0)
+        {
+          if (errno == EINTR || errno == ECONNABORTED)
+            continue;
+          break;                                        // e.g. EINVAL after stop_serving()
+        }
+      const String data = text();
+      size_t written = 0;
+      while (written < data.size())
+        {
+          const ssize_t n = send (fd, data.data() + written, data.size() - written, MSG_NOSIGNAL);
+          if (n < 0 && errno == EINTR)
+            continue;
+          if (n <= 0)
+            break;
+          written += n;
+        }
+      close (fd);
+    }
+}
+
+/** Export metrics on a Unix domain socket.
+ * Starts a background thread that accepts connections on @a socket_path, writes the
+ * current text() snapshot to each client and closes the connection, so e.g.
+ * "socat - UNIX-CONNECT:<socket_path>" can be used for scraping. A stale socket
+ * file at @a socket_path is replaced. Only one exporter can be active per process,
+ * returns false and sets errno on failure. Use stop_serving() to shut it down.
+ */
+bool
+serve (const String &socket_path)
+{
+  ScopedLock<Mutex> locker (metrics_mutex);
+  if (metrics_server_fd >= 0)
+    {
+      errno = EBUSY;
+      return false;
+    }
+  struct sockaddr_un addr = { 0, };
+  addr.sun_family = AF_UNIX;
+  if (socket_path.empty() || socket_path.size() >= sizeof (addr.sun_path))
+    {
+      errno = ENAMETOOLONG;
+      return false;
+    }
+  strcpy (addr.sun_path, socket_path.c_str());
+  struct stat st;
+  if (lstat (socket_path.c_str(), &st) == 0 && S_ISSOCK (st.st_mode))
+    unlink (socket_path.c_str());
+  const int fd = socket (AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0)
+    return false;
+  if (bind (fd, (struct sockaddr*) &addr, sizeof (addr)) < 0 || listen (fd, 8) < 0)
+    {
+      const int saved_errno = errno;
+      close (fd);
+      errno = saved_errno;
+      return false;
+    }
+  metrics_server_fd = fd;
+  metrics_server_path = socket_path;
+  metrics_server_thread = new std::thread (metrics_server_loop, fd);
+  return true;
+}
+
+/// Stop the exporter started by serve() and remove its socket file, returns false if none was running.
+bool
+stop_serving ()
+{
+  int fd;
+  std::thread *thread;
+  {
+    ScopedLock<Mutex> locker (metrics_mutex);
+    if (metrics_server_fd < 0)
+      return false;
+    unlink (metrics_server_path.c_str());
+    fd = metrics_server_fd;
+    thread = metrics_server_thread;
+    metrics_server_fd = -1;
+    metrics_server_path = "";
+    metrics_server_thread = NULL;
+  }
+  shutdown (fd, SHUT_RDWR);                             // wakes up accept()
+  thread->join();                                       // without metrics_mutex, the loop needs it for text()
+  delete thread;
+  close (fd);
+  return true;
+}
+
+} // Metrics
+} // Rapicorn
@@ -0,0 +1,82 @@
+// This Source Code Form is licensed MPL-2.0: http://mozilla.org/MPL/2.0
+#ifndef __RAPICORN_METRICS_HH__
+#define __RAPICORN_METRICS_HH__
+
+#include <rcore/utilities.hh>
+#include <rcore/cpuasm.hh>
+#include <atomic>
+
+namespace Rapicorn {
+
+/** The Metrics namespace provides a registry of aggregated runtime counters and latency histograms.
+ * Metrics are registered once by name and live for the entire program lifetime, so references
+ * returned by Metrics::counter() and Metrics::histogram() can be kept in static variables.
+ * Updates are lock-free, the current values can be queried with Metrics::text() or exported
+ * in plain text to clients connecting to a Unix domain socket, see Metrics::serve() and Metrics::stop_serving().
+ */
+namespace Metrics {
+
+extern __thread uint _thread_shard;     // 0 until assigned, see Counter::shard()
+uint _assign_thread_shard ();
+
+/// Monotonic event counter, sharded across threads to avoid cache line contention.
+class Counter {
+  static constexpr size_t SHARDS = 16;
+  struct alignas (RAPICORN_CACHE_LINE_ALIGNMENT) Shard { std::atomic<uint64> value; }; // one cache line each
+  const String  name_, blurb_;
+  Shard         shards_[SHARDS];
+  static inline size_t shard () { return (RAPICORN_LIKELY (_thread_shard) ? _thread_shard : _assign_thread_shard()) % SHARDS; }
+  RAPICORN_CLASS_NON_COPYABLE (Counter);
+public:
+  explicit      Counter (const String &name, const String &blurb);
+  String        name    () const        { return name_; }   ///< Get the registered counter name.
+  String        blurb   () const        { return blurb_; }  ///< Get the counter description.
+  uint64        value   () const;                           ///< Sum of all increments so far.
+  /// Increment the counter by @a delta.
+  void          add     (uint64 delta = 1) { shards_[shard()].value.fetch_add (delta, std::memory_order_relaxed); }
+};
+
+/** Histogram of recorded values with bounded relative error.
+ * Values are sorted into logarithmic buckets which are linearly subdivided (similar to HDR histograms),
+ * so quantiles are accurate to within 1/16 (6.25%) of the recorded values over the entire uint64 range.
+ */
+class Histogram {
+  static constexpr uint SUB_BITS = 4, SUB_BUCKETS = 1 << SUB_BITS;
+  static constexpr uint BUCKETS = (64 - SUB_BITS + 1) * SUB_BUCKETS;
+  const String          name_, blurb_;
+  std::atomic<uint64>   count_, sum_, max_;
+  std::atomic<uint64>   buckets_[BUCKETS];
+  static uint           bucket_index (uint64 v);
+  static uint64         bucket_start (uint index);
+  RAPICORN_CLASS_NON_COPYABLE (Histogram);
+public:
+  explicit      Histogram (const String &name, const String &blurb);
+  String        name      () const      { return name_; }   ///< Get the registered histogram name.
+  String        blurb     () const      { return blurb_; }  ///< Get the histogram description.
+  uint64        count     () const      { return count_.load (std::memory_order_relaxed); }   ///< Number of recorded values.
+  uint64        sum       () const      { return sum_.load (std::memory_order_relaxed); }     ///< Sum of recorded values.
+  uint64        max       () const      { return max_.load (std::memory_order_relaxed); }     ///< Maximum recorded value.
+  uint64        quantile  (double q) const;
+  void          record    (uint64 value);
+  /// Scope guard that records the elapsed nanoseconds of its lifetime into a Histogram.
+  class Latency {
+    Histogram  &histogram_;
+    const uint64 start_;
+  public:
+    explicit Latency  (Histogram &histogram) : histogram_ (histogram), start_ (timestamp_benchmark()) {}
+    /*dtor*/ ~Latency ()                                { histogram_.record (timestamp_benchmark() - start_); }
+  };
+};
+
+Counter&        counter         (const String &name, const String &blurb = "");
+Histogram&      histogram       (const String &name, const String &blurb = "");
+Counter*        find_counter    (const String &name);
+Histogram*      find_histogram  (const String &name);
+String          text            ();
+bool            serve           (const String &socket_path);
+bool            stop_serving    ();
+
+} // Metrics
+} // Rapicorn
+
+#endif // __RAPICORN_METRICS_HH__
@@ -42,6 +42,7 @@ struct CPUInfo {
   uint x86_mmx : 1, x86_mmxext : 1, x86_3dnow : 1, x86_3dnowext : 1;
   uint x86_sse : 1, x86_sse2   : 1, x86_sse3  : 1, x86_ssse3    : 1;
   uint x86_cx16 : 1, x86_sse4_1 : 1, x86_sse4_2 : 1, x86_rdrand : 1;
+  uint x86_avx : 1, x86_avx2   : 1;
 };
 
 /* figure architecture name from compiler */
@@ -118,7 +119,7 @@ get_arch_name (void)
     "xchg %%ebx, %%esi"                         \
     : "=a" (eax), "=S" (ebx),                   \
       "=c" (ecx), "=d" (edx)                    \
-    : "0" (input)                               \
+    : "0" (input), "2" (0) /* subleaf */        \
     : "cc")
 #elif   defined __x86_64__ || defined __amd64__
 /* CPUID is always present on AMD64, see:
@@ -138,7 +139,7 @@ get_arch_name (void)
     "xchg %%rbx, %%rsi"                         \
     : "=a" (eax), "=S" (ebx),                   \
       "=c" (ecx), "=d" (edx)                    \
-    : "0" (input)                               \
+    : "0" (input), "2" (0) /* subleaf */        \
     : "cc")
 #else
 #  define x86_has_cpuid()                       (false)
@@ -165,7 +166,7 @@ get_x86_cpu_features (CPUInfo *ci)
   /* query intel CPUID range */
   unsigned int eax, ebx, ecx, edx;
   x86_cpuid (0, eax, ebx, ecx, edx);
-  unsigned int v_ebx = ebx, v_ecx = ecx, v_edx = edx;
+  unsigned int v_eax = eax, v_ebx = ebx, v_ecx = ecx, v_edx = edx;
   char *vendor = ci->cpu_vendor;
   *((unsigned int*) &vendor[0]) = ebx;
   *((unsigned int*) &vendor[4]) = edx;
@@ -186,6 +187,15 @@ get_x86_cpu_features (CPUInfo *ci)
         ci->x86_sse4_2 = true;
       if (ecx & (1 << 30))
         ci->x86_rdrand = true;
+      if ((ecx & (1 << 27)) && (ecx & (1 << 28)))       /* OSXSAVE and AVX */
+        {
+#if     defined __i386__ || defined __x86_64__ || defined __amd64__
+          unsigned int xcr0_lo, xcr0_hi;
+          __asm__ __volatile__ ("xgetbv" : "=a" (xcr0_lo), "=d" (xcr0_hi) : "c" (0));
+          if ((xcr0_lo & 0x6) == 0x6)                   /* OS saves XMM and YMM state */
+            ci->x86_avx = true;
+#endif // x86
+        }
       if (edx & (1 << 0))
         ci->x86_fpu = true;
       if (edx & (1 << 4))
@@ -205,6 +215,12 @@ get_x86_cpu_features (CPUInfo *ci)
        * "Intel Processor Identification and the CPUID Instruction"
        */
     }
+  if (v_eax >= 7 && ci->x86_avx)  /* may query structured extended feature flags */
+    {
+      x86_cpuid (7, eax, ebx, ecx, edx);
+      if (ebx & (1 << 5))
+        ci->x86_avx2 = true;
+    }
 
   /* query extended CPUID range */
   x86_cpuid (0x80000000, eax, ebx, ecx, edx);
@@ -263,7 +279,7 @@ cpu_arch()
  * a number of flag words describing CPU features plus a trailing space.
  * This allows checks for CPU features via a simple string search for
  * " FEATURE ".
- * @return Example: "4 AMD64 GenuineIntel FPU TSC HTT CMPXCHG16B MMX MMXEXT SSESYS SSE SSE2 SSE3 SSSE3 SSE4.1 SSE4.2 "
+ * @return Example: "4 AMD64 GenuineIntel FPU TSC HTT CMPXCHG16B MMX MMXEXT SSESYS SSE SSE2 SSE3 SSSE3 SSE4.1 SSE4.2 AVX AVX2 "
  */
 String
 cpu_info()
@@ -309,6 +325,10 @@ cpu_info()
       info += " SSE4.1";
     if (cpu_info.x86_sse4_2)
       info += " SSE4.2";
+    if (cpu_info.x86_avx)
+      info += " AVX";
+    if (cpu_info.x86_avx2)
+      info += " AVX2";
     if (cpu_info.x86_rdrand)
       info += " rdrand";
     // 3DNOW flags
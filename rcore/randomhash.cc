@@ -113,6 +113,100 @@ Lib::KeccakF1600::permute (const uint32_t n_rounds)
     }
 }
 
+// == Multi-lane KeccakF1600 ==
+/* The lane variants permute several independent states with the very same steps as
+ * KeccakF1600::permute(), every SIMD vector element holds one 64 bit word of a distinct state.
+ * GCC vector extensions are used, so the compiler picks SSE2 or AVX2 instructions as enabled
+ * for the calling function.
+ */
+typedef uint64_t KeccakV2 __attribute__ ((vector_size (16)));
+typedef uint64_t KeccakV4 __attribute__ ((vector_size (32)));
+#define KECCAK_ROTATE(v, offset)        ((offset) ? ((v) << (offset)) | ((v) >> (64 - (offset))) : (v))
+
+template<class V, size_t LANES> static inline __attribute__ ((always_inline)) void
+keccak_permute_lanes (Lib::KeccakF1600 *const *states, const uint32_t n_rounds)
+{
+  V A[25];
+  for (size_t i = 0; i < 25; i++)
+    for (size_t l = 0; l < LANES; l++)
+      A[i][l] = (*states[l])[i];
+  for (size_t round_index = 0; round_index < n_rounds; round_index++)
+    {
+      // theta
+      V C[5];
+      for (size_t x = 0; x < 5; x++)
+        C[x] = A[x] ^ A[x + 5] ^ A[x + 10] ^ A[x + 15] ^ A[x + 20];
+      for (size_t x = 0; x < 5; x++)
+        {
+          const V D = C[(5 + x - 1) % 5] ^ KECCAK_ROTATE (C[(x + 1) % 5], 1);
+          for (size_t y = 0; y < 25; y += 5)
+            A[x + y] ^= D;
+        }
+      // rho and pi
+      V B[25];
+      for (size_t y = 0; y < 5; y++)
+        for (size_t x = 0; x < 5; x++)
+          B[y + 5 * ((2 * x + 3 * y) % 5)] = KECCAK_ROTATE (A[x + 5 * y], KECCAK_RHO_OFFSETS[x + 5 * y]);
+      // chi
+      for (size_t y = 0; y < 25; y += 5)
+        for (size_t x = 0; x < 5; x++)
+          A[x + y] = B[x + y] ^ (~B[(x + 1) % 5 + y] & B[(x + 2) % 5 + y]);
+      // iota
+      A[0] ^= KECCAK_ROUND_CONSTANTS[round_index];
+    }
+  for (size_t i = 0; i < 25; i++)
+    for (size_t l = 0; l < LANES; l++)
+      (*states[l])[i] = A[i][l];
+}
+
+static void
+keccak_permute_x2 (Lib::KeccakF1600 *const *states, uint32_t n_rounds)
+{
+  keccak_permute_lanes<KeccakV2, 2> (states, n_rounds);
+}
+
+#if     defined __i386__ || defined __x86_64__ || defined __amd64__
+static __attribute__ ((target ("avx2"))) void
+keccak_permute_x4_avx2 (Lib::KeccakF1600 *const *states, uint32_t n_rounds)
+{
+  keccak_permute_lanes<KeccakV4, 4> (states, n_rounds);
+}
+#endif // x86
+
+static size_t
+keccak_simd_lanes ()
+{
+  const String cpu = cpu_info();
+  if (cpu.find (" AVX2 ") != String::npos)
+    return 4;
+  if (cpu.find (" SSE2 ") != String::npos)
+    return 2;
+  return 1;
+}
+
+/** Apply the Keccak permutation with @a n_rounds to @a n_states independent states.
+ * Groups of states are permuted in parallel SIMD lanes, up to @a max_lanes at once and as supported
+ * by the runtime CPU. The results are identical to calling permute() on each state.
+ */
+void
+Lib::KeccakF1600::permute_n (KeccakF1600 *const *states, size_t n_states, const uint32_t n_rounds, size_t max_lanes)
+{
+  assert (n_rounds < 255); // adjust the KECCAK_ROUND_CONSTANTS access to lift this assertion
+  static const size_t simd_lanes = keccak_simd_lanes();
+  const size_t lanes = MIN (max_lanes, simd_lanes);
+  size_t i = 0;
+#if     defined __i386__ || defined __x86_64__ || defined __amd64__
+  if (lanes >= 4)
+    for (; i + 4 <= n_states; i += 4)
+      keccak_permute_x4_avx2 (states + i, n_rounds);
+#endif // x86
+  if (lanes >= 2)
+    for (; i + 2 <= n_states; i += 2)
+      keccak_permute_x2 (states + i, n_rounds);
+  for (; i < n_states; i++)
+    states[i]->permute (n_rounds);
+}
+
 // == KeccakRng ==
 /// Keccak permutation for 1600 bits, see Keccak11 @cite Keccak11 .
 void
@@ -554,6 +648,92 @@ shake256_hash (const void *data, size_t data_length, uint8_t *hashvalues, size_t
   context.squeeze_digest (hashvalues, n);
 }
 
+// == Batched Hashing ==
+/// Absorb all inputs with MultiRatePadding and squeeze @a n_out bytes each, permuting all states that still need it at once.
+static void
+keccak_hash_batch (size_t byte_rate, uint8_t domain_bits, size_t n_inputs, const void *const data[], const size_t data_lengths[],
+                   uint8_t *hashvalues, size_t n_out)
+{
+  vector<Lib::KeccakF1600> states (n_inputs);
+  vector<Lib::KeccakF1600*> active;
+  vector<size_t> offsets (n_inputs, 0);
+  // absorb a block of each input per pass, inputs that have been padded already are done
+  for (;;)
+    {
+      active.clear();
+      for (size_t i = 0; i < n_inputs; i++)
+        {
+          if (offsets[i] > data_lengths[i])
+            continue;
+          const uint8_t *input = ((const uint8_t*) data[i]) + offsets[i];
+          const size_t count = std::min (byte_rate, data_lengths[i] - offsets[i]);
+          for (size_t j = 0; j < count; j++)
+            states[i].byte (j) ^= input[j];
+          if (count < byte_rate)
+            {
+              states[i].byte (count) ^= domain_bits;    // payload boundary bit, preceeded by domain separation bits
+              states[i].byte (byte_rate - 1) ^= 0x80;   // last bitrate bit
+              offsets[i] = data_lengths[i] + 1;
+            }
+          else
+            offsets[i] += count;
+          active.push_back (&states[i]);
+        }
+      if (active.empty())
+        break;
+      Lib::KeccakF1600::permute_n (active.data(), active.size(), 24);
+    }
+  // squeeze
+  for (size_t i = 0; i < n_inputs; i++)
+    active.push_back (&states[i]);
+  for (size_t pos = 0; pos < n_out; )
+    {
+      const size_t count = std::min (byte_rate, n_out - pos);
+      for (size_t i = 0; i < n_inputs; i++)
+        for (size_t j = 0; j < count; j++)
+          hashvalues[i * n_out + pos + j] = states[i].byte (j);
+      pos += count;
+      if (pos < n_out)
+        Lib::KeccakF1600::permute_n (active.data(), active.size(), 24);
+    }
+}
+
+void
+sha3_224_hash_batch (size_t n_inputs, const void *const data[], const size_t data_lengths[], uint8_t *hashvalues)
+{
+  keccak_hash_batch (1152 / 8, 0x06, n_inputs, data, data_lengths, hashvalues, 28);
+}
+
+void
+sha3_256_hash_batch (size_t n_inputs, const void *const data[], const size_t data_lengths[], uint8_t *hashvalues)
+{
+  keccak_hash_batch (1088 / 8, 0x06, n_inputs, data, data_lengths, hashvalues, 32);
+}
+
+void
+sha3_384_hash_batch (size_t n_inputs, const void *const data[], const size_t data_lengths[], uint8_t *hashvalues)
+{
+  keccak_hash_batch (832 / 8, 0x06, n_inputs, data, data_lengths, hashvalues, 48);
+}
+
+void
+sha3_512_hash_batch (size_t n_inputs, const void *const data[], const size_t data_lengths[], uint8_t *hashvalues)
+{
+  keccak_hash_batch (576 / 8, 0x06, n_inputs, data, data_lengths, hashvalues, 64);
+}
+
+void
+shake128_hash_batch (size_t n_inputs, const void *const data[], const size_t data_lengths[], uint8_t *hashvalues, size_t n)
+{
+  keccak_hash_batch (1344 / 8, 0x1f, n_inputs, data, data_lengths, hashvalues, n);
+}
+
+void
+shake256_hash_batch (size_t n_inputs, const void *const data[], const size_t data_lengths[], uint8_t *hashvalues, size_t n)
+{
+  keccak_hash_batch (1088 / 8, 0x1f, n_inputs, data, data_lengths, hashvalues, n);
+}
+
 // == Pcg32Rng ==
 Pcg32Rng::Pcg32Rng () :
   increment_ (0), accu_ (0)
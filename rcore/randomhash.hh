@@ -119,6 +119,23 @@ private:
 /// Calculate SHA3 extendable output digest for 256 bit security strength, see also class SHAKE256.
 void    shake256_hash   (const void *data, size_t data_length, uint8_t *hashvalues, size_t n);
 
+// == Batched Hashing ==
+/** Calculate the 224 bit SHA3 digests of @a n_inputs independent inputs.
+ * The digest of input @a i is stored at @a hashvalues + 28 * i, the results are identical to
+ * calling sha3_224_hash() for each input, but several inputs are hashed in parallel SIMD lanes.
+ */
+void    sha3_224_hash_batch (size_t n_inputs, const void *const data[], const size_t data_lengths[], uint8_t *hashvalues);
+/// Calculate the 256 bit SHA3 digests of @a n_inputs inputs into @a hashvalues + 32 * i, see sha3_224_hash_batch().
+void    sha3_256_hash_batch (size_t n_inputs, const void *const data[], const size_t data_lengths[], uint8_t *hashvalues);
+/// Calculate the 384 bit SHA3 digests of @a n_inputs inputs into @a hashvalues + 48 * i, see sha3_224_hash_batch().
+void    sha3_384_hash_batch (size_t n_inputs, const void *const data[], const size_t data_lengths[], uint8_t *hashvalues);
+/// Calculate the 512 bit SHA3 digests of @a n_inputs inputs into @a hashvalues + 64 * i, see sha3_224_hash_batch().
+void    sha3_512_hash_batch (size_t n_inputs, const void *const data[], const size_t data_lengths[], uint8_t *hashvalues);
+/// Calculate @a n SHAKE128 digest bytes for each of @a n_inputs inputs into @a hashvalues + n * i, see sha3_224_hash_batch().
+void    shake128_hash_batch (size_t n_inputs, const void *const data[], const size_t data_lengths[], uint8_t *hashvalues, size_t n);
+/// Calculate @a n SHAKE256 digest bytes for each of @a n_inputs inputs into @a hashvalues + n * i, see sha3_224_hash_batch().
+void    shake256_hash_batch (size_t n_inputs, const void *const data[], const size_t data_lengths[], uint8_t *hashvalues, size_t n);
+
 namespace Lib { // Namespace for implementation internals
 
 /// The Keccak-f[1600] Permutation, see the Keccak specification @cite Keccak11 .
@@ -135,6 +152,7 @@ public:
   uint64_t&     operator[]  (int      index)       { return A[index]; }
   uint64_t      operator[]  (int      index) const { return A[index]; }
   void          permute     (uint32_t n_rounds);        ///< Apply Keccak permutation with @a n_rounds.
+  static void   permute_n   (KeccakF1600 *const *states, size_t n_states, uint32_t n_rounds, size_t max_lanes = 4);
   inline uint8_t&
   byte (size_t state_index)                             ///< Access byte 0..199 of the state.
   {
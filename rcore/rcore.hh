@@ -19,9 +19,11 @@
 #include <rcore/main.hh>
 #include <rcore/markup.hh>
 #include <rcore/memory.hh>
+#include <rcore/metrics.hh>
 #include <rcore/quicktimer.hh>
 #include <rcore/randomhash.hh>
 #include <rcore/thread.hh>
+#include <rcore/trace.hh>
 #include <rcore/visitor.hh>
 #include <rcore/math.hh>
 #include <rcore/unicode.hh>
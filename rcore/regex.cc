@@ -1,21 +1,176 @@
 // This Source Code Form is licensed MPL-2.0: http://mozilla.org/MPL/2.0
 #include "regex.hh"
+#include "thread.hh"
 
 #include <glib.h>
+#include <list>
+#include <unordered_map>
 
 namespace Rapicorn {
 namespace Regex {
 
+class Pattern::Impl {
+  GRegex *regex_;
+public:
+  const String       pattern;
+  const CompileFlags flags;
+  explicit Impl (GRegex *regex, const String &pattern_string, CompileFlags compile_flags) :
+    regex_ (regex), pattern (pattern_string), flags (compile_flags)
+  {}
+  ~Impl ()              { g_regex_unref (regex_); }
+  GRegex* regex () const { return regex_; }
+};
+
+/// Compile @a pattern into a reusable Pattern, on failure an invalid Pattern is returned and @a error is set.
+Pattern
+Pattern::compile (const String &pattern, CompileFlags compile_flags, String *error)
+{
+  GError *gerror = NULL;
+  GRegex *regex = g_regex_new (pattern.c_str(), GRegexCompileFlags (compile_flags), GRegexMatchFlags (0), &gerror);
+  if (error)
+    *error = gerror ? gerror->message : "";
+  if (gerror)
+    g_error_free (gerror);
+  if (!regex)
+    return Pattern();
+  return Pattern (std::make_shared<Impl> (regex, pattern, compile_flags));
+}
+
+String
+Pattern::pattern () const
+{
+  return impl_ ? impl_->pattern : "";
+}
+
+CompileFlags
+Pattern::flags () const
+{
+  return impl_ ? impl_->flags : COMPILE_NORMAL;
+}
+
+/// Check if @a utf8string contains a match for this pattern.
+bool
+Pattern::match (const String &utf8string, MatchFlags match_flags) const
+{
+  return_unless (impl_, false);
+  return g_regex_match_full (impl_->regex(), utf8string.data(), utf8string.size(), 0, GRegexMatchFlags (match_flags), NULL, NULL);
+}
+
+/// Find the first match at or after byte @a offset, @a start and @a end are set to the byte range of the match.
+bool
+Pattern::find (const String &utf8string, size_t *start, size_t *end, size_t offset, MatchFlags match_flags) const
+{
+  return_unless (impl_ && offset <= utf8string.size(), false);
+  GMatchInfo *match_info = NULL;
+  const bool matched = g_regex_match_full (impl_->regex(), utf8string.data(), utf8string.size(), offset,
+                                           GRegexMatchFlags (match_flags), &match_info, NULL);
+  if (matched)
+    {
+      int mstart = 0, mend = 0;
+      g_match_info_fetch_pos (match_info, 0, &mstart, &mend);
+      if (start)
+        *start = mstart;
+      if (end)
+        *end = mend;
+    }
+  g_match_info_free (match_info);
+  return matched;
+}
+
+/// List all non-overlapping matches in @a utf8string.
+StringVector
+Pattern::find_all (const String &utf8string, MatchFlags match_flags) const
+{
+  StringVector matches;
+  return_unless (impl_, matches);
+  GMatchInfo *match_info = NULL;
+  g_regex_match_full (impl_->regex(), utf8string.data(), utf8string.size(), 0, GRegexMatchFlags (match_flags), &match_info, NULL);
+  while (g_match_info_matches (match_info))
+    {
+      int mstart = 0, mend = 0;
+      g_match_info_fetch_pos (match_info, 0, &mstart, &mend);
+      matches.push_back (utf8string.substr (mstart, mend - mstart));
+      g_match_info_next (match_info, NULL);
+    }
+  g_match_info_free (match_info);
+  return matches;
+}
+
+/// Replace all matches in @a utf8string with @a replacement, which may contain back references like "\\1".
+String
+Pattern::replace (const String &utf8string, const String &replacement, MatchFlags match_flags) const
+{
+  return_unless (impl_, utf8string);
+  GError *gerror = NULL;
+  gchar *result = g_regex_replace (impl_->regex(), utf8string.data(), utf8string.size(), 0, replacement.c_str(),
+                                   GRegexMatchFlags (match_flags), &gerror);
+  if (!result)
+    {
+      critical ("%s: invalid replacement: %s", __func__, gerror ? gerror->message : "?");
+      if (gerror)
+        g_error_free (gerror);
+      return utf8string;
+    }
+  String string = result;
+  g_free (result);
+  return string;
+}
+
+// == PatternCache ==
+// LRU cache of compiled patterns, keyed by compile flags and pattern string.
+class PatternCache {
+  enum { MAX_ENTRIES = 64 };
+  typedef std::pair<String, Pattern>                     Entry;
+  std::list<Entry>                                       lru_;   // most recently used first
+  std::unordered_map<String, std::list<Entry>::iterator> index_;
+  Mutex                                                  mutex_;
+public:
+  Pattern
+  lookup (const String &pattern, CompileFlags compile_flags)
+  {
+    const String key = string_format ("%x:", compile_flags) + pattern;
+    ScopedLock<Mutex> locker (mutex_);
+    auto it = index_.find (key);
+    if (it != index_.end())
+      {
+        lru_.splice (lru_.begin(), lru_, it->second);
+        return it->second->second;
+      }
+    locker.unlock();
+    String error;
+    const Pattern compiled = Pattern::compile (pattern, compile_flags | OPTIMIZE, &error);
+    if (!compiled.valid())
+      critical ("invalid regular expression: %s", error);
+    locker.lock();
+    it = index_.find (key);     // another thread may have raced us
+    if (it != index_.end())
+      return it->second->second;
+    lru_.push_front (Entry (key, compiled));
+    index_[key] = lru_.begin();
+    if (lru_.size() > MAX_ENTRIES)
+      {
+        index_.erase (lru_.back().first);
+        lru_.pop_back();
+      }
+    return compiled;
+  }
+};
+
+/// Lookup or compile @a pattern in a process wide cache of recently used patterns, invalid patterns are cached as well.
+Pattern
+Pattern::cached (const String &pattern, CompileFlags compile_flags)
+{
+  static PatternCache &pattern_cache = *new PatternCache(); // leaked, may be used from static dtors
+  return pattern_cache.lookup (pattern, compile_flags);
+}
+
 bool
 match_simple (const String   &pattern,
               const String   &utf8string,
               CompileFlags    compile_flags,
               MatchFlags      match_flags)
 {
-  bool matched = g_regex_match_simple (pattern.c_str(), utf8string.c_str(),
-                                       GRegexCompileFlags (compile_flags),
-                                       GRegexMatchFlags (match_flags));
-  return matched;
+  return Pattern::cached (pattern, compile_flags).match (utf8string, match_flags);
 }
 
 } // Regex
@@ -18,7 +18,7 @@ typedef enum { // copied from gregex.h
   UNGREEDY          = 1 << 9,
   RAW               = 1 << 11,
   NO_AUTO_CAPTURE   = 1 << 12,
-  OPTIMIZE          = 1 << 13,
+  OPTIMIZE          = 1 << 13,   ///< Optimize for repeated matching, uses the PCRE JIT where GLib supports it.
   DUPNAMES          = 1 << 19,
   NEWLINE_CR        = 1 << 20,
   NEWLINE_LF        = 1 << 21,
@@ -47,6 +47,25 @@ inline MatchFlags& operator&= (MatchFlags &s1, MatchFlags s2) { s1 = s1 & s2; re
 inline MatchFlags  operator|  (MatchFlags  s1, MatchFlags s2) { return MatchFlags (s1 | (uint64) s2); }
 inline MatchFlags& operator|= (MatchFlags &s1, MatchFlags s2) { s1 = s1 | s2; return s1; }
 
+/// Compiled regular expression, copies share the compiled pattern and may be used from multiple threads.
+class Pattern {
+  class Impl;
+  std::shared_ptr<const Impl> impl_;
+  explicit       Pattern  (const std::shared_ptr<const Impl> &impl) : impl_ (impl) {}
+public:
+  explicit       Pattern  ()    {}                                      ///< Construct an invalid pattern that never matches.
+  static Pattern compile  (const String &pattern, CompileFlags compile_flags = COMPILE_NORMAL, String *error = NULL);
+  static Pattern cached   (const String &pattern, CompileFlags compile_flags = COMPILE_NORMAL);
+  bool           valid    () const                      { return impl_ != NULL; } ///< Checks if the pattern compiled successfully.
+  String         pattern  () const;                                     ///< Provide the source of the regular expression.
+  CompileFlags   flags    () const;                                     ///< Provide the flags used for compilation.
+  bool           match    (const String &utf8string, MatchFlags match_flags = MATCH_NORMAL) const;
+  bool           find     (const String &utf8string, size_t *start, size_t *end,
+                           size_t offset = 0, MatchFlags match_flags = MATCH_NORMAL) const;
+  StringVector   find_all (const String &utf8string, MatchFlags match_flags = MATCH_NORMAL) const;
+  String         replace  (const String &utf8string, const String &replacement, MatchFlags match_flags = MATCH_NORMAL) const;
+};
+
 bool    match_simple    (const String   &pattern,
                          const String   &utf8string,
                          CompileFlags    compile_flags,
@@ -7,6 +7,9 @@
 #include <unistd.h>
 #include <sys/stat.h>
 #include <sys/mman.h>
+#include <string.h>
+#include <unordered_map>
+#include <list>
 
 #define DEBUG(...)      RAPICORN_KEY_DEBUG ("Res", __VA_ARGS__)
 
@@ -139,38 +142,162 @@ ByteBlob<Deleter>::string ()
 
 // == ResourceEntry ==
 #ifndef DOXYGEN
-static ResourceEntry *res_head = NULL;
-static Mutex          res_mutex;
+/* Entries are registered from static constructors, so instead of copying the lock-free
+ * index for every registration, the entries added since the last index update are
+ * merged in by the next lookup.
+ */
+static std::atomic<ResourceEntry*> res_head { NULL };           // all entries, most recently registered first
+static std::atomic<ResourceEntry*> res_indexed { NULL };        // res_head at the last index update
+static Mutex                       res_mutex;
+typedef RcuMap<String, const ResourceEntry*> ResourceIndex;
+
+static ResourceIndex&
+res_index ()
+{
+  static ResourceIndex &index = *new ResourceIndex(); // leaked, entries may be removed by static destructors
+  return index;
+}
 
 void
 ResourceEntry::reg_add (ResourceEntry *entry)
 {
   assert_return (entry && !entry->next);
   ScopedLock<Mutex> sl (res_mutex);
-  entry->next = res_head;
-  res_head = entry;
+  entry->next = res_head.load();
+  res_head.store (entry, std::memory_order_release);
+}
+
+void
+ResourceEntry::index_pending ()
+{
+  ScopedLock<Mutex> sl (res_mutex);
+  ResourceEntry *const head = res_head.load(), *const indexed = res_indexed.load();
+  if (head == indexed)
+    return;
+  vector<const ResourceEntry*> pending;
+  for (const ResourceEntry *e = head; e != indexed; e = e->next)
+    pending.push_back (e);
+  res_index().update ([&pending] (ResourceIndex::Map &map) {
+      for (auto it = pending.rbegin(); it != pending.rend(); ++it)
+        map[(*it)->name] = *it;                                 // later registrations take precedence
+    });
+  res_indexed.store (head, std::memory_order_release);
 }
 
 ResourceEntry::~ResourceEntry()
 {
   ScopedLock<Mutex> sl (res_mutex);
-  ResourceEntry **ptr = &res_head;
-  while (*ptr != this)
-    ptr = &(*ptr)->next;
-  *ptr = next;
+  if (res_indexed.load() == this)
+    res_indexed.store (next);
+  if (res_head.load() == this)
+    res_head.store (next);
+  else
+    {
+      ResourceEntry *prev = res_head.load();
+      while (prev->next != this)
+        prev = prev->next;
+      prev->next = next;
+    }
+  if (res_index().lookup (name) == this)
+    res_index().update ([this] (ResourceIndex::Map &map) {
+        map.erase (name);
+        for (const ResourceEntry *e = res_indexed.load(); e; e = e->next)
+          if (strcmp (e->name, name) == 0)
+            {
+              map[name] = e;                                    // uncover previous registration
+              break;
+            }
+      });
 }
 
 const ResourceEntry*
 ResourceEntry::find_entry (const String &res_name)
 {
-  ScopedLock<Mutex> sl (res_mutex);
-  for (const ResourceEntry *e = res_head; e; e = e->next)
-    if (res_name == e->name)
-      return e;
-  return NULL;
+  if (RAPICORN_UNLIKELY (res_head.load (std::memory_order_acquire) != res_indexed.load (std::memory_order_acquire)))
+    index_pending();
+  return res_index().lookup (res_name);
 }
 #endif // !DOXYGEN
 
+// == BlobCache ==
+/* Cache of decompressed resources, keyed by resource name. Blobs still in use are found
+ * through weak references, the most recently used ones are also kept alive up to MAX_BYTES.
+ */
+class BlobCache {
+  enum { MAX_BYTES = 8 * 1024 * 1024 };
+  typedef std::shared_ptr<BlobResource>                  BlobResourceP;
+  typedef std::pair<String, BlobResourceP>               LruEntry;
+  struct Entry {
+    const ResourceEntry                *rentry = NULL;  // detects replaced resources
+    std::weak_ptr<BlobResource>         blob;
+    std::list<LruEntry>::iterator       lru;
+    bool                                held = false;   // lru is valid
+  };
+  std::list<LruEntry>                    lru_;   // most recently used first
+  std::unordered_map<String, Entry>      index_;
+  size_t                                 bytes_;
+  Mutex                                  mutex_;
+  void
+  touch (Entry &entry, const String &name, const BlobResourceP &blob)
+  {
+    if (entry.held)
+      {
+        lru_.splice (lru_.begin(), lru_, entry.lru);
+        return;
+      }
+    lru_.push_front (LruEntry (name, blob));
+    entry.lru = lru_.begin();
+    entry.held = true;
+    bytes_ += blob->size();
+    while (bytes_ > MAX_BYTES && lru_.size() > 1)
+      {
+        Entry &last = index_[lru_.back().first];
+        bytes_ -= lru_.back().second->size();
+        last.held = false;
+        lru_.pop_back();                // blob remains available while in use elsewhere
+      }
+  }
+public:
+  BlobCache() : bytes_ (0) {}
+  BlobResourceP
+  lookup (const String &name, const ResourceEntry *rentry)
+  {
+    ScopedLock<Mutex> locker (mutex_);
+    auto it = index_.find (name);
+    if (it == index_.end() || it->second.rentry != rentry)
+      return NULL;
+    BlobResourceP blob = it->second.blob.lock();
+    if (blob)
+      touch (it->second, name, blob);
+    return blob;
+  }
+  BlobResourceP
+  insert (const String &name, const ResourceEntry *rentry, const BlobResourceP &blob)
+  {
+    ScopedLock<Mutex> locker (mutex_);
+    Entry &entry = index_[name];
+    if (entry.rentry == rentry)
+      {
+        BlobResourceP cached = entry.blob.lock();
+        if (cached)
+          {
+            touch (entry, name, cached);
+            return cached;              // another thread raced us
+          }
+      }
+    if (entry.held)
+      {
+        bytes_ -= entry.lru->second->size();
+        lru_.erase (entry.lru);
+        entry.held = false;
+      }
+    entry.rentry = rentry;
+    entry.blob = blob;
+    touch (entry, name, blob);
+    return blob;
+  }
+};
+
 // == StringBlob ==
 struct StringBlob : public BlobResource {
   String                name_;
@@ -251,10 +378,16 @@ Blob::asres (const String &resource)
   // blob from compressed resources
   if (entry && entry->psize < entry->dsize)
     {
-      const uint8 *u8data = zintern_decompress (entry->dsize, reinterpret_cast<const uint8*> (entry->pdata), entry->psize);
-      const char *data = reinterpret_cast<const char*> (u8data);
-      struct ZinternDeleter { void operator() (const char *d) { zintern_free ((uint8*) d); } };
-      return Blob (std::make_shared<ByteBlob<ZinternDeleter>> (resource, entry->dsize, data, ZinternDeleter()));
+      static BlobCache &blob_cache = *new BlobCache(); // leaked, Blobs may be used from static dtors
+      std::shared_ptr<BlobResource> blob = blob_cache.lookup (resource, entry);
+      if (!blob)
+        {
+          const uint8 *u8data = zintern_decompress (entry->dsize, reinterpret_cast<const uint8*> (entry->pdata), entry->psize);
+          const char *data = reinterpret_cast<const char*> (u8data);
+          struct ZinternDeleter { void operator() (const char *d) { zintern_free ((uint8*) d); } };
+          blob = blob_cache.insert (resource, entry, std::make_shared<ByteBlob<ZinternDeleter>> (resource, entry->dsize, data, ZinternDeleter()));
+        }
+      return Blob (blob);
     }
   // handle resource errors
   return error_result (resource, ENOENT, String (entry ? "invalid" : "unknown") + " resource entry");
@@ -70,6 +70,7 @@ class ResourceEntry {
   friend         class Blob;
   static const ResourceEntry* find_entry (const String&);
   static void                 reg_add    (ResourceEntry*);
+  static void                 index_pending ();
 public:
   template<size_t N>  ResourceEntry (const char *res, const char (&idata) [N], size_t data_size = 0) :
     next (NULL), name (res), pdata (idata), psize (N), dsize (data_size)
@@ -21,6 +21,8 @@ const char*                     rapicorn_gettext        (const char *text) RAPIC
 #define CQUOTE(str)                                     RAPICORN_CQUOTE(str)
 /// Create a Rapicorn::StringVector, from a const char* C-style array.
 #define STRING_VECTOR_FROM_ARRAY(ConstCharArray)        RAPICORN_STRING_VECTOR_FROM_ARRAY(ConstCharArray)
+/// Formatted printing like string_format() of a literal format, parsed and checked against the arguments at compile time.
+#define STRING_FORMAT(...)                              RAPICORN_STRING_FORMAT (__VA_ARGS__)
 #endif // RAPICORN_CONVENIENCE
 
 // == C-String ==
@@ -29,6 +31,7 @@ bool    		       cstring_to_bool       (const char *string, bool fallback = fals
 // == String Formatting ==
 template<class... Args> String string_format         (const char *format, const Args &...args) RAPICORN_PRINTF (1, 0);
 template<class... Args> String string_locale_format  (const char *format, const Args &...args) RAPICORN_PRINTF (1, 0);
+template<class... Args> size_t string_format_to      (char *buffer, size_t size, const char *format, const Args &...args) RAPICORN_PRINTF (3, 0);
 String                         string_vprintf        (const char *format, va_list vargs);
 String                         string_locale_vprintf (const char *format, va_list vargs);
 
@@ -175,6 +178,9 @@ const char*     strerror ();    // simple wrapper for strerror (errno)
     __a.push_back (ConstCharArray[__ai]);                               \
   __a; })
 #define RAPICORN_CQUOTE(str)    (Rapicorn::string_to_cquote (str).c_str())
+#define RAPICORN_STRING_FORMAT(format, ...)                             ({ \
+  static constexpr auto __f = ::Rapicorn::Lib::StringFormatter::literal (format);         \
+  ::Rapicorn::Lib::StringFormatter::format_literal<__f.n_args()> (NULL, __f, ##__VA_ARGS__); })
 
 /// Formatted printing ala printf() into a String, using the POSIX/C locale.
 template<class... Args> RAPICORN_NOINLINE String
@@ -190,6 +196,13 @@ string_locale_format (const char *format, const Args &...args)
   return Lib::StringFormatter::format<Lib::StringFormatter::CURRENT_LOCALE> (NULL, format, args...);
 }
 
+/// Formatted printing ala snprintf() into @a buffer of @a size bytes, using the POSIX/C locale, returns the untruncated length.
+template<class... Args> RAPICORN_NOINLINE size_t
+string_format_to (char *buffer, size_t size, const char *format, const Args &...args)
+{
+  return Lib::StringFormatter::format_to (buffer, size, format, args...);
+}
+
 } // Rapicorn
 
 namespace RapicornInternal {
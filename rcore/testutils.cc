@@ -103,6 +103,36 @@ Timer::max_elapsed () const
   return m;
 }
 
+double
+Timer::mean_elapsed () const
+{
+  double sum = 0;
+  for (size_t i = 0; i < samples_.size(); i++)
+    sum += samples_[i];
+  return samples_.size() ? sum / samples_.size() : 0;
+}
+
+double
+Timer::median_elapsed () const
+{
+  vector<double> sorted = samples_;
+  std::sort (sorted.begin(), sorted.end());
+  const size_t n = sorted.size();
+  if (!n)
+    return 0;
+  return n & 1 ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) * 0.5;
+}
+
+double
+Timer::stddev_elapsed () const
+{
+  const double mean = mean_elapsed();
+  double sum = 0;
+  for (size_t i = 0; i < samples_.size(); i++)
+    sum += (samples_[i] - mean) * (samples_[i] - mean);
+  return samples_.size() > 1 ? sqrt (sum / (samples_.size() - 1)) : 0;
+}
+
 static String
 ensure_newline (const String &s)
 {
@@ -51,6 +51,10 @@ public:
   double         test_elapsed () const { return test_duration_; }      ///< Seconds spent in benchmark()
   double         min_elapsed  () const;         ///< Minimum time benchmarked for a @a callee() call.
   double         max_elapsed  () const;         ///< Maximum time benchmarked for a @a callee() call.
+  double         mean_elapsed () const;         ///< Average time benchmarked for a @a callee() call.
+  double         median_elapsed () const;       ///< Median time benchmarked for a @a callee() call.
+  double         stddev_elapsed () const;       ///< Standard deviation of the times benchmarked for a @a callee() call.
+  size_t         n_samples    () const { return samples_.size(); }     ///< Number of timing samples taken by benchmark()
   template<typename Callee>
   double         benchmark    (Callee callee);
 };
@@ -44,6 +44,13 @@ static size_t volatile          thread_counter = 0;
 ThreadInfo __thread*            ThreadInfo::self_cached = NULL;
 static Mutex                    thread_info_mutex;
 
+static std::vector<std::pair<void*, void (*) (void*)>>&
+orphaned_retirees ()
+{
+  static auto &orphans = *new std::vector<std::pair<void*, void (*) (void*)>>(); // leaked, protected by thread_info_mutex
+  return orphans;
+}
+
 ThreadInfo::~ThreadInfo ()
 {
   assert ("~ThreadInfo must not be reached" == 0);
@@ -141,6 +148,12 @@ ThreadInfo::reset_specific ()
   data_list_.clear_like_destructor();
   for (size_t i = 0; i < ARRAY_SIZE (hp); i++)
     hp[i] = NULL;
+  if (!retired_.empty())
+    {
+      ScopedLock<Mutex> locker (thread_info_mutex);
+      orphaned_retirees().insert (orphaned_retirees().end(), retired_.begin(), retired_.end());
+    }
+  std::vector<Retiree>().swap (retired_);
   self_cached = NULL;
   pthread_t pttid = pthread_self();
   while (!pth_thread_id.compare_exchange_strong (pttid, 0))
@@ -180,6 +193,51 @@ ThreadInfo::collect_hazards()
   return ptrs;
 }
 
+/** Retire @a ptr, i.e. defer deleter (ptr) until no hazard pointer references @a ptr anymore.
+ * The caller must have unlinked @a ptr from all shared data structures, so that no new hazard
+ * pointers to it can be set up. Retired pointers are kept in a per-thread list that is scanned
+ * once its length exceeds twice the number of hazard pointers of all threads, which bounds
+ * the number of unreclaimed pointers and amortises scanning costs to O(1) per retire() call.
+ */
+void
+ThreadInfo::retire (void *ptr, void (*deleter) (void*))
+{
+  assert_return (ptr != NULL && deleter != NULL);
+  ThreadInfo &self = ThreadInfo::self();
+  self.retired_.push_back (Retiree (ptr, deleter));
+  const size_t threshold = 2 * ARRAY_SIZE (self.hp) * thread_counter;
+  if (self.retired_.size() > threshold)
+    self.scan_retired();
+}
+
+void
+ThreadInfo::reclaim_retired ()
+{
+  ThreadInfo::self().scan_retired();
+}
+
+void
+ThreadInfo::scan_retired ()
+{
+  { // adopt pointers retired by threads that exited
+    ScopedLock<Mutex> locker (thread_info_mutex);
+    std::vector<Retiree> &orphans = orphaned_retirees();
+    retired_.insert (retired_.end(), orphans.begin(), orphans.end());
+    orphans.clear();
+  }
+  std::atomic_thread_fence (std::memory_order_seq_cst); // order unlinking of retirees before hazard reads
+  const VoidPointers hazards = collect_hazards();
+  std::vector<Retiree> unreclaimable, reclaimable;
+  for (const Retiree &retiree : retired_)
+    if (lookup_pointer (hazards, retiree.first))
+      unreclaimable.push_back (retiree);
+    else
+      reclaimable.push_back (retiree);
+  retired_.swap (unreclaimable);
+  for (const Retiree &retiree : reclaimable)    // deleters may retire() again
+    retiree.second (retiree.first);
+}
+
 String
 ThreadInfo::ident ()
 {
@@ -6,6 +6,7 @@
 #include <rcore/cpuasm.hh>
 #include <thread>
 #include <list>
+#include <unordered_map>
 
 namespace Rapicorn {
 
@@ -80,6 +81,13 @@ struct ThreadInfo {
   void *volatile      hp[8];   ///< Hazard pointers variables, see: http://www.research.ibm.com/people/m/michael/ieeetpds-2004.pdf .
   static VoidPointers collect_hazards (); ///< Collect hazard pointers from all threads. Returns sorted vector of unique elements.
   static inline bool  lookup_pointer  (const std::vector<void*> &ptrs, void *arg); ///< Lookup pointers in a hazard pointer vector.
+  template<class T> inline T* protect_hazard (uint slot, const std::atomic<T*> &ptr); ///< Load @a ptr into hazard pointer @a slot.
+  inline void         clear_hazard    (uint slot);        ///< Reset hazard pointer @a slot, protected pointers may be reclaimed afterwards.
+  static void         retire          (void *ptr, void (*deleter) (void*)); ///< Defer deleter(ptr) until @a ptr is not a hazard anymore.
+  static void         reclaim_retired (); ///< Scan the retired pointers of the current thread and reclaim unprotected ones.
+  enum { ASYNC_QUEUE_HAZARD = 6, ///< Hazard pointer slot used by AsyncSegmentQueue operations.
+         RCU_MAP_HAZARD = 7,     ///< Hazard pointer slot used by RcuMap readers.
+  };
   /// @name Thread identification
   String                    ident       ();                             ///< Simple identifier for this thread, usually TID/PID.
   String                    name        ();                             ///< Get thread name.
@@ -100,6 +108,8 @@ private:
   String                      name_;
   Mutex                       data_mutex_;
   DataList                    data_list_;
+  typedef std::pair<void*, void (*) (void*)> Retiree;
+  std::vector<Retiree>        retired_;
   static ThreadInfo __thread *self_cached;
   /*ctor*/              ThreadInfo      ();
   /*ctor*/              ThreadInfo      (const ThreadInfo&) = delete;
@@ -108,6 +118,7 @@ private:
   static void           destroy_specific(void *vdata);
   void                  reset_specific  ();
   void                  setup_specific  ();
+  void                  scan_retired    ();
   static ThreadInfo*    create          ();
   void                  tdl             () { data_mutex_.lock(); }
   void                  tdu             () { data_mutex_.unlock(); }
@@ -203,16 +214,90 @@ public:
   /*dtor*/ ~Exclusive ()                        { ScopedLock<Mutex> locker (mutex_); if (data_) data_->~Type(); }
 };
 
+/**
+ * RcuMap is a thread-safe hash map, optimized for lookups in read-mostly data.
+ * Readers access an immutable snapshot of the map, protected only by a hazard pointer
+ * (see ThreadInfo::protect_hazard()), so lookup() needs no locks and never blocks.
+ * Writers copy the current snapshot, modify the copy and atomically publish it, the old
+ * snapshot is handed to ThreadInfo::retire() and deleted once no reader references it.
+ * Modifications are thus expensive, update() allows batching several changes into one copy.
+ */
+template<class Key, class Value, class Hash = std::hash<Key>, class KeyEqual = std::equal_to<Key>>
+class RcuMap {
+public:
+  typedef std::unordered_map<Key, Value, Hash, KeyEqual> Map;
+private:
+  std::atomic<Map*> map_;
+  Mutex             writer_mutex_;
+  static void       delete_map (void *map)      { delete static_cast<Map*> (map); }
+  RAPICORN_CLASS_NON_COPYABLE (RcuMap);
+public:
+  explicit RcuMap () : map_ (new Map())         {}
+  /*dtor*/ ~RcuMap ()                           { delete map_.load(); } ///< No concurrent lookups must occour at this point.
+  bool     lookup (const Key &key, Value &value) const;
+  Value    lookup (const Key &key) const        { Value v = Value(); lookup (key, v); return v; } ///< Lookup @a key, returns Value() if unknown.
+  size_t   size   () const;
+  bool     insert (const Key &key, const Value &value);
+  bool     erase  (const Key &key);
+  template<class Updater> void update (const Updater &updater);
+};
+
+// == AsyncSegmentQueue ==
+/**
+ * This is a thread-safe lock-free FIFO queue for any number of producers and consumers.
+ * Elements are stored in fixed size segments which are linked into a list, so memory is allocated
+ * once per SEGMENT_SIZE elements and not per element. Producers and consumers claim slots through
+ * atomic increments of per segment indices, drained segments are reclaimed via hazard pointers,
+ * see ThreadInfo::retire(). A consumer may claim a slot before its producer filled it, in which
+ * case the slot is skipped and the producer retries with another slot.
+ * The @a Value type needs to be default constructible and assignable.
+ */
+template<class Value>
+class AsyncSegmentQueue {
+  static constexpr uint SEGMENT_SIZE = 128;
+  enum SlotState : uint { EMPTY = 0, FULL, SKIPPED };
+  struct Slot {
+    std::atomic<uint>     state;
+    Value                 value;
+  };
+  struct Segment {
+    std::atomic<uint>     head_index;                   // next slot to consume
+    char                  head_pad_[RAPICORN_CACHE_LINE_ALIGNMENT - sizeof (std::atomic<uint>)];
+    std::atomic<uint>     tail_index;                   // next slot to fill
+    std::atomic<Segment*> next;
+    char                  tail_pad_[RAPICORN_CACHE_LINE_ALIGNMENT - sizeof (std::atomic<uint>) - sizeof (std::atomic<Segment*>)];
+    Slot                  slots[SEGMENT_SIZE];
+    Segment() : head_index (0), tail_index (0), next (NULL) { for (Slot &slot : slots) slot.state = EMPTY; }
+  };
+  std::atomic<Segment*>   head_;
+  char                    head_pad_[RAPICORN_CACHE_LINE_ALIGNMENT - sizeof (std::atomic<Segment*>)];
+  std::atomic<Segment*>   tail_;
+  static void             delete_segment (void *segment)        { delete static_cast<Segment*> (segment); }
+  static bool             drained        (const Segment *segment);
+  RAPICORN_CLASS_NON_COPYABLE (AsyncSegmentQueue);
+public:
+  explicit AsyncSegmentQueue ();
+  /*dtor*/ ~AsyncSegmentQueue ();      ///< Deletes all elements, no concurrent access must occour at this point.
+  void     push              (const Value &v);
+  bool     pop               (Value &v);
+  bool     pending           () const;
+};
+
 // == AsyncBlockingQueue ==
 /**
  * This is a thread-safe asyncronous queue which blocks in pop() until data is provided through push().
+ * Elements are passed on through an AsyncSegmentQueue, locking is only needed to block in pop() while
+ * the queue is empty and to wake up blocked consumers from push().
  */
 template<class Value>
 class AsyncBlockingQueue {
-  Mutex            mutex_;
-  Cond             cond_;
-  std::list<Value> list_;
+  static constexpr uint    SPIN_POPS = 4;      // pop() attempts before blocking
+  AsyncSegmentQueue<Value> queue_;
+  std::atomic<uint>        waiters_;
+  Mutex                    mutex_;
+  Cond                     cond_;
 public:
+  explicit AsyncBlockingQueue () : waiters_ (0) {}
   void  push    (const Value &v);
   Value pop     ();
   bool  pending ();
@@ -222,13 +307,17 @@ public:
 // == AsyncNotifyingQueue ==
 /**
  * This is a thread-safe asyncronous queue which returns 0 from pop() until data is provided through push().
+ * Elements are passed on through an AsyncSegmentQueue, the notifier is called when a push() follows
+ * after all previously pushed elements have been popped.
  */
 template<class Value>
 class AsyncNotifyingQueue {
-  Mutex                 mutex_;
-  std::function<void()> notifier_;
-  std::list<Value>      list_;
+  AsyncSegmentQueue<Value> queue_;
+  std::atomic<int64>       count_;      // pushed minus popped elements, may be transiently negative
+  Mutex                    mutex_;
+  std::function<void()>    notifier_;
 public:
+  explicit AsyncNotifyingQueue () : count_ (0) {}
   void  push     (const Value &v);
   Value pop      (Value fallback = 0);
   bool  pending  ();
@@ -355,80 +444,212 @@ AsyncRingBuffer<T>::read (uint length, T *data, bool partial)
   return orig_length - length;
 }
 
+template<class Value>
+AsyncSegmentQueue<Value>::AsyncSegmentQueue () :
+  head_ (new Segment())
+{
+  tail_ = head_.load();
+}
+
+template<class Value>
+AsyncSegmentQueue<Value>::~AsyncSegmentQueue ()
+{
+  Segment *segment = head_.load();
+  while (segment)
+    {
+      Segment *next = segment->next.load();
+      delete segment;
+      segment = next;
+    }
+}
+
+template<class Value> bool
+AsyncSegmentQueue<Value>::drained (const Segment *segment)
+{
+  const uint tail_index = MIN (segment->tail_index.load(), SEGMENT_SIZE);
+  return segment->head_index.load() >= tail_index && segment->next.load() == NULL;
+}
+
+/// Append @a v to the queue, this never blocks.
+template<class Value> void
+AsyncSegmentQueue<Value>::push (const Value &v)
+{
+  ThreadInfo &self = ThreadInfo::self();
+  for (;;)
+    {
+      Segment *tail = self.protect_hazard (ThreadInfo::ASYNC_QUEUE_HAZARD, tail_);
+      const uint index = tail->tail_index.fetch_add (1);
+      if (RAPICORN_LIKELY (index < SEGMENT_SIZE))
+        {
+          Slot &slot = tail->slots[index];
+          slot.value = v;
+          uint expected = EMPTY;
+          if (RAPICORN_LIKELY (slot.state.compare_exchange_strong (expected, FULL)))
+            break;
+          slot.value = Value();         // slot was skipped by a consumer
+          continue;
+        }
+      // segment is full, link and/or advance to the next segment
+      Segment *next = tail->next.load();
+      if (!next)
+        {
+          Segment *segment = new Segment();
+          if (tail->next.compare_exchange_strong (next, segment))
+            next = segment;
+          else
+            delete segment;
+        }
+      tail_.compare_exchange_strong (tail, next);
+    }
+  self.clear_hazard (ThreadInfo::ASYNC_QUEUE_HAZARD);
+}
+
+/** Remove the first element from the queue and assign it to @a v, returns false if the queue is empty.
+ * The element is moved out of its slot, so the previous contents of @a v are destroyed after the
+ * hazard pointer is released and Value destructors may use the queue themselves.
+ */
+template<class Value> bool
+AsyncSegmentQueue<Value>::pop (Value &v)
+{
+  ThreadInfo &self = ThreadInfo::self();
+  Value value;
+  bool popped = false;
+  for (;;)
+    {
+      Segment *head = self.protect_hazard (ThreadInfo::ASYNC_QUEUE_HAZARD, head_);
+      if (drained (head))
+        break;
+      const uint index = head->head_index.fetch_add (1);
+      if (RAPICORN_UNLIKELY (index >= SEGMENT_SIZE))
+        {
+          Segment *next = head->next.load();
+          if (!next)
+            break;
+          Segment *tail = head;
+          tail_.compare_exchange_strong (tail, next); // tail_ must not reference a retired segment
+          if (head_.compare_exchange_strong (head, next))
+            {
+              self.clear_hazard (ThreadInfo::ASYNC_QUEUE_HAZARD);
+              ThreadInfo::retire (head, delete_segment);
+            }
+          continue;
+        }
+      Slot &slot = head->slots[index];
+      if (RAPICORN_LIKELY (slot.state.exchange (SKIPPED) == FULL))
+        {
+          value = std::move (slot.value);
+          slot.value = Value();         // resets the moved-from slot
+          popped = true;
+          break;
+        }
+      // the producer of this slot has not finished, it will retry with another slot
+    }
+  self.clear_hazard (ThreadInfo::ASYNC_QUEUE_HAZARD);
+  if (popped)
+    v = std::move (value);
+  return popped;
+}
+
+/// Check if the queue contains elements, concurrent push() and pop() calls may change the result at any time.
+template<class Value> bool
+AsyncSegmentQueue<Value>::pending () const
+{
+  ThreadInfo &self = ThreadInfo::self();
+  const bool empty = drained (self.protect_hazard (ThreadInfo::ASYNC_QUEUE_HAZARD, head_));
+  self.clear_hazard (ThreadInfo::ASYNC_QUEUE_HAZARD);
+  return !empty;
+}
+
 template<class Value> void
 AsyncBlockingQueue<Value>::push (const Value &v)
 {
-  ScopedLock<Mutex> sl (mutex_);
-  const bool notify = list_.empty();
-  list_.push_back (v);
-  if (RAPICORN_UNLIKELY (notify))
-    cond_.broadcast();
+  queue_.push (v);
+  if (RAPICORN_UNLIKELY (waiters_.load() > 0))
+    {
+      ScopedLock<Mutex> sl (mutex_);
+      cond_.signal();
+    }
 }
 
 template<class Value> Value
 AsyncBlockingQueue<Value>::pop ()
 {
+  Value v;
+  for (uint i = 0; i < SPIN_POPS; i++)
+    {
+      if (RAPICORN_LIKELY (queue_.pop (v)))
+        return v;
+      ThisThread::yield();      // give producers a chance before blocking
+    }
   ScopedLock<Mutex> sl (mutex_);
-  while (list_.empty())
+  waiters_++;                   // ordered before the pop() check, so push() cannot miss waking us
+  while (!queue_.pop (v))
     cond_.wait (mutex_);
-  Value v = list_.front();
-  list_.pop_front();
+  waiters_--;
   return v;
 }
 
 template<class Value> bool
 AsyncBlockingQueue<Value>::pending()
 {
-  ScopedLock<Mutex> sl (mutex_);
-  return !list_.empty();
+  return queue_.pending();
 }
 
+/// Exchange the queue contents with @a list, elements pushed concurrently may end up in either.
 template<class Value> void
 AsyncBlockingQueue<Value>::swap (std::list<Value> &list)
 {
-  ScopedLock<Mutex> sl (mutex_);
-  const bool notify = list_.empty();
-  list_.swap (list);
-  if (notify && !list_.empty())
-    cond_.broadcast();
+  std::list<Value> popped;
+  Value v;
+  while (queue_.pop (v))
+    popped.push_back (v);
+  for (const Value &e : list)
+    push (e);
+  list.swap (popped);
 }
 
 template<class Value> void
 AsyncNotifyingQueue<Value>::push (const Value &v)
 {
-  ScopedLock<Mutex> sl (mutex_);
-  const bool notify = list_.empty();
-  list_.push_back (v);
-  if (RAPICORN_UNLIKELY (notify) && notifier_)
-    notifier_();
+  queue_.push (v);
+  if (RAPICORN_UNLIKELY (count_.fetch_add (1) == 0))
+    {
+      ScopedLock<Mutex> sl (mutex_);
+      if (notifier_)
+        notifier_();
+    }
 }
 
 template<class Value> Value
 AsyncNotifyingQueue<Value>::pop (Value fallback)
 {
-  ScopedLock<Mutex> sl (mutex_);
-  if (RAPICORN_UNLIKELY (list_.empty()))
+  Value v;
+  if (RAPICORN_UNLIKELY (!queue_.pop (v)))
     return fallback;
-  Value v = list_.front();
-  list_.pop_front();
+  count_.fetch_sub (1);
   return v;
 }
 
 template<class Value> bool
 AsyncNotifyingQueue<Value>::pending()
 {
-  ScopedLock<Mutex> sl (mutex_);
-  return !list_.empty();
+  return queue_.pending();
 }
 
+/// Exchange the queue contents with @a list, elements pushed concurrently may end up in either.
 template<class Value> void
 AsyncNotifyingQueue<Value>::swap (std::list<Value> &list)
 {
-  ScopedLock<Mutex> sl (mutex_);
-  const bool notify = list_.empty();
-  list_.swap (list);
-  if (notify && !list_.empty() && notifier_)
-    notifier_();
+  std::list<Value> popped;
+  Value v;
+  while (queue_.pop (v))
+    {
+      count_.fetch_sub (1);
+      popped.push_back (v);
+    }
+  for (const Value &e : list)
+    push (e);
+  list.swap (popped);
 }
 
 template<class Value> void
@@ -446,6 +667,82 @@ ThreadInfo::self()
   return *self_cached;
 }
 
+template<class T> inline T*
+ThreadInfo::protect_hazard (uint slot, const std::atomic<T*> &ptr)
+{
+  T *p = ptr.load (std::memory_order_relaxed);
+  for (;;)
+    {
+      __atomic_store_n (&hp[slot], (void*) p, __ATOMIC_SEQ_CST); // publish hazard before validating
+      T *const q = ptr.load (std::memory_order_seq_cst);
+      if (RAPICORN_LIKELY (p == q))
+        return p;       // p cannot be reclaimed before hp[slot] is reset
+      p = q;
+    }
+}
+
+inline void
+ThreadInfo::clear_hazard (uint slot)
+{
+  __atomic_store_n (&hp[slot], (void*) NULL, __ATOMIC_RELEASE);
+}
+
+/// Lookup @a key and assign its value to @a value, returns false if @a key is unknown.
+template<class Key, class Value, class Hash, class KeyEqual> bool
+RcuMap<Key,Value,Hash,KeyEqual>::lookup (const Key &key, Value &value) const
+{
+  ThreadInfo &self = ThreadInfo::self();
+  const Map *map = self.protect_hazard (ThreadInfo::RCU_MAP_HAZARD, map_);
+  auto it = map->find (key);
+  const bool found = it != map->end();
+  if (found)
+    value = it->second;
+  self.clear_hazard (ThreadInfo::RCU_MAP_HAZARD);
+  return found;
+}
+
+/// Retrieve the number of elements in the map.
+template<class Key, class Value, class Hash, class KeyEqual> size_t
+RcuMap<Key,Value,Hash,KeyEqual>::size () const
+{
+  ThreadInfo &self = ThreadInfo::self();
+  const size_t n = self.protect_hazard (ThreadInfo::RCU_MAP_HAZARD, map_)->size();
+  self.clear_hazard (ThreadInfo::RCU_MAP_HAZARD);
+  return n;
+}
+
+/// Apply @a updater to a copy of the map and publish the result, @a updater is called as updater (Map&).
+template<class Key, class Value, class Hash, class KeyEqual> template<class Updater> void
+RcuMap<Key,Value,Hash,KeyEqual>::update (const Updater &updater)
+{
+  ScopedLock<Mutex> locker (writer_mutex_);
+  Map *map = new Map (*map_.load (std::memory_order_relaxed));
+  updater (*map);
+  Map *old = map_.exchange (map);
+  ThreadInfo::retire (old, delete_map);
+}
+
+/// Add or replace the value of @a key, returns false if @a key was already present.
+template<class Key, class Value, class Hash, class KeyEqual> bool
+RcuMap<Key,Value,Hash,KeyEqual>::insert (const Key &key, const Value &value)
+{
+  bool inserted = false;
+  update ([&] (Map &map) {
+      inserted = map.find (key) == map.end();
+      map[key] = value;
+    });
+  return inserted;
+}
+
+/// Remove @a key from the map, returns false if @a key was not present.
+template<class Key, class Value, class Hash, class KeyEqual> bool
+RcuMap<Key,Value,Hash,KeyEqual>::erase (const Key &key)
+{
+  bool erased = false;
+  update ([&] (Map &map) { erased = map.erase (key) > 0; });
+  return erased;
+}
+
 inline bool
 ThreadInfo::lookup_pointer (const std::vector<void*> &ptrs, void *arg)
 {
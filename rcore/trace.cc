@@ -0,0 +1,248 @@
+// This Source Code Form is licensed MPL-2.0: http://mozilla.org/MPL/2.0
+#include "trace.hh"
+#include "thread.hh"
+#include "main.hh"              // program_alias
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <atomic>
+
+namespace Rapicorn {
+namespace Trace {
+
+std::atomic<int> _trace_enabled_cache (-1);
+
+/* Each thread owns a ring buffer that only it writes to. Every slot is guarded by a sequence
+ * number (seqlock style), the writer marks slot i as being written with an odd sequence 2*i+1,
+ * stores the event fields and publishes it with 2*i+2. Readers copy a slot only if its sequence
+ * matches 2*i+2 before and after reading the fields, so events the writer overwrote in the mean
+ * time are skipped. All fields are relaxed atomics, so concurrent copying is race free.
+ * Buffers are never freed, so events of exited threads remain available.
+ */
+struct TraceBuffer {
+  struct Slot {
+    std::atomic<uint64>       seq;
+    std::atomic<uint64>       stamp;
+    std::atomic<const char*>  name;
+    std::atomic<int64>        value;
+    std::atomic<Phase>        phase;
+  };
+  static constexpr size_t CAPACITY = 8192;      // power of 2
+  std::atomic<uint64>     head_;                // number of events ever recorded
+  std::atomic<uint64>     tail_;                // events before tail_ have been cleared
+  const int               tid_;
+  const String            thread_name_;
+  Slot                    slots_[CAPACITY];
+  static_assert ((CAPACITY & (CAPACITY - 1)) == 0, "TraceBuffer::CAPACITY must be a power of 2");
+  explicit TraceBuffer (int tid, const String &thread_name) :
+    head_ (0), tail_ (0), tid_ (tid), thread_name_ (thread_name)
+  {
+    for (Slot &slot : slots_)
+      slot.seq.store (0, std::memory_order_relaxed);
+  }
+  void
+  push (const Event &event)
+  {
+    const uint64 h = head_.load (std::memory_order_relaxed);
+    Slot &slot = slots_[h & (CAPACITY - 1)];
+    slot.seq.store (2 * h + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence (std::memory_order_release);
+    slot.stamp.store (event.stamp, std::memory_order_relaxed);
+    slot.name.store (event.name, std::memory_order_relaxed);
+    slot.value.store (event.value, std::memory_order_relaxed);
+    slot.phase.store (event.phase, std::memory_order_relaxed);
+    slot.seq.store (2 * h + 2, std::memory_order_release);
+    head_.store (h + 1, std::memory_order_release);
+  }
+  void
+  snapshot (vector<Event> &events) const
+  {
+    const uint64 h = head_.load (std::memory_order_acquire);
+    const uint64 t = tail_.load (std::memory_order_relaxed);
+    for (uint64 i = MAX (t, h > CAPACITY ? h - CAPACITY : 0); i < h; i++)
+      {
+        const Slot &slot = slots_[i & (CAPACITY - 1)];
+        const uint64 seq = slot.seq.load (std::memory_order_acquire);
+        if (seq != 2 * i + 2)
+          continue;                             // overwritten by a newer event
+        Event event;
+        event.stamp = slot.stamp.load (std::memory_order_relaxed);
+        event.name = slot.name.load (std::memory_order_relaxed);
+        event.value = slot.value.load (std::memory_order_relaxed);
+        event.phase = slot.phase.load (std::memory_order_relaxed);
+        std::atomic_thread_fence (std::memory_order_acquire);
+        if (slot.seq.load (std::memory_order_relaxed) == seq)
+          events.push_back (event);
+      }
+  }
+  void
+  clear ()
+  {
+    tail_.store (head_.load (std::memory_order_acquire), std::memory_order_relaxed);
+  }
+};
+
+static Mutex                  trace_mutex;
+static __thread TraceBuffer  *thread_trace_buffer = NULL;
+
+static vector<TraceBuffer*>&
+trace_buffers ()
+{
+  static vector<TraceBuffer*> &buffers = *new vector<TraceBuffer*>(); // leaked, buffers outlive threads
+  return buffers;
+}
+
+static TraceBuffer*
+create_thread_buffer ()
+{
+  TraceBuffer *tbuffer = new TraceBuffer (ThisThread::thread_pid(), ThisThread::name());
+  ScopedLock<Mutex> locker (trace_mutex);
+  trace_buffers().push_back (tbuffer);
+  return tbuffer;
+}
+
+/// Record a trace event for the current thread, use the inline wrappers like Trace::begin() instead.
+void
+record (Phase phase, const char *name, int64 value)
+{
+  TraceBuffer *tbuffer = thread_trace_buffer;
+  if (RAPICORN_UNLIKELY (!tbuffer))
+    tbuffer = thread_trace_buffer = create_thread_buffer();
+  Event event;
+  event.stamp = timestamp_benchmark();
+  event.name = name;
+  event.value = value;
+  event.phase = phase;
+  tbuffer->push (event);
+}
+
+static void
+write_trace_at_exit ()
+{
+  const String filename = string_format ("rapicorn-trace.%u.json", ThisThread::process_pid());
+  if (!write_chrome_json (filename))
+    user_warning (UserSource ("trace"), "failed to write trace file: %s: %s", filename, strerror (errno));
+}
+
+bool
+_trace_enabled_check ()
+{
+  static Mutex check_mutex;
+  ScopedLock<Mutex> locker (check_mutex);
+  if (_trace_enabled_cache.load() < 0)
+    {
+      const bool onoff = RAPICORN_FLIPPER ("trace", "Rapicorn::Trace: record hot-path trace events and write rapicorn-trace.<pid>.json at exit.");
+      if (onoff)
+        atexit (write_trace_at_exit);
+      _trace_enabled_cache.store (onoff);
+    }
+  return _trace_enabled_cache.load() > 0;
+}
+
+void
+enable (bool onoff)
+{
+  _trace_enabled_cache.store (onoff, std::memory_order_relaxed);
+}
+
+void
+clear ()
+{
+  ScopedLock<Mutex> locker (trace_mutex);
+  for (TraceBuffer *tbuffer : trace_buffers())
+    tbuffer->clear();
+}
+
+static String
+json_string (const char *str)
+{
+  String s = "\"";
+  for (const char *c = str; *c; c++)
+    switch (*c)
+      {
+      case '"':  s += "\\\"";   break;
+      case '\\': s += "\\\\";   break;
+      default:
+        if (uint8 (*c) < 0x20)
+          s += string_format ("\\u%04x", uint8 (*c));
+        else
+          s += *c;
+      }
+  return s + "\"";
+}
+
+/** Render recorded events in Chrome trace event format.
+ * The JSON output contains all events still held by the per-thread ring buffers,
+ * timestamps are given in microseconds and threads are labeled with their names.
+ */
+String
+chrome_json ()
+{
+  const int pid = ThisThread::process_pid();
+  vector<std::pair<const TraceBuffer*,size_t>> threads;
+  vector<Event> events;
+  {
+    ScopedLock<Mutex> locker (trace_mutex);
+    for (const TraceBuffer *tbuffer : trace_buffers())
+      {
+        tbuffer->snapshot (events);
+        threads.push_back (std::make_pair (tbuffer, events.size()));
+      }
+  }
+  String json = "{\"traceEvents\":[\n";
+  json += string_format ("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":%s}}", pid, json_string (program_alias().c_str()));
+  size_t i = 0;
+  for (const auto &thread : threads)
+    {
+      const int tid = thread.first->tid_;
+      json += string_format (",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":%s}}",
+                             pid, tid, json_string (thread.first->thread_name_.c_str()));
+      for (; i < thread.second; i++)
+        {
+          const Event &event = events[i];
+          json += string_format (",\n{\"name\":%s,\"ph\":\"%c\",\"ts\":%u.%03u,\"pid\":%d,\"tid\":%d",
+                                 json_string (event.name), char (event.phase),
+                                 event.stamp / 1000, event.stamp % 1000, pid, tid);
+          switch (event.phase)
+            {
+            case COUNTER:
+              json += string_format (",\"args\":{\"value\":%d}}", event.value);
+              break;
+            case INSTANT:
+              json += ",\"s\":\"t\"}";
+              break;
+            case FLOW_SEND:
+              json += string_format (",\"cat\":\"ipc\",\"id\":\"0x%x\"}", event.value);
+              break;
+            case FLOW_RECEIVE:
+              json += string_format (",\"cat\":\"ipc\",\"id\":\"0x%x\",\"bp\":\"e\"}", event.value);
+              break;
+            default:
+              json += "}";
+              break;
+            }
+        }
+    }
+  json += "\n],\"displayTimeUnit\":\"ms\"}\n";
+  return json;
+}
+
+/// Write chrome_json() output into @a filename, returns false and sets errno on failure.
+bool
+write_chrome_json (const String &filename)
+{
+  const String json = chrome_json();
+  FILE *file = fopen (filename.c_str(), "w");
+  if (!file)
+    return false;
+  const bool written = fwrite (json.data(), json.size(), 1, file) == 1;
+  const int saved_errno = errno;
+  const bool closed = fclose (file) == 0;
+  if (!written)
+    errno = saved_errno;
+  return written && closed;
+}
+
+} // Trace
+} // Rapicorn
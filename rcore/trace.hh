@@ -0,0 +1,83 @@
+// This Source Code Form is licensed MPL-2.0: http://mozilla.org/MPL/2.0
+#ifndef __RAPICORN_TRACE_HH__
+#define __RAPICORN_TRACE_HH__
+
+#include <rcore/inout.hh>
+#include <atomic>
+
+namespace Rapicorn {
+
+/** The Trace namespace provides lock-free hot-path instrumentation.
+ * Each thread records fixed-size binary events into its own ring buffer, the recording
+ * costs a timestamp and a few stores and needs no locks or allocations (except for the
+ * first event recorded per thread). Tracing is enabled with RAPICORN_FLIPPER=trace or
+ * Trace::enable(), the recorded events can be dumped in the Chrome trace event format
+ * (as understood by chrome://tracing) via Trace::chrome_json(). If tracing is enabled
+ * via RAPICORN_FLIPPER, the trace is written to rapicorn-trace.<pid>.json at exit.
+ * Event names must be pointers to static strings, they are stored by reference.
+ */
+namespace Trace {
+
+/// Event types, the values match the Chrome trace event phases.
+enum Phase : uint8 {
+  BEGIN         = 'B',  ///< Start of a duration scope.
+  END           = 'E',  ///< End of a duration scope.
+  COUNTER       = 'C',  ///< Counter sample, the event value holds the counter.
+  INSTANT       = 'i',  ///< Single point in time.
+  FLOW_SEND     = 's',  ///< IPC message is sent, the event value holds the message id.
+  FLOW_RECEIVE  = 'f',  ///< IPC message is received, the event value holds the message id.
+};
+
+/// Binary trace event as recorded into the per-thread ring buffers.
+struct Event {
+  uint64        stamp;  ///< Nanoseconds as returned by timestamp_benchmark().
+  const char   *name;   ///< Static event name.
+  int64         value;  ///< Counter value or message id.
+  Phase         phase;  ///< Event type.
+};
+
+extern std::atomic<int> _trace_enabled_cache;   ///< Tri-state cache, -1 until the flipper has been checked.
+bool   _trace_enabled_check ();
+void   record            (Phase phase, const char *name, int64 value = 0);
+void   enable            (bool onoff);          ///< Enable or disable event recording.
+void   clear             ();                    ///< Discard events recorded so far.
+String chrome_json       ();                    ///< Render recorded events in Chrome trace event format.
+bool   write_chrome_json (const String &filename);
+
+/// Check if trace events are recorded.
+inline bool
+enabled ()
+{
+  const int cache = _trace_enabled_cache.load (std::memory_order_relaxed);
+  return RAPICORN_LIKELY (cache >= 0) ? cache : _trace_enabled_check();
+}
+/// Record the start of a duration scope.
+inline void begin        (const char *name)                     { if (RAPICORN_UNLIKELY (enabled())) record (BEGIN, name); }
+/// Record the end of a duration scope.
+inline void end          (const char *name)                     { if (RAPICORN_UNLIKELY (enabled())) record (END, name); }
+/// Record a counter sample.
+inline void counter      (const char *name, int64 value)        { if (RAPICORN_UNLIKELY (enabled())) record (COUNTER, name, value); }
+/// Record a single point in time.
+inline void instant      (const char *name)                     { if (RAPICORN_UNLIKELY (enabled())) record (INSTANT, name); }
+/// Record sending of an IPC message, @a msgid must match the corresponding flow_receive().
+inline void flow_send    (const char *name, uint64 msgid)       { if (RAPICORN_UNLIKELY (enabled())) record (FLOW_SEND, name, msgid); }
+/// Record receiving of an IPC message, @a msgid must match the corresponding flow_send().
+inline void flow_receive (const char *name, uint64 msgid)       { if (RAPICORN_UNLIKELY (enabled())) record (FLOW_RECEIVE, name, msgid); }
+
+/// Scope guard that records BEGIN and END events, see RAPICORN_TRACE_SCOPE().
+class Scope {
+  const char *name_;
+  RAPICORN_CLASS_NON_COPYABLE (Scope);
+public:
+  explicit Scope  (const char *name) : name_ (RAPICORN_UNLIKELY (enabled()) ? name : NULL) { if (name_) record (BEGIN, name_); }
+  /*dtor*/ ~Scope ()                                                                    { if (name_) record (END, name_); }
+};
+
+} // Trace
+
+/// Record a trace duration scope (Trace::BEGIN, Trace::END) that lasts until the end of the enclosing block.
+#define RAPICORN_TRACE_SCOPE(name)      ::Rapicorn::Trace::Scope RAPICORN_CPP_PASTE2 (__rapicorn_trace_scope__, __LINE__) (name)
+
+} // Rapicorn
+
+#endif // __RAPICORN_TRACE_HH__
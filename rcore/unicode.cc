@@ -1,35 +1,110 @@
 // This Source Code Form is licensed MPL-2.0: http://mozilla.org/MPL/2.0
 #include "unicode.hh"
+#include "thread.hh"
 #include <glib.h>
+#include <array>
+#include <set>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 namespace Rapicorn {
 
 /// The Unicode namespace provides support for the Unicode standard and UTF-8 encoding.
 namespace Unicode {
 
+/* --- character properties --- */
+// The classifiers below are answered from a two-level table, properties of each code point are packed
+// into 32 bits and kept in pages of 256 code points. Pages are filled from GLib on first use and pages
+// with identical contents (unassigned planes, private use areas, CJK blocks, etc) are shared.
+enum : uint32 {
+  PROP_TYPE_MASK = 0x1f,        PROP_BREAK_SHIFT = 5,           PROP_BREAK_MASK = 0x3f << PROP_BREAK_SHIFT,
+  PROP_ALNUM     = 1 << 11,     PROP_ALPHA       = 1 << 12,     PROP_CNTRL      = 1 << 13,
+  PROP_DIGIT     = 1 << 14,     PROP_GRAPH       = 1 << 15,     PROP_LOWER      = 1 << 16,
+  PROP_PRINT     = 1 << 17,     PROP_PUNCT       = 1 << 18,     PROP_SPACE      = 1 << 19,
+  PROP_UPPER     = 1 << 20,     PROP_XDIGIT      = 1 << 21,     PROP_TITLE      = 1 << 22,
+  PROP_DEFINED   = 1 << 23,     PROP_WIDE        = 1 << 24,     PROP_WIDE_CJK   = 1 << 25,
+};
+static constexpr const unichar PROP_LIMIT = 0x110000, PROP_PAGE_BITS = 8, PROP_PAGE_SIZE = 1 << PROP_PAGE_BITS;
+typedef std::array<uint32, PROP_PAGE_SIZE> PropPage;
+static std::atomic<const uint32*> prop_pages[PROP_LIMIT >> PROP_PAGE_BITS];
+static Mutex                      prop_pages_mutex;
+
+static uint32
+glib_properties (unichar uc)
+{
+  uint32 props = g_unichar_type (uc) | g_unichar_break_type (uc) << PROP_BREAK_SHIFT;
+  props |= g_unichar_isalnum (uc) ? PROP_ALNUM : 0;
+  props |= g_unichar_isalpha (uc) ? PROP_ALPHA : 0;
+  props |= g_unichar_iscntrl (uc) ? PROP_CNTRL : 0;
+  props |= g_unichar_isdigit (uc) ? PROP_DIGIT : 0;
+  props |= g_unichar_isgraph (uc) ? PROP_GRAPH : 0;
+  props |= g_unichar_islower (uc) ? PROP_LOWER : 0;
+  props |= g_unichar_isprint (uc) ? PROP_PRINT : 0;
+  props |= g_unichar_ispunct (uc) ? PROP_PUNCT : 0;
+  props |= g_unichar_isspace (uc) ? PROP_SPACE : 0;
+  props |= g_unichar_isupper (uc) ? PROP_UPPER : 0;
+  props |= g_unichar_isxdigit (uc) ? PROP_XDIGIT : 0;
+  props |= g_unichar_istitle (uc) ? PROP_TITLE : 0;
+  props |= g_unichar_isdefined (uc) ? PROP_DEFINED : 0;
+  props |= g_unichar_iswide (uc) ? PROP_WIDE : 0;
+#if GLIB_CHECK_VERSION (2, 12, 0)
+  props |= g_unichar_iswide_cjk (uc) ? PROP_WIDE_CJK : 0;
+#endif
+  return props;
+}
+
+static RAPICORN_NOINLINE const uint32*
+properties_page (const uint page_index)
+{
+  PropPage page;
+  for (uint i = 0; i < PROP_PAGE_SIZE; i++)
+    page[i] = glib_properties (page_index << PROP_PAGE_BITS | i);
+  static std::set<PropPage> &unique_pages = *new std::set<PropPage>(); // leaked, pages are referenced until exit
+  ScopedLock<Mutex> locker (prop_pages_mutex);
+  const uint32 *entries = prop_pages[page_index].load();
+  if (!entries)
+    {
+      entries = unique_pages.insert (page).first->data();
+      prop_pages[page_index].store (entries, std::memory_order_release);
+    }
+  return entries;
+}
+
+static inline uint32
+properties (unichar uc)
+{
+  if (RAPICORN_UNLIKELY (uc >= PROP_LIMIT))
+    return glib_properties (uc);
+  const uint32 *entries = prop_pages[uc >> PROP_PAGE_BITS].load (std::memory_order_acquire);
+  if (RAPICORN_UNLIKELY (!entries))
+    entries = properties_page (uc >> PROP_PAGE_BITS);
+  return entries[uc & (PROP_PAGE_SIZE - 1)];
+}
+
 /* --- unichar ctype.h equivalents --- */
 bool
 isalnum (unichar uc)
 {
-  return g_unichar_isalnum (uc);
+  return properties (uc) & PROP_ALNUM;
 }
 
 bool
 isalpha (unichar uc)
 {
-  return g_unichar_isalpha (uc);
+  return properties (uc) & PROP_ALPHA;
 }
 
 bool
 iscntrl (unichar uc)
 {
-  return g_unichar_iscntrl (uc);
+  return properties (uc) & PROP_CNTRL;
 }
 
 bool
 isdigit (unichar uc)
 {
-  return g_unichar_isdigit (uc);
+  return properties (uc) & PROP_DIGIT;
 }
 
 int
@@ -41,13 +116,13 @@ digit_value (unichar uc)
 bool
 isgraph (unichar uc)
 {
-  return g_unichar_isgraph (uc);
+  return properties (uc) & PROP_GRAPH;
 }
 
 bool
 islower (unichar uc)
 {
-  return g_unichar_islower (uc);
+  return properties (uc) & PROP_LOWER;
 }
 
 unichar
@@ -59,25 +134,25 @@ tolower (unichar uc)
 bool
 isprint (unichar uc)
 {
-  return g_unichar_isprint (uc);
+  return properties (uc) & PROP_PRINT;
 }
 
 bool
 ispunct (unichar uc)
 {
-  return g_unichar_ispunct (uc);
+  return properties (uc) & PROP_PUNCT;
 }
 
 bool
 isspace (unichar uc)
 {
-  return g_unichar_isspace (uc);
+  return properties (uc) & PROP_SPACE;
 }
 
 bool
 isupper (unichar uc)
 {
-  return g_unichar_isupper (uc);
+  return properties (uc) & PROP_UPPER;
 }
 
 unichar
@@ -89,7 +164,7 @@ toupper (unichar uc)
 bool
 isxdigit (unichar uc)
 {
-  return g_unichar_isxdigit (uc);
+  return properties (uc) & PROP_XDIGIT;
 }
 
 int
@@ -101,7 +176,7 @@ xdigit_value (unichar uc)
 bool
 istitle (unichar uc)
 {
-  return g_unichar_istitle (uc);
+  return properties (uc) & PROP_TITLE;
 }
 
 unichar
@@ -113,35 +188,31 @@ totitle (unichar uc)
 bool
 isdefined (unichar uc)
 {
-  return g_unichar_isdefined (uc);
+  return properties (uc) & PROP_DEFINED;
 }
 
 bool
 iswide (unichar uc)
 {
-  return g_unichar_iswide (uc);
+  return properties (uc) & PROP_WIDE;
 }
 
 bool
 iswide_cjk (unichar uc)
 {
-#if GLIB_CHECK_VERSION (2, 12, 0)
-  return g_unichar_iswide_cjk (uc);
-#else
-  return false;
-#endif
+  return properties (uc) & PROP_WIDE_CJK;
 }
 
 Type
 get_type (unichar uc)
 {
-  return Type (g_unichar_type (uc));
+  return Type (properties (uc) & PROP_TYPE_MASK);
 }
 
 BreakType
 get_break (unichar uc)
 {
-  return BreakType (g_unichar_break_type (uc));
+  return BreakType ((properties (uc) & PROP_BREAK_MASK) >> PROP_BREAK_SHIFT);
 }
 
 /* --- ensure castable Rapicorn::Unicode::Type --- */
@@ -296,17 +367,158 @@ utf8_from_unichar (unichar uc,
   return l;
 }
 
+/// Skip ASCII characters up to the first non-ASCII or NUL byte.
+static inline const char*
+utf8_skip_ascii (const char *p, const char *end)
+{
+#ifdef __SSE2__
+  const __m128i zero = _mm_setzero_si128();
+  for (; end - p >= 16; p += 16)
+    {
+      const __m128i chars = _mm_loadu_si128 ((const __m128i*) p);
+      const int mask = _mm_movemask_epi8 (chars) | _mm_movemask_epi8 (_mm_cmpeq_epi8 (chars, zero));
+      if (mask)
+        return p + __builtin_ctz (mask);
+    }
+#endif
+  while (p < end && uint8 (*p - 1) < 0x7f)
+    p++;
+  return p;
+}
+
+/// Find the first invalid or NUL character in @a str, returns @a end for valid UTF-8.
+static const char*
+utf8_find_invalid (const char *p, const char *end)
+{
+  while (p < end)
+    {
+      const uint8 c = *p;
+      if (c < 0x80)
+        {
+          if (RAPICORN_UNLIKELY (c == 0))
+            return p;
+          p = utf8_skip_ascii (p + 1, end);
+          continue;
+        }
+      // reject overlong forms, surrogates and code points beyond U+10FFFF like g_utf8_validate()
+      const ptrdiff_t left = end - p;
+      if (c < 0xc2)
+        return p;
+      else if (c < 0xe0)
+        {
+          if (left < 2 || (p[1] & 0xc0) != 0x80)
+            return p;
+          p += 2;
+        }
+      else if (c < 0xf0)
+        {
+          const uint8 lower = c == 0xe0 ? 0xa0 : 0x80, upper = c == 0xed ? 0x9f : 0xbf;
+          if (left < 3 || uint8 (p[1]) < lower || uint8 (p[1]) > upper || (p[2] & 0xc0) != 0x80)
+            return p;
+          p += 3;
+        }
+      else if (c < 0xf5)
+        {
+          const uint8 lower = c == 0xf0 ? 0x90 : 0x80, upper = c == 0xf4 ? 0x8f : 0xbf;
+          if (left < 4 || uint8 (p[1]) < lower || uint8 (p[1]) > upper || (p[2] & 0xc0) != 0x80 || (p[3] & 0xc0) != 0x80)
+            return p;
+          p += 4;
+        }
+      else
+        return p;
+    }
+  return end;
+}
+
+/// Check @a length bytes of @a str for valid UTF-8, @a bound is set to the index of the first invalid character or -1.
+bool
+utf8_validate (const char *str, size_t length, int *bound)
+{
+  const char *invalid = utf8_find_invalid (str, str + length);
+  const bool valid = invalid == str + length;
+  if (bound)
+    *bound = valid ? -1 : invalid - str;
+  return valid;
+}
+
 bool
 utf8_validate (const String   &strng,
                int            *bound)
 {
-  const char *c = &strng[0];
-  size_t l = strng.size();
-  const gchar *end = NULL;
-  gboolean gb = g_utf8_validate (c, l, &end);
-  if (bound)
-    *bound = !gb ? end - c : -1;
-  return gb != false;
+  return utf8_validate (strng.data(), strng.size(), bound);
+}
+
+/// Widen ASCII characters into @a codepoints up to the first non-ASCII byte.
+static inline const char*
+utf8_widen_ascii (const char *p, const char *end, unichar *&codepoints)
+{
+#ifdef __SSE2__
+  const __m128i zero = _mm_setzero_si128();
+  while (end - p >= 16)
+    {
+      const __m128i chars = _mm_loadu_si128 ((const __m128i*) p);
+      const __m128i lo = _mm_unpacklo_epi8 (chars, zero), hi = _mm_unpackhi_epi8 (chars, zero);
+      // codepoints has room for end - p entries, so all 16 can be stored before checking
+      _mm_storeu_si128 ((__m128i*) (codepoints +  0), _mm_unpacklo_epi16 (lo, zero));
+      _mm_storeu_si128 ((__m128i*) (codepoints +  4), _mm_unpackhi_epi16 (lo, zero));
+      _mm_storeu_si128 ((__m128i*) (codepoints +  8), _mm_unpacklo_epi16 (hi, zero));
+      _mm_storeu_si128 ((__m128i*) (codepoints + 12), _mm_unpackhi_epi16 (hi, zero));
+      const int mask = _mm_movemask_epi8 (chars);
+      if (mask)
+        {
+          const int n = __builtin_ctz (mask);
+          codepoints += n;
+          return p + n;
+        }
+      codepoints += 16;
+      p += 16;
+    }
+#endif
+  while (p < end && uint8 (*p) < 0x80)
+    *codepoints++ = uint8 (*p++);
+  return p;
+}
+
+/**
+ * Decode @a length bytes of UTF-8 from @a str into @a codepoints, which must provide room for @a length entries.
+ * Malformed or truncated sequences are decoded as 0xffffffff per byte, use utf8_validate() to reject those upfront.
+ * Returns the number of decoded characters.
+ */
+size_t
+utf8_to_unicode (const char *str, size_t length, unichar *codepoints)
+{
+  const char *p = str, *const end = str + length;
+  unichar *u = codepoints;
+  while (p < end)
+    {
+      const uint8 c = *p;
+      if (c < 0x80)
+        {
+          p = utf8_widen_ascii (p, end, u);
+          continue;
+        }
+      const int clen = utf8_skip_table[c];
+      bool valid = clen > 1 && end - p >= clen;
+      unichar uc = c & utf8_char_mask (c);
+      for (int i = 1; valid && i < clen; i++)
+        {
+          const uint8 b = p[i];
+          valid = (b & 0xc0) == 0x80;
+          uc = (uc << 6) + (b & 0x3f);
+        }
+      *u++ = valid ? uc : 0xffffffff;
+      p += valid ? clen : 1;
+    }
+  return u - codepoints;
+}
+
+/// Decode UTF-8 string @a str into a vector of Unicode characters, see utf8_to_unicode().
+vector<unichar>
+utf8_to_unicode (const String &str)
+{
+  vector<unichar> codepoints (str.size());
+  codepoints.resize (utf8_to_unicode (str.data(), str.size(), codepoints.data()));
+  return codepoints;
 }
 
 } // Rapicorn
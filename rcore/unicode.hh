@@ -83,6 +83,13 @@ int                   utf8_from_unichar (unichar         uc,
                                          char            str[8]);
 bool                  utf8_validate     (const String   &string,
                                          int            *bound = NULL);
+bool                  utf8_validate     (const char     *str,
+                                         size_t          length,
+                                         int            *bound = NULL);
+size_t                utf8_to_unicode   (const char     *str,
+                                         size_t          length,
+                                         unichar        *codepoints);
+vector<unichar>       utf8_to_unicode   (const String   &str);
 bool                  utf8_is_locale_charset ();
 
 /* --- implementation bits --- */
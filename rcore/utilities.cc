@@ -1375,58 +1375,51 @@ memwrite (const String &filename, size_t len, const uint8 *bytes)
 } // Path
 
 /* --- DataList --- */
-DataList::NodeBase::~NodeBase ()
-{}
-
-void
-DataList::set_data (NodeBase *node)
+bool
+DataList::rip (DataKey<void> *key, Slot &slot)
 {
-  /* delete old node */
-  NodeBase *it = rip_data (node->key);
-  if (it)
-    delete it;
-  /* prepend node */
-  node->next = nodes;
-  nodes = node;
+  Slot *s = lookup (key);
+  if (!s)
+    return false;
+  slot = *s;
+  *s = slots_->end()[-1];       // slot order is irrelevant, fill the gap with the last slot
+  resize (slots_->n_slots - 1);
+  return true;
 }
 
-DataList::NodeBase*
-DataList::get_data (DataKey<void> *key) const
+void
+DataList::append (const Slot &slot)
 {
-  NodeBase *it;
-  for (it = nodes; it; it = it->next)
-    if (it->key == key)
-      return it;
-  return NULL;
+  const size_t n_slots = slots_ ? slots_->n_slots : 0;
+  resize (n_slots + 1);
+  slots_->begin()[n_slots] = slot;
 }
 
-DataList::NodeBase*
-DataList::rip_data (DataKey<void> *key)
+/// Reallocate the slot array to hold exactly @a n_slots, the array is freed if @a n_slots is 0.
+void
+DataList::resize (size_t n_slots)
 {
-  NodeBase *last = NULL, *it;
-  for (it = nodes; it; last = it, it = last->next)
-    if (it->key == key)
-      {
-        /* unlink existing node */
-        if (last)
-          last->next = it->next;
-        else
-          nodes = it->next;
-        it->next = NULL;
-        return it;
-      }
-  return NULL;
+  if (!n_slots)
+    {
+      free (slots_);
+      slots_ = NULL;
+      return;
+    }
+  Slots *slots = (Slots*) realloc (slots_, sizeof (Slots) + n_slots * sizeof (Slot));
+  if (UNLIKELY (!slots))
+    fatal ("DataList: out of memory");
+  slots->n_slots = n_slots;
+  slots_ = slots;
 }
 
 void
 DataList::clear_like_destructor()
 {
-  while (nodes)
+  while (slots_)
     {
-      NodeBase *it = nodes;
-      nodes = it->next;
-      it->next = NULL;
-      delete it;
+      Slot slot = slots_->end()[-1];
+      resize (slots_->n_slots - 1);
+      slot.destroy (slot);
     }
 }
 
@@ -278,56 +278,95 @@ public:
 };
 
 class DataList {
-  class NodeBase {
-  protected:
-    NodeBase      *next;
+  /* Keyed data is kept in a heap array of slots that is sized to the number of keys, so an empty
+   * DataList only takes a pointer. Small trivially copyable values are stored inside the slot, other
+   * values are boxed on the heap, so slots can be relocated with memcpy. The destroy function of a slot
+   * invokes DataKey::destroy and releases the value, it is always called on a slot copy that has been
+   * removed from the array already, so DataKey::destroy hooks can safely reenter the DataList.
+   */
+  struct Slot {
     DataKey<void> *key;
-    explicit       NodeBase (DataKey<void> *k) : next (NULL), key (k) {}
-    virtual       ~NodeBase ();
-    friend         class DataList;
+    void         (*destroy) (Slot &slot);
+    union {
+      uint64       word;
+      void        *box;
+    };
   };
   template<typename T>
-  class Node : public NodeBase {
-    T data;
-  public:
-    T        get_data ()     { return data; }
-    T        swap     (T d)  { T result = data; data = d; return result; }
-    virtual ~Node()
+  struct SlotValue {
+    static constexpr bool INLINE = std::is_trivially_copyable<T>::value && sizeof (T) <= sizeof (Slot::word) &&
+                                   alignof (T) <= alignof (uint64);
+    static T*       ptr       (Slot &s)         { return INLINE ? reinterpret_cast<T*> (&s.word) : static_cast<T*> (s.box); }
+    static const T* ptr       (const Slot &s)   { return INLINE ? reinterpret_cast<const T*> (&s.word) : static_cast<const T*> (s.box); }
+    static void
+    construct (Slot &s, T &&d)
+    {
+      if (INLINE)
+        new (&s.word) T (std::move (d));
+      else
+        s.box = new T (std::move (d));
+      s.destroy = destroy;
+    }
+    static T
+    take (Slot &s)
     {
-      if (key)
-        {
-          DataKey<T> *dkey = reinterpret_cast<DataKey<T>*> (key);
-          dkey->destroy (data);
-        }
+      T *p = ptr (s);
+      T d (std::move (*p));
+      if (INLINE)
+        p->~T();
+      else
+        delete p;
+      return d;
     }
-    explicit Node (DataKey<T> *k,
-                   T           d) :
-      NodeBase (reinterpret_cast<DataKey<void>*> (k)),
-      data (d)
-    {}
+    static void
+    destroy (Slot &s)
+    {
+      DataKey<T> *dkey = reinterpret_cast<DataKey<T>*> (s.key);
+      T d = take (s);
+      dkey->destroy (d);
+    }
+  };
+  struct Slots {                        // heap block header, followed by the slots
+    size_t n_slots;
+    Slot*  begin ()                     { return reinterpret_cast<Slot*> (this + 1); }
+    Slot*  end   ()                     { return begin() + n_slots; }
   };
-  NodeBase *nodes;
+  Slots    *slots_;                     // NULL if empty
   RAPICORN_CLASS_NON_COPYABLE (DataList);
+  Slot*
+  lookup (DataKey<void> *key) const
+  {
+    if (slots_)
+      for (Slot *s = slots_->begin(), *const end = slots_->end(); s < end; s++)
+        if (s->key == key)
+          return s;
+    return NULL;
+  }
+  template<typename T> static DataKey<void>* vkey (DataKey<T> *key) { return reinterpret_cast<DataKey<void>*> (key); }
+  bool      rip    (DataKey<void> *key, Slot &slot);
+  void      append (const Slot &slot);
+  void      resize (size_t n_slots);
 public:
   DataList() :
-    nodes (NULL)
+    slots_ (NULL)
   {}
   template<typename T> void
   set (DataKey<T> *key,
        T           data)
   {
-    Node<T> *node = new Node<T> (key, data);
-    set_data (node);
+    Slot slot;
+    if (rip (vkey (key), slot))
+      slot.destroy (slot);
+    slot.key = vkey (key);
+    SlotValue<T>::construct (slot, std::move (data));
+    append (slot);
   }
   template<typename T> T
   get (DataKey<T> *key) const
   {
-    NodeBase *nb = get_data (reinterpret_cast<DataKey<void>*> (key));
-    if (nb)
-      {
-        Node<T> *node = reinterpret_cast<Node<T>*> (nb);
-        return node->get_data();
-      }
+    const Slot *slot = lookup (vkey (key));
+    if (slot)
+      return *SlotValue<T>::ptr (*slot);
     else
       return key->fallback();
   }
@@ -335,46 +374,38 @@ public:
   swap (DataKey<T> *key,
         T           data)
   {
-    NodeBase *nb = get_data (reinterpret_cast<DataKey<void>*> (key));
-    if (nb)
+    Slot *slot = lookup (vkey (key));
+    if (slot)
       {
-        Node<T> *node = reinterpret_cast<Node<T>*> (nb);
-        return node->swap (data);
+        T *p = SlotValue<T>::ptr (*slot);
+        T result (std::move (*p));
+        *p = std::move (data);
+        return result;
       }
     else
       {
-        set (key, data);
+        set (key, std::move (data));
         return key->fallback();
       }
   }
   template<typename T> T
   swap (DataKey<T> *key)
   {
-    NodeBase *nb = rip_data (reinterpret_cast<DataKey<void>*> (key));
-    if (nb)
-      {
-        Node<T> *node = reinterpret_cast<Node<T>*> (nb);
-        T d = node->get_data();
-        nb->key = NULL; // rip key to prevent data destruction
-        delete nb;
-        return d;
-      }
+    Slot slot;
+    if (rip (vkey (key), slot))
+      return SlotValue<T>::take (slot); // skips DataKey::destroy
     else
       return key->fallback();
   }
   template<typename T> void
   del (DataKey<T> *key)
   {
-    NodeBase *nb = rip_data (reinterpret_cast<DataKey<void>*> (key));
-    if (nb)
-      delete nb;
+    Slot slot;
+    if (rip (vkey (key), slot))
+      slot.destroy (slot);
   }
   void clear_like_destructor();
   ~DataList();
-private:
-  void      set_data (NodeBase      *node);
-  NodeBase* get_data (DataKey<void> *key) const;
-  NodeBase* rip_data (DataKey<void> *key);
 };
 
 /** DataListContainer - typesafe storage and retrieval of arbitrary members.
@@ -3,68 +3,15 @@
 #include "strings.hh"
 #include <string.h>
 #include <algorithm>
+#include <unordered_map>
 
 namespace Rapicorn {
 
-XmlNode::XmlNode (const String &element_name,
-                  uint          line,
-                  uint          _char,
-                  const String &file) :
-  name_ (element_name),
-  parent_ (NULL), file_ (file),
-  line_ (line), char_ (_char)
+XmlNode::XmlNode ()
 {}
 
 XmlNode::~XmlNode ()
-{
-  /* since parents own a reference on their children, parent_ must be NULL */
-  assert (parent_ == NULL);
-}
-
-void
-XmlNode::rename (XmlNodeP self, const String &newname)
-{
-  if (self.get() == this)
-    name_ = newname;
-}
-
-static inline vector<String>::const_iterator
-find_attribute (const vector<String> &attribute_names,
-                const String         &name,
-                bool                  case_insensitive)
-{
-  if (case_insensitive)
-    {
-      const char *cname = name.c_str();
-      for (vector<String>::const_iterator it = attribute_names.begin(); it != attribute_names.end(); it++)
-        if (strcasecmp (cname, it->c_str()) == 0)
-          return it;
-      return attribute_names.end();
-    }
-  else
-    return find (attribute_names.begin(), attribute_names.end(), name);
-}
-
-bool
-XmlNode::set_attribute (const String &name,
-                        const String &value,
-                        bool          replace)
-{
-  vector<String>::const_iterator it = find_attribute (attribute_names_, name, false);
-  if (it == attribute_names_.end())
-    {
-      attribute_names_.push_back (name);
-      attribute_values_.push_back (value);
-      return true;
-    }
-  else if (replace)
-    {
-      attribute_values_[it - attribute_names_.begin()] = value;
-      return true;
-    }
-  else
-    return false;
-}
+{}
 
 String
 XmlNode::get_attribute (const String &name,
@@ -75,57 +22,23 @@ XmlNode::get_attribute (const String &name,
   return value;
 }
 
-bool
-XmlNode::has_attribute (const String &name,
-                        bool          case_insensitive,
-                        String       *valuep) const
-{
-  vector<String>::const_iterator it = find_attribute (attribute_names_, name, case_insensitive);
-  const bool has_attr = it != attribute_names_.end();
-  if (has_attr && valuep)
-    *valuep = attribute_values_[it - attribute_names_.begin()];
-  return has_attr;
-}
-
-bool
-XmlNode::del_attribute (const String &name)
-{
-  vector<String>::const_iterator c_it = find_attribute (attribute_names_, name, false);
-  if (c_it == attribute_names_.end())
-    return false;
-  const size_t nth = c_it - attribute_names_.begin();
-  attribute_names_.erase (attribute_names_.begin() + nth);
-  attribute_values_.erase (attribute_values_.begin() + nth);
-  return true;
-}
-
-void
-XmlNode::set_parent (XmlNode *c,
-                     XmlNode *p)
-{
-  c->parent_ = p;
-}
-
 XmlNodeP
 XmlNode::find_child (const std::string &name) const
 {
-  ConstNodes *node_children = &children();
-  if (node_children)
-    for (auto &xchild : *node_children)
-      if (xchild->name() == name)
-        return xchild;
+  for (auto xchild : children())
+    if (xchild->name() == name)
+      return xchild;
   return XmlNodeP();
 }
 
 void
 XmlNode::steal_children (XmlNode &parent)
 {
-  ConstNodes cl = parent.children();
   vector<XmlNodeP> temp;
-  for (auto c : cl)
+  for (auto c : parent.children())
     temp.push_back (c);
-  for (size_t i = cl.size(); i > 0; i++)
-    parent.del_child (*cl[i-1]);
+  for (size_t i = temp.size(); i > 0; i--)
+    parent.del_child (*temp[i-1]);
   for (auto c : temp)
     add_child (*c);
 }
@@ -135,14 +48,115 @@ XmlNode::steal_children (XmlNode &parent)
 namespace { // Anon
 using namespace Rapicorn;
 
-class XmlNodeText : public virtual XmlNode {
+static inline vector<String>::const_iterator
+find_attribute (const vector<String> &attribute_names,
+                const String         &name,
+                bool                  case_insensitive)
+{
+  if (case_insensitive)
+    {
+      const char *cname = name.c_str();
+      for (vector<String>::const_iterator it = attribute_names.begin(); it != attribute_names.end(); it++)
+        if (strcasecmp (cname, it->c_str()) == 0)
+          return it;
+      return attribute_names.end();
+    }
+  else
+    return find (attribute_names.begin(), attribute_names.end(), name);
+}
+
+// == XmlNodeData ==
+/// Modifiable node, created via XmlNode::create_parent() or XmlNode::create_text().
+class XmlNodeData : public virtual XmlNode {
+  String                name_; // element name
+  XmlNode              *parent_;
+  StringVector          attribute_names_;
+  StringVector          attribute_values_;
+  String                file_;
+  uint                  line_, char_;
+protected:
+  explicit
+  XmlNodeData (const String &element_name, uint line, uint _char, const String &file) :
+    name_ (element_name), parent_ (NULL), file_ (file), line_ (line), char_ (_char)
+  {}
+  virtual
+  ~XmlNodeData ()
+  {
+    /* since parents own a reference on their children, parent_ must be NULL */
+    assert (parent_ == NULL);
+  }
+  static void
+  set_parent (XmlNodeData *c, XmlNode *p)
+  {
+    c->parent_ = p;
+  }
+  virtual XmlNodeP
+  node_handle () const
+  {
+    return const_cast<XmlNodeData*> (this)->VirtualEnableSharedFromThis<XmlNode>::shared_from_this();
+  }
+public:
+  virtual String        name            () const        { return name_; }
+  virtual XmlNode*      parent          () const        { return parent_; }
+  virtual StringVector  list_attributes () const        { return attribute_names_; }
+  virtual StringVector  list_values     () const        { return attribute_values_; }
+  virtual String        parsed_file     () const        { return file_; }
+  virtual uint          parsed_line     () const        { return line_; }
+  virtual uint          parsed_char     () const        { return char_; }
+  virtual void
+  rename (XmlNodeP self, const String &newname)
+  {
+    if (self.get() == this)
+      name_ = newname;
+  }
+  virtual bool
+  set_attribute (const String &name, const String &value, bool replace)
+  {
+    vector<String>::const_iterator it = find_attribute (attribute_names_, name, false);
+    if (it == attribute_names_.end())
+      {
+        attribute_names_.push_back (name);
+        attribute_values_.push_back (value);
+        return true;
+      }
+    else if (replace)
+      {
+        attribute_values_[it - attribute_names_.begin()] = value;
+        return true;
+      }
+    else
+      return false;
+  }
+  virtual bool
+  has_attribute (const String &name, bool case_insensitive, String *valuep) const
+  {
+    vector<String>::const_iterator it = find_attribute (attribute_names_, name, case_insensitive);
+    const bool has_attr = it != attribute_names_.end();
+    if (has_attr && valuep)
+      *valuep = attribute_values_[it - attribute_names_.begin()];
+    return has_attr;
+  }
+  virtual bool
+  del_attribute (const String &name)
+  {
+    vector<String>::const_iterator c_it = find_attribute (attribute_names_, name, false);
+    if (c_it == attribute_names_.end())
+      return false;
+    const size_t nth = c_it - attribute_names_.begin();
+    attribute_names_.erase (attribute_names_.begin() + nth);
+    attribute_values_.erase (attribute_values_.begin() + nth);
+    return true;
+  }
+};
+
+class XmlNodeText : public virtual XmlNodeData {
   friend class FriendAllocator<XmlNodeText>;
   String                text_;
   // XmlNodeText
   virtual String        text            () const         { return text_; }
   virtual bool          istext          () const         { return true; }
   // XmlNodeParent
-  virtual ConstNodes&   children        () const         { return *(ConstNodes*) NULL; }
+  virtual ConstNodes    children        () const         { return XmlNodeList(); }
   virtual bool          add_child       (XmlNode &child) { return false; }
   virtual bool          del_child       (XmlNode &child) { return false; }
 public:
@@ -150,11 +164,11 @@ public:
                uint          line,
                uint          _char,
                const String &file) :
-    XmlNode ("", line, _char, file), text_ (utf8text)
+    XmlNodeData ("", line, _char, file), text_ (utf8text)
   {}
 };
 
-class XmlNodeParent : public virtual XmlNode {
+class XmlNodeParent : public virtual XmlNodeData {
   friend class FriendAllocator<XmlNodeParent>;
   vector<XmlNodeP>      children_;
   // XmlNodeText
@@ -172,13 +186,15 @@ class XmlNodeParent : public virtual XmlNode {
     return false;
   }
   /* XmlNodeParent */
-  virtual ConstNodes&   children        () const        { return children_; }
+  virtual ConstNodes    children        () const        { return children_; }
   virtual bool
-  add_child (XmlNode &child)
+  add_child (XmlNode &node)
   {
-    assert_return (child.parent() == NULL, false);
-    children_.push_back (shared_ptr_cast<XmlNode> (&child));
-    set_parent (&child, this);
+    XmlNodeData *child = dynamic_cast<XmlNodeData*> (&node);
+    assert_return (child != NULL, false); // parsed nodes cannot be re-parented
+    assert_return (child->parent() == NULL, false);
+    children_.push_back (shared_ptr_cast<XmlNode> (child));
+    set_parent (child, this);
     return true;
   }
   virtual bool
@@ -193,7 +209,7 @@ class XmlNodeParent : public virtual XmlNode {
           assert (&child == &**it);
           children_.erase (it);
           assert (child.parent() == this);
-          set_parent (&child, NULL);
+          set_parent (dynamic_cast<XmlNodeData*> (&child), NULL);
           return true;
         }
     return false;
@@ -208,15 +224,170 @@ public:
                  uint          line,
                  uint          _char,
                  const String &file) :
-    XmlNode (element_name, line, _char, file)
+    XmlNodeData (element_name, line, _char, file)
+  {}
+};
+
+// == XmlDom ==
+class XmlDomNode;
+
+/// Arena holding all nodes, names and strings of a parsed document.
+class XmlDom : public std::enable_shared_from_this<XmlDom> {
+public:
+  enum : uint { NONE = ~0U };
+  struct Attribute { uint key, value_offset, value_length; };
+  const String          file_;          // source file name, shared by all nodes
+  vector<String>        atoms_;         // interned element names and attribute keys
+  std::unordered_map<String,uint> atom_ids_;
+  String                chars_;         // text contents and attribute values
+  vector<Attribute>     attributes_;    // attributes of all nodes, contiguous per node
+  std::unique_ptr<XmlDomNode[]> nodes_; // all nodes in document order
+  vector<XmlNode*>      children_;      // child lists of all nodes, contiguous per node
+  explicit              XmlDom          (const String &file) : file_ (file) {}
+  uint
+  intern (const String &string)
+  {
+    auto it = atom_ids_.find (string);
+    if (it != atom_ids_.end())
+      return it->second;
+    const uint id = atoms_.size();
+    atoms_.push_back (string);
+    atom_ids_[string] = id;
+    return id;
+  }
+  uint
+  lookup (const String &string) const
+  {
+    auto it = atom_ids_.find (string);
+    return it != atom_ids_.end() ? it->second : uint (NONE);
+  }
+  uint
+  add_chars (const String &string)
+  {
+    const uint offset = chars_.size();
+    chars_.append (string);
+    return offset;
+  }
+  String
+  chars (uint offset, uint length) const
+  {
+    return chars_.substr (offset, length);
+  }
+};
+typedef std::shared_ptr<XmlDom> XmlDomP;
+
+/// Read-only node of a parsed document, handles to it share ownership of the entire XmlDom.
+class XmlDomNode : public virtual XmlNode {
+  friend class          XmlNodeParser;
+  const XmlDom         *dom_;
+  uint                  name_, parent_;                 // text nodes have no name
+  uint                  first_attribute_, n_attributes_;
+  uint                  first_child_, n_children_;
+  uint                  text_offset_, text_length_;
+  uint                  line_, char_;
+  const XmlDom::Attribute*
+  find_attribute (const String &name, bool case_insensitive) const
+  {
+    const XmlDom::Attribute *attributes = dom_->attributes_.data() + first_attribute_;
+    if (case_insensitive)
+      {
+        for (size_t i = 0; i < n_attributes_; i++)
+          if (strcasecmp (name.c_str(), dom_->atoms_[attributes[i].key].c_str()) == 0)
+            return &attributes[i];
+        return NULL;
+      }
+    const uint key = dom_->lookup (name);
+    if (key != XmlDom::NONE)
+      for (size_t i = 0; i < n_attributes_; i++)
+        if (attributes[i].key == key)
+          return &attributes[i];
+    return NULL;
+  }
+  bool
+  read_only (const char *method) const
+  {
+    critical ("%s:%d: XmlNode::%s: parsed nodes are read-only", dom_->file_, line_, method);
+    return false;
+  }
+protected:
+  virtual XmlNodeP
+  node_handle () const
+  {
+    return XmlNodeP (std::const_pointer_cast<XmlDom> (dom_->shared_from_this()), const_cast<XmlDomNode*> (this));
+  }
+public:
+  explicit
+  XmlDomNode () :
+    dom_ (NULL), name_ (XmlDom::NONE), parent_ (XmlDom::NONE), first_attribute_ (0), n_attributes_ (0),
+    first_child_ (0), n_children_ (0), text_offset_ (0), text_length_ (0), line_ (0), char_ (0)
   {}
+  virtual String        name            () const        { return istext() ? "" : dom_->atoms_[name_]; }
+  virtual String        parsed_file     () const        { return dom_->file_; }
+  virtual uint          parsed_line     () const        { return line_; }
+  virtual uint          parsed_char     () const        { return char_; }
+  virtual bool          istext          () const        { return name_ == XmlDom::NONE; }
+  virtual XmlNode*
+  parent () const
+  {
+    return parent_ == XmlDom::NONE ? NULL : &dom_->nodes_[parent_];
+  }
+  virtual StringVector
+  list_attributes () const
+  {
+    StringVector names;
+    for (size_t i = 0; i < n_attributes_; i++)
+      names.push_back (dom_->atoms_[dom_->attributes_[first_attribute_ + i].key]);
+    return names;
+  }
+  virtual StringVector
+  list_values () const
+  {
+    StringVector values;
+    for (size_t i = 0; i < n_attributes_; i++)
+      {
+        const XmlDom::Attribute &attribute = dom_->attributes_[first_attribute_ + i];
+        values.push_back (dom_->chars (attribute.value_offset, attribute.value_length));
+      }
+    return values;
+  }
+  virtual bool
+  has_attribute (const String &name, bool case_insensitive, String *valuep) const
+  {
+    const XmlDom::Attribute *attribute = find_attribute (name, case_insensitive);
+    if (attribute && valuep)
+      *valuep = dom_->chars (attribute->value_offset, attribute->value_length);
+    return attribute != NULL;
+  }
+  virtual String
+  text () const
+  {
+    if (istext())
+      return dom_->chars (text_offset_, text_length_);
+    String result;
+    for (size_t i = 0; i < n_children_; i++)
+      result.append (dom_->children_[first_child_ + i]->text());
+    return result;
+  }
+  virtual ConstNodes
+  children () const
+  {
+    return XmlNodeList (dom_->children_.data() + first_child_, n_children_);
+  }
+  virtual void          rename          (XmlNodeP, const String&)               { read_only ("rename"); }
+  virtual bool          set_attribute   (const String&, const String&, bool)    { return read_only ("set_attribute"); }
+  virtual bool          del_attribute   (const String&)                         { return read_only ("del_attribute"); }
+  virtual bool          add_child       (XmlNode&)                              { return read_only ("add_child"); }
+  virtual bool          del_child       (XmlNode&)                              { return read_only ("del_child"); }
 };
 
 class XmlNodeParser : public Rapicorn::MarkupParser {
-  vector<XmlNodeP> node_stack_;
-  XmlNodeP         first_;
+  struct Record { uint name, parent, first_attribute, n_attributes, text_offset, text_length, line, chr; };
+  XmlDomP          dom_;
+  vector<Record>   records_;
+  vector<uint>     node_stack_;
+  uint             first_;
   XmlNodeParser (const String &input_name) :
-    MarkupParser (input_name), first_ (NULL)
+    MarkupParser (input_name), dom_ (std::make_shared<XmlDom> (input_name)), first_ (XmlDom::NONE)
   {}
   virtual
   ~XmlNodeParser()
@@ -227,27 +398,38 @@ class XmlNodeParser : public Rapicorn::MarkupParser {
                  ConstStrings  &attribute_values,
                  Error         &error)
   {
-    XmlNodeP current = node_stack_.size() ? node_stack_[node_stack_.size() - 1] : NULL;
+    const uint current = node_stack_.size() ? node_stack_[node_stack_.size() - 1] : XmlDom::NONE;
     if (element_name.size() < 1 || !element_name[0]) /* paranoid checks */
       error.set (INVALID_ELEMENT, String() + "invalid element name: <" + escape_text (element_name) + "/>");
     int xline, xchar;
     get_position (&xline, &xchar);
-    XmlNodeP xnode = XmlNode::create_parent (element_name, xline, xchar, input_name());
+    Record record = { dom_->intern (element_name), current, uint (dom_->attributes_.size()), 0, 0, 0, uint (xline), uint (xchar) };
     for (uint i = 0; i < attribute_names.size(); i++)
-      xnode->set_attribute (attribute_names[i], attribute_values[i]);
-    if (current)
-      current->add_child (*xnode);
-    else
       {
-        if (first_)
+        const XmlDom::Attribute attribute = { dom_->intern (attribute_names[i]), dom_->add_chars (attribute_values[i]),
+                                              uint (attribute_values[i].size()) };
+        size_t j;
+        for (j = record.first_attribute; j < dom_->attributes_.size(); j++)
+          if (dom_->attributes_[j].key == attribute.key)
+            break;
+        if (j < dom_->attributes_.size())
+          dom_->attributes_[j] = attribute;     // last value wins, like set_attribute()
+        else
           {
-            error.set (INVALID_ELEMENT, String() + "multiple toplevel elements: "
-                       "<" + escape_text (first_->name()) + "/> <" + escape_text (element_name) + "/>");
-            first_ = NULL;
+            dom_->attributes_.push_back (attribute);
+            record.n_attributes++;
           }
-        first_ = xnode;
       }
-    node_stack_.push_back (xnode);
+    const uint index = records_.size();
+    records_.push_back (record);
+    if (current == XmlDom::NONE)
+      {
+        if (first_ != XmlDom::NONE)
+          error.set (INVALID_ELEMENT, String() + "multiple toplevel elements: "
+                     "<" + escape_text (dom_->atoms_[records_[first_].name]) + "/> <" + escape_text (element_name) + "/>");
+        first_ = index;
+      }
+    node_stack_.push_back (index);
   }
   virtual void
   end_element (const String  &element_name,
@@ -259,14 +441,54 @@ class XmlNodeParser : public Rapicorn::MarkupParser {
   text (const String  &text,
         Error         &error)
   {
-    XmlNodeP current = node_stack_.size() ? node_stack_[node_stack_.size() - 1] : NULL;
+    const uint current = node_stack_.size() ? node_stack_[node_stack_.size() - 1] : XmlDom::NONE;
     int xline, xchar;
     get_position (&xline, &xchar);
-    XmlNodeP xnode = XmlNode::create_text (text, xline, xchar, input_name());
-    if (current)
-      current->add_child (*xnode);
-    else
-      first_ = xnode;
+    const Record record = { XmlDom::NONE, current, 0, 0, dom_->add_chars (text), uint (text.size()), uint (xline), uint (xchar) };
+    const uint index = records_.size();
+    records_.push_back (record);
+    if (current == XmlDom::NONE)
+      first_ = index;
+  }
+  XmlNodeP
+  build_dom ()
+  {
+    if (first_ == XmlDom::NONE)
+      return NULL;
+    // allocate all nodes at once, then hand out contiguous child list slices per parent
+    const size_t n_nodes = records_.size();
+    dom_->nodes_.reset (new XmlDomNode[n_nodes]);
+    XmlDomNode *nodes = dom_->nodes_.get();
+    for (const Record &record : records_)
+      if (record.parent != XmlDom::NONE)
+        nodes[record.parent].n_children_++;
+    uint n_children = 0;
+    for (size_t i = 0; i < n_nodes; i++)
+      {
+        nodes[i].first_child_ = n_children;
+        n_children += nodes[i].n_children_;
+      }
+    dom_->children_.resize (n_children);
+    vector<uint> filled (n_nodes, 0);
+    for (size_t i = 0; i < n_nodes; i++)
+      {
+        const Record &record = records_[i];
+        XmlDomNode &node = nodes[i];
+        node.dom_ = dom_.get();
+        node.name_ = record.name;
+        node.parent_ = record.parent;
+        node.first_attribute_ = record.first_attribute;
+        node.n_attributes_ = record.n_attributes;
+        node.text_offset_ = record.text_offset;
+        node.text_length_ = record.text_length;
+        node.line_ = record.line;
+        node.char_ = record.chr;
+        if (record.parent != XmlDom::NONE)
+          dom_->children_[nodes[record.parent].first_child_ + filled[record.parent]++] = &node;
+      }
+    dom_->chars_.shrink_to_fit();
+    dom_->attributes_.shrink_to_fit();
+    return nodes[first_].shared_from_this();
   }
 public:
   static XmlNodeP
@@ -286,9 +508,7 @@ public:
       xnp.parse (String (String ("</") + pseudoroot + ">").c_str(), -1, &error);
     if (!error.code)
       xnp.end_parse (&error);
-    if (!error.code)
-      {}
-    return xnp.first_;
+    return xnp.build_dom();
   }
 };
 
@@ -10,45 +10,78 @@ class XmlNode;
 typedef std::shared_ptr<XmlNode> XmlNodeP;
 typedef std::weak_ptr  <XmlNode> XmlNodeW;
 
+/// Read-only sequence of XmlNode children, yielding XmlNodeP handles.
+class XmlNodeList {
+  const XmlNodeP       *handles_;       // children of modifiable nodes
+  XmlNode *const       *nodes_;         // children of parsed, arena allocated nodes
+  size_t                size_;
+public:
+  class const_iterator {
+    const XmlNodeP     *handles_;
+    XmlNode *const     *nodes_;
+    size_t              index_;
+  public:
+    typedef std::forward_iterator_tag   iterator_category;
+    typedef XmlNodeP                    value_type;
+    typedef ptrdiff_t                   difference_type;
+    typedef const XmlNodeP*             pointer;
+    typedef XmlNodeP                    reference;
+    explicit            const_iterator  (const XmlNodeP *h, XmlNode *const *n, size_t i) : handles_ (h), nodes_ (n), index_ (i) {}
+    XmlNodeP            operator*       () const;
+    XmlNodeP            operator->      () const        { return operator*(); }
+    const_iterator&     operator++      ()              { index_++; return *this; }
+    const_iterator      operator++      (int)           { const_iterator it = *this; index_++; return it; }
+    bool                operator==      (const const_iterator &o) const { return index_ == o.index_ && handles_ == o.handles_ && nodes_ == o.nodes_; }
+    bool                operator!=      (const const_iterator &o) const { return !operator== (o); }
+  };
+  explicit              XmlNodeList     () : handles_ (NULL), nodes_ (NULL), size_ (0) {}
+  /*implicit*/          XmlNodeList     (const vector<XmlNodeP> &handles) : handles_ (handles.data()), nodes_ (NULL), size_ (handles.size()) {}
+  explicit              XmlNodeList     (XmlNode *const *nodes, size_t n) : handles_ (NULL), nodes_ (nodes), size_ (n) {}
+  size_t                size            () const        { return size_; }
+  bool                  empty           () const        { return size_ == 0; }
+  XmlNodeP              operator[]      (size_t i) const;
+  const_iterator        begin           () const        { return const_iterator (handles_, nodes_, 0); }
+  const_iterator        end             () const        { return const_iterator (handles_, nodes_, size_); }
+};
+
 /** Simple XML tree representation.
+ * Trees returned from parse_xml() are read-only and allocated in a single arena per document,
+ * element names and attribute keys are interned and all nodes share the source file name.
+ * Nodes created via create_parent() or create_text() can be modified.
  * @DISCOURAGED: Nonpublic API, data structure used internally.
  */
 class XmlNode : public virtual DataListContainer, public virtual VirtualEnableSharedFromThis<XmlNode> {
-  String                name_; // element name
-  XmlNode              *parent_;
-  StringVector          attribute_names_;
-  StringVector          attribute_values_;
-  String                file_;
-  uint                  line_, char_;
 protected:
-  explicit              XmlNode         (const String&, uint, uint, const String&);
+  explicit              XmlNode         ();
   virtual              ~XmlNode         ();
-  static void           set_parent      (XmlNode *c, XmlNode *p);
+  virtual XmlNodeP      node_handle     () const = 0;
 public:
-  typedef const vector<XmlNodeP>     ConstNodes;
+  typedef const XmlNodeList          ConstNodes;
   typedef ConstNodes::const_iterator ConstChildIter;
-  String                name            () const                { return name_; }
-  XmlNode*              parent          () const                { return parent_; }
-  const StringVector&   list_attributes () const                { return attribute_names_; }
-  const StringVector&   list_values     () const                { return attribute_values_; }
-  void                  rename          (XmlNodeP self, const String &newname);
-  bool                  set_attribute   (const String   &name,
+  XmlNodeP                       shared_from_this ()       { return node_handle(); }
+  std::shared_ptr<const XmlNode> shared_from_this () const { return node_handle(); }
+  virtual String        name            () const = 0;
+  virtual XmlNode*      parent          () const = 0;
+  virtual StringVector  list_attributes () const = 0;
+  virtual StringVector  list_values     () const = 0;
+  virtual void          rename          (XmlNodeP self, const String &newname) = 0;
+  virtual bool          set_attribute   (const String   &name,
                                          const String   &value,
-                                         bool            replace = true);
+                                         bool            replace = true) = 0;
   String                get_attribute   (const String   &name,
                                          bool            case_insensitive = false) const;
-  bool                  has_attribute   (const String   &name,
+  virtual bool          has_attribute   (const String   &name,
                                          bool            case_insensitive = false,
-                                         String         *valuep = NULL) const;
-  bool                  del_attribute   (const String   &name);
-  String                parsed_file     () const                { return file_; }
-  uint                  parsed_line     () const                { return line_; }
-  uint                  parsed_char     () const                { return char_; }
+                                         String         *valuep = NULL) const = 0;
+  virtual bool          del_attribute   (const String   &name) = 0;
+  virtual String        parsed_file     () const = 0;
+  virtual uint          parsed_line     () const = 0;
+  virtual uint          parsed_char     () const = 0;
   // Text Nodes
   virtual String        text            () const = 0;
   virtual bool          istext          () const = 0;
   // Container Nodes
-  virtual ConstNodes&   children        () const = 0;
+  virtual ConstNodes    children        () const = 0;
   ConstChildIter        children_begin  () const { return children().begin(); }
   ConstChildIter        children_end    () const { return children().end(); }
   XmlNodeP              find_child      (const String   &name) const;
@@ -79,6 +112,19 @@ public:
   static String         strip_xml_tags  (const String   &input);
 };
 
+// == Implementation Details ==
+inline XmlNodeP
+XmlNodeList::const_iterator::operator* () const
+{
+  return handles_ ? handles_[index_] : nodes_[index_]->shared_from_this();
+}
+
+inline XmlNodeP
+XmlNodeList::operator[] (size_t i) const
+{
+  return handles_ ? handles_[i] : nodes_[i]->shared_from_this();
+}
+
 } // Rapicorn
 
 #endif  /* __RAPICORN_XMLNODE_HH__ */
@@ -201,6 +201,35 @@ test_any()
       TASSERT (dup.get<TestEnum>() == TEST_COFFEE_COFFEE);
       printf ("  TEST   Aida basic functions                                            OK\n");
     }
+  if (true) // value semantics of shared and inline storage
+    {
+      struct Big { int64 a, b, c, d; bool operator== (const Big &o) const { return a == o.a && d == o.d; } };
+      Any big (Big { 1, 2, 3, 4 }), big2 = big;     // too large for inline storage
+      TASSERT (big == big2 && big2.get<Big>().d == 4);
+      Any f (Foo { 1 });
+      f.swap (big2);
+      TASSERT (f.get<Big>().d == 4 && big2.get<Foo>().i == 1);
+      Any s1 ("a string that exceeds the small string buffer"), s2 = s1;
+      TASSERT (s1 == s2);
+      s1.set ("other");
+      TASSERT (s1 != s2 && s2.get<String>() == "a string that exceeds the small string buffer");
+      s2.set (s2.get<String>());
+      TASSERT (s2.get<String>() == "a string that exceeds the small string buffer");
+      Any::AnyVector av;
+      av.push_back (Any ("seq"));
+      av.push_back (Any (Foo { 2 }));
+      Any seq1 (av), seq2 = seq1;
+      TASSERT (seq1 == seq2 && seq2.get<Any::AnyVector>().size() == 2);
+      seq1.set (Any::AnyVector());
+      TASSERT (seq1 != seq2 && seq1.get<Any::AnyVector>().empty());
+      TASSERT (seq2.get<Any::AnyVector>()[1].get<Foo>().i == 2);
+      Any::FieldVector fv;
+      fv.push_back (Any::Field ("seq", seq2));
+      Any rec1 (fv), rec2 = rec1;
+      rec1.clear();
+      TASSERT (rec2.get<Any::FieldVector>()[0].get<Any::AnyVector>()[0].get<String>() == "seq");
+      printf ("  TEST   Aida copy-on-write and inline values                            OK\n");
+    }
   String s;
   const size_t cases = ANY_TEST_COUNT;
   for (size_t j = 0; j <= cases; j++)
@@ -120,4 +120,83 @@ data_list_test ()
 }
 REGISTER_OUTPUT_TEST ("DataList Tests", data_list_test);
 
+static int counted_key_destructions = 0;
+
+template<typename T>
+class CountedKey : public DataKey<T> {
+  virtual void destroy (T data) override { counted_key_destructions++; }
+};
+
+struct ChainedKey : public DataKey<int> {
+  DataListContainer *container;
+  DataKey<int>      *next_key;
+  virtual void
+  destroy (int data) override
+  {
+    counted_key_destructions++;
+    if (next_key) // reenter container from destroy hook
+      container->set_data (next_key, data + 1);
+  }
+};
+
+static void
+data_list_slots_test ()
+{
+  // an empty DataList is a single pointer, slots are allocated per key
+  TCMP (sizeof (DataList), ==, sizeof (void*));
+  // mix inline and boxed values across many keys to grow and shrink the slot array
+  static CountedKey<int64> int_keys[16];
+  static CountedKey<String> string_keys[16];
+  static CountedKey<std::shared_ptr<int>> ptr_keys[4];
+  std::shared_ptr<int> shared = std::make_shared<int> (17);
+  counted_key_destructions = 0;
+  {
+    DataListContainer r;
+    for (size_t i = 0; i < 16; i++)
+      {
+        r.set_data (&int_keys[i], int64 (i) << 40);
+        r.set_data (&string_keys[i], string_format ("string-value-%d-exceeding-small-string-capacity", i));
+      }
+    for (size_t i = 0; i < 4; i++)
+      r.set_data (&ptr_keys[i], shared);
+    TCMP (shared.use_count(), ==, 5);
+    for (size_t i = 0; i < 16; i++)
+      {
+        TCMP (r.get_data (&int_keys[i]), ==, int64 (i) << 40);
+        TCMP (r.get_data (&string_keys[i]), ==, string_format ("string-value-%d-exceeding-small-string-capacity", i));
+      }
+    TCMP (counted_key_destructions, ==, 0);
+    for (size_t i = 0; i < 16; i += 2)
+      r.delete_data (&string_keys[i]);
+    TCMP (counted_key_destructions, ==, 8);
+    r.set_data (&int_keys[3], int64 (-3));                      // replacing destroys the old value
+    TCMP (counted_key_destructions, ==, 9);
+    TCMP (r.swap_data (&string_keys[1]), ==, string_format ("string-value-%d-exceeding-small-string-capacity", 1));
+    TCMP (counted_key_destructions, ==, 9);                     // swap_data() skips destroy
+    TCMP (r.get_data (&string_keys[1]), ==, "");
+    TCMP (r.get_data (&int_keys[3]), ==, -3);
+    TCMP (*r.swap_data (&ptr_keys[0], std::shared_ptr<int>()), ==, 17);
+    TCMP (shared.use_count(), ==, 4);
+    for (size_t i = 0; i < 16; i++)
+      TCMP (r.get_data (&int_keys[i]), ==, (i == 3 ? -3 : int64 (i) << 40));
+  }
+  // 16 ints + 7 strings + 4 shared_ptrs destroyed with the container
+  TCMP (counted_key_destructions, ==, 9 + 16 + 7 + 4);
+  TCMP (shared.use_count(), ==, 1);
+  // destroy hooks may add new data while the container is being cleared
+  counted_key_destructions = 0;
+  {
+    DataListContainer r;
+    static ChainedKey chain[3];
+    for (size_t i = 0; i < 3; i++)
+      {
+        chain[i].container = &r;
+        chain[i].next_key = i + 1 < 3 ? &chain[i + 1] : NULL;
+      }
+    r.set_data (&chain[0], 0);
+  }
+  TCMP (counted_key_destructions, ==, 3);
+}
+REGISTER_TEST ("DataList/Slots", data_list_slots_test);
+
 } // anon
@@ -157,6 +157,40 @@ test_regex (void)
 }
 REGISTER_TEST ("General/Regex Tests", test_regex);
 
+static void
+test_regex_pattern (void)
+{
+  String error;
+  Regex::Pattern invalid = Regex::Pattern::compile ("(unclosed", Regex::COMPILE_NORMAL, &error);
+  TCMP (invalid.valid(), ==, false);
+  TCMP (error.empty(), ==, false);
+  TCMP (invalid.match ("(unclosed"), ==, false);
+  Regex::Pattern words = Regex::Pattern::compile ("\\b(\\w)(\\w*)", Regex::OPTIMIZE, &error);
+  TASSERT (words.valid() && error.empty());
+  TCMP (words.pattern(), ==, "\\b(\\w)(\\w*)");
+  TCMP (words.flags(), ==, Regex::OPTIMIZE);
+  TCMP (words.match ("  ..."), ==, false);
+  TCMP (words.match ("quick brown"), ==, true);
+  size_t start = 0, end = 0;
+  TCMP (words.find ("The quick fox", &start, &end, 1), ==, true);
+  TCMP (start, ==, 4u);
+  TCMP (end, ==, 9u);
+  TCMP (words.find ("The quick fox", &start, &end, 13), ==, false);
+  const StringVector all = words.find_all ("The quick, brown fox");
+  TCMP (string_join (",", all), ==, "The,quick,brown,fox");
+  TCMP (words.replace ("quick brown fox", "\\2\\1"), ==, "uickq rownb oxf");
+  // cached patterns are shared and behave like freshly compiled ones
+  Regex::Pattern c1 = Regex::Pattern::cached ("^[a-z]+$", Regex::CASELESS);
+  Regex::Pattern c2 = Regex::Pattern::cached ("^[a-z]+$", Regex::CASELESS);
+  TCMP (c1.match ("Lion"), ==, true);
+  TCMP (c2.match ("Lion7"), ==, false);
+  TCMP (c1.pattern(), ==, c2.pattern());
+  TCMP (Regex::Pattern::cached ("^[a-z]+$").match ("Lion"), ==, false);
+  for (uint i = 0; i < 300; i++) // exceed the cache size
+    TCMP (Regex::match_simple (string_format ("^x%u$", i % 100), string_format ("x%u", i % 100), Regex::COMPILE_NORMAL, Regex::MATCH_NORMAL), ==, true);
+}
+REGISTER_TEST ("General/Regex Pattern", test_regex_pattern);
+
 static void
 test_debug_config ()
 {
@@ -663,6 +697,12 @@ access_text_resources ()
 /// [Blob-EXAMPLE]
 REGISTER_TEST ("Resource/Test Example", access_text_resources);
 
+// rapidres dump of string_multiply ("compressed test resource\n", 64)
+RAPICORN_RES_STATIC_DATA (compressed_test_resource) =
+  "x\332K\316\317-(J-.NMQ(I-.Q\0\262\363K\213\222S\271\222G%F%F%F%F%F%pK\0"
+  "\0U\243i\337"; // 47 + 1
+RAPICORN_RES_STATIC_ENTRY (compressed_test_resource, "testing/compressed-resource.txt", 1600);
+
 static void
 test_builtin_resources()
 {
@@ -672,6 +712,15 @@ test_builtin_resources()
   assert (blob && blob.size() > 0);
   blob = Res ("@res Rapicorn/icons/broken-image.svg");
   assert (blob && blob.size() > 0);
+  blob = Res ("@res Rapicorn/icons/no-such-image.svg");
+  assert (!blob);
+  // compressed resources are shared, not decompressed again
+  blob = Res ("@res testing/compressed-resource.txt");
+  assert (blob && blob.size() == 1600);
+  assert (blob.string() == string_multiply ("compressed test resource\n", 64));
+  assert (blob.data() != __Rapicorn_static_resourceD__compressed_test_resource);
+  Blob again = Res ("@res testing/compressed-resource.txt");
+  assert (again.data() == blob.data());
 }
 REGISTER_TEST ("Resource/Builtin Tests", test_builtin_resources);
 
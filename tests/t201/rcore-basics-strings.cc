@@ -97,6 +97,71 @@ random_utf8_and_unichar_test (ptrdiff_t count)
 REGISTER_TEST ("Strings/random UTF8", random_utf8_and_unichar_test, 30000);
 REGISTER_SLOWTEST ("Strings/random UTF8 (slow)", random_utf8_and_unichar_test, 1000000);
 
+static void
+utf8_validation_tests ()
+{
+  const char *samples[] = {
+    "", "ASCII only, long enough to cover vectorized scanning", "gr\xc3\xbc\xc3\x9f\x65 \xe6\xbc\xa2\xe5\xad\x97 \xf0\x9f\x98\x80",
+    "\xc0\xaf", "\xc1\xbf", "\xe0\x80\xaf", "\xe0\x9f\xbf", "\xf0\x80\x80\xaf", "\xf0\x8f\xbf\xbf", // overlong forms
+    "\xed\xa0\x80", "\xed\xbf\xbf", "\xed\x9f\xbf", "\xee\x80\x80",                                     // surrogates
+    "\xf4\x8f\xbf\xbf", "\xf4\x90\x80\x80", "\xf5\x80\x80\x80", "\xf8\x88\x80\x80\x80", "\xfe", "\xff", // range
+    "0123456789abcdef\x80", "0123456789abcde\xc3", "0123456789abcd\xe6\xbc", "\xe6\xbc\xa2\xe6\xbc",        // truncation
+    "\xef\xbf\xbe", "\xef\xbf\xbf", "\xef\xb7\x90",                                                        // noncharacters
+  };
+  for (size_t i = 0; i < ARRAY_SIZE (samples); i++)
+    for (size_t offset = 0; offset < 20; offset += 19)
+      {
+        const String str = String (offset, 'x') + samples[i] + String (offset, 'y');
+        const char *gp = NULL;
+        const bool gb = g_utf8_validate (str.data(), str.size(), &gp);
+        int indx = 0;
+        const bool bb = utf8_validate (str, &indx);
+        TCMP (bb, ==, gb);
+        if (!bb)
+          TCMP (str.data() + indx, ==, gp);
+      }
+  const String nul ("0123456789abcdef0123\0xyz", 24);
+  int indx = 0;
+  TCMP (utf8_validate (nul, &indx), ==, false);
+  TCMP (indx, ==, 20);
+}
+REGISTER_TEST ("Strings/UTF8 validation", utf8_validation_tests);
+
+static void
+utf8_decoding_test (ptrdiff_t count)
+{
+  for (ptrdiff_t n = 0; n < count; n++)
+    {
+      String str;
+      const size_t nchars = rand() % 97;
+      for (size_t i = 0; i < nchars; i++)
+        {
+          unichar uc = rand() % 4 ? 1 + rand() % 0x7f : 1 + rand() % (0x100 << (i % 13));
+          if (!Unicode::isvalid (uc))
+            uc = 0xfffd;
+          char buffer[8];
+          str.append (buffer, utf8_from_unichar (uc, buffer));
+        }
+      TASSERT (utf8_validate (str));
+      glong gn = 0;
+      gunichar *gucs = g_utf8_to_ucs4_fast (str.c_str(), str.size(), &gn);
+      const vector<unichar> ucs = utf8_to_unicode (str);
+      TCMP (ucs.size(), ==, size_t (gn));
+      TCMP (memcmp (ucs.data(), gucs, ucs.size() * sizeof (unichar)), ==, 0);
+      g_free (gucs);
+    }
+  // malformed bytes decode as 0xffffffff and resynchronize on the next byte
+  const vector<unichar> ucs = utf8_to_unicode ("a\x80\xe6\xbc" "b\xc3");
+  TCMP (ucs.size(), ==, 6u);
+  TCMP (ucs[0], ==, 'a');
+  TCMP (ucs[1], ==, 0xffffffff);
+  TCMP (ucs[2], ==, 0xffffffff);
+  TCMP (ucs[3], ==, 0xffffffff);
+  TCMP (ucs[4], ==, 'b');
+  TCMP (ucs[5], ==, 0xffffffff);
+}
+REGISTER_TEST ("Strings/UTF8 decoding", utf8_decoding_test, 3000);
+
 #define UC_CMP(uc,a,eq,b)       do { if (a != b) printerr ("unichar(0x%08x): ", uc); TCMP (a, eq, b); } while (0)
 
 static void
@@ -198,6 +263,20 @@ random_unichar_test (ptrdiff_t count)
 REGISTER_TEST ("Strings/random unichar", random_unichar_test, 30000);
 REGISTER_SLOWTEST ("Strings/random unichar (slow)", random_unichar_test, 1000000);
 
+static void
+unichar_table_test ()
+{
+  for (unichar uc = 0; uc <= 0x10ffff; uc++)
+    {
+      UC_CMP (uc, Unicode::get_type (uc), ==, (int) g_unichar_type (uc));
+      UC_CMP (uc, Unicode::get_break (uc), ==, (int) g_unichar_break_type (uc));
+      UC_CMP (uc, Unicode::isalpha (uc), ==, bool (g_unichar_isalpha (uc)));
+      UC_CMP (uc, Unicode::isspace (uc), ==, bool (g_unichar_isspace (uc)));
+      UC_CMP (uc, Unicode::iswide (uc), ==, bool (g_unichar_iswide (uc)));
+    }
+}
+REGISTER_SLOWTEST ("Strings/unichar table (slow)", unichar_table_test);
+
 static void
 unichar_noncharacter_tests ()
 {
@@ -557,6 +636,25 @@ test_cxxprintf()
   TCMP (string_format ("| %qd %Zd %LF |", (long long) 1234, size_t (4321), (long double) 1234.), ==, "| 1234 4321 1234.000000 |");
   TCMP (string_format ("- %C - %lc -", long ('X'), long ('x')), ==, "- X - x -");
   // TCMP (string_format ("+ %S +", (wchar_t*) "\1\1\1\1\0\0\0\0"), ==, "+ \1\1\1\1 +");
+  // directly rendered integer conversions
+  TCMP (string_format ("|%5d|%-5d|%05d|%x|%X|%u|", -42, 42, -42, 0xbeefu, 0xbeefu, uint8 (200)), ==, "|  -42|42   |-0042|beef|BEEF|200|");
+  TCMP (string_format ("|%d|%u|%hhd|", int8 (-7), int8 (-7), -7), ==, "|-7|249|-7|");
+  TCMP (string_format ("|%3c|%-3c|%*d|", 'a', 'b', -4, 1), ==, "|  a|b  |   1|");
+  // compile-time parsed literal formats
+  static constexpr auto literal = Lib::StringFormatter::literal ("%2$s: %1$*3$d%%");
+  static_assert (literal.n_args() == 3, "literal format argument count");
+  TCMP (STRING_FORMAT ("%2$s: %1$*3$d%%", 42, "answer", 4), ==, "answer:   42%");
+  TCMP (STRING_FORMAT ("|%5d|%-3c|%.2f|%s|", -42, 'x', 0.125, String ("str")), ==, "|  -42|x  |0.12|str|");
+  TCMP (STRING_FORMAT ("no directives"), ==, "no directives");
+  // string_format_to
+  char buffer[8];
+  TCMP (string_format_to (buffer, sizeof (buffer), "%s-%d", "abc", 42), ==, 6u);
+  TCMP (String (buffer), ==, "abc-42");
+  TCMP (string_format_to (buffer, sizeof (buffer), "%s-%d", "hello", 12345), ==, 11u);
+  TCMP (String (buffer), ==, "hello-1");
+  TCMP (string_format_to (buffer, 0, "%s", "unused"), ==, 6u);
+  TCMP (string_format_to (buffer, sizeof (buffer), "%.2f", 0.125), ==, 4u);
+  TCMP (String (buffer), ==, "0.12");
 }
 REGISTER_TEST ("Strings/CxxPrintf", test_cxxprintf);
 
@@ -936,6 +1034,90 @@ test_shake_hashing()
 }
 REGISTER_TEST ("RandomHash/SHAKE Hashing", test_shake_hashing);
 
+static void
+test_keccak_lanes()
+{
+  // multi-lane permutations must match the scalar permutation, for all SIMD widths and remainders
+  KeccakFastRng rng;
+  for (size_t max_lanes : { 1, 2, 4 })
+    for (size_t n = 1; n <= 9; n++)
+      {
+        std::vector<Lib::KeccakF1600> lanes (n), scalar (n);
+        std::vector<Lib::KeccakF1600*> states;
+        for (size_t i = 0; i < n; i++)
+          {
+            for (size_t j = 0; j < 25; j++)
+              lanes[i][j] = scalar[i][j] = rng();
+            states.push_back (&lanes[i]);
+          }
+        Lib::KeccakF1600::permute_n (states.data(), n, 24, max_lanes);
+        for (size_t i = 0; i < n; i++)
+          {
+            scalar[i].permute (24);
+            for (size_t j = 0; j < 25; j++)
+              TCMP (lanes[i][j], ==, scalar[i][j]);
+          }
+      }
+  // batched digests of the FIPS 202 test inputs, plus inputs around the block sizes
+  std::vector<std::string> inputs = { image_to_bytes ("0F8B2D8FCFD9D68CFFC17CCFB117709B53D26462A3F346FB7C79B85E"),
+                                      image_to_bytes ("DE286BA4206E8B005714F80FB1CDFAEBDE91D29F84603E4A3EBC04686F99A46C9E880B96C574825582E8812A26E5A857FFC6579F63742F"),
+                                      image_to_bytes ("1F877C"), image_to_bytes ("CC"), "" };
+  for (size_t length : { 71, 72, 103, 104, 135, 136, 137, 167, 168, 169, 500 })
+    inputs.push_back (std::string (length, char (length)));
+  std::vector<const void*> data;
+  std::vector<size_t> lengths;
+  for (const auto &input : inputs)
+    {
+      data.push_back (input.data());
+      lengths.push_back (input.size());
+    }
+  const size_t n_inputs = inputs.size();
+  std::vector<uint8_t> digests (n_inputs * 512);
+  uint8_t hashvalue[512];
+  sha3_224_hash_batch (n_inputs, data.data(), lengths.data(), digests.data());
+  TCMP (byte_image (&digests[0 * 28], 28), ==, "1e693b0bce2372550daef35b14f13ab43441ed6742dee3e86fd1d8ef");
+  for (size_t i = 0; i < n_inputs; i++)
+    {
+      sha3_224_hash (data[i], lengths[i], hashvalue);
+      TCMP (byte_image (&digests[i * 28], 28), ==, byte_image (hashvalue, 28));
+    }
+  sha3_256_hash_batch (n_inputs, data.data(), lengths.data(), digests.data());
+  TCMP (byte_image (&digests[1 * 32], 32), ==, "1bc1bcc70f638958db1006af37b02ebd8954ec59b3acbad12eacedbc5b21e908");
+  for (size_t i = 0; i < n_inputs; i++)
+    {
+      sha3_256_hash (data[i], lengths[i], hashvalue);
+      TCMP (byte_image (&digests[i * 32], 32), ==, byte_image (hashvalue, 32));
+    }
+  sha3_384_hash_batch (n_inputs, data.data(), lengths.data(), digests.data());
+  TCMP (byte_image (&digests[2 * 48], 48), ==, "14f6f486fb98ed46a4a198040da8079e79e448daacebe905fb4cf0df86ef2a7151f62fe095bf8516eb0677fe607734e2");
+  for (size_t i = 0; i < n_inputs; i++)
+    {
+      sha3_384_hash (data[i], lengths[i], hashvalue);
+      TCMP (byte_image (&digests[i * 48], 48), ==, byte_image (hashvalue, 48));
+    }
+  sha3_512_hash_batch (n_inputs, data.data(), lengths.data(), digests.data());
+  TCMP (byte_image (&digests[3 * 64], 64), ==, "3939fcc8b57b63612542da31a834e5dcc36e2ee0f652ac72e02624fa2e5adeecc7dd6bb3580224b4d6138706fc6e80597b528051230b00621cc2b22999eaa205");
+  for (size_t i = 0; i < n_inputs; i++)
+    {
+      sha3_512_hash (data[i], lengths[i], hashvalue);
+      TCMP (byte_image (&digests[i * 64], 64), ==, byte_image (hashvalue, 64));
+    }
+  shake128_hash_batch (n_inputs, data.data(), lengths.data(), digests.data(), 512);
+  TCMP (byte_image (&digests[4 * 512], 16), ==, "7f9c2ba4e88f827d616045507605853e");
+  for (size_t i = 0; i < n_inputs; i++)
+    {
+      shake128_hash (data[i], lengths[i], hashvalue, 512);
+      TCMP (byte_image (&digests[i * 512], 512), ==, byte_image (hashvalue, 512));
+    }
+  shake256_hash_batch (n_inputs, data.data(), lengths.data(), digests.data(), 512);
+  for (size_t i = 0; i < n_inputs; i++)
+    {
+      shake256_hash (data[i], lengths[i], hashvalue, 512);
+      TCMP (byte_image (&digests[i * 512], 512), ==, byte_image (hashvalue, 512));
+    }
+}
+REGISTER_TEST ("RandomHash/Keccak Lanes", test_keccak_lanes);
+
 static void
 test_string_hashing()
 {
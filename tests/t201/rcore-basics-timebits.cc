@@ -1,5 +1,9 @@
 // This Source Code Form is licensed MPL-2.0: http://mozilla.org/MPL/2.0
 #include <rcore/testutils.hh>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <string.h>
 
 namespace {
 using namespace Rapicorn;
@@ -89,4 +93,128 @@ test_ini_files()
 }
 REGISTER_OUTPUT_TEST ("IniFiles/Parsing", test_ini_files);
 
+static void
+test_ini_lookups()
+{
+  IniFile inifile (Blob::from (ini_testfile));
+  String v;
+  TCMP (inifile.has_value ("simple-section.key1", &v), ==, true);
+  TCMP (v, ==, "1");
+  TCMP (inifile.has_raw_value ("simple-section.string-key", &v), ==, true);
+  TCMP (v, ==, "string 'with # Hash'");
+  TCMP (inifile.value_as_string ("simple-section.string-key"), ==, "string with # Hash");
+  TCMP (inifile.value_as_string ("simple-section.name[de]"), ==, "DE localized key");
+  TCMP (inifile.has_attribute ("simple-section", "colon"), ==, true);
+  TCMP (inifile.has_attribute ("simple-section", "missing"), ==, false);
+  TCMP (inifile.has_value ("simple-section.missing"), ==, false);
+  TCMP (inifile.has_value ("key1"), ==, false);
+  TCMP (inifile.raw_value ("Section With Spaces And Comment.longvalue1"), ==, "value contains line continuation");
+  IniFile first_wins ("-", "[a.b]\nkey = first\nkey = second\n");
+  TCMP (first_wins.value_as_string ("a.b.key"), ==, "first");
+  std::unordered_map<String,String> values;
+  values["a.b.key"] = "preset";
+  inifile.merge_values (values);
+  first_wins.merge_values (values);
+  TCMP (values["a.b.key"], ==, "preset");
+  TCMP (values["simple-section.indented"], ==, "value");
+}
+REGISTER_TEST ("IniFiles/Lookups", test_ini_lookups);
+
+static void
+test_trace_events()
+{
+  const bool was_enabled = Trace::enabled();
+  Trace::enable (true);
+  Trace::clear();
+  {
+    RAPICORN_TRACE_SCOPE ("Test::scope");
+    Trace::counter ("Test::counter", 4711);
+    Trace::instant ("Test::\"instant\"");
+  }
+  std::thread receiver ([] () { Trace::flow_receive ("Test::message", 0x1234abcd); });
+  Trace::flow_send ("Test::message", 0x1234abcd);
+  receiver.join();
+  String json = Trace::chrome_json();
+  TASSERT (json.find ("\"traceEvents\"") != json.npos);
+  TASSERT (json.find ("{\"name\":\"Test::scope\",\"ph\":\"B\"") != json.npos);
+  TASSERT (json.find ("{\"name\":\"Test::scope\",\"ph\":\"E\"") != json.npos);
+  TASSERT (json.find ("\"args\":{\"value\":4711}") != json.npos);
+  TASSERT (json.find ("\"Test::\\\"instant\\\"\",\"ph\":\"i\"") != json.npos);
+  TASSERT (json.find ("\"ph\":\"s\"") != json.npos);
+  TASSERT (json.find ("\"ph\":\"f\"") != json.npos);
+  TASSERT (json.find ("\"id\":\"0x1234abcd\"") != json.npos);
+  TASSERT (json.find ("\"thread_name\"") != json.npos);
+  // ring buffers keep only the most recent events
+  Trace::clear();
+  for (size_t i = 0; i < 20000; i++)
+    Trace::counter ("Test::overflow", i);
+  json = Trace::chrome_json();
+  TASSERT (json.find ("{\"value\":19999}") != json.npos);
+  TASSERT (json.find ("{\"value\":0}") == json.npos);
+  TASSERT (json.find ("Test::scope") == json.npos);
+  Trace::clear();
+  Trace::enable (false);
+  Trace::counter ("Test::disabled", 1);
+  TASSERT (Trace::chrome_json().find ("Test::disabled") == String::npos);
+  Trace::enable (was_enabled);
+}
+REGISTER_TEST ("Trace/Chrome JSON", test_trace_events);
+
+static void
+test_metrics()
+{
+  Metrics::Counter &counter = Metrics::counter ("test_metrics_counter", "Test counter");
+  TCMP (&counter, ==, &Metrics::counter ("test_metrics_counter"));
+  TCMP (Metrics::find_counter ("test_metrics_counter"), ==, &counter);
+  TCMP (Metrics::find_counter ("test_metrics_missing"), ==, (Metrics::Counter*) NULL);
+  vector<std::thread> threads;
+  for (size_t i = 0; i < 4; i++)
+    threads.push_back (std::thread ([&counter] () { for (size_t j = 0; j < 10000; j++) counter.add(); }));
+  for (auto &thread : threads)
+    thread.join();
+  counter.add (5);
+  TCMP (counter.value(), ==, 40005);
+  Metrics::Histogram &histogram = Metrics::histogram ("test_metrics_latency");
+  TCMP (histogram.quantile (0.5), ==, 0);
+  for (uint64 v = 1; v <= 1000; v++)
+    histogram.record (v * 1000);
+  TCMP (histogram.count(), ==, 1000);
+  TCMP (histogram.max(), ==, 1000000);
+  TCMP (histogram.sum(), ==, 500500000);
+  const uint64 median = histogram.quantile (0.5), p99 = histogram.quantile (0.99);
+  TASSERT (median >= 500000 * 15 / 16 && median <= 500000 * 17 / 16);
+  TASSERT (p99 >= 990000 * 15 / 16 && p99 <= 990000 * 17 / 16);
+  TCMP (histogram.quantile (1.0), ==, 1000000);
+  Metrics::Histogram &small = Metrics::histogram ("test_metrics_small");
+  for (uint64 v = 0; v < 16; v++)
+    small.record (v);
+  TCMP (small.quantile (0), ==, 0);
+  TCMP (small.quantile (1), ==, 15);
+  const String text = Metrics::text();
+  TASSERT (text.find ("# TYPE test_metrics_counter counter\ntest_metrics_counter 40005\n") != String::npos);
+  TASSERT (text.find ("test_metrics_latency_count 1000\n") != String::npos);
+  TASSERT (text.find ("test_metrics_latency{quantile=\"0.99\"} ") != String::npos);
+  // scrape the exporter socket
+  const String socket_path = string_format ("/tmp/rapicorn-metrics-test.%u", ThisThread::process_pid());
+  TCMP (Metrics::serve (socket_path), ==, true);
+  TCMP (Metrics::serve (socket_path), ==, false);
+  const int fd = socket (AF_UNIX, SOCK_STREAM, 0);
+  struct sockaddr_un addr = { 0, };
+  addr.sun_family = AF_UNIX;
+  strcpy (addr.sun_path, socket_path.c_str());
+  TCMP (connect (fd, (struct sockaddr*) &addr, sizeof (addr)), ==, 0);
+  String scraped;
+  char buffer[4096];
+  ssize_t n;
+  while ((n = read (fd, buffer, sizeof (buffer))) > 0)
+    scraped.append (buffer, n);
+  close (fd);
+  TASSERT (scraped.find ("test_metrics_counter 40005\n") != String::npos);
+  // shut down the exporter, so it doesn't outlive this test
+  TCMP (Metrics::stop_serving(), ==, true);
+  TCMP (Metrics::stop_serving(), ==, false);
+  TASSERT (access (socket_path.c_str(), F_OK) != 0);
+}
+REGISTER_TEST ("Metrics/Counters and Histograms", test_metrics);
+
 } // Anon
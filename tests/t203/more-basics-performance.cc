@@ -1,6 +1,7 @@
 // This Source Code Form is licensed MPL-2.0: http://mozilla.org/MPL/2.0
 #include <rcore/testutils.hh>
 #include <string.h>
+#include <glib.h>
 
 namespace {
 using namespace Rapicorn;
@@ -60,4 +61,174 @@ perf_skip_whitespace (void)
 }
 REGISTER_TEST ("Performance/Whitespace Skipping", perf_skip_whitespace);
 
+static String markup_input;
+
+static RAPICORN_NOINLINE void
+parse_markup_input ()
+{
+  MarkupParser *parser = MarkupParser::create_parser ("markup-benchmark");
+  MarkupParser::Error error;
+  parser->parse (markup_input.data(), markup_input.size(), &error);
+  if (!error.code)
+    parser->end_parse (&error);
+  result = error.code;
+  delete parser;
+}
+
+static RAPICORN_NOINLINE void
+parse_xml_input ()
+{
+  MarkupParser::Error error;
+  XmlNodeP xnode = XmlNode::parse_xml ("xml-benchmark", markup_input.data(), markup_input.size(), &error, "benchmark");
+  result = error.code || !xnode;
+}
+
+static void
+perf_markup_parsing (void)
+{
+  // bundled resource XML, stripped of XML declarations so the files can be concatenated under a pseudo root
+  markup_input = "";
+  for (auto resource : { "@res Rapicorn/foundation.xml", "@res Rapicorn/standard.xml", "@res themes/Default.xml" })
+    {
+      Blob blob = Res (resource);
+      TASSERT (blob.size() > 0);
+      const String data = blob.string();
+      markup_input += data.compare (0, 5, "<?xml") == 0 ? data.substr (data.find ("?>") + 2) : data;
+    }
+  markup_input = "<benchmark>" + markup_input + "</benchmark>";
+  ThisThread::yield(); // volountarily giveup time slice, so we last longer during the benchmark
+  Test::Timer timer;
+  const double parse_time = timer.benchmark (parse_markup_input);
+  TCMP (result, ==, 0);
+  const double xml_time = timer.benchmark (parse_xml_input);
+  TCMP (result, ==, 0);
+  const double mbytes = markup_input.size() / (1024.0 * 1024.0);
+  TPASS ("markup parsing benchmark # throughput: MarkupParser=%.1fMB/s XmlNode=%.1fMB/s (%d bytes)\n",
+         mbytes / parse_time, mbytes / xml_time, markup_input.size());
+}
+REGISTER_TEST ("Performance/Markup Parsing", perf_markup_parsing);
+
+static String   utf8_input;
+static unichar *ucs4_output = NULL;
+static size_t   ucs4_length = 0;
+
+static RAPICORN_NOINLINE void
+utf8_validate_rapicorn ()
+{
+  result = utf8_validate (utf8_input.data(), utf8_input.size());
+}
+
+static RAPICORN_NOINLINE void
+utf8_validate_glib ()
+{
+  result = g_utf8_validate (utf8_input.data(), utf8_input.size(), NULL);
+}
+
+static RAPICORN_NOINLINE void
+utf8_decode_rapicorn ()
+{
+  result = utf8_to_unicode (utf8_input.data(), utf8_input.size(), ucs4_output);
+}
+
+static RAPICORN_NOINLINE void
+utf8_decode_glib ()
+{
+  glong n = 0;
+  gunichar *ucs4 = g_utf8_to_ucs4_fast (utf8_input.data(), utf8_input.size(), &n);
+  result = n;
+  g_free (ucs4);
+}
+
+static RAPICORN_NOINLINE void
+classify_rapicorn ()
+{
+  uint n = 0;
+  for (size_t i = 0; i < ucs4_length; i++)
+    n += Unicode::isalpha (ucs4_output[i]) + Unicode::get_break (ucs4_output[i]);
+  result = n;
+}
+
+static RAPICORN_NOINLINE void
+classify_glib ()
+{
+  uint n = 0;
+  for (size_t i = 0; i < ucs4_length; i++)
+    n += g_unichar_isalpha (ucs4_output[i]) + g_unichar_break_type (ucs4_output[i]);
+  result = n;
+}
+
+static void
+perf_utf8_unicode (void)
+{
+  // mostly ASCII markup, interspersed with Latin-1, CJK and astral plane characters
+  utf8_input = "";
+  for (uint i = 0; utf8_input.size() < 256 * 1024; i++)
+    utf8_input += i % 5 ? "<label markup-text=\"Some text\"/>\n" : "Gr\xc3\xbc\xc3\x9f\x65, \xe6\xbc\xa2\xe5\xad\x97 \xf0\x9f\x98\x80\n";
+  vector<unichar> ucs4 (utf8_input.size());
+  ucs4_output = ucs4.data();
+  ThisThread::yield(); // volountarily giveup time slice, so we last longer during the benchmark
+  Test::Timer timer;
+  const double rvalidate = timer.benchmark (utf8_validate_rapicorn);
+  TCMP (result, ==, true);
+  const double gvalidate = timer.benchmark (utf8_validate_glib);
+  TCMP (result, ==, true);
+  const double gdecode = timer.benchmark (utf8_decode_glib);
+  ucs4_length = result;
+  const double rdecode = timer.benchmark (utf8_decode_rapicorn);
+  TCMP (result, ==, ucs4_length);
+  const double gclassify = timer.benchmark (classify_glib);
+  const uint gclasses = result;
+  const double rclassify = timer.benchmark (classify_rapicorn);
+  TCMP (result, ==, gclasses);
+  ucs4_output = NULL;
+  const double mbytes = utf8_input.size() / (1024.0 * 1024.0), mchars = ucs4_length / 1000000.0;
+  TPASS ("UTF-8 benchmark # throughput: validate=%.1fMB/s (GLib %.1fMB/s) decode=%.1fMB/s (GLib %.1fMB/s)\n",
+         mbytes / rvalidate, mbytes / gvalidate, mbytes / rdecode, mbytes / gdecode);
+  TPASS ("Unicode classification benchmark # throughput: table=%.1fM/s GLib=%.1fM/s\n",
+         mchars / rclassify, mchars / gclassify);
+}
+REGISTER_TEST ("Performance/UTF-8 and Unicode", perf_utf8_unicode);
+
+static RAPICORN_NOINLINE void
+format_with_string_format ()
+{
+  result += string_format ("ClientConnectionImpl: SEEN_GARBAGE (%016x) %s: %d", result, "orbid", -17).size();
+}
+
+static RAPICORN_NOINLINE void
+format_with_literal ()
+{
+  result += STRING_FORMAT ("ClientConnectionImpl: SEEN_GARBAGE (%016x) %s: %d", result, "orbid", -17).size();
+}
+
+static RAPICORN_NOINLINE void
+format_with_format_to ()
+{
+  char buffer[128];
+  result += string_format_to (buffer, sizeof (buffer), "ClientConnectionImpl: SEEN_GARBAGE (%016x) %s: %d", result, "orbid", -17);
+}
+
+static RAPICORN_NOINLINE void
+format_with_snprintf ()
+{
+  char buffer[128];
+  result += snprintf (buffer, sizeof (buffer), "ClientConnectionImpl: SEEN_GARBAGE (%016x) %s: %d", result, "orbid", -17);
+}
+
+static void
+perf_string_formatting (void)
+{
+  ThisThread::yield(); // volountarily giveup time slice, so we last longer during the benchmark
+  Test::Timer timer;
+  result = 0;
+  const double format_time = timer.benchmark (format_with_string_format);
+  const double literal_time = timer.benchmark (format_with_literal);
+  const double format_to_time = timer.benchmark (format_with_format_to);
+  const double snprintf_time = timer.benchmark (format_with_snprintf);
+  TCMP (result, >, 0);
+  TPASS ("string formatting benchmark # timing: string_format=%.3fµs STRING_FORMAT=%.3fµs string_format_to=%.3fµs snprintf=%.3fµs\n",
+         format_time * 1000000.0, literal_time * 1000000.0, format_to_time * 1000000.0, snprintf_time * 1000000.0);
+}
+REGISTER_TEST ("Performance/String Formatting", perf_string_formatting);
+
 } // Anon
@@ -161,6 +161,53 @@ class TestCollectorWhile0 {
 };
 REGISTER_TEST ("Signal/CollectorWhile0", TestCollectorWhile0::run);
 
+static void
+test_signal_reentrancy()
+{
+  typedef Aida::Signal<void (int)> IntSignal;
+  String accu;
+  IntSignal *sig = new IntSignal ([&accu] (int) { accu += "d"; }); // default handler
+  size_t id1 = 0, id2 = 0, id3 = 0, id4 = 0;
+  // disconnect during emission, handlers 2 and 3 are disconnected by 1
+  id1 = (*sig)() += [&] (int) { accu += "1"; (*sig)() -= id2; (*sig)() -= id3; };
+  id2 = (*sig)() += [&] (int) { accu += "2"; };
+  id3 = (*sig)() += [&] (int) { accu += "3"; };
+  sig->emit (0);
+  TCMP (accu, ==, "d1");
+  TASSERT (((*sig)() -= id2) == false);
+  TASSERT (((*sig)() -= id1) == true);
+  // handlers connected during emission are not invoked by that emission
+  accu = "";
+  id4 = (*sig)() += [&] (int) {
+    accu += "4";
+    for (size_t i = 0; i < 8; i++)      // forces handler buffer reallocation
+      (*sig)() += [&] (int) { accu += "+"; };
+  };
+  sig->emit (0);
+  TCMP (accu, ==, "d4");
+  TASSERT (((*sig)() -= id4) == true);
+  accu = "";
+  sig->emit (0);
+  TCMP (accu, ==, "d++++++++");
+  // recursive emissions
+  IntSignal recursive;
+  accu = "";
+  recursive() += [&] (int depth) { accu += string_format ("%d", depth); if (depth < 3) recursive.emit (depth + 1); };
+  recursive() += [&] (int depth) { accu += "r"; };
+  recursive.emit (0);
+  TCMP (accu, ==, "0123rrrr");
+  // destruction during emission
+  accu = "";
+  IntSignal *doomed = new IntSignal();
+  (*doomed)() += [&] (int) { accu += "a"; delete doomed; doomed = NULL; };
+  (*doomed)() += [&] (int) { accu += "b"; };
+  doomed->emit (0);
+  TCMP (accu, ==, "a");
+  TASSERT (doomed == NULL);
+  delete sig;
+}
+REGISTER_TEST ("Signal/Reentrancy", test_signal_reentrancy);
+
 static void
 async_signal_tests()
 {
@@ -530,6 +530,176 @@ test_thread_atomic_cxx (void)
 }
 REGISTER_TEST ("Threads/C++AtomicThreading", test_thread_atomic_cxx);
 
+// == Hazard Pointers ==
+static std::atomic<int> hazard_deletions { 0 };
+
+static void
+hazard_delete_int (void *ptr)
+{
+  delete static_cast<int*> (ptr);
+  hazard_deletions++;
+}
+
+static void
+test_hazard_pointers()
+{
+  ThreadInfo &self = ThreadInfo::self();
+  ThreadInfo::reclaim_retired();
+  hazard_deletions = 0;
+  std::atomic<int*> shared { new int (7) };
+  int *protected_int = self.protect_hazard (0, shared);
+  TCMP (*protected_int, ==, 7);
+  int *unprotected_int = new int (8);
+  shared = unprotected_int;
+  ThreadInfo::retire (protected_int, hazard_delete_int);
+  ThreadInfo::retire (shared.exchange (NULL), hazard_delete_int);
+  ThreadInfo::reclaim_retired();
+  TCMP (hazard_deletions, ==, 1);       // protected_int must survive
+  TCMP (*protected_int, ==, 7);
+  self.clear_hazard (0);
+  ThreadInfo::reclaim_retired();
+  TCMP (hazard_deletions, ==, 2);
+}
+REGISTER_TEST ("Threads/Hazard Pointers", test_hazard_pointers);
+
+static void
+test_rcu_map()
+{
+  const int n_keys = 1000, n_readers = 4;
+  RcuMap<int,int> rcu_map;
+  std::atomic<bool> done { false };
+  std::atomic<int> mismatches { 0 };
+  auto reader = [&] () {
+    uint64 lookups = 0;
+    while (!done || lookups < 1000)
+      {
+        int value = -1;
+        const int key = lookups++ % n_keys;
+        if (rcu_map.lookup (key, value) && value != key * 3)
+          mismatches++;
+      }
+  };
+  std::vector<std::thread> readers;
+  for (int i = 0; i < n_readers; i++)
+    readers.push_back (std::thread (reader));
+  for (int k = 0; k < n_keys; k++)
+    TASSERT (rcu_map.insert (k, k * 3) == true);
+  TASSERT (rcu_map.insert (0, 0) == false);
+  TASSERT (rcu_map.erase (0) == true);
+  TASSERT (rcu_map.erase (0) == false);
+  rcu_map.update ([] (RcuMap<int,int>::Map &map) { map[0] = 0 * 3; });
+  done = true;
+  for (auto &thread : readers)
+    thread.join();
+  TCMP (mismatches, ==, 0);
+  TCMP (rcu_map.size(), ==, size_t (n_keys));
+  TCMP (rcu_map.lookup (n_keys - 1), ==, (n_keys - 1) * 3);
+  TCMP (rcu_map.lookup (n_keys), ==, 0);
+}
+REGISTER_TEST ("Threads/RcuMap", test_rcu_map);
+
+struct QueueReentrant {         // pops another element when destroyed
+  AsyncSegmentQueue<std::shared_ptr<QueueReentrant>> &queue;
+  size_t &destroyed;
+  bool    reenter;
+  QueueReentrant (AsyncSegmentQueue<std::shared_ptr<QueueReentrant>> &q, size_t &d) : queue (q), destroyed (d), reenter (true) {}
+  ~QueueReentrant()
+  {
+    destroyed++;
+    std::shared_ptr<QueueReentrant> next;
+    if (reenter && queue.pop (next))
+      next->reenter = false;
+  }
+};
+
+static void
+test_async_queues()
+{
+  // FIFO order and segment transitions
+  AsyncBlockingQueue<String> squeue;
+  TASSERT (squeue.pending() == false);
+  for (int i = 0; i < 1000; i++)
+    squeue.push (string_format ("%d", i));
+  TASSERT (squeue.pending() == true);
+  for (int i = 0; i < 1000; i++)
+    TCMP (squeue.pop(), ==, string_format ("%d", i));
+  TASSERT (squeue.pending() == false);
+  std::list<String> slist = { "x", "y" };
+  squeue.push ("a");
+  squeue.swap (slist);
+  TCMP (slist.size(), ==, 1);
+  TCMP (slist.front(), ==, "a");
+  TCMP (squeue.pop(), ==, "x");
+  TCMP (squeue.pop(), ==, "y");
+  // multiple producers and blocking consumers
+  const int n_threads = 4, n_values = 20000;
+  AsyncBlockingQueue<int64> bqueue;
+  std::atomic<int64> bsum { 0 };
+  std::vector<std::thread> threads;
+  for (int t = 0; t < n_threads; t++)
+    threads.push_back (std::thread ([&] () { for (int i = 0; i < n_values; i++) bsum += bqueue.pop(); }));
+  for (int t = 0; t < n_threads; t++)
+    threads.push_back (std::thread ([&] () { for (int i = 1; i <= n_values; i++) bqueue.push (i); }));
+  for (auto &thread : threads)
+    thread.join();
+  threads.clear();
+  TCMP (bsum, ==, int64 (n_threads) * n_values * (n_values + 1) / 2);
+  TASSERT (bqueue.pending() == false);
+  // notifications are sent when the queue has been drained
+  AsyncNotifyingQueue<int64> nqueue;
+  Mutex nmutex;
+  Cond ncond;
+  int notifications = 0;
+  nqueue.notifier ([&] () { ScopedLock<Mutex> locker (nmutex); notifications++; ncond.signal(); });
+  nqueue.push (1);
+  nqueue.push (2);
+  TCMP (notifications, ==, 1);
+  TCMP (nqueue.pop(), ==, 1);
+  TCMP (nqueue.pop(), ==, 2);
+  TCMP (nqueue.pop(), ==, 0);
+  nqueue.push (3);
+  TCMP (notifications, ==, 2);
+  TCMP (nqueue.pop(), ==, 3);
+  int64 nsum = 0, npopped = 0;
+  std::thread consumer ([&] () {
+      while (npopped < n_threads * n_values)
+        {
+          {
+            ScopedLock<Mutex> locker (nmutex);
+            while (!notifications)
+              ncond.wait (nmutex);
+            notifications = 0;
+          }
+          for (int64 v = nqueue.pop(); v; v = nqueue.pop())
+            {
+              nsum += v;
+              npopped++;
+            }
+        }
+    });
+  for (int t = 0; t < n_threads; t++)
+    threads.push_back (std::thread ([&] () { for (int i = 1; i <= n_values; i++) nqueue.push (i); }));
+  for (auto &thread : threads)
+    thread.join();
+  consumer.join();
+  TCMP (nsum, ==, int64 (n_threads) * n_values * (n_values + 1) / 2);
+  nqueue.notifier (NULL);
+  // elements replaced by pop() are destroyed outside of it, so their destructors may use the queue
+  AsyncSegmentQueue<std::shared_ptr<QueueReentrant>> rqueue;
+  size_t destroyed = 0;
+  const size_t n_elements = 64 * 128;
+  for (size_t i = 0; i < n_elements; i++)
+    rqueue.push (std::make_shared<QueueReentrant> (rqueue, destroyed));
+  std::shared_ptr<QueueReentrant> element;
+  size_t popped = 0;
+  while (rqueue.pop (element))
+    popped++;
+  element.reset();
+  TCMP (destroyed, ==, n_elements);
+  TCMP (popped, ==, n_elements / 2 + 1);       // every other element is popped by a destructor
+}
+REGISTER_TEST ("Threads/Async Queues", test_async_queues);
+
 #if 0   // disable AsyncRingBuffer
 /* AsyncRingBuffer isn't needed atm and -fsanitize=thread reports lots of races about it.
  * The code segfaults if compiled with g++ 6.2.0-5ubuntu12, so it's disabled for now until
@@ -75,6 +75,14 @@ xml_tree_test (void)
   TCMP (oa[3], ==, "foofoo");
   TCMP (oa[4], ==, "coffee");
   TCMP (oa[5], ==, "last");
+  /* check that child handles keep the parsed document alive */
+  XmlNodeP child1 = xnode->find_child ("child1");
+  XmlNodeW rootw = xnode;
+  xnode = NULL;
+  TCMP (rootw.expired(), ==, false);
+  TCMP (child1->parent()->name(), ==, "toplevel-tag");
+  TCMP (child1->parsed_file(), ==, "testdata");
+  TCMP (child1->get_attribute ("A", true), ==, "a");
 }
 REGISTER_TEST ("XML-Tests/Test XmlNode", xml_tree_test);
 
@@ -10,6 +10,14 @@ using namespace Rapicorn::Aida;
 class MiniServerImpl;
 typedef std::shared_ptr<MiniServerImpl> MiniServerImplP;
 
+class TokenImpl : public A1::TokenIface {
+public:
+  static int64 n_instances;     // server side objects, to check remote garbage collection
+  TokenImpl ()  { n_instances++; }
+  ~TokenImpl () { n_instances--; }
+};
+int64 TokenImpl::n_instances = 0;
+
 class MiniServerImpl : public A1::MiniServerIface {
   MainLoopP         loop_;
   ServerConnectionP connection_;
@@ -38,6 +46,7 @@ class MiniServerImpl : public A1::MiniServerIface {
   A1::Location      location_;
   A1::StringSeq     strings_;
   A1::DerivedIfaceP derived_;
+  A1::TokenIfaceP   kept_token_;
   int               sensor_;
 public:
   void                      changed  (const String &what)              { sig_changed.emit (what); }
@@ -74,6 +83,15 @@ public:
   virtual void message (const String &what) override { printout ("%s\n", what); }
   virtual void quit    () override                   { loop_->quit(); } // FIXME: loop is quit before remote references can be cleared
   virtual void test_parameters () override;
+  virtual A1::TokenIfaceP create_token () override  { return std::make_shared<TokenImpl>(); }
+  virtual int64           n_tokens     () override  { return TokenImpl::n_instances; }
+  virtual A1::TokenIfaceP
+  kept_token () override
+  {
+    if (!kept_token_)
+      kept_token_ = std::make_shared<TokenImpl>();
+    return kept_token_;
+  }
 };
 
 void
@@ -303,6 +321,80 @@ test_server (A1::MiniServerH server)
   server.message ("  CHECK  MiniServer property access                                      OK");
 }
 
+static uint64
+metrics_value (const char *name)
+{
+  Metrics::Counter *counter = Metrics::find_counter (name);
+  return counter ? counter->value() : 0;
+}
+
+/// Make round trips, which dispatch pending garbage collection slices, until the server holds @a n_tokens.
+static bool
+await_tokens (A1::MiniServerH server, int64 n_tokens)
+{
+  for (size_t i = 0; i < 1000; i++)
+    if (server.n_tokens() == n_tokens)
+      return true;
+  return false;
+}
+
+static void
+test_remote_gc (A1::MiniServerH server)
+{
+  const size_t gc_slice = 1024;         // objects examined per sweep, see gc_sweep_slice
+  const int64 n_live = 3000, n_dead = 2500;
+  // remote handles keep their server objects alive
+  std::vector<A1::TokenH> live;
+  for (int64 i = 0; i < n_live; i++)
+    live.push_back (server.create_token());
+  assert (server.n_tokens() == n_live);
+  // released young handles are collected in several slices, live ones survive
+  std::vector<A1::TokenH> dead;
+  for (int64 i = 0; i < n_dead; i++)
+    dead.push_back (server.create_token());
+  uint64 sweeps = metrics_value ("rapicorn_aida_gc_sweeps"), purged = metrics_value ("rapicorn_aida_gc_purged");
+  uint64 young_examined = metrics_value ("rapicorn_aida_gc_young_examined");
+  dead.clear();
+  assert (await_tokens (server, n_live));
+  sweeps = metrics_value ("rapicorn_aida_gc_sweeps") - sweeps;
+  young_examined = metrics_value ("rapicorn_aida_gc_young_examined") - young_examined;
+  assert (sweeps >= (n_dead + gc_slice - 1) / gc_slice);
+  assert (young_examined >= uint64 (n_dead) && young_examined <= sweeps * gc_slice);
+  assert (metrics_value ("rapicorn_aida_gc_purged") - purged == uint64 (n_dead));
+  // each sweep promotes up to gc_slice young survivors into the old generation
+  for (size_t i = 0; i < (n_live + n_dead) / gc_slice + 2; i++)
+    {
+      server.create_token();
+      assert (await_tokens (server, n_live));
+    }
+  // released old handles are collected in several slices, live ones survive
+  sweeps = metrics_value ("rapicorn_aida_gc_sweeps");
+  purged = metrics_value ("rapicorn_aida_gc_purged");
+  uint64 old_examined = metrics_value ("rapicorn_aida_gc_old_examined");
+  live.resize (n_live - n_dead);
+  assert (await_tokens (server, n_live - n_dead));
+  sweeps = metrics_value ("rapicorn_aida_gc_sweeps") - sweeps;
+  old_examined = metrics_value ("rapicorn_aida_gc_old_examined") - old_examined;
+  assert (sweeps >= (n_dead + gc_slice - 1) / gc_slice);
+  assert (old_examined >= uint64 (n_dead) && old_examined <= sweeps * gc_slice);
+  assert (metrics_value ("rapicorn_aida_gc_purged") - purged == uint64 (n_dead));
+  // objects exported again while a sweep is in flight are retained, even if the client reported them
+  const uint64 retained = metrics_value ("rapicorn_aida_gc_retained");
+  A1::TokenH kept = server.kept_token();
+  kept = A1::TokenH();                  // SEEN_GARBAGE, the server starts a sweep
+  kept = server.kept_token();           // GARBAGE_SWEEP reports kept before the result arrives
+  assert (kept != NULL);
+  assert (await_tokens (server, n_live - n_dead + 1));
+  assert (metrics_value ("rapicorn_aida_gc_retained") - retained == 1);
+  // the retained reference is released with the next sweep
+  purged = metrics_value ("rapicorn_aida_gc_purged");
+  kept = A1::TokenH();
+  for (size_t i = 0; i < 1000 && metrics_value ("rapicorn_aida_gc_purged") == purged; i++)
+    server.n_tokens();
+  assert (metrics_value ("rapicorn_aida_gc_purged") - purged == 1);
+  server.message ("  CHECK  MiniServer remote garbage collection                            OK");
+}
+
 static void
 test_a1_server ()
 {
@@ -323,6 +415,7 @@ test_a1_server ()
         {
           server.message ("  CHECK  MiniServer remote call successfull                              OK");
           test_server (server);
+          test_remote_gc (server);
           server.quit();
         }
       new ClientConnectionP (connection); // FIXME: need to leak this because ~ClientConnection is unsupported
@@ -50,6 +50,17 @@ test_application_list_model_relay()
   lmr->fill (0, aseq);
   a = model->row (0);
   TASSERT (a.get<String>() == "cell");
+  // columnar fill
+  lmr->update (UpdateRequest (UpdateKind::INSERTION, UpdateSpan (1, 2)));
+  AnySeqSeq columns;
+  AnySeq &column = columns.append_back();
+  column.append_back().set ("second");
+  column.append_back().set ("third");
+  lmr->fill_columns (1, columns);
+  AnySeq rows = model->rows (0, 3);
+  TASSERT (rows.size() == 3);
+  TASSERT (rows[0].get<String>() == "cell");
+  TASSERT (rows[2].get<String>() == "third");
 }
 REGISTER_UITHREAD_TEST ("Server/Application ListModelRelay", test_application_list_model_relay);
 
@@ -180,4 +180,97 @@ test_store_modifications ()
 }
 REGISTER_UITHREAD_TEST ("Stores/Memory Store Modifications", test_store_modifications);
 
+static void
+test_column_store ()
+{
+  ListColumnStore store (2);
+  const size_t N = 5000;                        // spans several chunks
+  store.insert (0, N);
+  TCMP (store.count(), ==, N);
+  for (size_t i = 0; i < N; i++)
+    store.set_cell (i, 0, Any (int64 (i)));
+  TCMP (store.cell (4321, 0).get<int64>(), ==, 4321);
+  TASSERT (store.cell (4321, 1).kind() == Aida::UNTYPED);
+  TASSERT (store.row (17).kind() == Aida::SEQUENCE); // rows of multi-column stores hold all cells
+  TCMP (store.row (17).to_string(), ==, Any (Any::AnyVector ({ Any (int64 (17)), Any() })).to_string());
+  // insert and erase across chunk boundaries
+  store.insert (1000, 3);
+  TCMP (store.count(), ==, N + 3);
+  TASSERT (store.cell (1001, 0).kind() == Aida::UNTYPED);
+  TCMP (store.cell (1003, 0).get<int64>(), ==, 1000);
+  store.erase (500, 1503);
+  TCMP (store.count(), ==, N - 1500);
+  TCMP (store.cell (499, 0).get<int64>(), ==, 499);
+  TCMP (store.cell (500, 0).get<int64>(), ==, 2000);
+  TCMP (store.cell (N - 1501, 0).get<int64>(), ==, N - 1);
+  // typed columns fall back to Any storage for mixed cells
+  store.set_cell (2, 1, Any ("two"));
+  store.set_cell (3, 1, Any (3.5));
+  TCMP (store.cell (2, 1).get<String>(), ==, "two");
+  TCMP (store.cell (3, 1).get<double>(), ==, 3.5);
+  Any row = store.row (2);
+  TASSERT (row.kind() == Aida::SEQUENCE);
+  TCMP (row.to_string(), ==, Any (Any::AnyVector ({ Any (int64 (2)), Any ("two") })).to_string());
+  // rows fetch a page at once
+  AnySeq page = store.rows (N - 1502, 10);
+  TCMP (page.size(), ==, 2);
+  TCMP ((*page[1].get<const Any::AnyVector*>())[0].get<int64>(), ==, N - 1);
+  // columns can grow
+  store.set_cell (0, 3, Any (true));
+  TCMP (store.n_columns(), ==, 4);
+  TCMP (store.cell (0, 3).get<bool>(), ==, true);
+  store.erase (0, store.count());
+  TCMP (store.count(), ==, 0);
+  store.insert (0, 1);
+  TASSERT (store.cell (0, 3).kind() == Aida::UNTYPED);
+  MemoryListStoreP mstore (new MemoryListStore (1));
+  for (uint i = 0; i < 7; i++)
+    mstore->insert (-1, Any (string_format ("row%u", i)));
+  page = mstore->rows (5, 100);
+  TCMP (page.size(), ==, 2);
+  TCMP (page[0].get<String>(), ==, "row5");
+}
+REGISTER_UITHREAD_TEST ("Stores/Column store", test_column_store);
+
+static void
+test_memory_store_round_trip ()
+{
+  MemoryListStoreP store (new MemoryListStore (3));
+  const Any full (Any::AnyVector ({ Any (int64 (1)), Any ("two"), Any (3.5) }));
+  const Any longer (Any::AnyVector ({ Any (int64 (1)), Any ("two"), Any (3.5), Any (true) }));
+  const Any shorter (Any::AnyVector ({ Any ("single") }));
+  const Any partial (Any::AnyVector ({ Any (int64 (7)), Any(), Any() }));
+  const Any plain ("plain");
+  for (const Any &row : { full, longer, shorter, partial, plain, Any() })
+    store->insert (-1, row);
+  TCMP (store->count(), ==, 6);
+  // rows read back exactly as stored, whether split across columns or not
+  TCMP (store->row (0).to_string(), ==, full.to_string());
+  TCMP (store->row (1).to_string(), ==, longer.to_string());
+  TASSERT (store->row (2).kind() == Aida::SEQUENCE);
+  TCMP (store->row (2).to_string(), ==, shorter.to_string());
+  TASSERT (store->row (3).kind() == Aida::SEQUENCE);
+  TCMP (store->row (3).to_string(), ==, partial.to_string());
+  TCMP (store->row (4).get<String>(), ==, "plain");
+  TASSERT (store->row (5).kind() == Aida::UNTYPED);
+  AnySeq page = store->rows (0, 6);
+  TCMP (page.size(), ==, 6);
+  for (size_t i = 0; i < page.size(); i++)
+    TCMP (page[i].to_string(), ==, store->row (i).to_string());
+  // updates switch between split and unsplit storage
+  store->update_row (0, shorter);
+  TCMP (store->row (0).to_string(), ==, shorter.to_string());
+  store->update_row (2, full);
+  TCMP (store->row (2).to_string(), ==, full.to_string());
+  store->update_row (1, plain);
+  TCMP (store->row (1).get<String>(), ==, "plain");
+  // single column stores keep sequences intact as well
+  MemoryListStoreP single (new MemoryListStore (1));
+  single->insert (-1, shorter);
+  single->insert (-1, full);
+  TCMP (single->row (0).to_string(), ==, shorter.to_string());
+  TCMP (single->row (1).to_string(), ==, full.to_string());
+}
+REGISTER_UITHREAD_TEST ("Stores/Memory store round trip", test_memory_store_round_trip);
+
 } // Anon
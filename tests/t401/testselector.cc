@@ -570,6 +570,23 @@ test_selector_matching ()
   test_query (__LINE__, w, "*.Window RapicornTestWidget#test-widget::test-parent:not(:empty)", 1, "HBox"); // pseudo element and combinator
   test_query (__LINE__, w, "*.Window RapicornTestWidget#test-widget::test-parent:not(:empty)!", 1, "HBox"); // like above with subject indicator
 
+  // selectors without combinators, resolved from the viewport selector index
+  test_query (__LINE__, w, "#special-arrow", 1, "Arrow");
+  test_query (__LINE__, w, "Arrow#special-arrow:empty", 1, "Arrow");
+  test_query (__LINE__, w, "Label#ChildB:first-child", 0);
+  test_query (__LINE__, w, "Button", 4, "Button");
+  WidgetIfaceP testbox = w->query_selector ("#testbox");
+  TASSERT (testbox);
+  test_query (__LINE__, testbox, "Label", 5, "Label");
+  test_query (__LINE__, testbox, "#label1", 0);
+  test_query (__LINE__, testbox, "HBox#testbox", 1, "HBox");
+  WidgetIfaceP childd = testbox->query_selector ("#ChildD");
+  TASSERT (childd);
+  childd->id ("ChildD2");       // must invalidate the index
+  test_query (__LINE__, w, "#ChildD", 0);
+  test_query (__LINE__, w, "#ChildD2", 1, "Label");
+  test_query (__LINE__, w, "Label#ChildD2:last-child", 0);
+
   WidgetIfaceP i1 = w->query_selector ("#special-arrow");
   TASSERT (i1);
   TASSERT (i1->query_selector_all ("*").size() == 1);
@@ -1,6 +1,12 @@
 // Licensed CC0 Public Domain: http://creativecommons.org/publicdomain/zero/1.0
 #include <rcore/testutils.hh>
 #include <ui/uithread.hh>
+#include <ui/listarea.hh>
+#include <ui/table.hh>
+#include <ui/models.hh>
+#include <ui/scrollwidgets.hh>
+#include <ui/image.hh>
+#include <unistd.h>
 
 namespace { // Anon
 using namespace Rapicorn;
@@ -23,4 +29,522 @@ test_window()
 }
 REGISTER_UITHREAD_TEST ("Widgets/Test Window creation", test_window);
 
+static void
+test_list_row_heights()
+{
+  ListRowHeights rh (10);
+  rh.resize (1000);
+  TCMP (rh.total(), ==, 10000);                 // default estimate
+  TCMP (rh.row_at (-5), ==, 0);
+  TCMP (rh.row_at (55), ==, 5);
+  TCMP (rh.row_at (999999), ==, 999);
+  // measured heights determine the estimate for unmeasured rows
+  TASSERT (rh.measure (0, 20) == true);
+  TASSERT (rh.measure (0, 20) == false);
+  TCMP (rh.estimate(), ==, 20);
+  TCMP (rh.offset (3), ==, 60);
+  rh.measure (1, 40);
+  TCMP (rh.estimate(), ==, 30);
+  TCMP (rh.offset (2), ==, 60);
+  TCMP (rh.offset (4), ==, 120);
+  TCMP (rh.row_at (59), ==, 1);
+  TCMP (rh.row_at (60), ==, 2);
+  // incremental edits keep measured rows in place
+  rh.insert (0, 2);
+  TCMP (rh.size(), ==, 1002);
+  TCMP (rh.measured (2), ==, 20);
+  TCMP (rh.offset (3), ==, 80);
+  TCMP (rh.row_at (80), ==, 3);
+  rh.erase (0, 3);
+  TCMP (rh.size(), ==, 999);
+  TCMP (rh.measured (0), ==, 40);
+  TCMP (rh.estimate(), ==, 40);
+  rh.unmeasure (0);
+  TCMP (rh.total(), ==, 999 * 10);
+  // offsets and row_at() agree for mixed heights
+  for (size_t i = 0; i < rh.size(); i += 3)
+    rh.measure (i, 1 + i % 17);
+  for (size_t i = 0; i < rh.size(); i++)
+    {
+      TCMP (rh.offset (i + 1) - rh.offset (i), ==, rh.height (i));
+      TCMP (rh.row_at (rh.offset (i)), ==, i);
+    }
+}
+REGISTER_UITHREAD_TEST ("Widgets/ListRowHeights", test_list_row_heights);
+
+static const char *const test_list_xml =
+  "<interfaces>\n"
+  "  <SelectableItem declare=\"test-list-row\" hexpand=\"1\" height=\"12\">\n"
+  "    <FocusFrame hexpand=\"1\" tight-focus=\"true\" frame-type=\"none\">\n"
+  "      <HBox><Label markup-text=\"Row\"/></HBox>\n"
+  "    </FocusFrame>\n"
+  "  </SelectableItem>\n"
+  "  <Window declare=\"test-list-window\">\n"
+  "    <ScrollArea>\n"
+  "      <WidgetList id=\"test-list\" hexpand=\"1\"/>\n"
+  "    </ScrollArea>\n"
+  "  </Window>\n"
+  "</interfaces>\n";
+
+struct AllocationAccess : WidgetImpl {  // provides access to the allocation flags and WidgetImpl::render_widget
+  static bool allocation_invalid (WidgetImpl &widget) { return widget.test_any (INVALID_ALLOCATION); }
+  static void render             (WidgetImpl &widget) { (widget.*(&AllocationAccess::render_widget)) (); }
+};
+
+static void
+allocate_invalid (WidgetImpl &widget) // mimics the allocation pass of ViewportImpl::negotiate_sizes
+{
+  if (AllocationAccess::allocation_invalid (widget))
+    widget.set_child_allocation (widget.child_allocation());
+  ContainerImpl *container = widget.as_container_impl();
+  if (container)
+    for (auto &child : *container)
+      allocate_invalid (*child);
+}
+
+/// Create a window with a WidgetList inside a 320x240 ScrollArea, bound to a model of @a n_rows.
+static WidgetListImpl&
+create_test_list (WindowImpl *&window, ScrollAreaIface *&scroll_area, size_t n_rows)
+{
+  static const bool __used load_once = [] () {
+    ApplicationImpl::the().load_string (test_list_xml);
+    return true;
+  } ();
+  window = &ApplicationImpl::the().create_window ("test-list-window")->impl();
+  WidgetListImpl *list = dynamic_cast<WidgetListImpl*> (window->query_selector ("#test-list").get());
+  scroll_area = dynamic_cast<ScrollAreaIface*> (window->query_selector (".ScrollArea").get());
+  TASSERT (list && scroll_area);
+  MemoryListStoreP store (new MemoryListStore (1));
+  for (size_t i = 0; i < n_rows; i++)
+    store->insert (-1, Any (int64 (i)));
+  list->bind_model (*store, "test-list-row");
+  window->requisition();
+  window->set_child_allocation (Allocation (0, 0, 320, 240));
+  uithread_main_loop()->iterate_pending();      // let ScrollPort adjust its adjustments
+  allocate_invalid (*window);
+  return *list;
+}
+
+/// Check that visible rows of @a list cover the list area from @a y to @a y + @a height.
+static bool
+list_rows_cover (WidgetListImpl &list, int y, int height)
+{
+  const int end = y + height;
+  for (bool progress = true; y < end && progress;)
+    {
+      progress = false;
+      for (auto &child : list)
+        {
+          const Allocation &area = child->child_allocation();
+          if (child->visible() && area.height > 0 && area.y <= y && area.y + area.height > y)
+            {
+              y = area.y + area.height;
+              progress = true;
+            }
+        }
+    }
+  return y >= end;
+}
+
+static size_t
+count_visible_rows (WidgetListImpl &list)
+{
+  size_t n = 0;
+  for (auto &child : list)
+    n += child->visible();
+  return n;
+}
+
+static void
+test_list_row_realization()
+{
+  WindowImpl *window;
+  ScrollAreaIface *scroll_area;
+  WidgetListImpl &list = create_test_list (window, scroll_area, 10000);
+  const int port_height = list.parent()->allocation().height;
+  TCMP (port_height, >, 0);
+  TCMP (list.child_allocation().height, ==, 10000 * 12);
+  // only rows around the visible area are realized
+  TASSERT (list_rows_cover (list, 0, port_height));
+  const size_t max_realized = 2 * port_height / 12 + 4;   // visible rows plus overscan
+  TCMP (count_visible_rows (list), >=, size_t (port_height / 12));
+  TCMP (count_visible_rows (list), <=, max_realized);
+  // moving the visible area recycles rows instead of creating new ones
+  for (int offset : { 60000, 60000 + port_height / 3, 119000, 0 })
+    {
+      scroll_area->scroll_to (0, offset);
+      list.invalidate_allocation();
+      allocate_invalid (*window);
+      const int top = -list.child_allocation().y;
+      TCMP (top, ==, MIN (offset, 10000 * 12 - port_height));
+      TASSERT (list_rows_cover (list, top, port_height));
+      TCMP (count_visible_rows (list), <=, max_realized);
+      TCMP (list.n_children(), <=, 2 * max_realized + 16);  // realized rows plus row pool
+    }
+  window->close();
+}
+REGISTER_UITHREAD_TEST ("Widgets/WidgetList row realization", test_list_row_realization);
+
+static void
+test_list_scrolling()
+{
+  WindowImpl *window;
+  ScrollAreaIface *scroll_area;
+  WidgetListImpl &list = create_test_list (window, scroll_area, 10000);
+  const int port_height = list.parent()->allocation().height;
+  // scrolling moves the list without re-allocation, the list must still realize newly visible rows
+  for (int offset = 0; offset < 10000 * 12 - port_height; offset += 1237)
+    {
+      scroll_area->scroll_to (0, offset);
+      allocate_invalid (*window);
+      TCMP (-list.child_allocation().y, ==, offset);
+      TASSERT (list_rows_cover (list, offset, port_height));
+    }
+  // small steps within the overscan area keep the realized rows
+  scroll_area->scroll_to (0, 5000 * 12);
+  allocate_invalid (*window);
+  TASSERT (list_rows_cover (list, 5000 * 12, port_height));
+  scroll_area->scroll_to (0, 5000 * 12 + 6);
+  TASSERT (AllocationAccess::allocation_invalid (list) == false);
+  TASSERT (list_rows_cover (list, 5000 * 12 + 6, port_height));
+  window->close();
+}
+REGISTER_UITHREAD_TEST ("Widgets/WidgetList scrolling", test_list_scrolling);
+
+/// Compare the pixels of two equally sized snapshots.
+static bool
+snapshots_equal (cairo_surface_t *a, cairo_surface_t *b)
+{
+  cairo_surface_flush (a);
+  cairo_surface_flush (b);
+  const int width = cairo_image_surface_get_width (a), height = cairo_image_surface_get_height (a);
+  if (width != cairo_image_surface_get_width (b) || height != cairo_image_surface_get_height (b))
+    return false;
+  const int astride = cairo_image_surface_get_stride (a), bstride = cairo_image_surface_get_stride (b);
+  const uint8 *adata = cairo_image_surface_get_data (a), *bdata = cairo_image_surface_get_data (b);
+  for (int y = 0; y < height; y++)
+    if (memcmp (adata + y * astride, bdata + y * bstride, width * 4) != 0)
+      return false;
+  return true;
+}
+
+static void
+test_list_scroll_by_copy()
+{
+  WindowImpl *window, *reference;
+  ScrollAreaIface *scroll_area, *reference_area;
+  WidgetListImpl &list = create_test_list (window, scroll_area, 10000);
+  WidgetListImpl &reference_list = create_test_list (reference, reference_area, 10000);
+  WidgetImpl &port = *list.parent(), &reference_port = *reference_list.parent();
+  const IRect area (0, 0, 320, 240);
+  AllocationAccess::render (*window);
+  for (int offset : { 6, 37, 100, 1237, 5000 * 12, 5000 * 12 + 12 * 3 + 5 })
+    {
+      // scroll by copy: the list moves, the port keeps its allocation
+      const Allocation port_area = port.child_allocation();
+      scroll_area->scroll_to (0, offset);
+      TASSERT (AllocationAccess::allocation_invalid (port) == false);
+      TCMP (list.child_allocation().y, ==, -offset);
+      TCMP (port.child_allocation(), ==, port_area);
+      allocate_invalid (*window);
+      TASSERT (list_rows_cover (list, offset, port_area.height));
+      AllocationAccess::render (*window);
+      // the reference takes the no-scroll-copy path, an invalid port allocation forces re-allocation
+      reference_port.invalidate_allocation();
+      reference_area->scroll_to (0, offset);
+      allocate_invalid (*reference);
+      TCMP (reference_list.child_allocation().y, ==, -offset);
+      AllocationAccess::render (*reference);
+      // both must render the same viewport contents
+      cairo_surface_t *snapshot = window->create_snapshot (area), *reference_snapshot = reference->create_snapshot (area);
+      TASSERT (snapshots_equal (snapshot, reference_snapshot));
+      cairo_surface_destroy (snapshot);
+      cairo_surface_destroy (reference_snapshot);
+    }
+  window->close();
+  reference->close();
+}
+REGISTER_UITHREAD_TEST ("Widgets/WidgetList scroll-by-copy rendering", test_list_scroll_by_copy);
+
+static void
+test_list_row_focus()
+{
+  WindowImpl *window;
+  ScrollAreaIface *scroll_area;
+  WidgetListImpl &list = create_test_list (window, scroll_area, 10000);
+  // focusing an unrealized row realizes it
+  TCMP (list.focus_row(), ==, -1);
+  TASSERT (list.grab_row_focus (5000) == true);
+  TCMP (list.focus_row(), ==, 5000);
+  WidgetImpl *focus_widget = window->get_focus_widget();
+  TASSERT (focus_widget != NULL);
+  // the focus row stays focused while it remains realized
+  scroll_area->scroll_to (0, 5000 * 12 - 50);
+  list.invalidate_allocation();
+  allocate_invalid (*window);
+  TCMP (list.focus_row(), ==, 5000);
+  TASSERT (window->get_focus_widget() == focus_widget);
+  // recycling the focus row drops focus, so no hidden row keeps it
+  scroll_area->scroll_to (0, 0);
+  list.invalidate_allocation();
+  allocate_invalid (*window);
+  TASSERT (window->get_focus_widget() == NULL);
+  TASSERT (list.grab_row_focus (3) == true);
+  TCMP (list.focus_row(), ==, 3);
+  window->close();
+  // detached lists must not touch the window for focus changes
+  WidgetImplP detached = Factory::create_ui_widget ("WidgetList");
+  WidgetListImpl *dlist = dynamic_cast<WidgetListImpl*> (detached.get());
+  TASSERT (dlist != NULL);
+  MemoryListStoreP store (new MemoryListStore (1));
+  for (size_t i = 0; i < 100; i++)
+    store->insert (-1, Any (int64 (i)));
+  dlist->bind_model (*store, "test-list-row");
+  TASSERT (dlist->grab_row_focus (50, 0) == false);
+  TCMP (dlist->focus_row(), ==, -1);
+}
+REGISTER_UITHREAD_TEST ("Widgets/WidgetList row focus", test_list_row_focus);
+
+static void
+test_table_requisition()
+{
+  WidgetImplP table = Factory::create_ui_widget ("Table");
+  TASSERT (table && table->interface<TableImpl*>());
+  ContainerImpl &container = *table->as_container_impl();
+  vector<WidgetImplP> cells;
+  for (int row = 0; row < 3; row++)
+    for (int col = 0; col < 3; col++)
+      {
+        WidgetImplP cell = Factory::create_ui_widget ("Arrow");
+        cell->width (10);
+        cell->height (5);
+        cell->hposition (col);
+        cell->vposition (row);
+        container.add (*cell);
+        cells.push_back (cell);
+      }
+  WidgetImplP span = Factory::create_ui_widget ("Arrow");
+  span->width (10);
+  span->height (5);
+  span->vposition (3);
+  span->hspan (3);
+  container.add (*span);
+  for (auto cell : cells)
+    cell->requisition();
+  span->requisition();
+  Requisition rq = table->requisition();
+  TCMP (rq.width, ==, 30);
+  TCMP (rq.height, ==, 20);
+  // growing and shrinking a single cell only affects its row and column
+  cells[4]->width (50);
+  cells[4]->requisition();
+  rq = table->requisition();
+  TCMP (rq.width, ==, 70);
+  cells[4]->width (10);
+  cells[4]->height (15);
+  cells[4]->requisition();
+  rq = table->requisition();
+  TCMP (rq.width, ==, 30);
+  TCMP (rq.height, ==, 30);
+  // multi-column children distribute extra space
+  span->width (90);
+  span->requisition();
+  rq = table->requisition();
+  TCMP (rq.width, ==, 90);
+  // removed children no longer contribute
+  container.remove (*cells[4]);
+  rq = table->requisition();
+  TCMP (rq.width, ==, 90);
+  TCMP (rq.height, ==, 20);
+  container.remove (*span);
+  rq = table->requisition();
+  TCMP (rq.width, ==, 30);
+  // repacked and hidden children are picked up without querying their requisition first
+  cells[8]->hposition (4);
+  rq = table->requisition();
+  TCMP (rq.width, ==, 40);
+  TCMP (rq.height, ==, 15);
+  cells[8]->visible (false);
+  rq = table->requisition();
+  TCMP (rq.width, ==, 30);
+  cells[8]->visible (true);
+  cells[8]->height (25);
+  rq = table->requisition();
+  TCMP (rq.width, ==, 40);
+  TCMP (rq.height, ==, 35);
+}
+REGISTER_UITHREAD_TEST ("Widgets/Table requisition", test_table_requisition);
+
+/// Reference implementation of ContainerImpl::point_descendants() that scans all children.
+static void
+linear_point_descendants (const ContainerImpl &container, Point widget_point, std::vector<WidgetImplP> &stack)
+{
+  for (auto childp : container)
+    {
+      const Allocation &area = childp->child_allocation();
+      const Point p (widget_point.x - area.x, widget_point.y - area.y);
+      if (childp->point (p))
+        {
+          stack.push_back (childp);
+          ContainerImpl *cc = childp->as_container_impl();
+          if (cc)
+            linear_point_descendants (*cc, p, stack);
+        }
+    }
+}
+
+/// Check that point_descendants() of @a container matches a linear scan across its allocation.
+static void
+check_point_descendants (ContainerImpl &container)
+{
+  const Allocation &area = container.allocation();
+  for (int y = -2; y < area.height + 2; y += 3)
+    for (int x = -2; x < area.width + 2; x += 3)
+      {
+        const Point p (x + 0.5, y + 0.5);
+        std::vector<WidgetImplP> hits, expected;
+        container.point_descendants (p, hits);
+        linear_point_descendants (container, p, expected);
+        TASSERT (hits == expected);
+      }
+}
+
+static void
+test_hit_testing()
+{
+  // the child grid is used for containers with many children, unless RAPICORN_FLIPPER=no-child-grid
+  for (size_t dim : { 4, 32 })
+    {
+      WidgetImplP table = Factory::create_ui_widget ("Table");
+      MultiContainerImpl &container = dynamic_cast<MultiContainerImpl&> (*table->as_container_impl());
+      WidgetImplP background = Factory::create_ui_widget ("Arrow");
+      background->hspan (dim);
+      background->vspan (dim);
+      container.add (*background);
+      for (size_t row = 0; row < dim; row++)
+        for (size_t col = 0; col < dim; col++)
+          {
+            WidgetImplP cell = Factory::create_ui_widget ("Arrow");
+            cell->width (5 + col % 7);
+            cell->height (5 + row % 5);
+            cell->hposition (col);
+            cell->vposition (row);
+            container.add (*cell);
+          }
+      const Requisition rq = table->requisition();
+      table->set_child_allocation (Allocation (0, 0, rq.width, rq.height));
+      // hits and stacking order must match a linear scan
+      check_point_descendants (container);
+      container.lower_child (*container.nth_child (dim * dim));   // last cell goes below the background
+      check_point_descendants (container);
+      container.raise_child (*background);
+      check_point_descendants (container);
+      // moved and hidden children are picked up
+      WidgetImpl *cell = container.nth_child (dim + 1);
+      cell->hposition (0);
+      cell->vposition (0);
+      container.nth_child (2)->visible (false);
+      table->requisition();
+      table->set_child_allocation (Allocation (0, 0, rq.width, rq.height));
+      check_point_descendants (container);
+      container.remove (*cell);
+      check_point_descendants (container);
+    }
+}
+REGISTER_UITHREAD_TEST ("Widgets/Hit testing", test_hit_testing);
+
+static void
+test_size_group_requisition()
+{
+  WidgetGroupP group = WidgetGroup::create ("test-hsize-group", WIDGET_GROUP_HSIZE);
+  WidgetImplP table1 = Factory::create_ui_widget ("Table"), table2 = Factory::create_ui_widget ("Table");
+  vector<WidgetImplP> members;
+  for (int i = 0; i < 4; i++)
+    {
+      WidgetImplP widget = Factory::create_ui_widget ("Arrow");
+      widget->width (10 + i);
+      widget->height (5 + i);
+      widget->vposition (i);
+      (i < 3 ? table1 : table2)->as_container_impl()->add (*widget);
+      group->add_widget (*widget);
+      members.push_back (widget);
+    }
+  for (auto widget : members)
+    {
+      TCMP (widget->requisition().width, ==, 13);
+      TCMP (widget->requisition().height, <, 10);       // HSIZE groups leave heights alone
+    }
+  // growing a single member raises the group size
+  members[1]->width (40);
+  TCMP (members[1]->requisition().width, ==, 40);
+  TCMP (members[0]->requisition().width, ==, 40);
+  TCMP (members[3]->requisition().width, ==, 40);
+  TCMP (table2->requisition().width, ==, 40);         // parents of unchanged members follow the group
+  // shrinking the largest member falls back to the next largest
+  members[1]->width (20);
+  TCMP (members[2]->requisition().width, ==, 20);
+  members[1]->width (1);
+  TCMP (members[0]->requisition().width, ==, 13);
+  TCMP (table2->requisition().width, ==, 13);
+  // removed and invisible members no longer contribute
+  group->remove_widget (*members[3]);
+  TCMP (members[0]->requisition().width, ==, 12);
+  TCMP (members[3]->requisition().width, ==, 13);
+  members[2]->visible (false);
+  TCMP (members[0]->requisition().width, ==, 11);
+  members[2]->visible (true);
+  TCMP (members[0]->requisition().width, ==, 12);
+  for (size_t i = 0; i < 3; i++)
+    group->remove_widget (*members[i]);
+  TCMP (table1->requisition().width, ==, 12);
+}
+REGISTER_UITHREAD_TEST ("Widgets/SizeGroup requisition", test_size_group_requisition);
+
+
+static void
+test_image_loading()
+{
+  // small PNGs are loaded synchronously, large ones are decoded asynchronously
+  const String small_png = __TOPDIR__ "tests/t401/image-small-tmp.png";
+  const String large_png = __TOPDIR__ "tests/t401/image-large-tmp.png";
+  Pixmap small (24, 16), large (512, 384);
+  for (int y = 0; y < large.height(); y++)
+    for (int x = 0; x < large.width(); x++)
+      large.row (y)[x] = 0xff000000 | random_int64();       // noise compresses badly
+  if (!small.save_png (small_png) || !large.save_png (large_png))
+    fatal ("failed to save PNG images: %s", string_from_errno (errno).c_str());
+  TASSERT (Blob::load (large_png).size() >= 64 * 1024);
+  struct TestRes : Res { using Res::utest_hook; };
+  TestRes::utest_hook ([] (const String &res_path) { return Blob::load (res_path); });
+  // the size request is correct right after creation through the factory
+  WidgetImplP simage = Factory::create_ui_widget ("Image", Strings ("source=" + small_png));
+  TCMP (simage->requisition().width, ==, 24);
+  TCMP (simage->requisition().height, ==, 16);
+  TCMP (ImageImpl::loads_pending(), ==, 0);
+  WidgetImplP limage = Factory::create_ui_widget ("Image", Strings ("source=" + large_png));
+  TCMP (limage->requisition().width, ==, 512);
+  TCMP (limage->requisition().height, ==, 384);
+  TCMP (ImageImpl::loads_pending(), ==, 1);
+  while (ImageImpl::loads_pending())
+    uithread_main_loop()->iterate (true);
+  TCMP (limage->requisition().width, ==, 512);
+  TCMP (limage->requisition().height, ==, 384);
+  // a load that was replaced by a newer source is discarded
+  ImageImpl *image = dynamic_cast<ImageImpl*> (limage.get());
+  TASSERT (image != NULL);
+  image->source (small_png);
+  image->source (large_png);
+  image->source (small_png);
+  TCMP (ImageImpl::loads_pending(), ==, 1);
+  TCMP (limage->requisition().width, ==, 24);
+  while (ImageImpl::loads_pending())
+    uithread_main_loop()->iterate (true);
+  TCMP (limage->requisition().width, ==, 24);
+  TCMP (limage->requisition().height, ==, 16);
+  TestRes::utest_hook (nullptr);
+  unlink (small_png.c_str());
+  unlink (large_png.c_str());
+}
+REGISTER_UITHREAD_TEST ("Widgets/Image loading", test_image_loading);
+
 } // Anon
@@ -116,4 +116,55 @@ test_pixstreams (void)
 }
 REGISTER_TEST ("Pixmaps/pixstreams", test_pixstreams);
 
+static void
+test_pixmap_async_load (void)
+{
+  const String reference = Path::vpath_find (__TOPDIR__ "tests/t402/testpixs.png");
+  Blob blob = Blob::load (reference);
+  assert (blob.size() > 0);
+  uint width = 0, height = 0;
+  assert (Pixmap::peek_png_size (blob.size(), blob.data(), &width, &height));
+  assert (width == 32 && height == 128);
+  assert (Pixmap::peek_png_size (4, "GdkP", &width, &height) == false);
+  Pixmap pixref;
+  assert (pixref.load_png (reference));
+  // decode in parallel, including a failing load
+  Mutex mutex;
+  Cond cond;
+  vector<Pixmap> pixmaps;
+  int n_failed = 0;
+  for (size_t i = 0; i < 8; i++)
+    Pixmap::load_png_async (blob, [&] (Pixmap pixmap, int error) {
+        ScopedLock<Mutex> locker (mutex);
+        assert (error == 0);
+        pixmaps.push_back (pixmap);
+        cond.signal();
+      });
+  Pixmap::load_png_async (Blob::from ("no PNG data"), [&] (Pixmap pixmap, int error) {
+      ScopedLock<Mutex> locker (mutex);
+      assert (error == ENODATA);
+      n_failed++;
+      cond.signal();
+    });
+  // fetch the data from the decoder thread
+  Pixmap::load_png_async ([&reference] () { return Blob::load (reference); }, [&] (Pixmap pixmap, int error) {
+      ScopedLock<Mutex> locker (mutex);
+      assert (error == 0);
+      pixmaps.push_back (pixmap);
+      cond.signal();
+    });
+  Pixmap::load_png_async ([] () { return Blob(); }, [&] (Pixmap pixmap, int error) {
+      ScopedLock<Mutex> locker (mutex);
+      assert (error == ENOENT);
+      n_failed++;
+      cond.signal();
+    });
+  ScopedLock<Mutex> locker (mutex);
+  while (pixmaps.size() < 9 || n_failed < 2)
+    cond.wait (mutex);
+  for (const Pixmap &pixmap : pixmaps)
+    assert (pixref.compare (pixmap, 0, 0, -1, -1, 0, 0) == false);
+}
+REGISTER_TEST ("Pixmaps/async load", test_pixmap_async_load);
+
 } // Anon
@@ -3,6 +3,7 @@
 #include <rcore/randomhash.hh>
 #include <random>
 #include <array>
+#include <unistd.h>
 
 using namespace Rapicorn;
 
@@ -315,6 +316,23 @@ random_hash_benchmarks()
   };
   bench_time = timer.benchmark (mix_shake256);
   TPASS ("Shake256        # size=%-4zd timing: fastest=%fs throughput=%.1fMB/s\n", sizeof (SHAKE256), bench_time, N_BYTES / bench_time / 1048576.);
+
+  constexpr size_t N_BATCH = 8;
+  const void *batch_inputs[N_BATCH];
+  size_t batch_lengths[N_BATCH];
+  for (size_t i = 0; i < N_BATCH; i++)
+    {
+      batch_inputs[i] = &mixinput[0];
+      batch_lengths[i] = sizeof (uint32_t) * ARRAY_SIZE (mixinput);
+    }
+  uint32_t batch_output[N_BATCH][THROUGHPUT_BLOCK_SIZE];
+  constexpr size_t N_BATCH_BYTES = (THROUGHPUT_N_RUNS + N_BATCH - 1) / N_BATCH * N_BATCH * THROUGHPUT_BLOCK_SIZE * sizeof (uint32_t) * 2;
+  auto mix_shake128_batch = [&batch_inputs, &batch_lengths, &batch_output] () {
+    for (size_t j = 0; j < THROUGHPUT_N_RUNS; j += N_BATCH)
+      shake128_hash_batch (N_BATCH, batch_inputs, batch_lengths, (uint8_t*) &batch_output[0][0], sizeof (batch_output[0]));
+  };
+  bench_time = timer.benchmark (mix_shake128_batch);
+  TPASS ("Shake128 x%zu     # size=%-4zd timing: fastest=%fs throughput=%.1fMB/s\n", N_BATCH, sizeof (Lib::KeccakF1600), bench_time, N_BATCH_BYTES / bench_time / 1048576.);
 }
 REGISTER_TEST ("RandomHash/~ Benchmarks", random_hash_benchmarks);
 
@@ -430,6 +448,135 @@ test_keccak_prng()
 }
 REGISTER_TEST ("RandomGenerator/KeccakRng", test_keccak_prng);
 
+/// The mutex and std::list based queue that AsyncBlockingQueue used to be, for comparison.
+template<class Value>
+class ListBlockingQueue {
+  Mutex            mutex_;
+  Cond             cond_;
+  std::list<Value> list_;
+public:
+  void
+  push (const Value &v)
+  {
+    ScopedLock<Mutex> sl (mutex_);
+    const bool notify = list_.empty();
+    list_.push_back (v);
+    if (RAPICORN_UNLIKELY (notify))
+      cond_.broadcast();
+  }
+  Value
+  pop ()
+  {
+    ScopedLock<Mutex> sl (mutex_);
+    while (list_.empty())
+      cond_.wait (mutex_);
+    Value v = list_.front();
+    list_.pop_front();
+    return v;
+  }
+};
+
+template<class Queue> static double
+queue_contention_run (int n_producers, int n_consumers, int n_values)
+{
+  Queue queue;
+  std::atomic<int64> sum { 0 };
+  const uint64 start = timestamp_realtime();
+  std::vector<std::thread> threads;
+  for (int c = 0; c < n_consumers; c++)
+    threads.push_back (std::thread ([&] () {
+          int64 s = 0;
+          for (int i = 0; i < n_values * n_producers / n_consumers; i++)
+            s += queue.pop();
+          sum += s;
+        }));
+  for (int p = 0; p < n_producers; p++)
+    threads.push_back (std::thread ([&] () { for (int i = 1; i <= n_values; i++) queue.push (i); }));
+  for (auto &thread : threads)
+    thread.join();
+  TCMP (sum, ==, int64 (n_producers) * n_values * (n_values + 1) / 2);
+  return (timestamp_realtime() - start) * 1000.0 / (int64 (n_producers) * n_values); // nanoseconds per element
+}
+
+static void
+queue_benchmarks()
+{
+  const int n_values = 100000;
+  for (auto pc : { std::make_pair (1, 1), std::make_pair (4, 1), std::make_pair (2, 2), std::make_pair (4, 4) })
+    {
+      const double list_ns = queue_contention_run<ListBlockingQueue<int64>> (pc.first, pc.second, n_values);
+      const double async_ns = queue_contention_run<AsyncBlockingQueue<int64>> (pc.first, pc.second, n_values);
+      TPASS ("BlockingQueue %dP/%dC # ListBlockingQueue: %.1fns/element AsyncBlockingQueue: %.1fns/element\n",
+             pc.first, pc.second, list_ns, async_ns);
+    }
+}
+REGISTER_TEST ("Threads/~ Queue Benchmarks", queue_benchmarks);
+
+static size_t
+resident_bytes()        // resident set size from /proc, 0 if unavailable
+{
+  size_t pages = 0, resident = 0;
+  FILE *file = fopen ("/proc/self/statm", "r");
+  if (file)
+    {
+      if (fscanf (file, "%zu %zu", &pages, &resident) != 2)
+        resident = 0;
+      fclose (file);
+    }
+  return resident * sysconf (_SC_PAGESIZE);
+}
+
+static void
+data_list_benchmarks()
+{
+  static DataKey<uint> uint_key;
+  static DataKey<void*> pointer_key;
+  static DataKey<String> string_key;
+  static DataKey<std::shared_ptr<int>> shared_key;
+  const size_t N_CONTAINERS = 10000;
+  std::vector<DataListContainer> containers (N_CONTAINERS);
+  for (auto &c : containers)
+    {
+      c.set_data (&uint_key, 1u);
+      c.set_data (&pointer_key, (void*) &c);
+      c.set_data (&string_key, String ("id"));
+      c.set_data (&shared_key, std::shared_ptr<int>());
+    }
+  uint64 sum = 0;
+  auto lookups = [&] () {
+    for (const auto &c : containers)
+      sum += c.get_data (&uint_key) + (c.get_data (&pointer_key) != NULL);
+  };
+  Test::Timer timer (0.25);
+  const double bench_time = timer.benchmark (lookups);
+  TASSERT (sum > 0);
+  TPASS ("DataList get_data # keys=4 timing: fastest=%fs lookup=%.1fns\n", bench_time, bench_time * 1e9 / (2 * N_CONTAINERS));
+  // memory use of a widget tree, most widgets carry few keys, trees are kept alive so heap memory is not reused
+  const size_t N_WIDGETS = 100000;
+  std::list<std::vector<DataListContainer>> trees;
+  for (size_t n_keys : { 0, 1, 2, 4 })
+    {
+      const size_t rss = resident_bytes();
+      trees.emplace_back (N_WIDGETS);
+      for (auto &c : trees.back())
+        {
+          if (n_keys >= 1)
+            c.set_data (&pointer_key, (void*) &c);
+          if (n_keys >= 2)
+            c.set_data (&uint_key, 1u);
+          if (n_keys >= 4)
+            {
+              c.set_data (&string_key, String ("id"));
+              c.set_data (&shared_key, std::shared_ptr<int>());
+            }
+        }
+      const double bytes = resident_bytes() - rss;
+      TPASS ("DataList memory # widgets=%u keys=%u sizeof=%u RSS=%.1fMB (%.1f bytes/widget)\n",
+             N_WIDGETS, n_keys, sizeof (DataList), bytes / (1024 * 1024), bytes / N_WIDGETS);
+    }
+}
+REGISTER_TEST ("DataList/~ Benchmarks", data_list_benchmarks);
+
 
 int
 main (int   argc,
@@ -0,0 +1,551 @@
+// This Source Code Form is licensed MPL-2.0: http://mozilla.org/MPL/2.0
+#include <ui/uithread.hh>
+#include <ui/table.hh>
+#include <rapicorn.hh>
+#include <rcore/testutils.hh>
+#include <stdio.h>
+#include <string.h>
+
+/* Benchmark suite for regression tracking.
+ * Each scenario is timed with Test::Timer::benchmark() and reported as a BENCH line,
+ * with --json=FILE, all results are additionally written to FILE in JSON format.
+ * Client side scenarios (Any, IPC calls, remote GC) run in the main thread, all other scenarios
+ * use server internals and run in the ui-thread.
+ */
+
+namespace { // Anon
+using namespace Rapicorn;
+
+static ApplicationH app;
+
+// == Result Collection ==
+struct BenchResult {
+  String name;
+  double ops, min, median, mean, stddev, max;   // seconds per operation
+  size_t samples;
+};
+static Mutex               bench_mutex;
+static vector<BenchResult> bench_results;
+
+/// Benchmark @a callee which executes @a ops operations per call, e.g. @a ops rows laid out or @a ops calls made.
+template<class Callee> static void
+bench_run (const String &name, size_t ops, Callee callee)
+{
+  Test::Timer timer (0.25);
+  ThisThread::yield(); // volountarily giveup time slice, so we last longer during the benchmark
+  timer.benchmark (callee);
+  BenchResult r;
+  r.name = name;
+  r.ops = ops;
+  r.min = timer.min_elapsed() / ops;
+  r.median = timer.median_elapsed() / ops;
+  r.mean = timer.mean_elapsed() / ops;
+  r.stddev = timer.stddev_elapsed() / ops;
+  r.max = timer.max_elapsed() / ops;
+  r.samples = timer.n_samples();
+  printout ("  BENCH    %-36s %11.3fus/op; median: %.3fus; stddev: %.1f%%; ops/s: %g\n",
+            name, r.min * 1000000, r.median * 1000000, r.mean > 0 ? r.stddev / r.mean * 100 : 0, 1 / r.min);
+  ScopedLock<Mutex> locker (bench_mutex);
+  bench_results.push_back (r);
+}
+
+static String
+bench_json ()
+{
+  ScopedLock<Mutex> locker (bench_mutex);
+  String s = "{\n";
+  s += string_format ("  \"rapicorn_version\": \"%s\",\n", rapicorn_version());
+  s += string_format ("  \"buildid\": \"%s\",\n", rapicorn_buildid());
+  s += string_format ("  \"timestamp\": %u,\n", timestamp_realtime() / 1000000);
+  s += "  \"unit\": \"seconds per operation\",\n";
+  s += "  \"benchmarks\": [";
+  for (size_t i = 0; i < bench_results.size(); i++)
+    {
+      const BenchResult &r = bench_results[i];
+      s += string_format ("%s\n    { \"name\": %s, \"ops_per_call\": %u, \"samples\": %u,"
+                          " \"min\": %.9g, \"median\": %.9g, \"mean\": %.9g, \"stddev\": %.9g, \"max\": %.9g }",
+                          i ? "," : "", string_to_cquote (r.name), size_t (r.ops), r.samples,
+                          r.min, r.median, r.mean, r.stddev, r.max);
+    }
+  s += "\n  ]\n}\n";
+  return s;
+}
+
+static const char *const bench_xml =
+  "<interfaces>\n"
+  "  <Window declare=\"bench-idl-window\">\n"
+  "    <RapicornIdlTestWidget id=\"bench-idl\" />\n"
+  "  </Window>\n"
+  "  <Window declare=\"bench-list-window\">\n"
+  "    <ScrollArea>\n"
+  "      <VBox id=\"bench-list\" spacing=\"1\" />\n"
+  "    </ScrollArea>\n"
+  "  </Window>\n"
+  "</interfaces>\n";
+
+static void
+ensure_bench_xml ()
+{
+  static const bool __used load_once = [] () {
+    app.load_string (bench_xml);
+    return true;
+  } ();
+}
+
+// == IPC ==
+static void
+bench_ipc_calls ()
+{
+  ensure_bench_xml();
+  bench_run ("IPC/int32 call", 100, [] () {
+      for (size_t i = 0; i < 100; i++)
+        app.test_counter_inc_fetch();
+    });
+  WindowH window = app.create_window ("bench-idl-window");
+  IdlTestWidgetH twidget = window.component<IdlTestWidgetH> ("#bench-idl");
+  TASSERT (twidget != NULL);
+  const String short_string = "Rapicorn", long_string = String (4096, 'x');
+  bench_run ("IPC/String set+get (8 bytes)", 2, [&] () {
+      twidget.string_prop (short_string);
+      TASSERT (twidget.string_prop().size() == short_string.size());
+    });
+  bench_run ("IPC/String set+get (4096 bytes)", 2, [&] () {
+      twidget.string_prop (long_string);
+      TASSERT (twidget.string_prop().size() == long_string.size());
+    });
+  const Any any_value (short_string);
+  bench_run ("IPC/Any set+get", 2, [&] () {
+      twidget.set_user_data ("bench-any", any_value);
+      TASSERT (twidget.get_user_data ("bench-any") == any_value);
+    });
+  StringSeq seq;
+  for (size_t i = 0; i < 64; i++)
+    seq.push_back (string_format ("item-%u", i));
+  bench_run ("IPC/StringSeq set+get (64 items)", 2, [&] () {
+      twidget.sequence_prop (seq);
+      TASSERT (twidget.sequence_prop().size() == seq.size());
+    });
+  typedef decltype (twidget.record_prop()) ClientRequisition; // Requisition refers to the server side type here
+  const ClientRequisition req (123, 765);
+  bench_run ("IPC/Requisition set+get", 2, [&] () {
+      twidget.record_prop (req);
+      TASSERT (twidget.record_prop().width == req.width);
+    });
+  window.close();
+}
+REGISTER_TEST ("Bench/IPC calls", bench_ipc_calls);
+
+// == Any ==
+static void
+bench_any ()
+{
+  struct Point { double x, y; bool operator== (const Point &o) const { return x == o.x && y == o.y; } };
+  const Any local_any (Point { 1, 2 }), local_other (Point { 1, 2 });
+  Any::AnyVector seq;
+  for (size_t i = 0; i < 64; i++)
+    seq.push_back (Any (string_format ("item-%u", i)));
+  const Any seq_any (seq);
+  Any::FieldVector rec;
+  for (size_t i = 0; i < 16; i++)
+    rec.push_back (Any::Field (string_format ("field%u", i), i));
+  const Any rec_any (rec), string_any (String (4096, 'x'));
+  bench_run ("Any/copy LOCAL", 100, [&] () {
+      for (size_t i = 0; i < 100; i++)
+        TASSERT (Any (local_any).kind() == Aida::LOCAL);
+    });
+  bench_run ("Any/copy SEQUENCE (64 strings)", 100, [&] () {
+      for (size_t i = 0; i < 100; i++)
+        TASSERT (Any (seq_any).kind() == Aida::SEQUENCE);
+    });
+  bench_run ("Any/copy RECORD (16 fields)", 100, [&] () {
+      for (size_t i = 0; i < 100; i++)
+        TASSERT (Any (rec_any).kind() == Aida::RECORD);
+    });
+  bench_run ("Any/copy STRING (4096 bytes)", 100, [&] () {
+      for (size_t i = 0; i < 100; i++)
+        TASSERT (Any (string_any).kind() == Aida::STRING);
+    });
+  bench_run ("Any/compare LOCAL", 100, [&] () {
+      for (size_t i = 0; i < 100; i++)
+        TASSERT (local_any == local_other);
+    });
+  const Any string_copy = string_any, seq_copy = seq_any;
+  bench_run ("Any/compare STRING copies (4096 bytes)", 100, [&] () {
+      for (size_t i = 0; i < 100; i++)
+        TASSERT (string_any == string_copy);
+    });
+  bench_run ("Any/compare SEQUENCE copies (64 strings)", 10, [&] () {
+      for (size_t i = 0; i < 10; i++)
+        TASSERT (seq_any == seq_copy);
+    });
+}
+REGISTER_TEST ("Bench/Any", bench_any);
+
+// == Remote GC ==
+static uint64
+metrics_value (const char *name)
+{
+  Metrics::Counter *counter = Metrics::find_counter (name);
+  return counter ? counter->value() : 0;
+}
+
+static void
+bench_remote_gc ()
+{
+  ensure_bench_xml();
+  WindowH window = app.create_window ("bench-list-window");
+  ContainerH list = window.component<ContainerH> ("#bench-list");
+  TASSERT (list != NULL);
+  // long lived handles end up in the old generation
+  const size_t n_old = 5000;
+  vector<WidgetH> old_widgets;
+  for (size_t i = 0; i < n_old; i++)
+    old_widgets.push_back (list.create_widget ("Arrow", StringSeq()));
+  // short lived handles are collected from the young generation
+  bench_run ("GC/create+release 10 remote handles", 10, [&] () {
+      for (size_t i = 0; i < 10; i++)
+        {
+          WidgetH child = list.create_widget ("Arrow", StringSeq());
+          list.remove_widget (child);
+        }
+      app.test_counter_inc_fetch();     // round trip, picks up GARBAGE_SWEEP
+    });
+  // releasing the old generation is collected incrementally
+  const uint64 purged = metrics_value ("rapicorn_aida_gc_purged");
+  for (auto &child : old_widgets)
+    list.remove_widget (child);
+  old_widgets.clear();
+  for (size_t i = 0; i < 1000 && metrics_value ("rapicorn_aida_gc_purged") - purged < n_old; i++)
+    app.test_counter_inc_fetch();
+  printout ("  GCSTATS  sweeps=%u young=%u old=%u promoted=%u purged=%u retained=%u sweep_p99=%uns\n",
+            metrics_value ("rapicorn_aida_gc_sweeps"), metrics_value ("rapicorn_aida_gc_young_examined"),
+            metrics_value ("rapicorn_aida_gc_old_examined"), metrics_value ("rapicorn_aida_gc_promoted"),
+            metrics_value ("rapicorn_aida_gc_purged"), metrics_value ("rapicorn_aida_gc_retained"),
+            Metrics::find_histogram ("rapicorn_aida_gc_sweep_ns")->quantile (0.99));
+  window.close();
+}
+REGISTER_TEST ("Bench/Remote GC", bench_remote_gc);
+
+// == Event Loop ==
+static void
+bench_event_loop ()
+{
+  MainLoopP loop = MainLoop::create();
+  const size_t n_callbacks = 1000;
+  size_t counter = 0;
+  bench_run ("Loop/exec_callback+dispatch", n_callbacks, [&] () {
+      for (size_t i = 0; i < n_callbacks; i++)
+        loop->exec_callback ([&counter] () { counter++; });
+      loop->iterate_pending();
+    });
+  TASSERT (counter > 0 && counter % n_callbacks == 0);
+  loop->destroy_loop();
+}
+REGISTER_UITHREAD_TEST ("Bench/Event loop", bench_event_loop);
+
+// == XML ==
+static void
+bench_xml_parse ()
+{
+  String input = "<interfaces>\n";
+  for (size_t i = 0; i < 200; i++)
+    input += string_format ("  <Window declare=\"w%u\"><VBox spacing=\"3\"><Label markup-text=\"Label &amp; %u\"/>"
+                            "<Button on-click=\"Widget::print('%u')\"><Label markup-text=\"Click\"/></Button></VBox></Window>\n", i, i, i);
+  input += "</interfaces>\n";
+  bench_run ("XML/parse_xml (200 declarations)", 1, [&] () {
+      MarkupParser::Error error;
+      XmlNodeP xnode = XmlNode::parse_xml ("bench", input.data(), input.size(), &error, "interfaces");
+      TASSERT (xnode != NULL);
+    });
+}
+REGISTER_UITHREAD_TEST ("Bench/XML parsing", bench_xml_parse);
+
+// == Factory ==
+static void
+bench_factory ()
+{
+  bench_run ("Factory/create_ui_widget (Arrow)", 100, [] () {
+      for (size_t i = 0; i < 100; i++)
+        {
+          WidgetImplP widget = Factory::create_ui_widget ("Arrow");
+          TASSERT (widget != NULL);
+        }
+    });
+  bench_run ("Factory/create_ui_widget (Button+Label)", 10, [] () {
+      for (size_t i = 0; i < 10; i++)
+        {
+          WidgetImplP button = Factory::create_ui_widget ("Button");
+          Factory::create_ui_child (*button->as_container_impl(), "Label", Factory::ArgumentList());
+        }
+    });
+}
+REGISTER_UITHREAD_TEST ("Bench/Factory", bench_factory);
+
+// == Layout ==
+static void
+bench_table_layout ()
+{
+  const size_t dim = 32;
+  WidgetImplP table = Factory::create_ui_widget ("Table");
+  ContainerImpl &container = *table->as_container_impl();
+  for (size_t row = 0; row < dim; row++)
+    for (size_t col = 0; col < dim; col++)
+      {
+        WidgetImplP cell = Factory::create_ui_widget ("Arrow");
+        cell->width (5 + col % 7);
+        cell->height (5 + row % 5);
+        cell->hposition (col);
+        cell->vposition (row);
+        container.add (*cell);
+      }
+  bench_run ("Layout/Table 32x32 requisition+allocation", dim * dim, [&] () {
+      table->invalidate_size();
+      const Requisition rq = table->requisition();
+      table->set_child_allocation (Allocation (0, 0, rq.width, rq.height));
+    });
+}
+REGISTER_UITHREAD_TEST ("Bench/Table layout", bench_table_layout);
+
+// == Hit testing ==
+static void
+bench_hit_testing ()
+{
+  const size_t dim = 32;
+  WidgetImplP table = Factory::create_ui_widget ("Table");
+  MultiContainerImpl &container = dynamic_cast<MultiContainerImpl&> (*table->as_container_impl());
+  WidgetImplP background = Factory::create_ui_widget ("Arrow");
+  background->hspan (dim);
+  background->vspan (dim);
+  container.add (*background);
+  for (size_t row = 0; row < dim; row++)
+    for (size_t col = 0; col < dim; col++)
+      {
+        WidgetImplP cell = Factory::create_ui_widget ("Arrow");
+        cell->width (5 + col % 7);
+        cell->height (5 + row % 5);
+        cell->hposition (col);
+        cell->vposition (row);
+        container.add (*cell);
+      }
+  const Requisition rq = table->requisition();
+  table->set_child_allocation (Allocation (0, 0, rq.width, rq.height));
+  size_t i = 0;
+  bench_run ("HitTest/Table 32x32 point_descendants", 1, [&] () {
+      i = (i + 7919) % (rq.width * rq.height);
+      std::vector<WidgetImplP> hits;
+      table->as_container_impl()->point_descendants (Point (i % int (rq.width) + 0.5, i / int (rq.width) + 0.5), hits);
+    });
+}
+REGISTER_UITHREAD_TEST ("Bench/Hit testing", bench_hit_testing);
+
+static void
+bench_list_layout ()
+{
+  ensure_bench_xml();
+  ApplicationImpl &app_impl = ApplicationImpl::the();
+  WindowImpl &window = app_impl.create_window ("bench-list-window")->impl();
+  WidgetIfaceP listp = window.query_selector ("#bench-list");
+  TASSERT (listp != NULL);
+  ContainerImpl *list = listp->impl().as_container_impl();
+  TASSERT (list != NULL);
+  const size_t rows = 1000;
+  for (size_t i = 0; i < rows; i++)
+    {
+      WidgetImplP row = Factory::create_ui_widget ("Arrow");
+      row->height (10 + i % 3);
+      list->add (*row);
+    }
+  bench_run ("Layout/VBox 1000 rows requisition+allocation", rows, [&] () {
+      list->invalidate_size();
+      const Requisition rq = window.requisition();
+      window.set_child_allocation (Allocation (0, 0, MAX (rq.width, 320), MAX (rq.height, 240)));
+    });
+  window.close();
+}
+REGISTER_UITHREAD_TEST ("Bench/List layout", bench_list_layout);
+
+struct RenderAccess : WidgetImpl {     // provides access to WidgetImpl::render_widget and allocation flags
+  static void render             (WidgetImpl &widget) { (widget.*(&RenderAccess::render_widget)) (); }
+  static bool allocation_invalid (WidgetImpl &widget) { return widget.test_any (INVALID_ALLOCATION); }
+};
+
+// == Scrolling ==
+static void
+allocate_invalid (WidgetImpl &widget) // mimics the allocation pass of ViewportImpl::negotiate_sizes
+{
+  if (RenderAccess::allocation_invalid (widget))
+    widget.set_child_allocation (widget.child_allocation());
+  ContainerImpl *container = widget.as_container_impl();
+  if (container)
+    for (auto &child : *container)
+      allocate_invalid (*child);
+}
+
+static void
+bench_list_scroll ()
+{
+  ensure_bench_xml();
+  ApplicationImpl &app_impl = ApplicationImpl::the();
+  WindowImpl &window = app_impl.create_window ("bench-list-window")->impl();
+  WidgetIfaceP listp = window.query_selector ("#bench-list");
+  TASSERT (listp != NULL);
+  ContainerImpl *list = listp->impl().as_container_impl();
+  TASSERT (list != NULL);
+  ScrollAreaIface *scroll_area = dynamic_cast<ScrollAreaIface*> (window.query_selector (".ScrollArea").get());
+  TASSERT (scroll_area != NULL);
+  const size_t rows = 1000;
+  for (size_t i = 0; i < rows; i++)
+    {
+      WidgetImplP row = Factory::create_ui_widget ("Arrow");
+      row->height (10);
+      list->add (*row);
+    }
+  window.requisition();
+  window.set_child_allocation (Allocation (0, 0, 320, 240));
+  uithread_main_loop()->iterate_pending();      // let ScrollPort adjust its adjustments
+  RenderAccess::render (window);
+  int offset = 0;
+  bench_run ("Scroll/VBox 1000 rows scroll+render", 1, [&] () {
+      offset = (offset + 37) % 5000;
+      scroll_area->scroll_to (0, offset);
+      allocate_invalid (window);
+      RenderAccess::render (window);
+    });
+  window.close();
+}
+REGISTER_UITHREAD_TEST ("Bench/List scrolling", bench_list_scroll);
+
+// == Rendering ==
+static void
+invalidate_content_recursive (WidgetImpl &widget)
+{
+  widget.invalidate_content();
+  ContainerImpl *container = widget.as_container_impl();
+  if (container)
+    for (auto &child : *container)
+      invalidate_content_recursive (*child);
+}
+
+static void
+bench_render ()
+{
+  ensure_bench_xml();
+  ApplicationImpl &app_impl = ApplicationImpl::the();
+  WindowImpl &window = app_impl.create_window ("bench-list-window")->impl();
+  WidgetIfaceP listp = window.query_selector ("#bench-list");
+  TASSERT (listp != NULL);
+  ContainerImpl *list = listp->impl().as_container_impl();
+  TASSERT (list != NULL);
+  for (size_t i = 0; i < 64; i++)
+    {
+      WidgetImplP row = Factory::create_ui_widget ("Arrow");
+      row->height (7);
+      list->add (*row);
+    }
+  const int width = 640, height = 480;
+  window.requisition();
+  window.set_child_allocation (Allocation (0, 0, width, height));
+  bench_run ("Render/640x480 window render+compose", 1, [&] () {
+      invalidate_content_recursive (window);
+      RenderAccess::render (window);
+      cairo_surface_t *surface = window.create_snapshot (IRect (0, 0, width, height));
+      TASSERT (surface != NULL);
+      cairo_surface_destroy (surface);
+    });
+  bench_run ("Render/640x480 window compose only", 1, [&] () {
+      cairo_surface_t *surface = window.create_snapshot (IRect (0, 0, width, height));
+      cairo_surface_destroy (surface);
+    });
+  window.close();
+}
+REGISTER_UITHREAD_TEST ("Bench/Offscreen rendering", bench_render);
+
+// == PNG Decoding ==
+static void
+bench_png_decode ()
+{
+  vector<Blob> corpus;
+  for (const char *png : { "tests/t700-png-image.png", "tests/t701-alignment-layout.png",
+                           "tests/t402/testpixs.png", "res/Rapicorn/icons/wm-gears.png" })
+    {
+      Blob blob = Blob::load (Path::vpath_find (__TOPDIR__ + String (png)));
+      TASSERT (blob.size() > 0);
+      corpus.push_back (blob);
+    }
+  bench_run ("PNG/load_png corpus", corpus.size(), [&] () {
+      for (const Blob &blob : corpus)
+        {
+          Pixmap pixmap;
+          TASSERT (pixmap.load_png (blob.size(), blob.data()));
+        }
+    });
+  Mutex mutex;
+  Cond cond;
+  size_t n_loaded = 0;
+  bench_run ("PNG/load_png_async corpus", corpus.size(), [&] () {
+      ScopedLock<Mutex> locker (mutex);
+      n_loaded = 0;
+      for (const Blob &blob : corpus)
+        Pixmap::load_png_async (blob, [&] (Pixmap pixmap, int error) {
+            TASSERT (error == 0 && pixmap.width() > 0);
+            ScopedLock<Mutex> locker (mutex);
+            n_loaded++;
+            cond.signal();
+          });
+      while (n_loaded < corpus.size())
+        cond.wait (mutex);
+    });
+}
+REGISTER_UITHREAD_TEST ("Bench/PNG decoding", bench_png_decode);
+
+// == Region ==
+static void
+bench_region ()
+{
+  vector<IRect> rects;
+  for (size_t i = 0; i < 100; i++)
+    rects.push_back (IRect ((i * 37) % 600, (i * 53) % 400, 20 + i % 30, 10 + i % 40));
+  bench_run ("Region/add 100 rects", 100, [&] () {
+      Region region;
+      for (const auto &r : rects)
+        region.add (r);
+      TASSERT (!region.empty());
+    });
+  Region a, b;
+  for (size_t i = 0; i < rects.size(); i++)
+    (i & 1 ? a : b).add (rects[i]);
+  bench_run ("Region/union+intersect+subtract", 3, [&] () {
+      Region u = a, n = a, d = a;
+      u.add (b);
+      n.intersect (b);
+      d.subtract (b);
+      TASSERT (u.count_rects() >= d.count_rects());
+    });
+}
+REGISTER_UITHREAD_TEST ("Bench/Region algebra", bench_region);
+
+} // Anon
+
+extern "C" int
+main (int   argc,
+      char *argv[])
+{
+  app = init_test_app (__PRETTY_FILE__, &argc, argv);
+  String json_file;
+  for (int i = 1; i < argc; i++)
+    if (strncmp (argv[i], "--json=", 7) == 0)
+      json_file = argv[i] + 7;
+  const int result = Test::run();
+  if (!json_file.empty())
+    {
+      const String json = bench_json();
+      FILE *file = fopen (json_file.c_str(), "w");
+      if (!file || fwrite (json.data(), json.size(), 1, file) != 1)
+        {
+          printerr ("%s: failed to write benchmark results: %s\n", json_file, strerror (errno));
+          return 1;
+        }
+      fclose (file);
+    }
+  return result;
+}
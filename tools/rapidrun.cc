@@ -31,6 +31,7 @@ help_usage (bool usage_error)
   printout ("  --snapshot pngname            Dump a snapshot to <pngname>.\n");
   printout ("  --test-dump                   Dump test stream after first expose.\n");
   printout ("  --test-matched-node PATTERN   Filter nodes in test dumps.\n");
+  printout ("  --metrics-socket PATH         Export runtime metrics on Unix socket PATH.\n");
   printout ("  -h, --help                    Display this help and exit.\n");
   printout ("  -v, --version                 Display version and exit.\n");
 }
@@ -41,6 +42,7 @@ static bool list_definitions = false;
 static String dump_snapshot = "";
 static bool test_dump = false;
 static vector<String> test_dump_matched_nodes;
+static String metrics_socket = "";
 
 static void
 parse_args (int    *argc_p,
@@ -101,6 +103,21 @@ parse_args (int    *argc_p,
             test_dump_matched_nodes.push_back (v);
           argv[i] = NULL;
         }
+      else  if (strcmp ("--metrics-socket", argv[i]) == 0 ||
+                strncmp ("--metrics-socket=", argv[i], 17) == 0)
+        {
+          char *v = NULL, *equal = argv[i] + 16;
+          if (*equal == '=')
+            v = equal + 1;
+          else if (i + 1 < argc)
+            {
+              argv[i++] = NULL;
+              v = argv[i];
+            }
+          if (v)
+            metrics_socket = v;
+          argv[i] = NULL;
+        }
       else if (strcmp (argv[i], "--help") == 0 || strcmp (argv[i], "-h") == 0)
         {
           help_usage (false);
@@ -186,6 +203,10 @@ main (int   argc,
   if (argc != 2)
     help_usage (true);
 
+  /* export metrics for scraping */
+  if (!metrics_socket.empty() && !Metrics::serve (metrics_socket))
+    printerr ("%s: failed to serve metrics: %s\n", metrics_socket.c_str(), strerror (errno));
+
   /* find GUI definition file, relative to CWD */
   String filename = app.auto_path (argv[1], ".");
 
@@ -665,22 +665,33 @@ ContainerImpl::stash_child (WidgetImpl &child, bool b)
   child.widget_adjust_state (WidgetState::STASHED, b);
 }
 
+/// Append the immediate children which contain Point @a widget_point to @a children, in stacking order.
+void
+ContainerImpl::point_children (Point widget_point, std::vector<WidgetImpl*> &children) const
+{
+  for (auto childp : *this)
+    {
+      WidgetImpl &child = *childp;
+      const Allocation &child_allocation = child.child_allocation();
+      if (child.point (Point (widget_point.x - child_allocation.x, widget_point.y - child_allocation.y)))
+        children.push_back (&child);
+    }
+}
+
 /// List all descendants in stacking order which contain Point @a widget_point.
 void
 ContainerImpl::point_descendants (Point widget_point, std::vector<WidgetImplP> &stack) const
 {
-  for (auto childp : *this)
+  std::vector<WidgetImpl*> children;
+  point_children (widget_point, children);
+  for (WidgetImpl *child : children)
     {
-      const WidgetImpl &child = *childp;
-      const Allocation child_allocation = child.child_allocation();
+      const Allocation &child_allocation = child->child_allocation();
       const Point p (widget_point.x - child_allocation.x, widget_point.y - child_allocation.y);
-      if (child.point (p))
-        {
-          stack.push_back (shared_ptr_cast<WidgetImpl> (&child));
-          const ContainerImpl *cc = const_cast<WidgetImpl*> (&child)->as_container_impl();
-          if (cc)
-            cc->point_descendants (p, stack);
-        }
+      stack.push_back (shared_ptr_cast<WidgetImpl> (child));
+      const ContainerImpl *cc = child->as_container_impl();
+      if (cc)
+        cc->point_descendants (p, stack);
     }
 }
 
@@ -900,9 +911,136 @@ ResizeContainerImpl::widget_invalidate (WidgetFlag mask)
 }
 
 // == MultiContainerImpl ==
-MultiContainerImpl::MultiContainerImpl ()
+static const bool no_child_grid = RAPICORN_FLIPPER ("no-child-grid", "Rapicorn::Container: hit-test children by scanning all child allocations instead of using a grid index.");
+
+/* Grid index over the child allocations of a MultiContainerImpl, used to hit-test large containers.
+ * Each cell lists the indices of all children overlapping it in ascending (stacking) order, children
+ * overlapping many cells (e.g. backgrounds) are listed once in spanning instead. The grid is rebuilt
+ * lazily on the next lookup after child allocations or the stacking order changed.
+ */
+struct MultiContainerImpl::ChildGrid {
+  enum { MIN_CHILDREN = 32, MAX_CELL_SPAN = 16, MAX_CELLS_PER_AXIS = 256 };
+  int          x, y, cell_width, cell_height, cols, rows;
+  vector<uint> offsets;         // cols * rows + 1 offsets into cells
+  vector<uint> cells;           // child indices per cell, ascending
+  vector<uint> spanning;        // children overlapping more than MAX_CELL_SPAN cells, ascending
+  bool         stale;
+  ChildGrid() : x (0), y (0), cell_width (1), cell_height (1), cols (0), rows (0), stale (true) {}
+  int          col      (int px) const { return CLAMP ((px - x) / cell_width, 0, cols - 1); }
+  int          row      (int py) const { return CLAMP ((py - y) / cell_height, 0, rows - 1); }
+  void
+  build (const std::vector<WidgetImplP> &widgets)
+  {
+    stale = false;
+    offsets.clear();
+    cells.clear();
+    spanning.clear();
+    int x2 = INT_MIN, y2 = INT_MIN;
+    x = y = INT_MAX;
+    for (const auto &widgetp : widgets)
+      {
+        const Allocation &a = widgetp->child_allocation();
+        x = MIN (x, a.x);
+        y = MIN (y, a.y);
+        x2 = MAX (x2, a.x + a.width);
+        y2 = MAX (y2, a.y + a.height);
+      }
+    const int width = MAX (1, x2 - x), height = MAX (1, y2 - y);
+    // aim at roughly one child per cell, with cells shaped after the children's bounding box
+    const double n = widgets.size();
+    cols = CLAMP (int (sqrt (n * width / height) + 0.5), 1, int (MAX_CELLS_PER_AXIS));
+    rows = CLAMP (int ((n + cols - 1) / cols), 1, int (MAX_CELLS_PER_AXIS));
+    cell_width = (width + cols - 1) / cols;
+    cell_height = (height + rows - 1) / rows;
+    cols = (width + cell_width - 1) / cell_width;
+    rows = (height + cell_height - 1) / cell_height;
+    // count children per cell, offsets[c + 1] serves as counter for cell c
+    offsets.resize (cols * rows + 1, 0);
+    for (uint i = 0; i < widgets.size(); i++)
+      {
+        const Allocation &a = widgets[i]->child_allocation();
+        const int c0 = col (a.x), c1 = col (a.x + a.width), r0 = row (a.y), r1 = row (a.y + a.height);
+        if ((c1 - c0 + 1) * (r1 - r0 + 1) > MAX_CELL_SPAN)
+          spanning.push_back (i);
+        else
+          for (int r = r0; r <= r1; r++)
+            for (int c = c0; c <= c1; c++)
+              offsets[r * cols + c + 1] += 1;
+      }
+    for (size_t c = 1; c < offsets.size(); c++)
+      offsets[c] += offsets[c - 1];
+    // fill cells in stacking order
+    cells.resize (offsets.back());
+    vector<uint> fill (offsets.begin(), offsets.end() - 1);
+    size_t s = 0;
+    for (uint i = 0; i < widgets.size(); i++)
+      {
+        if (s < spanning.size() && spanning[s] == i)
+          {
+            s++;
+            continue;
+          }
+        const Allocation &a = widgets[i]->child_allocation();
+        const int c0 = col (a.x), c1 = col (a.x + a.width), r0 = row (a.y), r1 = row (a.y + a.height);
+        for (int r = r0; r <= r1; r++)
+          for (int c = c0; c <= c1; c++)
+            cells[fill[r * cols + c]++] = i;
+      }
+  }
+  /// Find the cell containing @a p, returns false if @a p lies outside of all children.
+  bool
+  lookup (Point p, const uint **cell_begin, const uint **cell_end) const
+  {
+    if (p.x < x || p.y < y || p.x >= x + cols * cell_width || p.y >= y + rows * cell_height)
+      return false;
+    const int c = int ((p.y - y) / cell_height) * cols + int ((p.x - x) / cell_width);
+    *cell_begin = cells.data() + offsets[c];
+    *cell_end = cells.data() + offsets[c + 1];
+    return true;
+  }
+};
+
+MultiContainerImpl::MultiContainerImpl () :
+  child_grid_ (NULL)
 {}
 
+void
+MultiContainerImpl::child_grid_invalidate ()
+{
+  if (child_grid_)
+    child_grid_->stale = true;
+}
+
+void
+MultiContainerImpl::child_allocation_changed (WidgetImpl &child)
+{
+  child_grid_invalidate();
+}
+
+void
+MultiContainerImpl::point_children (Point widget_point, std::vector<WidgetImpl*> &children) const
+{
+  if (widgets.size() < ChildGrid::MIN_CHILDREN || no_child_grid)
+    return ContainerImpl::point_children (widget_point, children);
+  if (!child_grid_)
+    child_grid_ = new ChildGrid();
+  if (child_grid_->stale)
+    child_grid_->build (widgets);
+  const uint *cell = NULL, *cell_end = NULL;
+  if (!child_grid_->lookup (widget_point, &cell, &cell_end))
+    return;
+  // merge cell and spanning children, so hits are listed in stacking order
+  const uint *span = child_grid_->spanning.data(), *span_end = span + child_grid_->spanning.size();
+  while (cell < cell_end || span < span_end)
+    {
+      const uint i = span >= span_end || (cell < cell_end && *cell < *span) ? *cell++ : *span++;
+      WidgetImpl &child = *widgets[i];
+      const Allocation &child_allocation = child.child_allocation();
+      if (child.point (Point (widget_point.x - child_allocation.x, widget_point.y - child_allocation.y)))
+        children.push_back (&child);
+    }
+}
+
 WidgetImplP*
 MultiContainerImpl::begin () const
 {
@@ -922,6 +1060,7 @@ String
 MultiContainerImpl::add_child (WidgetImplP widget)
 {
   widgets.push_back (widget);
+  child_grid_invalidate();
   set_child_parent (*widget, this);
   return "";
 }
@@ -953,6 +1092,7 @@ MultiContainerImpl::remove_child (WidgetImpl &widget)
     {
       const WidgetImplP guard_widget = widgets[index];
       widgets.erase (widgets.begin() + index);
+      child_grid_invalidate();
       set_child_parent (widget, NULL);
     }
   else
@@ -970,6 +1110,7 @@ MultiContainerImpl::raise_child (WidgetImpl &widget)
             std::shared_ptr<WidgetImpl> widgetp = widgets[i];
             widgets.erase (widgets.begin() + i);
             widgets.push_back (widgetp);
+            child_grid_invalidate();
             if (widget.viewable())
               widget.expose();
           }
@@ -988,6 +1129,7 @@ MultiContainerImpl::lower_child (WidgetImpl &widget)
             std::shared_ptr<WidgetImpl> widgetp = widgets[i];
             widgets.erase (widgets.begin() + i);
             widgets.insert (widgets.begin(), widgetp);
+            child_grid_invalidate();
             if (widget.viewable())
               widget.expose();
           }
@@ -1005,6 +1147,7 @@ MultiContainerImpl::remove_all_children ()
 MultiContainerImpl::~MultiContainerImpl()
 {
   remove_all_children();
+  delete child_grid_;
 }
 
 } // Rapicorn
@@ -49,6 +49,9 @@ protected:
   static void         layout_child_allocation (WidgetImpl &child, const Allocation &carea);
   static Requisition  size_request_child (WidgetImpl &child, bool *hspread = NULL, bool *vspread = NULL);
   virtual void        selectable_child_changed (WidgetChain &chain);
+  virtual void        child_allocation_changed (WidgetImpl &child)     {}
+  virtual void        child_requisition_changed (WidgetImpl &child)    {}
+  virtual void        point_children    (Point widget_point, std::vector<WidgetImpl*> &children) const;
   void                set_child_parent (WidgetImpl &child, ContainerImpl *parent) { child.set_parent (parent); }
 public:
   virtual WidgetImplP*  begin             () const = 0;
@@ -115,12 +118,17 @@ protected:
 
 // == Multi Child Container ==
 class MultiContainerImpl : public virtual ContainerImpl {
+  struct ChildGrid;
   std::vector<WidgetImplP> widgets;
+  mutable ChildGrid    *child_grid_;
+  void                  child_grid_invalidate   ();
 protected:
   virtual              ~MultiContainerImpl      ();
   virtual void          render                  (RenderContext &rcontext) override {}
   virtual String        add_child               (WidgetImplP widget) override;
   virtual void          remove_child            (WidgetImpl &widget) override;
+  virtual void          child_allocation_changed (WidgetImpl &child) override;
+  virtual void          point_children          (Point widget_point, std::vector<WidgetImpl*> &children) const override;
   explicit              MultiContainerImpl      ();
 public:
   virtual WidgetImplP*  begin                   () const override;
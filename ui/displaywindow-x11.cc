@@ -184,6 +184,7 @@ struct DisplayWindowX11 : public virtual DisplayWindow, public virtual X11Widget
   void                  create_window           (const DisplayWindow::Setup &setup, const DisplayWindow::Config &config);
   void                  configure_window        (const Config &config, bool sizeevent);
   void                  blit                    (cairo_surface_t *surface, const Rapicorn::Region &region);
+  void                  copy_area               (const IRect &area, int dest_x, int dest_y);
   void                  filtered_event          (const XEvent &xevent);
   bool                  process_event           (const XEvent &xevent);
   bool                  send_selection_notify   (Window req_window, Atom selection, Atom target, Atom req_property, Time req_time);
@@ -964,6 +965,37 @@ DisplayWindowX11::blit (cairo_surface_t *surface, const Rapicorn::Region &region
   blit_expose_region();
 }
 
+void
+DisplayWindowX11::copy_area (const IRect &area, int dest_x, int dest_y)
+{
+  if (!window_ || !expose_surface_)
+    return;
+  cairo_surface_flush (expose_surface_);
+  const int surface_width = cairo_image_surface_get_width (expose_surface_);
+  const int surface_height = cairo_image_surface_get_height (expose_surface_);
+  const IRect extents = IRect (0, 0, surface_width, surface_height);
+  // clip source and destination against expose_surface_
+  const int dx = dest_x - area.x, dy = dest_y - area.y;
+  IRect src = area.intersection (extents);
+  IRect dest = IRect (src.x + dx, src.y + dy, src.width, src.height).intersection (extents);
+  src = IRect (dest.x - dx, dest.y - dy, dest.width, dest.height);
+  if (dest.empty())
+    return;
+  // move pixels, rows may overlap, so copy in the direction opposite to the move
+  const int stride = cairo_image_surface_get_stride (expose_surface_);
+  uint8 *const pixels = cairo_image_surface_get_data (expose_surface_);
+  const size_t row_bytes = dest.width * 4;      // CAIRO_FORMAT_ARGB32
+  for (int i = 0; i < dest.height; i++)
+    {
+      const int row = dy > 0 ? dest.height - 1 - i : i;
+      memmove (pixels + (dest.y + row) * stride + dest.x * 4, pixels + (src.y + row) * stride + src.x * 4, row_bytes);
+    }
+  cairo_surface_mark_dirty_rectangle (expose_surface_, dest.x, dest.y, dest.width, dest.height);
+  // redraw moved area
+  expose_region_.add (dest);
+  blit_expose_region();
+}
+
 void
 DisplayWindowX11::blit_expose_region()
 {
@@ -1345,6 +1377,9 @@ DisplayWindowX11::handle_command (DisplayCommand *command)
     case DisplayCommand::BLIT:
       blit (command->surface, *command->region);
       break;
+    case DisplayCommand::COPY:
+      copy_area (IRect (command->region->extents()), command->dest_x, command->dest_y);
+      break;
     case DisplayCommand::OWNER: {
       const StringVector &data_types = command->string_list;
       const Atom selection = command->source == CONTENT_SOURCE_SELECTION ? XA_PRIMARY :
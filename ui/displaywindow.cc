@@ -149,6 +149,16 @@ DisplayWindow::blit_surface (cairo_surface_t *surface, const Rapicorn::Region &r
   queue_command (cmd);
 }
 
+void
+DisplayWindow::copy_area (const Rapicorn::IRect &area, int dest_x, int dest_y)
+{
+  DisplayCommand *cmd = new DisplayCommand (DisplayCommand::COPY, this);
+  cmd->region = new Rapicorn::Region (area);
+  cmd->dest_x = dest_x;
+  cmd->dest_y = dest_y;
+  queue_command (cmd);
+}
+
 void
 DisplayWindow::start_user_move (uint button, double root_x, double root_y)
 {
@@ -257,7 +267,7 @@ DisplayWindow::flags_name (uint64 flags, String combo)
 // == DisplayCommand ==
 DisplayCommand::DisplayCommand (Type ctype, DisplayWindow *window) :
   type (ctype), display_window (window), config (NULL), setup (NULL), surface (NULL), region (NULL),
-  nonce (0), root_x (-1), root_y (-1), button (-1), source (ContentSourceType (0)), need_resize (false)
+  nonce (0), root_x (-1), root_y (-1), button (-1), dest_x (0), dest_y (0), source (ContentSourceType (0)), need_resize (false)
 {}
 
 DisplayCommand::~DisplayCommand()
@@ -279,7 +289,7 @@ DisplayCommand::reply_type (Type type)
     {
     case CREATE: case SHUTDOWN: return true; // has reply
     case OK: case ERROR:        return true; // is reply
-    case CONFIGURE: case BLIT:
+    case CONFIGURE: case BLIT: case COPY:
     case UMOVE: case URESIZE:
     case OWNER:
     case PROVIDE: case CONTENT:
@@ -80,6 +80,7 @@ public:
   void          destroy                 ();                     ///< Destroy onscreen windows and reset event wakeup.
   void          configure               (const Config &config, bool sizeevent); ///< Change window configuration, requesting size event.
   void          blit_surface            (cairo_surface_t *surface, const Rapicorn::Region &region);   ///< Blit/paint window region.
+  void          copy_area               (const Rapicorn::IRect &area, int dest_x, int dest_y);        ///< Move window contents of @a area to @a dest_x, @a dest_y.
   void          start_user_move         (uint button, double root_x, double root_y);                  ///< Trigger window movement.
   void          start_user_resize       (uint button, double root_x, double root_y, Anchor edge);     ///< Trigger window resizing.
   void          set_content_owner       (ContentSourceType source, uint64 nonce, const StringVector &data_types); ///< Yields CONTENT_REQUEST & CONTENT_CLEAR.
@@ -107,7 +108,7 @@ private:
 
 struct DisplayCommand   /// Structure for internal asynchronous communication between DisplayWindow and DisplayDriver.
 {
-  enum Type { ERROR, OK, CREATE, CONFIGURE, BEEP, SHOW, PRESENT, BLIT, UMOVE, URESIZE, CONTENT, OWNER, PROVIDE, DESTROY, SHUTDOWN, };
+  enum Type { ERROR, OK, CREATE, CONFIGURE, BEEP, SHOW, PRESENT, BLIT, COPY, UMOVE, URESIZE, CONTENT, OWNER, PROVIDE, DESTROY, SHUTDOWN, };
   const Type            type;
   DisplayWindow        *const display_window;
   String                string;
@@ -118,6 +119,7 @@ struct DisplayCommand   /// Structure for internal asynchronous communication be
   Rapicorn::Region     *region;
   union { uint64        nonce, u64; };
   int                   root_x, root_y, button;
+  int                   dest_x, dest_y;
   ContentSourceType     source;
   bool                  need_resize;
   /*ctor*/             ~DisplayCommand ();
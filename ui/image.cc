@@ -2,6 +2,7 @@
 #include "image.hh"
 #include "stock.hh"
 #include "factory.hh"
+#include "uithread.hh"
 
 namespace Rapicorn {
 
@@ -9,6 +10,8 @@ namespace Rapicorn {
 void
 ImageImpl::pixbuf (const Pixbuf &pixbuf)
 {
+  load_stamp_++;
+  loading_size_ = Requisition();
   image_painter_ = ImagePainter (Pixmap (pixbuf));
   invalidate_size();
   invalidate_content();
@@ -31,13 +34,76 @@ ImageImpl::broken_image()
   invalidate_content();
 }
 
+static uint image_loads_pending = 0;   // asynchronous loads not yet handed back to the UI thread
+
+/** Start decoding a large PNG image in a decoder thread, returns false if @a image_url needs synchronous loading.
+ * The image size is read from the PNG header, so the size request stays stable while the
+ * image is being decoded and nothing is rendered until the decoded pixels are available.
+ */
+bool
+ImageImpl::load_async (const String &image_url)
+{
+  static constexpr size_t ASYNC_PNG_BYTES = 64 * 1024; // icons decode faster than a decoder thread round trip
+  if (image_url.find ('#') != String::npos || string_endswith (image_url, ".svg") || string_startswith (image_url, "@res"))
+    return false;
+  const std::weak_ptr<ImageImpl> weak_image = shared_ptr_cast<ImageImpl*> (this);
+  if (weak_image.expired())
+    return false;
+  Blob blob = StyleIface::load_res (image_url);
+  uint width = 0, height = 0;
+  if (blob.size() < ASYNC_PNG_BYTES || !Pixmap::peek_png_size (blob.size(), blob.data(), &width, &height))
+    return false;
+  image_painter_.reset();
+  loading_size_ = Requisition (width, height);
+  const uint load_stamp = load_stamp_;
+  image_loads_pending++;
+  Pixmap::load_png_async (blob, [weak_image, load_stamp] (Pixmap pixmap, int error) {
+      // called from a decoder thread, the widget must only be accessed from the UI thread
+      uithread_main_loop()->exec_callback ([weak_image, load_stamp, pixmap, error] () {
+          image_loads_pending--;
+          std::shared_ptr<ImageImpl> image = weak_image.lock();
+          if (image)
+            image->async_loaded (load_stamp, pixmap, error);
+        });
+    });
+  return true;
+}
+
+/// Count the PNG images that are still being decoded asynchronously, e.g. to delay snapshots.
+uint
+ImageImpl::loads_pending ()
+{
+  return image_loads_pending;
+}
+
+void
+ImageImpl::async_loaded (uint load_stamp, Pixmap pixmap, int error)
+{
+  return_unless (load_stamp == load_stamp_);    // image was changed meanwhile
+  loading_size_ = Requisition();
+  image_painter_ = ImagePainter (pixmap);
+  if (error || !image_painter_)
+    {
+      RAPICORN_DIAG ("ImageImpl: failed to load %s: %s", CQUOTE (source_), strerror (error ? error : ENODATA));
+      broken_image();
+      return;
+    }
+  invalidate_size();
+  invalidate_content();
+}
+
 void
 ImageImpl::source (const String &image_url)
 {
   source_ = image_url;
-  image_painter_ = ImagePainter (source_);
-  if (!image_painter_)
-    broken_image();
+  load_stamp_++;
+  loading_size_ = Requisition();
+  if (!load_async (source_))
+    {
+      image_painter_ = ImagePainter (source_);
+      if (!image_painter_)
+        broken_image();
+    }
   invalidate_size();
   invalidate_content();
 }
@@ -53,6 +119,8 @@ ImageImpl::stock (const String &stock_id)
 {
   return_unless (stock_id_ != stock_id);
   stock_id_ = stock_id;
+  load_stamp_++;
+  loading_size_ = Requisition();
   String stock_icon = Stock (stock_id_).icon();
   image_painter_ = ImagePainter (stock_icon);
   if (!image_painter_)
@@ -70,7 +138,7 @@ ImageImpl::stock() const
 void
 ImageImpl::size_request (Requisition &requisition)
 {
-  const Requisition irq = image_painter_.image_size();
+  const Requisition irq = image_painter_ ? image_painter_.image_size() : loading_size_;
   requisition.width += irq.width;
   requisition.height += irq.height;
 }
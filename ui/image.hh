@@ -10,12 +10,17 @@ namespace Rapicorn {
 class ImageImpl : public virtual WidgetImpl, public virtual ImageIface {
   String                source_, stock_id_;
   ImagePainter          image_painter_;
+  Requisition           loading_size_;          // size of a PNG image that is still being decoded
+  uint                  load_stamp_ = 0;        // incremented to discard outdated asynchronous loads
+  void                  async_loaded    (uint load_stamp, Pixmap pixmap, int error);
 protected:
   void                  broken_image    ();
+  bool                  load_async      (const String &image_url);
   virtual void          size_request    (Requisition &requisition) override;
   virtual void          size_allocate   (Allocation area) override;
   virtual void          render          (RenderContext &rcontext) override;
 public:
+  static uint           loads_pending   ();
   virtual void          pixbuf          (const Pixbuf &pixbuf) override;
   virtual Pixbuf        pixbuf          () const override;
   virtual void          source          (const String &uri) override;
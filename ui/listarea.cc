@@ -2,6 +2,7 @@
 #include "listarea.hh"
 #include "factory.hh"
 #include "application.hh"
+#include "scrollwidgets.hh"
 
 //#define IFDEBUG(...)      do { /*__VA_ARGS__*/ } while (0)
 #define IFDEBUG(...)      __VA_ARGS__
@@ -88,6 +89,179 @@ SelectableItemImpl::reset (ResetMode mode)
 static const WidgetFactory<SelectableItemImpl> selectable_item_factory ("Rapicorn::SelectableItem");
 
 
+// == ListRowHeights ==
+ListRowHeights::ListRowHeights (int default_estimate) :
+  measured_sum_ (0), n_measured_ (0), default_estimate_ (MAX (1, default_estimate)), dirty_ (false)
+{}
+
+void
+ListRowHeights::clear ()
+{
+  heights_.clear();
+  height_tree_.clear();
+  count_tree_.clear();
+  measured_sum_ = 0;
+  n_measured_ = 0;
+  dirty_ = false;
+}
+
+void
+ListRowHeights::resize (size_t n_rows)
+{
+  if (n_rows < heights_.size())
+    erase (n_rows, heights_.size() - n_rows);
+  else if (n_rows > heights_.size())
+    insert (heights_.size(), n_rows - heights_.size());
+}
+
+/// Insert @a n_rows unmeasured rows before @a row.
+void
+ListRowHeights::insert (size_t row, size_t n_rows)
+{
+  return_unless (n_rows > 0);
+  row = MIN (row, heights_.size());
+  heights_.insert (heights_.begin() + row, n_rows, -1);
+  dirty_ = true;        // Fenwick trees cannot shift, rebuild lazily in O(n)
+}
+
+/// Remove @a n_rows rows starting at @a row.
+void
+ListRowHeights::erase (size_t row, size_t n_rows)
+{
+  return_unless (row < heights_.size());
+  n_rows = MIN (n_rows, heights_.size() - row);
+  return_unless (n_rows > 0);
+  for (size_t i = row; i < row + n_rows; i++)
+    if (heights_[i] >= 0)
+      {
+        measured_sum_ -= heights_[i];
+        n_measured_ -= 1;
+      }
+  heights_.erase (heights_.begin() + row, heights_.begin() + row + n_rows);
+  dirty_ = true;
+}
+
+void
+ListRowHeights::rebuild ()
+{
+  const size_t n = heights_.size();
+  height_tree_.assign (n + 1, 0);
+  count_tree_.assign (n + 1, 0);
+  for (size_t i = 1; i <= n; i++)
+    {
+      if (heights_[i - 1] >= 0)
+        {
+          height_tree_[i] += heights_[i - 1];
+          count_tree_[i] += 1;
+        }
+      const size_t parent = i + (i & -i);
+      if (parent <= n)
+        {
+          height_tree_[parent] += height_tree_[i];
+          count_tree_[parent] += count_tree_[i];
+        }
+    }
+  dirty_ = false;
+}
+
+void
+ListRowHeights::tree_add (size_t row, int64 dheight, int dcount)
+{
+  return_unless (!dirty_);      // rebuild() picks up the change
+  const size_t n = heights_.size();
+  for (size_t i = row + 1; i <= n; i += i & -i)
+    {
+      height_tree_[i] += dheight;
+      count_tree_[i] += dcount;
+    }
+}
+
+/// Record the measured @a height of @a row, returns whether it changed.
+bool
+ListRowHeights::measure (size_t row, int height)
+{
+  return_unless (row < heights_.size(), false);
+  height = MAX (0, height);
+  const int old = heights_[row];
+  return_unless (old != height, false);
+  heights_[row] = height;
+  measured_sum_ += height - MAX (0, old);
+  n_measured_ += old < 0;
+  tree_add (row, height - MAX (0, old), old < 0);
+  return true;
+}
+
+/// Forget the measured height of @a row, e.g. after its contents changed.
+void
+ListRowHeights::unmeasure (size_t row)
+{
+  return_unless (row < heights_.size() && heights_[row] >= 0);
+  const int old = heights_[row];
+  heights_[row] = -1;
+  measured_sum_ -= old;
+  n_measured_ -= 1;
+  tree_add (row, -old, -1);
+}
+
+/// Height assumed for unmeasured rows, the average of all measured rows.
+int
+ListRowHeights::estimate () const
+{
+  if (!n_measured_)
+    return default_estimate_;
+  return MAX (1, (measured_sum_ + n_measured_ / 2) / n_measured_);
+}
+
+int
+ListRowHeights::height (size_t row) const
+{
+  const int h = measured (row);
+  return h >= 0 ? h : estimate();
+}
+
+/// Vertical position of @a row, i.e. the sum of all heights before @a row.
+int64
+ListRowHeights::offset (size_t row)
+{
+  if (dirty_)
+    rebuild();
+  row = MIN (row, heights_.size());
+  int64 sum = 0, count = 0;
+  for (size_t i = row; i > 0; i -= i & -i)
+    {
+      sum += height_tree_[i];
+      count += count_tree_[i];
+    }
+  return sum + (row - count) * estimate();
+}
+
+/// Find the row covering vertical position @a y, clamped to the valid rows.
+size_t
+ListRowHeights::row_at (int64 y)
+{
+  const size_t n = heights_.size();
+  return_unless (n > 0, 0);
+  if (dirty_)
+    rebuild();
+  const int64 e = estimate();
+  size_t mask = 1;
+  while (mask <= n / 2)
+    mask <<= 1;
+  size_t pos = 0;
+  int64 acc = 0;
+  for (; mask; mask >>= 1)
+    if (pos + mask <= n)
+      {
+        const int64 span = height_tree_[pos + mask] + (int64 (mask) - count_tree_[pos + mask]) * e;
+        if (acc + span <= y)
+          {
+            pos += mask;
+            acc += span;
+          }
+      }
+  return MIN (pos, n - 1);
+}
+
 // == SelectionChangedGuard ==
 WidgetListImpl::SelectionChangedGuard::SelectionChangedGuard (WidgetListImpl &wlist) :
   wlist_ (wlist)
@@ -106,16 +280,27 @@ WidgetListImpl::SelectionChangedGuard::~SelectionChangedGuard ()
 // == WidgetListImpl ==
 static const WidgetFactory<WidgetListImpl> widget_list_factory ("Rapicorn::WidgetList");
 
+class RowIndexKey : public DataKey<int64> {
+  virtual int64 fallback () override { return -1; }
+};
+static RowIndexKey row_index_key;
+
 WidgetListImpl::WidgetListImpl() :
   model_ (NULL), conid_updated_ (0),
   selection_changed_freeze_ (0), selection_mode_ (uint64 (SelectionMode::SINGLE)), selection_changed_pending_ (false),
-  first_row_ (-1), last_row_ (-1), multi_sel_range_start_ (-1), insertion_cursor_ (0)
+  first_row_ (-1), last_row_ (-1), multi_sel_range_start_ (-1), max_row_width_ (0), insertion_cursor_ (0)
 {}
 
 WidgetListImpl::~WidgetListImpl()
 {
+  connect_scroll_ports (false);
   // remove model
-  assert_return (model_ == NULL);
+  if (model_)
+    {
+      model_->sig_updated() -= conid_updated_;
+      conid_updated_ = 0;
+      model_ = NULL;
+    }
   // purge widget rows
   for (size_t j = 0; j < widget_rows_.size(); j++)
     destroy_row (widget_rows_.size() - 1 - j); // container.cc is faster destroying from end
@@ -130,9 +315,31 @@ WidgetListImpl::~WidgetListImpl()
 void
 WidgetListImpl::hierarchy_changed (WindowImpl *old_toplevel)
 {
+  connect_scroll_ports (false);
   MultiContainerImpl::hierarchy_changed (old_toplevel);
   if (anchored())
-    queue_visual_update();
+    {
+      connect_scroll_ports (true);
+      queue_visual_update();
+    }
+}
+
+/* Scroll ports move their child without re-allocating it (see ScrollPortImpl::scroll_by_copy),
+ * so model rows are realized for a new visible area only if scrolling is tracked explicitly.
+ */
+void
+WidgetListImpl::connect_scroll_ports (bool connect)
+{
+  for (auto &port : scroll_ports_)
+    port.first->sig_scrolled() -= port.second;
+  scroll_ports_.clear();
+  if (connect)
+    for (ContainerImpl *ancestor = parent(); ancestor; ancestor = ancestor->parent())
+      {
+        ScrollPortImpl *port = dynamic_cast<ScrollPortImpl*> (ancestor);
+        if (port)
+          scroll_ports_.push_back (std::make_pair (port, port->sig_scrolled() += Aida::slot (*this, &WidgetListImpl::visible_rect_changed)));
+      }
 }
 
 void
@@ -157,10 +364,23 @@ WidgetListImpl::bind_model (ListModelIface &model, const String &row_identifier)
       oldmodel->sig_updated() -= conid_updated_;
       conid_updated_ = 0;
     }
+  // purge rows of the old model
+  truncate_rows (0);
+  while (row_pool_.size())
+    {
+      WidgetImplP row = row_pool_.back();
+      row_pool_.pop_back();
+      remove (*row);
+    }
+  row_heights_.clear();
+  selected_rows_.clear();
+  max_row_width_ = 0;
   if (model_)
     {
       conid_updated_ = model_->sig_updated() += Aida::slot (*this, &WidgetListImpl::model_updated);
       row_identifier_ = row_identifier;
+      row_heights_.resize (model_->count());
+      selected_rows_.resize (row_heights_.size());
     }
   else
     row_identifier_ = "";
@@ -187,6 +407,8 @@ WidgetListImpl::create_row (int64 index, const String &widget_identifier, const
 ssize_t
 WidgetListImpl::child_index (WidgetImpl &widget) const
 {
+  if (model_)
+    return widget.parent() == this ? widget.get_data (&row_index_key) : -1;
   for (size_t i = 0; i < widget_rows_.size(); i++)
     if (widget_rows_[i].get() == &widget)
       return i;
@@ -201,8 +423,11 @@ WidgetListImpl::add_child (WidgetImplP widget)
     return error;
   assert_return (widget->parent() == this, __HERE__);
   EventHandler *ehandler = dynamic_cast<EventHandler*> (&*widget);
+  WidgetImpl *row = &*widget; // the handler is owned by row, so avoid a reference cycle
   if (ehandler)
-    ehandler->sig_event() += [this, widget] (const Event &event) -> bool { return this->row_event (event, &*widget); };
+    ehandler->sig_event() += [this, row] (const Event &event) -> bool { return this->row_event (event, row); };
+  if (model_)
+    return "";          // model rows are tracked in realized_rows_ and row_pool_
   insertion_cursor_ = std::max (0U, insertion_cursor_);
   insertion_cursor_ = std::min (size_t (insertion_cursor_), widget_rows_.size()); // e.g. MAXINT appends
   if (insertion_cursor_ >= widget_rows_.size())
@@ -216,6 +441,19 @@ void
 WidgetListImpl::remove_child (WidgetImpl &widget)
 {
   MultiContainerImpl::remove_child (widget);
+  if (model_)
+    {
+      for (auto &row : realized_rows_)
+        if (row.get() == &widget)
+          row = NULL;
+      for (size_t i = 0; i < row_pool_.size(); i++)
+        if (row_pool_[i].get() == &widget)
+          {
+            row_pool_.erase (row_pool_.begin() + i);
+            break;
+          }
+      return;
+    }
   const ssize_t index = child_index (widget);
   if (index >= 0 && widget.parent() == this) // parented
     {
@@ -231,29 +469,101 @@ WidgetListImpl::model_updated (const UpdateRequest &urequest)
     case UpdateKind::READ:
       break;
     case UpdateKind::INSERTION:
-      // destroy_range (urequest.rowspan.start, ~size_t (0));
-      // row_heights_.resize (model_->count(), -1);
-      invalidate_model (true, true);
+      insert_model_rows (urequest.rowspan.start, urequest.rowspan.length);
       break;
     case UpdateKind::CHANGE:
       for (int64 i = urequest.rowspan.start; i < urequest.rowspan.start + urequest.rowspan.length; i++)
         update_row (i);
       break;
     case UpdateKind::DELETION:
-      // destroy_range (urequest.rowspan.start, ~size_t (0));
-      // row_heights_.resize (model_->count(), -1);
-      invalidate_model (true, true);
+      delete_model_rows (urequest.rowspan.start, urequest.rowspan.length);
       break;
     }
+  // guard against models that miss update notifications
+  const int64 mcount = model_ ? model_->count() : 0;
+  if (model_ && mcount != n_rows())
+    {
+      critical ("%s: row count mismatch: model=%d list=%d", __func__, mcount, n_rows());
+      truncate_rows (mcount);
+      row_heights_.resize (mcount);
+      selected_rows_.resize (mcount);
+    }
+  invalidate_size();
+}
+
+void
+WidgetListImpl::insert_model_rows (int64 start, int64 length)
+{
+  const int64 nrows = n_rows();
+  return_unless (length > 0);
+  start = CLAMP (start, 0, nrows);
+  row_heights_.insert (start, length);
+  selected_rows_.insert (selected_rows_.begin() + start, length, false);
+  if (first_row_ < 0)
+    return;
+  if (start <= first_row_)
+    {
+      // realized rows move down, refresh their index and row parity
+      first_row_ += length;
+      last_row_ += length;
+      for (size_t i = 0; i < realized_rows_.size(); i++)
+        if (realized_rows_[i])
+          fill_row (*realized_rows_[i], first_row_ + i);
+    }
+  else if (start <= last_row_)
+    truncate_rows (start);
+}
+
+void
+WidgetListImpl::delete_model_rows (int64 start, int64 length)
+{
+  const int64 nrows = n_rows();
+  return_unless (start >= 0 && start < nrows && length > 0);
+  length = MIN (length, nrows - start);
+  bool selection_changed = false;
+  for (int64 i = start; i < start + length && !selection_changed; i++)
+    selection_changed = selected_rows_[i];
+  if (first_row_ >= 0)
+    {
+      if (start + length <= first_row_)
+        {
+          first_row_ -= length;
+          last_row_ -= length;
+          for (size_t i = 0; i < realized_rows_.size(); i++)
+            if (realized_rows_[i])
+              fill_row (*realized_rows_[i], first_row_ + i);
+        }
+      else if (start <= last_row_)
+        truncate_rows (MAX (start, first_row_));
+    }
+  row_heights_.erase (start, length);
+  selected_rows_.erase (selected_rows_.begin() + start, selected_rows_.begin() + start + length);
+  if (selection_changed)
+    {
+      SelectionChangedGuard selection_changed_guard (*this);
+      notify_selection_changed();
+      validate_selection (start);
+    }
+}
+
+int64
+WidgetListImpl::n_rows () const
+{
+  return model_ ? row_heights_.size() : widget_rows_.size();
+}
+
+WidgetImpl*
+WidgetListImpl::get_row_widget (uint64 idx) const
+{
+  if (model_)
+    return first_row_ >= 0 && idx >= uint64 (first_row_) && idx <= uint64 (last_row_) ? realized_rows_[idx - first_row_].get() : NULL;
+  return idx < widget_rows_.size() ? widget_rows_[idx].get() : NULL;
 }
 
 int64
 WidgetListImpl::row_widget_index (WidgetImpl &widget)
 {
-  for (size_t i = 0; i < widget_rows_.size(); i++)
-    if (widget_rows_[i].get() == &widget)
-      return i;
-  return -1;
+  return child_index (widget);
 }
 
 SelectionMode
@@ -278,6 +588,8 @@ WidgetListImpl::selection_mode (SelectionMode smode)
 bool
 WidgetListImpl::row_selected (uint64 idx) const
 {
+  if (model_)
+    return idx < selected_rows_.size() && selected_rows_[idx];
   WidgetImpl *row = get_row_widget (idx);
   return row && row->test_state (WidgetState::SELECTED);
 }
@@ -286,13 +598,18 @@ void
 WidgetListImpl::row_select_range (size_t first, size_t length, bool selected)
 {
   SelectionChangedGuard selection_changed_guard (*this);
-  const int64 nrows = widget_rows_.size();
+  const int64 nrows = n_rows();
   return_unless (first >= 0 && length >= 0);
   size_t firstrow = ~size_t (0);
   const size_t max_size = min (size_t (first + length), nrows);
   for (size_t i = first; i < max_size; i++)
     if (row_selected (i) != selected)
       {
+        if (model_)
+          {
+            selected_rows_[i] = selected;       // realized row widgets merely mirror selected_rows_
+            notify_selection_changed();
+          }
         WidgetImpl *row = get_row_widget (i);
         SelectableItemImpl *selectable = dynamic_cast<SelectableItemImpl*> (row);
         if (selectable)
@@ -306,7 +623,7 @@ void
 WidgetListImpl::deselect_rows ()
 {
   SelectionChangedGuard selection_changed_guard (*this);
-  const int64 nrows = widget_rows_.size();
+  const int64 nrows = n_rows();
   for (ssize_t i = 0; i < nrows; i++)
     if (row_selected (i))
       row_select (i, false);
@@ -316,7 +633,7 @@ void
 WidgetListImpl::set_selection (const BoolSeq &bseq)
 {
   SelectionChangedGuard selection_changed_guard (*this);
-  const int64 nrows = widget_rows_.size();
+  const int64 nrows = n_rows();
   size_t firstrow = ~size_t (0);
   const size_t max_size = min (bseq.size(), nrows);
   for (size_t i = 0; i < max_size; i++)
@@ -331,7 +648,7 @@ WidgetListImpl::set_selection (const BoolSeq &bseq)
 BoolSeq
 WidgetListImpl::get_selection ()
 {
-  const int64 nrows = widget_rows_.size();
+  const int64 nrows = n_rows();
   BoolSeq bseq;
   bseq.resize (nrows);
   for (ssize_t i = 0; i < nrows; i++)
@@ -343,7 +660,7 @@ bool
 WidgetListImpl::validate_selection (int fallback)
 {
   SelectionChangedGuard selection_changed_guard (*this);
-  const int64 nrows = widget_rows_.size();
+  const int64 nrows = n_rows();
   // ensure a valid selection
   bool changed = false;
   ssize_t first = -1;
@@ -388,7 +705,7 @@ void
 WidgetListImpl::change_selection (const int current, int previous, const bool toggle, const bool range, const bool preserve)
 {
   SelectionChangedGuard selection_changed_guard (*this);
-  const int64 nrows = widget_rows_.size();
+  const int64 nrows = n_rows();
   return_unless (nrows > 0);
   return_unless (previous < nrows);
   return_unless (current < nrows);
@@ -455,6 +772,13 @@ WidgetListImpl::notify_selection_changed()
 void
 WidgetListImpl::selectable_child_changed (WidgetChain &chain)
 {
+  const int64 index = model_ && chain.widget ? child_index (*chain.widget) : -1;
+  if (index >= 0 && index < n_rows())
+    {
+      const bool selected = chain.widget->selected();
+      return_unless (selected != selected_rows_[index]); // row widget got synced to selected_rows_
+      selected_rows_[index] = selected;
+    }
   notify_selection_changed();
   // since we emit notification, there's no need to propagate this further up
 }
@@ -462,7 +786,7 @@ WidgetListImpl::selectable_child_changed (WidgetChain &chain)
 void
 WidgetListImpl::invalidate_model (bool invalidate_heights, bool invalidate_widgets)
 {
-  // FIXME: reset all cached row_heights_ here?
+  // row_heights_ and realized rows are reset by bind_model()
   invalidate_size();
   invalidate_content();
 }
@@ -473,6 +797,26 @@ WidgetListImpl::size_request (Requisition &requisition)
   bool chspread = false, cvspread = false;
   requisition.width = 0;
   requisition.height = 0;
+  if (model_)
+    {
+      // measure a first row to estimate the height of unrealized rows
+      if (realized_rows_.empty() && n_rows() > 0 && row_heights_.measured (0) < 0)
+        {
+          realize_range (0, 0);
+          measure_realized_rows();
+        }
+      for (auto child : realized_rows_)
+        if (child && child->visible())
+          {
+            chspread |= child->hspread();
+            cvspread |= child->vspread();
+          }
+      requisition.width = max_row_width_;
+      requisition.height = MIN (row_heights_.total(), INT32_MAX);
+      set_flag (HSPREAD_CONTAINER, chspread);
+      set_flag (VSPREAD_CONTAINER, cvspread);
+      return;
+    }
   for (auto child : widget_rows_)
     {
       if (!child || !child->visible())
@@ -490,6 +834,30 @@ WidgetListImpl::size_request (Requisition &requisition)
 void
 WidgetListImpl::size_allocate (Allocation area)
 {
+  if (model_)
+    {
+      /* Realize only the rows that intersect the visible area (plus some overscan for
+       * scrolling), measuring rows may shift the visible range, so iterate a few times.
+       */
+      for (uint pass = 0; pass < 3; pass++)
+        {
+          const IRect visible = visible_rect();
+          int first = -1, last = -1;
+          if (n_rows() > 0 && visible.width > 0 && visible.height > 0)
+            {
+              const int overscan = MAX (visible.height / 2, row_heights_.estimate());
+              first = row_heights_.row_at (visible.y - overscan);
+              last = row_heights_.row_at (int64 (visible.y) + visible.height + overscan);
+            }
+          const bool realized = realize_range (first, last);
+          const bool measured = measure_realized_rows();
+          if (!realized && !measured)
+            break;
+        }
+      allocate_realized_rows();
+      tune_requisition (max_row_width_, MIN (row_heights_.total(), INT32_MAX));
+      return;
+    }
   const Allocation list_area = allocation();
   int64 list_y = list_area.y;
   for (auto child : widget_rows_)
@@ -508,6 +876,131 @@ WidgetListImpl::size_allocate (Allocation area)
     }
 }
 
+/// Determine the part of the list allocation not clipped by ancestors.
+IRect
+WidgetListImpl::visible_rect ()
+{
+  IRect area = rect_to_viewport (allocation());
+  for (ContainerImpl *ancestor = parent(); ancestor; ancestor = ancestor->parent())
+    area.intersect (ancestor->rect_to_viewport (ancestor->allocation()));
+  return rect_from_viewport (area);
+}
+
+/// Re-allocate model rows if the visible part of the list is not fully realized.
+void
+WidgetListImpl::visible_rect_changed ()
+{
+  return_unless (model_ && !test_any (INVALID_ALLOCATION));
+  const IRect visible = visible_rect();
+  return_unless (n_rows() > 0 && visible.width > 0 && visible.height > 0);
+  const int first = row_heights_.row_at (visible.y);
+  const int last = row_heights_.row_at (int64 (visible.y) + visible.height - 1);
+  if (first_row_ < 0 || first < first_row_ || last > last_row_)
+    invalidate_allocation();
+}
+
+/// Adjust realized_rows_ to cover rows @a first .. @a last, returns whether rows were (un-)realized.
+bool
+WidgetListImpl::realize_range (int first, int last)
+{
+  const int old_first = first_row_, old_last = last_row_;
+  if (first < 0 || last < first)
+    {
+      truncate_rows (0);
+      return old_first != first_row_;
+    }
+  // recycle rows outside of the new range
+  while (!realized_rows_.empty() && first_row_ < first)
+    {
+      recycle_row (realized_rows_.front());
+      realized_rows_.pop_front();
+      first_row_++;
+    }
+  while (!realized_rows_.empty() && last_row_ > last)
+    {
+      recycle_row (realized_rows_.back());
+      realized_rows_.pop_back();
+      last_row_--;
+    }
+  if (realized_rows_.empty())
+    {
+      first_row_ = first;
+      last_row_ = first - 1;
+    }
+  // realize missing rows, fetching their data with one model call per side
+  if (first_row_ > first)
+    {
+      const AnySeq data = model_->rows (first, first_row_ - first);
+      while (first_row_ > first)
+        {
+          const size_t i = --first_row_ - first;
+          realized_rows_.push_front (realize_row (first_row_, i < data.size() ? &data[i] : NULL));
+        }
+    }
+  if (last_row_ < last)
+    {
+      const int start = last_row_ + 1;
+      const AnySeq data = model_->rows (start, last - last_row_);
+      while (last_row_ < last)
+        {
+          const size_t i = ++last_row_ - start;
+          realized_rows_.push_back (realize_row (last_row_, i < data.size() ? &data[i] : NULL));
+        }
+    }
+  return old_first != first_row_ || old_last != last_row_;
+}
+
+/// Recycle all realized rows from index @a first onwards.
+void
+WidgetListImpl::truncate_rows (int first)
+{
+  while (!realized_rows_.empty() && last_row_ >= MAX (first, first_row_))
+    {
+      recycle_row (realized_rows_.back());
+      realized_rows_.pop_back();
+      last_row_--;
+    }
+  if (realized_rows_.empty())
+    first_row_ = last_row_ = -1;
+}
+
+/// Update row_heights_ from the realized rows, returns whether any height changed.
+bool
+WidgetListImpl::measure_realized_rows ()
+{
+  bool changed = false;
+  for (size_t i = 0; i < realized_rows_.size(); i++)
+    {
+      WidgetImpl *row = realized_rows_[i].get();
+      if (!row)
+        continue;
+      const Requisition crq = size_request_child (*row);
+      max_row_width_ = MAX (max_row_width_, crq.width);
+      changed |= row_heights_.measure (first_row_ + i, crq.height);
+    }
+  return changed;
+}
+
+void
+WidgetListImpl::allocate_realized_rows ()
+{
+  const Allocation list_area = allocation();
+  for (size_t i = 0; i < realized_rows_.size(); i++)
+    {
+      WidgetImpl *row = realized_rows_[i].get();
+      if (!row || !row->visible())
+        continue;
+      const int64 index = first_row_ + i;
+      Allocation carea;
+      carea.x = list_area.x;
+      carea.width = list_area.width;
+      carea.y = list_area.y + row_heights_.offset (index);
+      carea.height = row_heights_.height (index);
+      carea = layout_child (*row, carea); // handles spacing/alignment
+      row->set_child_allocation (carea);
+    }
+}
+
 int
 WidgetListImpl::focus_row()
 {
@@ -519,14 +1012,25 @@ bool
 WidgetListImpl::grab_row_focus (int next_focus, int old_focus)
 {
   WidgetImpl *row = get_row_widget (next_focus);
+  if (!row && model_ && next_focus >= 0 && next_focus < n_rows())
+    {
+      // realize rows around the new focus row, the next size_allocate() adjusts the range
+      const int span = MAX (0, last_row_ - first_row_) / 2;
+      realize_range (MAX (0, next_focus - span), MIN (n_rows() - 1, next_focus + span));
+      measure_realized_rows();
+      allocate_realized_rows();
+      invalidate_size();
+      row = get_row_widget (next_focus);
+    }
   bool success;
   if (row && row->grab_focus())                 // assign new focus
     success = true;
   else
     {
       row = get_row_widget (old_focus);
-      if (row && row->test_any (FOCUS_CHAIN))
-        get_window()->unset_focus();            // or no row gets focus
+      WindowImpl *window = row && row->test_any (FOCUS_CHAIN) ? get_window() : NULL;
+      if (window)
+        window->unset_focus();                  // or no row gets focus
       success = false;
     }
   const int current_focus = success ? focus_row () : -1;
@@ -566,7 +1070,7 @@ WidgetListImpl::move_focus (FocusDir fdir)
 bool
 WidgetListImpl::key_press_event (const EventKey &event)
 {
-  const int64 nrows = widget_rows_.size();
+  const int64 nrows = n_rows();
   bool handled = false;
   bool preserve_old_selection = event.key_state & MOD_CONTROL;
   bool toggle_selection = false, range_selection = event.key_state & MOD_SHIFT;
@@ -600,9 +1104,8 @@ WidgetListImpl::key_press_event (const EventKey &event)
       if (first_row_ >= 0 && last_row_ >= first_row_ && last_row_ < nrows)
         {
           // See KEY_Page_Down comment.
-          const Allocation list_area = allocation();
-          const int delta = list_area.height; // - row_height (current_focus) - 1;
-          const int jumprow = 0 * delta; // vscroll_relative_row (current_focus, -MAX (0, delta)) + 1;
+          const int delta = visible_rect().height - row_heights_.height (current_focus) - 1;
+          const int jumprow = model_ ? row_heights_.row_at (row_heights_.offset (current_focus) - MAX (0, delta)) + 1 : 0;
           current_focus = CLAMP (MIN (jumprow, current_focus - 1), 0, nrows - 1);
         }
       handled = true;
@@ -615,9 +1118,8 @@ WidgetListImpl::key_press_event (const EventKey &event)
            * to fit the target row fully. Also make sure to jump by at least single row so we keep
            * moving regardless of view height (which might be less than current_row height).
            */
-          const Allocation list_area = allocation();
-          const int delta = list_area.height; //  - row_height (current_focus) - 1;
-          const int jumprow = 0 * delta; // vscroll_relative_row (current_focus, +MAX (0, delta)) - 1;
+          const int delta = visible_rect().height - row_heights_.height (current_focus) - 1;
+          const int jumprow = model_ ? row_heights_.row_at (row_heights_.offset (current_focus + 1) + MAX (0, delta)) - 1 : 0;
           current_focus = CLAMP (MAX (jumprow, current_focus + 1), 0, nrows - 1);
         }
       handled = true;
@@ -704,51 +1206,96 @@ WidgetListImpl::update_row (uint64 index)
 {
   // bail out if there's no model to update from
   return_unless (model_ != NULL);
-  const uint64 mcount = model_->count();
-  return_unless (index < mcount);
-  // ensure the row has a widget
-  HBoxImpl *hbox;
-  if (widget_rows_.size() < mcount)
-    widget_rows_.resize (mcount);
-  WidgetImpl* row = get_row_widget (index);
+  return_unless (index < uint64 (n_rows()));
+  WidgetImpl *row = get_row_widget (index);
+  if (row)
+    fill_row (*row, index);
+  else
+    row_heights_.unmeasure (index);     // remeasure once realized
+}
+
+WidgetImplP
+WidgetListImpl::create_row_widget ()
+{
+  WidgetImplP row = Factory::create_ui_child (*this, row_identifier_, Factory::ArgumentList(), false);
   if (!row)
     {
-      Any vany = model_->row (index);
-      WidgetImplP widget = Factory::create_ui_child (*this, row_identifier_, Factory::ArgumentList(), false);
-      if (widget)
-        widget_rows_[index] = widget;
-      row = get_row_widget (index);
-      if (!row)
-        {
-          user_warning (UserSource ("Rapicorn", __FILE__, __LINE__), "%s: failed to create list row widget: %s", __func__, row_identifier_); // FIXME
-          return; // FIXME: add UI error widget?
-        }
-      hbox = row->interface<HBoxImpl*>();
-      if (hbox)
-        {
-          hbox->spacing (5); // FIXME
-          while (size_groups_.size() < hbox->n_children())
-            size_groups_.push_back (WidgetGroup::create (" Rapicorn.WidgetListImpl.SizeGroup-HORIZONTAL", WIDGET_GROUP_HSIZE));
-          size_t i = 0;
-          for (auto descendant : *hbox)
-            size_groups_[i++]->add_widget (*descendant);
-        }
-      add (*row);
+      user_warning (UserSource ("Rapicorn", __FILE__, __LINE__), "%s: failed to create list row widget: %s", __func__, row_identifier_); // FIXME
+      return NULL; // FIXME: add UI error widget?
     }
-  else
-    hbox = row->interface<HBoxImpl*>();
-  // update column contents
-  // FIXME: needed? if (row->row_index() != ssize_t (index)) row->row_index (index);
+  HBoxImpl *hbox = row->interface<HBoxImpl*>();
+  if (hbox)
+    {
+      hbox->spacing (5); // FIXME
+      while (size_groups_.size() < hbox->n_children())
+        size_groups_.push_back (WidgetGroup::create (" Rapicorn.WidgetListImpl.SizeGroup-HORIZONTAL", WIDGET_GROUP_HSIZE));
+      size_t i = 0;
+      for (auto descendant : *hbox)
+        size_groups_[i++]->add_widget (*descendant);
+    }
+  return row;
+}
+
+/// Assign model row @a index to @a row, updating contents, row parity and selection state.
+void
+WidgetListImpl::fill_row (WidgetImpl &row, uint64 index, const Any *data)
+{
+  row.set_data (&row_index_key, int64 (index));
+  HBoxImpl *hbox = row.interface<HBoxImpl*>();
   if (hbox)
     {
-      Any dat = model_->row (index);
+      const Any dat = data ? *data : model_->row (index);
       for (auto descendant : *hbox)
         descendant->set_property ("markup_text", dat.to_string());
-      AmbienceIface *ambience = row->interface<AmbienceIface*>();
+      AmbienceIface *ambience = row.interface<AmbienceIface*>();
       if (ambience)
         ambience->background (index & 1 ? "background-odd" : "background-even");
-      row_select (index, row_selected (index));
     }
+  SelectableItemImpl *selectable = dynamic_cast<SelectableItemImpl*> (&row);
+  if (selectable)
+    selectable->selected (row_selected (index));
+}
+
+/// Provide a widget for model row @a index, reusing pooled rows if possible.
+WidgetImplP
+WidgetListImpl::realize_row (uint64 index, const Any *data)
+{
+  WidgetImplP row;
+  if (row_pool_.size())
+    {
+      row = row_pool_.back();
+      row_pool_.pop_back();
+      fill_row (*row, index, data);
+      row->visible (true);
+    }
+  else
+    {
+      row = create_row_widget();
+      if (row)
+        {
+          fill_row (*row, index, data);
+          add (*row);
+        }
+    }
+  return row;
+}
+
+/// Hide @a row and keep it for later reuse, or destroy it if enough rows are pooled.
+void
+WidgetListImpl::recycle_row (WidgetImplP row)
+{
+  return_unless (row != NULL);
+  row->delete_data (&row_index_key);
+  WindowImpl *window = row->has_focus() ? get_window() : NULL;
+  if (window)
+    window->unset_focus();
+  if (row_pool_.size() < MAX (size_t (16), realized_rows_.size()))
+    {
+      row->visible (false);
+      row_pool_.push_back (row);
+    }
+  else
+    remove (*row);
 }
 
 void
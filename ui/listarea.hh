@@ -28,24 +28,74 @@ public:
 typedef std::shared_ptr<SelectableItemImpl> SelectableItemImplP;
 
 
+/// Row height bookkeeping for virtualized lists, with O(log n) offset and row lookups.
+class ListRowHeights {
+  vector<int>           heights_;       // measured row heights or -1
+  vector<int64>         height_tree_;   // Fenwick tree over measured heights
+  vector<int>           count_tree_;    // Fenwick tree over the number of measured rows
+  int64                 measured_sum_;
+  size_t                n_measured_;
+  int                   default_estimate_;
+  bool                  dirty_;         // trees need rebuilding after insert() or erase()
+  void                  rebuild         ();
+  void                  tree_add        (size_t row, int64 dheight, int dcount);
+public:
+  explicit              ListRowHeights  (int default_estimate = 1);
+  size_t                size            () const                { return heights_.size(); }
+  void                  clear           ();
+  void                  resize          (size_t n_rows);
+  void                  insert          (size_t row, size_t n_rows);
+  void                  erase           (size_t row, size_t n_rows);
+  int                   measured        (size_t row) const      { return row < heights_.size() ? heights_[row] : -1; }
+  bool                  measure         (size_t row, int height);
+  void                  unmeasure       (size_t row);
+  int                   estimate        () const;
+  int                   height          (size_t row) const;
+  int64                 offset          (size_t row);
+  size_t                row_at          (int64 y);
+  int64                 total           ()                      { return offset (size()); }
+};
+
+class ScrollPortImpl;
+
 class WidgetListImpl : public virtual MultiContainerImpl,
                        public virtual WidgetListIface,
                        public virtual EventHandler
 {
   ListModelIfaceP        model_;
   String                 row_identifier_;
-  vector<WidgetImplP>    widget_rows_; // FIXME: rename and merge w MultiContainer
+  vector<WidgetImplP>    widget_rows_; // rows added via create_row(), unused for model rows
+  std::deque<WidgetImplP> realized_rows_; // model rows first_row_..last_row_
+  vector<WidgetImplP>    row_pool_;     // hidden model row widgets, kept for recycling
+  ListRowHeights         row_heights_;
+  vector<bool>           selected_rows_;
   size_t                 conid_updated_;
+  vector<std::pair<ScrollPortImpl*,size_t>> scroll_ports_; // ancestors whose sig_scrolled is connected
   vector<WidgetGroupP>   size_groups_;
   uint                  selection_changed_freeze_ : 20;
   uint                  selection_mode_ : 8;
   uint                  selection_changed_pending_ : 1;
   int                   first_row_, last_row_, multi_sel_range_start_;
+  int                   max_row_width_;
   uint                  insertion_cursor_;
   void                  model_updated           (const UpdateRequest &ur);
-  WidgetImpl*           get_row_widget          (uint64 idx) const { return idx < widget_rows_.size() ? widget_rows_[idx].get() : NULL; }
+  int64                 n_rows                  () const;
+  WidgetImpl*           get_row_widget          (uint64 idx) const;
   int64                 row_widget_index        (WidgetImpl &widget);
   void                  destroy_row             (uint64 index);
+  WidgetImplP           create_row_widget       ();
+  void                  fill_row                (WidgetImpl &row, uint64 index, const Any *data = NULL);
+  WidgetImplP           realize_row             (uint64 index, const Any *data);
+  void                  recycle_row             (WidgetImplP row);
+  void                  truncate_rows           (int first);
+  bool                  realize_range           (int first, int last);
+  bool                  measure_realized_rows   ();
+  void                  allocate_realized_rows  ();
+  IRect                 visible_rect            ();
+  void                  visible_rect_changed    ();
+  void                  connect_scroll_ports    (bool connect);
+  void                  insert_model_rows       (int64 start, int64 length);
+  void                  delete_model_rows       (int64 start, int64 length);
   void                  row_select_range        (size_t first, size_t length, bool selected);
   void                  row_select              (uint64 idx, bool selected) { row_select_range (idx, 1, selected); }
   bool                  row_selected            (uint64 idx) const;
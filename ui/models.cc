@@ -1,9 +1,309 @@
 // This Source Code Form is licensed MPL-2.0: http://mozilla.org/MPL/2.0
 #include "models.hh"
 #include "application.hh"
+#include <algorithm>
 
 namespace Rapicorn {
 
+// == ListColumnStore::Column ==
+void
+ListColumnStore::Column::rekind (Aida::TypeKind kind)
+{
+  const size_t n = size();
+  if (kind == Aida::ANY)        // mixed cell types, box everything
+    {
+      vector<Any> anys (n);
+      for (size_t i = 0; i < n; i++)
+        anys[i] = get (i);
+      vector<int64>().swap (ints_);
+      vector<double>().swap (doubles_);
+      vector<String>().swap (strings_);
+      anys_.swap (anys);
+    }
+  else
+    {
+      assert_return (kind_ == Aida::UNTYPED);
+      switch (kind)
+        {
+        case Aida::BOOL:
+        case Aida::INT64:       ints_.assign (n, 0);            break;
+        case Aida::FLOAT64:     doubles_.assign (n, 0);         break;
+        case Aida::STRING:      strings_.assign (n, "");        break;
+        default:                assert_unreached();
+        }
+    }
+  kind_ = kind;
+}
+
+void
+ListColumnStore::Column::insert (size_t row, size_t n_rows)
+{
+  valid_.insert (valid_.begin() + row, n_rows, false);
+  switch (kind_)
+    {
+    case Aida::BOOL:
+    case Aida::INT64:   ints_.insert (ints_.begin() + row, n_rows, 0);          break;
+    case Aida::FLOAT64: doubles_.insert (doubles_.begin() + row, n_rows, 0);    break;
+    case Aida::STRING:  strings_.insert (strings_.begin() + row, n_rows, "");   break;
+    case Aida::ANY:     anys_.insert (anys_.begin() + row, n_rows, Any());      break;
+    default: ;
+    }
+}
+
+void
+ListColumnStore::Column::erase (size_t row, size_t n_rows)
+{
+  valid_.erase (valid_.begin() + row, valid_.begin() + row + n_rows);
+  switch (kind_)
+    {
+    case Aida::BOOL:
+    case Aida::INT64:   ints_.erase (ints_.begin() + row, ints_.begin() + row + n_rows);                break;
+    case Aida::FLOAT64: doubles_.erase (doubles_.begin() + row, doubles_.begin() + row + n_rows);       break;
+    case Aida::STRING:  strings_.erase (strings_.begin() + row, strings_.begin() + row + n_rows);       break;
+    case Aida::ANY:     anys_.erase (anys_.begin() + row, anys_.begin() + row + n_rows);                break;
+    default: ;
+    }
+}
+
+/// Move all cells from @a row onwards into @a tail.
+void
+ListColumnStore::Column::split (size_t row, Column &tail)
+{
+  tail.kind_ = kind_;
+  tail.valid_.assign (valid_.begin() + row, valid_.end());
+  valid_.resize (row);
+  switch (kind_)
+    {
+    case Aida::BOOL:
+    case Aida::INT64:
+      tail.ints_.assign (ints_.begin() + row, ints_.end());
+      ints_.resize (row);
+      break;
+    case Aida::FLOAT64:
+      tail.doubles_.assign (doubles_.begin() + row, doubles_.end());
+      doubles_.resize (row);
+      break;
+    case Aida::STRING:
+      tail.strings_.assign (std::make_move_iterator (strings_.begin() + row), std::make_move_iterator (strings_.end()));
+      strings_.resize (row);
+      break;
+    case Aida::ANY:
+      tail.anys_.assign (std::make_move_iterator (anys_.begin() + row), std::make_move_iterator (anys_.end()));
+      anys_.resize (row);
+      break;
+    default: ;
+    }
+}
+
+Any
+ListColumnStore::Column::get (size_t row) const
+{
+  if (!valid_[row])
+    return Any();
+  switch (kind_)
+    {
+    case Aida::BOOL:    return Any (bool (ints_[row]));
+    case Aida::INT64:   return Any (ints_[row]);
+    case Aida::FLOAT64: return Any (doubles_[row]);
+    case Aida::STRING:  return Any (strings_[row]);
+    case Aida::ANY:     return anys_[row];
+    default:            return Any();
+    }
+}
+
+void
+ListColumnStore::Column::set (size_t row, const Any &value)
+{
+  const Aida::TypeKind vkind = value.kind();
+  if (vkind == Aida::UNTYPED)
+    {
+      valid_[row] = false;
+      if (kind_ == Aida::STRING)
+        strings_[row].clear();
+      else if (kind_ == Aida::ANY)
+        anys_[row].clear();
+      return;
+    }
+  const bool typed = vkind == Aida::BOOL || vkind == Aida::INT64 || vkind == Aida::FLOAT64 || vkind == Aida::STRING;
+  const Aida::TypeKind kind = typed ? vkind : Aida::ANY;
+  if (kind_ != kind && kind_ != Aida::ANY)
+    rekind (kind_ == Aida::UNTYPED ? kind : Aida::ANY);
+  valid_[row] = true;
+  switch (kind_)
+    {
+    case Aida::BOOL:    ints_[row] = value.get<bool>();         break;
+    case Aida::INT64:   ints_[row] = value.get<int64>();        break;
+    case Aida::FLOAT64: doubles_[row] = value.get<double>();    break;
+    case Aida::STRING:  strings_[row] = value.get<String>();    break;
+    default:            anys_[row] = value;                     break;
+    }
+}
+
+// == ListColumnStore ==
+/** Create a store for rows of @a n_columns cells.
+ * Cells are kept in typed per-column arrays (bool, int64, double, String) instead of
+ * a boxed Any per row, columns with mixed cell types fall back to Any storage.
+ */
+ListColumnStore::ListColumnStore (uint n_columns) :
+  n_rows_ (0), n_columns_ (MAX (1, n_columns))
+{}
+
+size_t
+ListColumnStore::find_chunk (size_t row) const
+{
+  auto it = std::upper_bound (offsets_.begin(), offsets_.end(), row);
+  return it - offsets_.begin() - 1;
+}
+
+void
+ListColumnStore::update_offsets (size_t first_chunk)
+{
+  offsets_.resize (chunks_.size());
+  for (size_t i = first_chunk; i < chunks_.size(); i++)
+    offsets_[i] = i ? offsets_[i - 1] + chunks_[i - 1].n_rows : 0;
+}
+
+/// Ensure the store has at least @a n_columns columns.
+void
+ListColumnStore::add_columns (uint n_columns)
+{
+  return_unless (n_columns > n_columns_);
+  for (auto &chunk : chunks_)
+    chunk.columns.resize (n_columns, Column (chunk.n_rows));
+  n_columns_ = n_columns;
+}
+
+/// Insert @a n_rows empty rows before @a row.
+void
+ListColumnStore::insert (size_t row, size_t n_rows)
+{
+  return_unless (n_rows > 0);
+  row = MIN (row, n_rows_);
+  if (chunks_.empty())
+    {
+      chunks_.push_back (Chunk (n_columns_));
+      offsets_.push_back (0);
+    }
+  const size_t c = row == n_rows_ ? chunks_.size() - 1 : find_chunk (row);
+  Chunk &chunk = chunks_[c];
+  for (auto &column : chunk.columns)
+    column.insert (row - offsets_[c], n_rows);
+  chunk.whole.insert (chunk.whole.begin() + (row - offsets_[c]), n_rows, false);
+  chunk.n_rows += n_rows;
+  n_rows_ += n_rows;
+  // split oversized chunks from the end, so each split moves CHUNK_ROWS cells at most
+  vector<Chunk> tails;
+  while (chunk.n_rows >= 2 * CHUNK_ROWS)
+    {
+      Chunk tail (n_columns_);
+      const size_t at = chunk.n_rows - CHUNK_ROWS;
+      for (size_t i = 0; i < n_columns_; i++)
+        chunk.columns[i].split (at, tail.columns[i]);
+      tail.whole.assign (chunk.whole.begin() + at, chunk.whole.end());
+      chunk.whole.resize (at);
+      tail.n_rows = CHUNK_ROWS;
+      chunk.n_rows = at;
+      tails.push_back (std::move (tail));
+    }
+  chunks_.insert (chunks_.begin() + c + 1, std::make_move_iterator (tails.rbegin()), std::make_move_iterator (tails.rend()));
+  update_offsets (c);
+}
+
+/// Remove @a n_rows rows starting at @a row.
+void
+ListColumnStore::erase (size_t row, size_t n_rows)
+{
+  return_unless (row < n_rows_);
+  n_rows = MIN (n_rows, n_rows_ - row);
+  const size_t first_chunk = find_chunk (row);
+  size_t crow = row - offsets_[first_chunk];
+  for (size_t c = first_chunk; n_rows > 0; c++)
+    {
+      Chunk &chunk = chunks_[c];
+      const size_t n = MIN (n_rows, chunk.n_rows - crow);
+      for (auto &column : chunk.columns)
+        column.erase (crow, n);
+      chunk.whole.erase (chunk.whole.begin() + crow, chunk.whole.begin() + crow + n);
+      chunk.n_rows -= n;
+      n_rows_ -= n;
+      n_rows -= n;
+      crow = 0;
+    }
+  chunks_.erase (std::remove_if (chunks_.begin() + first_chunk, chunks_.end(), [] (const Chunk &chunk) { return chunk.n_rows == 0; }),
+                 chunks_.end());
+  update_offsets (first_chunk);
+}
+
+Any
+ListColumnStore::cell (size_t row, uint column) const
+{
+  assert_return (row < n_rows_, Any());
+  return_unless (column < n_columns_, Any());
+  const size_t c = find_chunk (row);
+  return chunks_[c].columns[column].get (row - offsets_[c]);
+}
+
+void
+ListColumnStore::set_cell (size_t row, uint column, const Any &value)
+{
+  assert_return (row < n_rows_);
+  add_columns (column + 1);
+  const size_t c = find_chunk (row);
+  chunks_[c].columns[column].set (row - offsets_[c], value);
+  chunks_[c].whole[row - offsets_[c]] = false;
+}
+
+/// Retrieve a row, i.e. the value assigned with set_row() or a sequence of all cells for multi-column stores.
+Any
+ListColumnStore::row (size_t row) const
+{
+  assert_return (row < n_rows_, Any());
+  const size_t c = find_chunk (row), crow = row - offsets_[c];
+  const Chunk &chunk = chunks_[c];
+  if (chunk.whole[crow] || n_columns_ == 1)
+    return chunk.columns[0].get (crow);
+  Any::AnyVector cells (n_columns_);
+  for (size_t i = 0; i < n_columns_; i++)
+    cells[i] = chunk.columns[i].get (crow);
+  Any any;
+  any.set (cells);
+  return any;
+}
+
+/** Assign a row, sequences with one element per column are distributed across columns.
+ * Other values are kept unsplit in the first column, so row() returns them unaltered.
+ */
+void
+ListColumnStore::set_row (size_t row, const Any &value)
+{
+  assert_return (row < n_rows_);
+  const size_t c = find_chunk (row), crow = row - offsets_[c];
+  Chunk &chunk = chunks_[c];
+  const Any::AnyVector *cells = n_columns_ > 1 && value.kind() == Aida::SEQUENCE ? value.get<const Any::AnyVector*>() : NULL;
+  if (cells && cells->size() != n_columns_)
+    cells = NULL;
+  for (size_t i = 0; i < n_columns_; i++)
+    if (cells)
+      chunk.columns[i].set (crow, (*cells)[i]);
+    else
+      chunk.columns[i].set (crow, i == 0 ? value : Any());
+  chunk.whole[crow] = !cells;
+}
+
+/// Retrieve up to @a count rows starting at @a first.
+AnySeq
+ListColumnStore::rows (size_t first, size_t count) const
+{
+  AnySeq aseq;
+  return_unless (first < n_rows_, aseq);
+  count = MIN (count, n_rows_ - first);
+  aseq.reserve (count);
+  for (size_t i = first; i < first + count; i++)
+    aseq.push_back (row (i));
+  return aseq;
+}
+
+// == ListModelRelayImpl ==
 ListModelRelayImpl::ListModelRelayImpl () :
   model_ (std::make_shared<RelayModel>())
 {}
@@ -17,7 +317,13 @@ Any
 ListModelRelayImpl::RelayModel::row (int r)
 {
   const size_t row = r;
-  return r >= 0 && row < rows_.size() ? rows_[row] : Any();
+  return r >= 0 && row < store_.count() ? store_.row (row) : Any();
+}
+
+AnySeq
+ListModelRelayImpl::RelayModel::rows (int first, int count)
+{
+  return first >= 0 && count > 0 ? store_.rows (first, count) : AnySeq();
 }
 
 void
@@ -35,7 +341,7 @@ ListModelRelayImpl::update (const UpdateRequest &urequest)
       assert_return (urequest.rowspan.start >= 0);
       assert_return (urequest.rowspan.start <= model_->count());
       assert_return (urequest.rowspan.length >= 0);
-      model_->rows_.insert (model_->rows_.begin() + urequest.rowspan.start, urequest.rowspan.length, Any());
+      model_->store_.insert (urequest.rowspan.start, urequest.rowspan.length);
       model_->sig_updated.emit (urequest);
       refill (urequest.rowspan.start, urequest.rowspan.length);
       break;
@@ -51,7 +357,7 @@ ListModelRelayImpl::update (const UpdateRequest &urequest)
       assert_return (urequest.rowspan.start <= model_->count());
       assert_return (urequest.rowspan.length >= 0);
       assert_return (urequest.rowspan.start + urequest.rowspan.length <= model_->count());
-      model_->rows_.erase (model_->rows_.begin() + urequest.rowspan.start, model_->rows_.begin() + urequest.rowspan.start + urequest.rowspan.length);
+      model_->store_.erase (urequest.rowspan.start, urequest.rowspan.length);
       model_->sig_updated.emit (urequest);
       break;
     case UpdateKind::READ: ;
@@ -65,12 +371,32 @@ ListModelRelayImpl::fill (int first, const AnySeq &anyseq)
   if (first >= model_->count())
     return;
   size_t i;
-  for (i = 0; i < anyseq.size() && first + i < model_->rows_.size(); i++)
-    model_->rows_[first + i] = anyseq[i];
+  for (i = 0; i < anyseq.size() && first + i < model_->store_.count(); i++)
+    model_->store_.set_row (first + i, anyseq[i]);
   if (i)
     emit_updated (UpdateKind::CHANGE, first, i);
 }
 
+void
+ListModelRelayImpl::fill_columns (int first, const AnySeqSeq &columns)
+{
+  assert_return (first >= 0);
+  if (first >= model_->count())
+    return;
+  model_->store_.add_columns (columns.size());
+  size_t length = 0;
+  for (size_t c = 0; c < columns.size(); c++)
+    {
+      const AnySeq &column = columns[c];
+      size_t i;
+      for (i = 0; i < column.size() && first + i < model_->store_.count(); i++)
+        model_->store_.set_cell (first + i, c, column[i]);
+      length = MAX (length, i);
+    }
+  if (length)
+    emit_updated (UpdateKind::CHANGE, first, length);
+}
+
 void
 ListModelRelayImpl::refill (int start, int length)
 {
@@ -96,7 +422,7 @@ ApplicationImpl::create_list_model_relay ()
 }
 
 MemoryListStore::MemoryListStore (int n_columns) :
-  columns_ (n_columns)
+  store_ (MAX (1, n_columns))
 {
   assert_return (n_columns > 0);
 }
@@ -105,42 +431,49 @@ Any
 MemoryListStore::row (int n)
 {
   if (n < 0)
-    n = rows_.size() + n;
-  assert_return (size_t (n) < rows_.size(), Any());
-  return rows_[n];
+    n = store_.count() + n;
+  assert_return (size_t (n) < store_.count(), Any());
+  return store_.row (n);
+}
+
+AnySeq
+MemoryListStore::rows (int first, int count)
+{
+  return first >= 0 && count > 0 ? store_.rows (first, count) : AnySeq();
 }
 
 void
 MemoryListStore::emit_updated (UpdateKind kind, uint start, uint length)
 {
-  sig_updated.emit (UpdateRequest (kind, UpdateSpan (start, length), UpdateSpan (0, columns_)));
+  sig_updated.emit (UpdateRequest (kind, UpdateSpan (start, length), UpdateSpan (0, store_.n_columns())));
 }
 
 void
 MemoryListStore::insert (int n, const Any &any)
 {
   assert_return (n >= -1);
-  assert_return (n <= signed (rows_.size()));
+  assert_return (n <= signed (store_.count()));
   if (n < 0)
-    n = rows_.size(); // append
-  rows_.insert (rows_.begin() + n, any);
+    n = store_.count(); // append
+  store_.insert (n, 1);
+  store_.set_row (n, any);
   emit_updated (UpdateKind::INSERTION, n, 1);
 }
 
 void
 MemoryListStore::update_row (uint n, const Any &any)
 {
-  assert_return (n < rows_.size());
-  rows_[n] = any;
+  assert_return (n < store_.count());
+  store_.set_row (n, any);
   emit_updated (UpdateKind::CHANGE, n, 1);
 }
 
 void
 MemoryListStore::remove (uint start, uint length)
 {
-  assert_return (start < rows_.size());
-  assert_return (start + length <= rows_.size());
-  rows_.erase (rows_.begin() + start, rows_.begin() + start + length);
+  assert_return (start < store_.count());
+  assert_return (start + length <= store_.count());
+  store_.erase (start, length);
   emit_updated (UpdateKind::DELETION, start, length);
 }
 
@@ -6,13 +6,61 @@
 
 namespace Rapicorn {
 
+/// Column oriented cell storage for list models, split into row chunks for cheap insertion and removal.
+class ListColumnStore {
+  class Column {
+    Aida::TypeKind      kind_;          // UNTYPED, BOOL, INT64, FLOAT64, STRING or ANY for mixed cells
+    vector<bool>        valid_;
+    vector<int64>       ints_;
+    vector<double>      doubles_;
+    vector<String>      strings_;
+    vector<Any>         anys_;
+    void                rekind          (Aida::TypeKind kind);
+  public:
+    explicit            Column          (size_t n_rows = 0) : kind_ (Aida::UNTYPED), valid_ (n_rows, false) {}
+    size_t              size            () const        { return valid_.size(); }
+    void                insert          (size_t row, size_t n_rows);
+    void                erase           (size_t row, size_t n_rows);
+    void                split           (size_t row, Column &tail);
+    Any                 get             (size_t row) const;
+    void                set             (size_t row, const Any &value);
+  };
+  struct Chunk {
+    size_t              n_rows;
+    vector<Column>      columns;
+    vector<bool>        whole;          // rows stored unsplit in the first column by set_row()
+    explicit            Chunk           (uint n_columns) : n_rows (0), columns (n_columns) {}
+  };
+  enum { CHUNK_ROWS = 512 };
+  vector<Chunk>         chunks_;
+  vector<size_t>        offsets_;       // first row of each chunk
+  size_t                n_rows_;
+  uint                  n_columns_;
+  size_t                find_chunk      (size_t row) const;
+  void                  update_offsets  (size_t first_chunk);
+public:
+  explicit              ListColumnStore (uint n_columns);
+  size_t                count           () const        { return n_rows_; }
+  uint                  n_columns       () const        { return n_columns_; }
+  void                  add_columns     (uint n_columns);
+  void                  insert          (size_t row, size_t n_rows);
+  void                  erase           (size_t row, size_t n_rows);
+  Any                   cell            (size_t row, uint column) const;
+  void                  set_cell        (size_t row, uint column, const Any &value);
+  Any                   row             (size_t row) const;
+  void                  set_row         (size_t row, const Any &value);
+  AnySeq                rows            (size_t first, size_t count) const;
+};
+
 class ListModelRelayImpl;
 typedef std::shared_ptr<ListModelRelayImpl> ListModelRelayImplP;
 class ListModelRelayImpl : public virtual ListModelRelayIface {
   struct RelayModel : public virtual ListModelIface {
-    vector<Any>                 rows_;
-    virtual int                 count           ()              { return rows_.size(); }
+    ListColumnStore             store_;
+    explicit                    RelayModel      () : store_ (1) {}
+    virtual int                 count           ()              { return store_.count(); }
     virtual Any                 row             (int n);
+    virtual AnySeq              rows            (int first, int count);
     virtual void                delete_this     ()              { /* do nothing for embedded object */ }
   };
   typedef std::shared_ptr<RelayModel> RelayModelP;
@@ -26,6 +74,7 @@ protected:
 public:
   virtual void                  update          (const UpdateRequest &urequest) override;
   virtual void                  fill            (int first, const AnySeq &aseq) override;
+  virtual void                  fill_columns    (int first, const AnySeqSeq &columns) override;
   virtual ListModelIfaceP       model           () override             { return model_; }
   void                          refill          (int start, int length);
 };
@@ -33,13 +82,13 @@ typedef std::shared_ptr<ListModelRelayImpl> ListModelRelayImplP;
 typedef std::weak_ptr  <ListModelRelayImpl> ListModelRelayImplW;
 
 class MemoryListStore : public virtual ListModelIface {
-  vector<Any>           rows_;
-  uint                  columns_;
+  ListColumnStore       store_;
   void                  emit_updated    (UpdateKind kind, uint start, uint length);
 public:
   explicit              MemoryListStore (int n_columns);
-  virtual int           count           ()              { return rows_.size(); }
+  virtual int           count           ()              { return store_.count(); }
   virtual Any           row             (int n);
+  virtual AnySeq        rows            (int first, int count);
   void                  insert          (int  n, const Any &aseq);
   void                  update_row      (uint n, const Any &aseq);
   void                  remove          (uint start, uint length);
@@ -400,13 +400,42 @@ PixmapT<Pixbuf>::load_pixstream (const uint8 *pixstream)
 } // Rapicorn
 
 #include <png.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 namespace {
 
+#if defined __SSE2__ && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+static inline __m128i
+premultiply_bgra_x2 (__m128i rgba16)            // 2 RGBA pixels, 16bit per sample
+{
+  const __m128i alpha_mask = _mm_set_epi16 (-1, 0, 0, 0, -1, 0, 0, 0);
+  __m128i bgra = _mm_shufflehi_epi16 (_mm_shufflelo_epi16 (rgba16, _MM_SHUFFLE (3, 0, 1, 2)), _MM_SHUFFLE (3, 0, 1, 2));
+  const __m128i alpha = _mm_shufflehi_epi16 (_mm_shufflelo_epi16 (rgba16, _MM_SHUFFLE (3, 3, 3, 3)), _MM_SHUFFLE (3, 3, 3, 3));
+  // IMUL() in 16bit: t = v * alpha + 0x80; (t + (t >> 8)) >> 8
+  __m128i t = _mm_add_epi16 (_mm_mullo_epi16 (bgra, alpha), _mm_set1_epi16 (0x80));
+  t = _mm_srli_epi16 (_mm_add_epi16 (t, _mm_srli_epi16 (t, 8)), 8);
+  bgra = _mm_or_si128 (_mm_andnot_si128 (alpha_mask, t), _mm_and_si128 (alpha_mask, alpha));
+  return bgra;
+}
+#endif
+
 static void
 rgba_2_argb_pre (png_structp png, png_row_infop row_info, png_bytep data)
 {
-  for (uint i = 0; i < row_info->rowbytes; i += 4)
+  uint i = 0;
+#if defined __SSE2__ && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  const __m128i zero = _mm_setzero_si128();
+  for (; i + 16 <= row_info->rowbytes; i += 16)   // 4 pixels per iteration, BGRA bytes are native endian ARGB
+    {
+      const __m128i rgba = _mm_loadu_si128 ((const __m128i*) &data[i]);
+      const __m128i lo = premultiply_bgra_x2 (_mm_unpacklo_epi8 (rgba, zero));
+      const __m128i hi = premultiply_bgra_x2 (_mm_unpackhi_epi8 (rgba, zero));
+      _mm_storeu_si128 ((__m128i*) &data[i], _mm_packus_epi16 (lo, hi));
+    }
+#endif
+  for (; i < row_info->rowbytes; i += 4)
     {
       const uint8 alpha = data[i + 3];          // RGBA bytes
       uint32 p = alpha << 24;
@@ -634,10 +663,99 @@ anon_load_png (PixmapT<Pixbuf> pixmap, size_t nbytes, const char *bytes)
   return errno == 0;
 }
 
+// == PNG Decoder Threads ==
+typedef AsyncBlockingQueue<std::function<void()>*> PngDecoderJobs;
+static constexpr int MAX_PNG_DECODERS = 4;
+
+static void
+png_decoder_loop (PngDecoderJobs *jobs)
+{
+  ThreadInfo::self().name ("RapicornPngDecoder");
+  for (;;)
+    {
+      std::function<void()> *job = jobs->pop();
+      (*job) ();
+      delete job;
+    }
+}
+
+static void
+png_decoder_exec (const std::function<void()> &job)
+{
+  static PngDecoderJobs *const jobs = [] () {
+    PngDecoderJobs *queue = new PngDecoderJobs(); // leaked, decoder threads run until exit
+    const int n_threads = CLAMP (ThisThread::online_cpus() - 1, 1, MAX_PNG_DECODERS);
+    for (int i = 0; i < n_threads; i++)
+      std::thread (png_decoder_loop, queue).detach();
+    return queue;
+  } ();
+  jobs->push (new std::function<void()> (job));
+}
+
 } // Anon
 
 namespace Rapicorn {
 
+/** Decode @a png_blob on one of the PNG decoder threads.
+ * Multiple PNG images are decoded in parallel, at most one worker thread per additional CPU is used.
+ * The @a callback is invoked from the decoder thread once all rows have been decoded and premultiplied,
+ * it receives the new Pixmap and an errno value, which is 0 on success, ENOENT for empty data and
+ * ENODATA if the data does not start with a PNG signature.
+ */
+template<class Pixbuf> void
+PixmapT<Pixbuf>::load_png_async (const Blob &png_blob, const LoadCallback &callback)
+{
+  assert_return (callback != NULL);
+  Blob blob = png_blob;
+  load_png_async ([blob] () { return blob; }, callback);
+}
+
+/** Fetch PNG data with @a fetch and decode it on one of the PNG decoder threads.
+ * Like load_png_async (const Blob&, const LoadCallback&), but @a fetch is also called from the
+ * decoder thread, so loading the data from a resource or file doesn't block the caller either.
+ */
+template<class Pixbuf> void
+PixmapT<Pixbuf>::load_png_async (const FetchCallback &fetch, const LoadCallback &callback)
+{
+  assert_return (fetch != NULL);
+  assert_return (callback != NULL);
+  png_decoder_exec ([fetch, callback] () {
+      const Blob blob = fetch();
+      PixmapT<Pixbuf> pixmap;
+      int error = 0;
+      if (!blob.size())
+        error = ENOENT;
+      else if (blob.size() < 8 || png_sig_cmp ((png_const_bytep) blob.data(), 0, 8) != 0)
+        error = ENODATA;        // not a PNG
+      else if (!pixmap.load_png (blob.size(), blob.data()))
+        error = errno ? errno : EINVAL;
+      callback (pixmap, error);
+    });
+}
+
+/** Retrieve the image dimensions from the PNG signature and header of @a bytes without decoding.
+ * Returns false and sets errno if the first @a nbytes do not start with a valid PNG header.
+ */
+template<class Pixbuf> bool
+PixmapT<Pixbuf>::peek_png_size (size_t nbytes, const char *bytes, uint *width, uint *height)
+{
+  const uint8 *b = (const uint8*) bytes;
+  errno = ENODATA;
+  if (!b || nbytes < 24 || png_sig_cmp ((png_const_bytep) b, 0, 8) != 0 || memcmp (b + 12, "IHDR", 4) != 0)
+    return false;
+  const uint w = (uint (b[16]) << 24) | (b[17] << 16) | (b[18] << 8) | b[19];
+  const uint h = (uint (b[20]) << 24) | (b[21] << 16) | (b[22] << 8) | b[23];
+  errno = ENOMEM;
+  if (w < 1 || h < 1 || w > MAXDIM || h > MAXDIM)
+    return false;
+  if (width)
+    *width = w;
+  if (height)
+    *height = h;
+  errno = 0;
+  return true;
+}
+
 template<class Pixbuf> bool
 PixmapT<Pixbuf>::save_png (const String &filename) /* assigns errno */
 {
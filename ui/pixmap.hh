@@ -17,6 +17,10 @@ template<class Pixbuf>
 class PixmapT {
   std::shared_ptr<Pixbuf> pixbuf_;
 public:
+  /// Callback for load_png_async(), receives the decoded Pixmap and 0 or an errno value on failure.
+  typedef std::function<void (PixmapT pixmap, int error)> LoadCallback;
+  /// Callback for load_png_async(), provides the PNG data to be decoded.
+  typedef std::function<Blob ()> FetchCallback;
   explicit      PixmapT         ();                     ///< Construct Pixmap with 0x0 pixesl.
   explicit      PixmapT         (uint w, uint h);       ///< Construct Pixmap at given width and height.
   explicit      PixmapT         (const Pixbuf &source); ///< Copy-construct Pixmap from a Pixbuf structure.
@@ -34,6 +38,9 @@ public:
   bool          load_png        (const String &filename, bool tryrepair = false); ///< Load from PNG file, assigns errno on failure.
   bool          load_png        (size_t nbytes, const char *bytes, bool tryrepair = false); ///< Load PNG data, sets errno.
   bool          save_png        (const String &filename); ///< Save to PNG, assigns errno on failure.
+  static void   load_png_async  (const Blob &png_blob, const LoadCallback &callback); ///< Decode PNG in a worker thread.
+  static void   load_png_async  (const FetchCallback &fetch, const LoadCallback &callback); ///< Fetch and decode PNG in a worker thread.
+  static bool   peek_png_size   (size_t nbytes, const char *bytes, uint *width, uint *height); ///< Read PNG header dimensions.
   bool          load_pixstream  (const uint8 *pixstream); ///< Decode and load from pixel stream, assigns errno on failure.
   void          set_attribute   (const String &name, const String &value); ///< Set string attribute, e.g. "comment".
   String        get_attribute   (const String &name) const;                ///< Get string attribute, e.g. "comment".
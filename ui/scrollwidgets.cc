@@ -5,6 +5,8 @@
 
 namespace Rapicorn {
 
+static const bool no_scroll_copy = RAPICORN_FLIPPER ("no-scroll-copy", "Rapicorn::ScrollPort: re-allocate and redraw the entire port when scrolling, instead of moving rendered contents.");
+
 // == ScrollAreaImpl ==
 ScrollAreaImpl::ScrollAreaImpl() :
   hadjustment_ (NULL), vadjustment_ (NULL)
@@ -70,7 +72,7 @@ static const WidgetFactory<ScrollAreaImpl> scroll_area_factory ("Rapicorn::Scrol
 // == ScrollPortImpl ==
 ScrollPortImpl::ScrollPortImpl() :
   hadjustment_ (NULL), vadjustment_ (NULL), conid_hadjustment_ (0), conid_vadjustment_ (0), fix_id_ (0),
-  sig_scrolled (Aida::slot (*this, &ScrollPortImpl::do_scrolled))
+  xoffset_ (0), yoffset_ (0), sig_scrolled (Aida::slot (*this, &ScrollPortImpl::do_scrolled))
 {}
 
 void
@@ -159,13 +161,44 @@ ScrollPortImpl::adjustment_changed()
 void
 ScrollPortImpl::do_scrolled ()
 {
-  if (0)
-    expose();
-  else
+  if (!scroll_by_copy())
     invalidate_allocation();
   // FIXME: need to issue 0-distance move here?
 }
 
+/* Scrolling only changes the child position, so if the current allocation is valid, the child
+ * can simply be moved, which leaves the allocations of all descendants intact. The already
+ * rendered port contents are moved on screen, so only newly exposed strips need to be drawn.
+ */
+bool
+ScrollPortImpl::scroll_by_copy ()
+{
+  return_unless (!no_scroll_copy && has_visible_child(), false);
+  WidgetImpl &child = get_child();
+  return_unless (!test_any (INVALID_REQUISITION | INVALID_ALLOCATION), false);
+  return_unless (!child.test_any (INVALID_REQUISITION | INVALID_ALLOCATION), false);
+  ViewportImpl *viewport = get_viewport();
+  return_unless (viewport && viewport == get_window(), false);     // scroll_area() needs the toplevel viewport
+  const int xoffset = hadjustment_ ? iround (hadjustment_->value()) : 0;
+  const int yoffset = vadjustment_ ? iround (vadjustment_->value()) : 0;
+  const int dx = xoffset_ - xoffset, dy = yoffset_ - yoffset;
+  return_unless (dx || dy, true);
+  // determine visible port area in viewport coordinates, clipped by ancestry
+  IRect visible = allocation();
+  for (WidgetImpl *last = this, *p = parent(); p; last = p, p = last->parent())
+    {
+      const Allocation child_allocation = last->child_allocation();
+      visible.x += child_allocation.x;
+      visible.y += child_allocation.y;
+      visible.intersect (p->allocation());
+    }
+  child.move_child_allocation (dx, dy);
+  xoffset_ = xoffset;
+  yoffset_ = yoffset;
+  viewport->scroll_area (visible, dx, dy);
+  return true;
+}
+
 void
 ScrollPortImpl::size_allocate (const Allocation area)
 {
@@ -186,6 +219,8 @@ ScrollPortImpl::size_allocate (const Allocation area)
   else
     child_area.height = rq.height;
   layout_child_allocation (child, child_area);
+  xoffset_ = xoffset;
+  yoffset_ = yoffset;
   if (!fix_id_)
     {
       WindowImpl *window = get_window();
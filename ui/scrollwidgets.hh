@@ -24,10 +24,12 @@ class ScrollPortImpl : public virtual ResizeContainerImpl, public virtual EventH
   Adjustment *hadjustment_, *vadjustment_;
   size_t conid_hadjustment_, conid_vadjustment_;
   uint   fix_id_;
+  int    xoffset_, yoffset_;    // scroll offsets of the last size_allocate
   void                          adjustment_changed      ();
   bool                          scroll                  (EventType scroll_dir);
   void                          fix_adjustments         ();
   void                          do_scrolled             ();
+  bool                          scroll_by_copy          ();
 protected:
   virtual void                  hierarchy_changed       (WindowImpl *old_toplevel) override;
   virtual void                  size_allocate           (Allocation area) override;
@@ -2,6 +2,7 @@
 #include "selector.hh"
 #include "factory.hh"
 #include <string.h>
+#include <unordered_map>
 
 #define SDEBUG(...)     RAPICORN_KEY_DEBUG ("Selector", __VA_ARGS__)
 
@@ -1096,9 +1097,9 @@ Matcher::match_element_selector (Selob &selob, const SelectorNode &snode)
 template<int CDIR> Selob*
 Matcher::match_selector_stepwise (Selob &selob, const size_t chain_index)
 {
-  assert_return (chain_index < chain.size(), NULL);
+  assert_return (chain_index < chain().size(), NULL);
   RAPICORN_STATIC_ASSERT (CDIR);
-  const SelectorNode &snode = chain[chain_index];
+  const SelectorNode &snode = chain()[chain_index];
   Selob *next_selob = &selob;
   bool force_current_subject = false;
   switch (snode.kind)
@@ -1138,7 +1139,7 @@ Matcher::match_selector_stepwise (Selob &selob, const size_t chain_index)
           if (pselob && chain_index > 0)
             return match_selector_stepwise<CDIR> (*pselob, chain_index - 1);
         }
-      else if (chain_index + 1 < chain.size()) // CDIR > 0
+      else if (chain_index + 1 < chain().size()) // CDIR > 0
         {
           const size_t n_children = selob.n_children();
           for (size_t i = 0; i < n_children; i++)
@@ -1163,7 +1164,7 @@ Matcher::match_selector_stepwise (Selob &selob, const size_t chain_index)
               pselob = pselob->get_parent();
             }
         }
-      else if (chain_index + 1 < chain.size()) // CDIR > 0
+      else if (chain_index + 1 < chain().size()) // CDIR > 0
         return match_selector_descendants (selob, chain_index + 1);
       return NULL; // no match
     case ADJACENT:
@@ -1176,7 +1177,7 @@ Matcher::match_selector_stepwise (Selob &selob, const size_t chain_index)
       else // CDIR > 0
         {
           Selob *sibling = selob.get_sibling (+1);
-          if (chain_index + 1 < chain.size() && sibling)
+          if (chain_index + 1 < chain().size() && sibling)
             return match_selector_stepwise<CDIR> (*sibling, chain_index + 1);
         }
       return NULL; // no adjacent sibling
@@ -1191,7 +1192,7 @@ Matcher::match_selector_stepwise (Selob &selob, const size_t chain_index)
                   return result;
               }
         }
-      else if (chain_index + 1 < chain.size()) // CDIR > 0
+      else if (chain_index + 1 < chain().size()) // CDIR > 0
         for (Selob *sibling = selob.get_sibling (+1); sibling; sibling = sibling->get_sibling (+1))
           {
             Selob *result = match_selector_stepwise<CDIR> (*sibling, chain_index + 1);
@@ -1206,7 +1207,7 @@ Matcher::match_selector_stepwise (Selob &selob, const size_t chain_index)
       Selob *result = match_selector_stepwise<CDIR> (*next_selob, chain_index - 1);
       return result && force_current_subject ? &selob : result;
     }
-  if (CDIR > 0 && chain_index + 1 < chain.size())
+  if (CDIR > 0 && chain_index + 1 < chain().size())
     {
       Selob *result = match_selector_stepwise<CDIR> (*next_selob, chain_index + 1);
       return result && force_current_subject ? &selob : result;
@@ -1231,14 +1232,14 @@ Matcher::match_selector_descendants (Selob &selob, const size_t chain_index)
   return NULL;
 }
 
-bool
-Matcher::parse_selector (const String &selector,
-                         bool with_combinators,
-                         String       *errorp)
+Matcher::CompiledP
+Matcher::compile_selector (const String &selector, bool with_combinators)
 {
-  assert_return (chain.empty(), false);
+  Compiled *compiled = new Compiled();
+  CompiledP compiledp (compiled);
+  SelectorChain &chain = compiled->chain;
   const char *s = selector.c_str();
-  String error;
+  String &error = compiled->error;
   // parse selector string
   if (!chain.parse (&s, with_combinators) || chain.empty())
     error = string_format ("invalid selector syntax: %s\n", string_to_cquote (selector).c_str());
@@ -1246,8 +1247,10 @@ Matcher::parse_selector (const String &selector,
     error = string_format ("unexpected junk in selector (%s): %s\n",
                            string_to_cquote (string_lstrip (s)).c_str(), string_to_cquote (selector).c_str());
   if (!error.empty())
-    goto error;
+    return compiledp;
   // find special indices
+  uint &subject_index = compiled->subject_index, &last_combinator = compiled->last_combinator;
+  uint &first_pseudo_element = compiled->first_pseudo_element;
   for (size_t i = 0; i < chain.size(); i++)
     if (chain[i].kind == SUBJECT)
       {
@@ -1265,57 +1268,123 @@ Matcher::parse_selector (const String &selector,
     error = string_format ("selector uses pseudo element for non-subject: %s", string_to_cquote (selector).c_str());
   if (subject_index == UINT_MAX)
     subject_index = last_combinator == UINT_MAX ? 0 : last_combinator + 1;
-  if (error.empty())
+  return compiledp;
+}
+
+struct Matcher::Cache {
+  enum { MAX_ENTRIES = 1024 };          // bounded, for programs that generate selector strings
+  Mutex                                 mutex;
+  std::unordered_map<String,CompiledP>  map;
+};
+
+Matcher::Cache&
+Matcher::selector_cache ()
+{
+  static Cache *cache = new Cache(); // never destroyed, may be used from static dtors
+  return *cache;
+}
+
+bool
+Matcher::parse_selector (const String &selector,
+                         bool with_combinators,
+                         String       *errorp)
+{
+  assert_return (compiled_ == NULL, false);
+  Cache &cache = selector_cache();
+  const String key = (with_combinators ? "+" : "-") + selector;
+  ScopedLock<Mutex> locker (cache.mutex);
+  auto it = cache.map.find (key);
+  if (it != cache.map.end())
+    compiled_ = it->second;
+  else
+    {
+      locker.unlock();
+      compiled_ = compile_selector (selector, with_combinators);
+      locker.lock();
+      if (cache.map.size() >= Cache::MAX_ENTRIES)
+        cache.map.clear();
+      cache.map[key] = compiled_;
+    }
+  locker.unlock();
+  if (compiled_->error.empty())
     return true;
   // encountered error
- error:
   if (errorp)
-    *errorp = error;
+    *errorp = compiled_->error;
   return false;
 }
 
+/// Discard all parsed selectors kept for reuse by the query_selector_*() functions.
+void
+Matcher::clear_selector_cache ()
+{
+  Cache &cache = selector_cache();
+  ScopedLock<Mutex> locker (cache.mutex);
+  cache.map.clear();
+}
+
+/**
+ * Check if @a selector can be resolved from an index over element ids or types.
+ * This is the case for valid selectors without combinators that contain an ID or TYPE
+ * element selector, any match of @a selector must then have the returned @a ident as id
+ * (for @a kind ID) or type (for @a kind TYPE).
+ */
+bool
+Matcher::query_selector_index_key (const String &selector, Kind *kind, String *ident)
+{
+  Matcher matcher;
+  if (!matcher.parse_selector (selector, true))
+    return false;
+  const Compiled &compiled = *matcher.compiled_;
+  if (compiled.last_combinator != UINT_MAX || compiled.first_pseudo_element != UINT_MAX)
+    return false;
+  const SelectorNode *best = NULL;
+  for (const SelectorNode &snode : compiled.chain)
+    if (snode.kind == ID)
+      {
+        best = &snode;          // ids are expected to be more selective than types
+        break;
+      }
+    else if (snode.kind == TYPE && !best)
+      best = &snode;
+  if (!best)
+    return false;
+  *kind = best->kind;
+  *ident = best->ident;
+  return true;
+}
+
 Selob*
 Matcher::match_selector_chain (Selob &selob)
 {
+  const uint subject_index = compiled_->subject_index;
   Selob *result = &selob;
-  if (subject_index < chain.size() && subject_index > 0 && !match_selector_stepwise<-1> (selob, subject_index - 1))
+  if (subject_index < chain().size() && subject_index > 0 && !match_selector_stepwise<-1> (selob, subject_index - 1))
     return NULL;
-  if (subject_index < chain.size())
+  if (subject_index < chain().size())
     result = match_selector_stepwise<+1> (selob, subject_index);
   return result;
 }
 
-template<size_t COUNT> vector<Selob*>
-Matcher::recurse_selector (Selob &selob)
+template<size_t COUNT, class OutputIter> size_t
+Matcher::recurse_selector (Selob &selob, OutputIter &oiter, size_t n_found)
 {
-  vector<Selob*> rvector;
   Selob *result = match_selector_chain (selob);
   if (result)
     {
-      rvector.push_back (result);
-      if (COUNT == 1)
-        return rvector;
+      *oiter++ = result;
+      n_found++;
+      if (COUNT && n_found >= COUNT)
+        return n_found;
     }
   const size_t n_children = selob.n_children();
   for (size_t i = 0; i < n_children; i++)
     {
-      Selob *cselob = selob.get_child (i);
-      vector<Selob*> subs;
-      if (COUNT == 2 && rvector.size() == 1)
-        subs = recurse_selector<1> (*cselob);
-      else // rvector.empty() || COUNT unlimited
-        subs = recurse_selector<COUNT> (*cselob);
-      if (!subs.empty())
-        {
-          if (rvector.empty())
-            rvector.swap (subs);
-          else
-            rvector.insert (rvector.end(), subs.begin(), subs.end());
-          if (COUNT && rvector.size() >= COUNT)
-            break;
-        }
+      n_found = recurse_selector<COUNT> (*selob.get_child (i), oiter, n_found);
+      if (COUNT && n_found >= COUNT)
+        break;
     }
-  return rvector;
+  return n_found;
 }
 
 bool
@@ -1335,7 +1404,10 @@ Matcher::query_selector_all (const String &selector, Selob &selob, String *error
   Matcher matcher;
   vector<Selob*> result;
   if (matcher.parse_selector (selector, true, errorp))
-    result = matcher.recurse_selector<0> (selob);
+    {
+      auto oiter = std::back_inserter (result);
+      matcher.recurse_selector<0> (selob, oiter, 0);
+    }
   return result;
 }
 
@@ -1343,20 +1415,27 @@ Selob*
 Matcher::query_selector_first (const String &selector, Selob &selob, String *errorp)
 {
   Matcher matcher;
-  vector<Selob*> result;
+  Selob *result[1] = { NULL };
   if (matcher.parse_selector (selector, true, errorp))
-    result = matcher.recurse_selector<1> (selob);
-  return result.empty() ? NULL : result[0];
+    {
+      Selob **oiter = result;
+      matcher.recurse_selector<1> (selob, oiter, 0);
+    }
+  return result[0];
 }
 
 Selob*
 Matcher::query_selector_unique (const String &selector, Selob &selob, String *errorp)
 {
   Matcher matcher;
-  vector<Selob*> result;
+  Selob *result[2] = { NULL, NULL };
+  size_t n_found = 0;
   if (matcher.parse_selector (selector, true, errorp))
-    result = matcher.recurse_selector<2> (selob);
-  return result.size() != 1 ? NULL : result[0];
+    {
+      Selob **oiter = result;
+      n_found = matcher.recurse_selector<2> (selob, oiter, 0);
+    }
+  return n_found != 1 ? NULL : result[0];
 }
 
 class SelobTrue : public Selob {
@@ -82,9 +82,18 @@ public:
 };
 
 class Matcher {
-  SelectorChain             chain;
-  uint                      subject_index, last_combinator, first_pseudo_element;
-  /*ctor*/                  Matcher() : subject_index (UINT_MAX), last_combinator (UINT_MAX), first_pseudo_element (UINT_MAX) {}
+  struct Compiled {                             // parsed selector, shared via the selector cache
+    SelectorChain           chain;
+    String                  error;
+    uint                    subject_index, last_combinator, first_pseudo_element;
+    /*ctor*/                Compiled() : subject_index (UINT_MAX), last_combinator (UINT_MAX), first_pseudo_element (UINT_MAX) {}
+  };
+  typedef std::shared_ptr<const Compiled> CompiledP;
+  struct                    Cache;
+  CompiledP                 compiled_;
+  /*ctor*/                  Matcher                    () {}
+  static Cache&             selector_cache             ();
+  const SelectorChain&      chain                      () const { return compiled_->chain; }
   bool                      match_attribute_selector   (Selob &selob, const SelectorNode &snode);
   Selob*                    match_pseudo_element       (Selob &selob, const SelectorNode &snode);
   bool                      match_pseudo_class         (Selob &selob, const SelectorNode &snode);
@@ -92,9 +101,10 @@ class Matcher {
   template<int CDIR> Selob* match_selector_stepwise    (Selob &selob, const size_t chain_index);
   Selob*                    match_selector_descendants (Selob &selob, const size_t chain_index);
   Selob*                    match_selector_chain       (Selob &selob);
-  template<size_t COUNT>
-  vector<Selob*>            recurse_selector           (Selob &selob);
+  template<size_t COUNT, class OutputIter>
+  size_t                    recurse_selector           (Selob &selob, OutputIter &oiter, size_t n_found);
   bool                      parse_selector             (const String &selector, bool with_combinators, String *errorp = NULL);
+  static CompiledP          compile_selector           (const String &selector, bool with_combinators);
 public:
   static bool               query_selector_bool        (const String &selector, Selob &selob, String *errorp = NULL);
   static Selob*             query_selector_first       (const String &selector, Selob &selob, String *errorp = NULL);
@@ -102,14 +112,28 @@ public:
   static vector<Selob*>     query_selector_all         (const String &selector, Selob &selob, String *errorp = NULL);
   template<class Iter>
   static vector<Selob*>     query_selector_objects     (const String &selector, Iter first, Iter last, String *errorp = NULL);
+  template<class Iter, class OutputIter>
+  static size_t             query_selector_candidates  (const String &selector, Iter first, Iter last, OutputIter oiter,
+                                                        size_t max_results = 0, String *errorp = NULL);
+  static bool               query_selector_index_key   (const String &selector, Kind *kind, String *ident);
+  static void               clear_selector_cache       ();
 };
 
 // Implementations
 template<class Iter> vector<Selob*>
 Matcher::query_selector_objects (const String &selector, Iter first, Iter last, String *errorp)
 {
-  Matcher matcher;
   vector<Selob*> rvector;
+  query_selector_candidates (selector, first, last, std::back_inserter (rvector), 0, errorp);
+  return rvector;
+}
+
+/// Match @a selector against the objects in [first, last), store matches in @a oiter and stop after @a max_results (0 = unlimited).
+template<class Iter, class OutputIter> size_t
+Matcher::query_selector_candidates (const String &selector, Iter first, Iter last, OutputIter oiter, size_t max_results, String *errorp)
+{
+  Matcher matcher;
+  size_t n_found = 0;
   if (matcher.parse_selector (selector, true, errorp))
     for (Iter it = first; it != last; it++)
       {
@@ -118,9 +142,14 @@ Matcher::query_selector_objects (const String &selector, Iter first, Iter last,
           continue;
         Selob *result = matcher.match_selector_chain (*selob);
         if (result)
-          rvector.push_back (result);
+          {
+            *oiter++ = result;
+            n_found++;
+            if (max_results && n_found >= max_results)
+              break;
+          }
       }
-  return rvector;
+  return n_found;
 }
 
 } // Selector
@@ -1,5 +1,8 @@
 // This Source Code Form is licensed MPL-2.0: http://mozilla.org/MPL/2.0
 #include "sizegroup.hh"
+#include "container.hh"
+
+#define SGDEBUG(...)    RAPICORN_KEY_DEBUG ("SizeGroup", __VA_ARGS__)
 
 namespace Rapicorn {
 
@@ -187,56 +190,151 @@ RadioGroup::widget_may_toggle (const WidgetImpl &widget)
 // == SizeGroup ==
 SizeGroup::SizeGroup (const String &name, WidgetGroupType type) :
   WidgetGroup (name, type),
-  enabled_ (true), all_dirty_ (false)
+  enabled_ (true), n_requests_ (0), n_cached_ (0), n_updates_ (0)
 {}
 
 void
-SizeGroup::widget_invalidated (WidgetImpl &widget)
+SizeGroup::enabled (bool isenabled)
 {
+  enabled_ = isenabled;
   invalidate_sizes();
 }
 
+int
+SizeGroup::member_size (const Requisition &req) const
+{
+  return type() == WIDGET_GROUP_HSIZE ? req.width : req.height;
+}
+
+void
+SizeGroup::mark_dirty (WidgetImpl &widget, Member &member)
+{
+  if (!member.dirty)
+    {
+      member.dirty = true;
+      dirty_members_.push_back (&widget);
+    }
+}
+
+void
+SizeGroup::uncount_member (Member &member)
+{
+  if (member.counted)
+    {
+      sizes_.erase (sizes_.find (member.size));
+      member.counted = false;
+    }
+}
+
+/// Force relayout of a member whose effective requisition changed, regardless of its inner requisition.
+void
+SizeGroup::invalidate_member (WidgetImpl &widget)
+{
+  widget.invalidate_allocation();
+  widget.invalidate_parent_requisition();
+}
+
+void
+SizeGroup::group_size_changed (int old_size, int new_size)
+{
+  n_updates_++;
+  SGDEBUG ("%s: group size %d -> %d: %s", name(), old_size, new_size, debug_stats());
+  return_unless (enabled());
+  // only members below the larger of both sizes are affected
+  const int threshold = MAX (old_size, new_size);
+  for (auto &it : members_)
+    if (it.second.counted && it.second.size < threshold)
+      invalidate_member (*it.first);
+}
+
+void
+SizeGroup::widget_invalidated (WidgetImpl &widget)
+{
+  // just the invalidated member needs a new size request, see group_size()
+  auto it = members_.find (&widget);
+  if (it != members_.end())
+    mark_dirty (widget, it->second);
+}
+
 void
 SizeGroup::widget_transit (WidgetImpl &widget)
 {
-  invalidate_sizes();
+  auto it = members_.find (&widget);
+  if (it == members_.end())     // adding
+    mark_dirty (widget, members_[&widget]);
+  else                          // removing
+    {
+      const int old_size = max_size();
+      uncount_member (it->second);
+      members_.erase (it);      // stale dirty_members_ entries are skipped by group_size()
+      const int new_size = max_size();
+      if (old_size != new_size)
+        group_size_changed (old_size, new_size);
+    }
   if (enabled())
-    widget.invalidate_size();
+    {
+      widget.invalidate_size();
+      invalidate_member (widget);
+    }
 }
 
 void
 SizeGroup::invalidate_sizes()
 {
-  if (enabled())
+  for (size_t i = 0; i < widgets_.size(); i++)
     {
-      if (all_dirty_)
-        return;
-      all_dirty_ = true;
-      for (size_t i = 0; i < widgets_.size(); i++)
-        widgets_[i]->invalidate_size();
+      WidgetImpl &widget = *widgets_[i];
+      auto it = members_.find (&widget);
+      if (it != members_.end())
+        mark_dirty (widget, it->second);
+      widget.invalidate_size();
+      invalidate_member (widget);
     }
 }
 
-const Requisition&
-SizeGroup::group_requisition ()
+/// Determine the maximum size of all visible members, only dirty members are re-requested.
+int
+SizeGroup::group_size ()
 {
-  while (all_dirty_)
+  if (dirty_members_.empty())
     {
-      all_dirty_ = false;
-      req_ = Requisition();
-      // beware, widgets_ vector _could_ change during loop
-      for (size_t i = 0; i < widgets_.size(); i++)
-        {
-          WidgetImpl &widget = *widgets_[i];
-          if (widget.visible())
-            {
-              const Requisition ireq = widget.inner_size_request();
-              req_.width = MAX (req_.width, ireq.width);
-              req_.height = MAX (req_.height, ireq.height);
-            }
-        }
+      n_cached_++;
+      return max_size();
     }
-  return req_;
+  const int old_size = max_size();
+  // beware, members may be invalidated or removed during inner_size_request()
+  while (!dirty_members_.empty())
+    {
+      WidgetImpl *widget = dirty_members_.back();
+      dirty_members_.pop_back();
+      auto it = members_.find (widget);
+      if (it == members_.end() || !it->second.dirty)
+        continue;
+      it->second.dirty = false;
+      uncount_member (it->second);
+      if (!widget->visible())
+        continue;
+      n_requests_++;
+      const int size = member_size (widget->inner_size_request());
+      it = members_.find (widget);
+      if (it == members_.end() || it->second.dirty)
+        continue;
+      it->second.size = size;
+      it->second.counted = true;
+      sizes_.insert (size);
+    }
+  const int new_size = max_size();
+  if (old_size != new_size)
+    group_size_changed (old_size, new_size);
+  return new_size;
+}
+
+/// Describe group size and cache efficiency for debugging purposes.
+String
+SizeGroup::debug_stats () const
+{
+  return string_format ("members=%d size=%d requests=%d cached=%d updates=%d",
+                        members_.size(), max_size(), n_requests_, n_cached_, n_updates_);
 }
 
 Requisition
@@ -253,11 +351,11 @@ SizeGroup::widget_requisition (WidgetImpl &widget)
             SizeGroupP sg = shared_ptr_cast<SizeGroup> (wgl[i]);
             if (!sg->enabled())
               continue;
-            Requisition gr = sg->group_requisition();
+            const int gsize = sg->group_size();
             if (sg->type() == WIDGET_GROUP_HSIZE)
-              zreq.width = MAX (zreq.width, gr.width);
+              zreq.width = MAX (zreq.width, gsize);
             if (sg->type() == WIDGET_GROUP_VSIZE)
-              zreq.height = MAX (zreq.height, gr.height);
+              zreq.height = MAX (zreq.height, gsize);
           }
     }
   // size request ungrouped/invisible widgets
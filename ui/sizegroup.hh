@@ -3,6 +3,8 @@
 #define __RAPICORN_SIZE_GROUP_HH__
 
 #include <ui/widget.hh>
+#include <unordered_map>
+#include <set>
 
 namespace Rapicorn {
 
@@ -62,10 +64,23 @@ typedef std::weak_ptr  <SizeGroup> SizeGroupW;
 class SizeGroup : public virtual WidgetGroup {
   friend              class WidgetImpl;
   friend class        FriendAllocator<SizeGroup>;
-  Requisition         req_;
+  struct Member {
+    int               size = 0;             // cached inner width or height
+    bool              counted = false;      // size is part of sizes_
+    bool              dirty = false;        // needs inner_size_request()
+  };
+  std::unordered_map<WidgetImpl*,Member> members_;
+  std::multiset<int>  sizes_;               // sizes of all counted members, for group max updates
+  vector<WidgetImpl*> dirty_members_;
   uint                enabled_ : 1;
-  uint                all_dirty_ : 1;        // need resize
-  const Requisition&  group_requisition         ();
+  uint                n_requests_, n_cached_, n_updates_;   // debugging stats
+  int                 group_size                ();
+  int                 max_size                  () const { return sizes_.empty() ? 0 : *sizes_.rbegin(); }
+  int                 member_size               (const Requisition &req) const;
+  void                mark_dirty                (WidgetImpl &widget, Member &member);
+  void                uncount_member            (Member &member);
+  void                group_size_changed        (int old_size, int new_size);
+  void                invalidate_member         (WidgetImpl &widget);
   void                invalidate_sizes          ();
   explicit            SizeGroup                 (const String &name, WidgetGroupType type);
   static Requisition  widget_requisition        (WidgetImpl &widget);   // called by WidgetImpl
@@ -76,7 +91,8 @@ protected:
   virtual void        widget_invalidated        (WidgetImpl &widget);
 public:
   virtual bool        enabled                   () const         { return enabled_; }
-  virtual void        enabled                   (bool isenabled) { enabled_ = isenabled; all_dirty_ = false; invalidate_sizes(); }
+  virtual void        enabled                   (bool isenabled);
+  String              debug_stats               () const;
 };
 
 } // Rapicorn
@@ -35,20 +35,56 @@ user_ini_files()
   return inifiles;
 }
 
-String
-Config::get (const String &setting, const String &fallback)
+namespace { // Anon
+struct ConfigSnapshot {
+  std::unordered_map<String,String> values;
+};
+} // Anon
+static Mutex                                 config_mutex;
+static std::shared_ptr<const ConfigSnapshot> config_snapshot; // accessed via std::atomic_load/atomic_store
+
+static std::shared_ptr<const ConfigSnapshot>
+config_load_snapshot ()
+{
+  auto snapshot = std::make_shared<ConfigSnapshot>();
+  for (const String &filename : user_ini_files())       // earlier files take precedence
+    IniFile (Blob::load (filename)).merge_values (snapshot->values);
+  return snapshot;
+}
+
+static std::shared_ptr<const ConfigSnapshot>
+config_current_snapshot ()
 {
-  static const StringVector ini_file_names = user_ini_files();
-  static vector<IniFile*> ini_files (ini_file_names.size());
-  String value;
-  for (size_t i = 0; i < ini_files.size(); i++)
+  std::shared_ptr<const ConfigSnapshot> snapshot = std::atomic_load (&config_snapshot);
+  if (RAPICORN_UNLIKELY (!snapshot))
     {
-      if (!ini_files[i])
-        ini_files[i] = new IniFile (Blob::load (ini_file_names[i]));
-      if (ini_files[i]->has_value (setting, &value))
-        return value;
+      ScopedLock<Mutex> locker (config_mutex);
+      snapshot = std::atomic_load (&config_snapshot);
+      if (!snapshot)
+        {
+          snapshot = config_load_snapshot();
+          std::atomic_store (&config_snapshot, snapshot);
+        }
     }
-  return fallback;
+  return snapshot;
+}
+
+/// Retrieve the value of @a setting ("section.attribute") from the user INI files.
+String
+Config::get (const String &setting, const String &fallback)
+{
+  const std::shared_ptr<const ConfigSnapshot> snapshot = config_current_snapshot();
+  auto it = snapshot->values.find (setting);
+  return it != snapshot->values.end() ? it->second : fallback;
+}
+
+/// Re-read the user INI files, concurrent Config::get() calls see either the old or the new settings.
+void
+Config::reload ()
+{
+  std::shared_ptr<const ConfigSnapshot> snapshot = config_load_snapshot();
+  ScopedLock<Mutex> locker (config_mutex);
+  std::atomic_store (&config_snapshot, snapshot);
 }
 
 // == Colors ==
@@ -130,10 +166,16 @@ StyleImpl::state_color (WidgetState state, StyleColor color_type, const String &
 Color
 StyleImpl::fragment_color (const String &fragment, WidgetState state)
 {
+  static Metrics::Counter &cache_hits = Metrics::counter ("rapicorn_style_color_cache_hits", "Number of StyleImpl fragment colors found in cache");
+  static Metrics::Counter &cache_misses = Metrics::counter ("rapicorn_style_color_cache_misses", "Number of StyleImpl fragment colors rendered from SVG");
   const FragmentStatePair fsp = std::make_pair (fragment, state);
   auto it = color_cache_.find (fsp);
   if (it != color_cache_.end())
-    return it->second; // pair of <FragmentStatePair,Color>
+    {
+      cache_hits.add();
+      return it->second; // pair of <FragmentStatePair,Color>
+    }
+  cache_misses.add();
   Color color = string_startswith (fragment, "fg") || string_startswith (fragment, "mark") ? 0xff006600 : 0xffeebbee;
   const String match = svg_file_ ? StyleIface::pick_fragment (fragment, state, svg_file_->list()) : "";
   if (!match.empty())
@@ -14,7 +14,8 @@ typedef std::shared_ptr<StyleIface> StyleIfaceP;
 // == Config ==
 class Config {
 public:
-  static String get (const String &setting, const String &fallback = "");
+  static String get    (const String &setting, const String &fallback = "");
+  static void   reload ();
 };
 
 // == StyleIface ==
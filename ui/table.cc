@@ -98,11 +98,204 @@ top_attach (const PackInfo &pi)
 }
 
 TableLayoutImpl::TableLayoutImpl() :
-  default_col_spacing_ (0), default_row_spacing_ (0), homogeneous_widgets_ (false)
+  default_col_spacing_ (0), default_row_spacing_ (0), homogeneous_widgets_ (false),
+  cells_valid_ (false), need_rescan_ (false), multi_span_dirty_ (true), layout_flags_dirty_ (true),
+  n_hspread_ (0), n_vspread_ (0)
 {
   resize_table (1, 1);
 }
 
+bool
+TableLayoutImpl::TableCell::operator== (const TableCell &o) const
+{
+  return left == o.left && right == o.right && bottom == o.bottom && top == o.top &&
+    width == o.width && height == o.height && visible == o.visible &&
+    hexpand == o.hexpand && vexpand == o.vexpand && hshrink == o.hshrink && vshrink == o.vshrink &&
+    hspread == o.hspread && vspread == o.vspread;
+}
+
+TableLayoutImpl::TableCell
+TableLayoutImpl::child_cell (WidgetImpl &child)
+{
+  TableCell cell;
+  if (!child.visible())
+    return cell;
+  const PackInfo &pi = child.pack_info();
+  const Requisition crq = child.requisition();
+  cell.left = left_attach (pi);
+  cell.right = right_attach (pi);
+  cell.bottom = bottom_attach (pi);
+  cell.top = top_attach (pi);
+  cell.width = crq.width + pi.left_spacing + pi.right_spacing;
+  cell.height = crq.height + pi.bottom_spacing + pi.top_spacing;
+  cell.visible = true;
+  cell.hexpand = child.hexpand();
+  cell.vexpand = child.vexpand();
+  cell.hshrink = child.hshrink();
+  cell.vshrink = child.vshrink();
+  cell.hspread = child.hspread();
+  cell.vspread = child.vspread();
+  return cell;
+}
+
+/// Replace the cached contribution of @a child, adjusting only the rows and columns it occupies.
+void
+TableLayoutImpl::update_cell (WidgetImpl &child, const TableCell &cell)
+{
+  TableCell &old = cells_[&child];
+  old.dirty = false;
+  return_unless (old != cell);
+  layout_flags_dirty_ = true;
+  if (old.multi_span() != cell.multi_span())
+    multi_span_dirty_ = true;
+  // withdraw old contribution, a shrinking maximum needs a rescan
+  if (old.visible)
+    {
+      n_hspread_ -= old.hspread;
+      n_vspread_ -= old.vspread;
+      if (old.left + 1 == old.right && old.left < cols_.size())
+        {
+          RowCol &col = cols_[old.left];
+          if (old.width >= col.cell_requisition || old.hexpand)
+            col.rescan = need_rescan_ = true;
+        }
+      if (old.bottom + 1 == old.top && old.bottom < rows_.size())
+        {
+          RowCol &row = rows_[old.bottom];
+          if (old.height >= row.cell_requisition || old.vexpand)
+            row.rescan = need_rescan_ = true;
+        }
+    }
+  // add new contribution
+  if (cell.visible)
+    {
+      n_hspread_ += cell.hspread;
+      n_vspread_ += cell.vspread;
+      if (cell.left + 1 == cell.right)
+        {
+          RowCol &col = cols_[cell.left];
+          col.cell_requisition = MAX (col.cell_requisition, cell.width);
+          col.cell_expand |= cell.hexpand;
+        }
+      if (cell.bottom + 1 == cell.top)
+        {
+          RowCol &row = rows_[cell.bottom];
+          row.cell_requisition = MAX (row.cell_requisition, cell.height);
+          row.cell_expand |= cell.vexpand;
+        }
+    }
+  old = cell;
+}
+
+/// Update cached child contributions, recalculating only rows and columns affected by changed children.
+void
+TableLayoutImpl::update_cells ()
+{
+  if (!cells_valid_)
+    {
+      cells_.clear();
+      n_hspread_ = n_vspread_ = 0;
+      for (auto *rcv : { &rows_, &cols_ })
+        for (RowCol &rc : *rcv)
+          {
+            rc.cell_requisition = 0;
+            rc.cell_expand = false;
+            rc.rescan = false;
+          }
+      need_rescan_ = false;
+      multi_span_dirty_ = true;
+      layout_flags_dirty_ = true;
+      cells_valid_ = true;
+      dirty_cells_.clear();
+      for (auto child : *this)
+        update_cell (*child, child_cell (*child));
+    }
+  // only children reported via child_requisition_changed() need their cells updated,
+  // requisitions of dirty children may queue further children, so iterate by index
+  for (size_t i = 0; i < dirty_cells_.size(); i++)
+    {
+      WidgetImpl &child = *dirty_cells_[i];
+      update_cell (child, child_cell (child));  // resets TableCell.dirty
+    }
+  dirty_cells_.clear();
+  if (need_rescan_)
+    {
+      for (auto *rcv : { &rows_, &cols_ })
+        for (RowCol &rc : *rcv)
+          if (rc.rescan)
+            {
+              rc.cell_requisition = 0;
+              rc.cell_expand = false;
+            }
+      for (const auto &entry : cells_)
+        {
+          const TableCell &cell = entry.second;
+          if (!cell.visible)
+            continue;
+          if (cell.left + 1 == cell.right && cols_[cell.left].rescan)
+            {
+              cols_[cell.left].cell_requisition = MAX (cols_[cell.left].cell_requisition, cell.width);
+              cols_[cell.left].cell_expand |= cell.hexpand;
+            }
+          if (cell.bottom + 1 == cell.top && rows_[cell.bottom].rescan)
+            {
+              rows_[cell.bottom].cell_requisition = MAX (rows_[cell.bottom].cell_requisition, cell.height);
+              rows_[cell.bottom].cell_expand |= cell.vexpand;
+            }
+        }
+      for (auto *rcv : { &rows_, &cols_ })
+        for (RowCol &rc : *rcv)
+          rc.rescan = false;
+      need_rescan_ = false;
+    }
+  if (multi_span_dirty_)
+    {
+      multi_span_cells_.clear();
+      for (auto child : *this)
+        {
+          const TableCell &cell = cells_[&*child];
+          if (cell.multi_span())
+            multi_span_cells_.push_back (&cell);
+        }
+      multi_span_dirty_ = false;
+    }
+}
+
+/// Queue @a child for update_cells(), called once its requisition or packing changed.
+void
+TableLayoutImpl::child_requisition_changed (WidgetImpl &child)
+{
+  TableCell &cell = cells_[&child];
+  if (!cell.dirty)
+    {
+      cell.dirty = true;
+      dirty_cells_.push_back (&child);
+    }
+}
+
+String
+TableLayoutImpl::add_child (WidgetImplP widget)
+{
+  const String error = MultiContainerImpl::add_child (widget);
+  if (error.empty())
+    child_requisition_changed (*widget);
+  return error;
+}
+
+void
+TableLayoutImpl::remove_child (WidgetImpl &widget)
+{
+  auto it = cells_.find (&widget);
+  if (it != cells_.end())
+    {
+      if (it->second.dirty)
+        dirty_cells_.erase (std::find (dirty_cells_.begin(), dirty_cells_.end(), &widget));
+      update_cell (widget, TableCell());
+      cells_.erase (it);
+    }
+  MultiContainerImpl::remove_child (widget);
+}
+
 bool
 TableLayoutImpl::is_row_used (int srow)
 {
@@ -165,7 +358,10 @@ TableLayoutImpl::resize_table (uint n_cols, uint n_rows)
       need_col_invalidate = true;
     }
   if (need_row_invalidate || need_col_invalidate)
-    invalidate_requisition();
+    {
+      invalidate_cells();
+      invalidate_requisition();
+    }
 }
 
 void
@@ -223,6 +419,7 @@ TableLayoutImpl::repack_child (WidgetImpl &widget, const PackInfo &orig, const P
   uint n_cols = right_attach (pnew), n_rows = top_attach (pnew);
   if (n_cols > cols_.size() || n_rows > rows_.size())
     resize_table (n_cols, n_rows);
+  child_requisition_changed (widget);
   MultiContainerImpl::repack_child (widget, orig, pnew);
 }
 
@@ -256,58 +453,24 @@ TableLayoutImpl::size_allocate (Allocation area)
 void
 TableLayoutImpl::size_request_init()
 {
-  for (uint row = 0; row < rows_.size(); row++)
-    {
-      rows_[row].requisition = 0;
-      rows_[row].expand = false;
-    }
-  for (uint col = 0; col < cols_.size(); col++)
-    {
-      cols_[col].requisition = 0;
-      cols_[col].expand = false;
-    }
-
-  bool chspread = false, cvspread = false;
-  for (auto child : *this)
-    {
-      // size request all children
-      if (!child->visible())
-        continue;
-      const PackInfo &pi = child->pack_info();
-      chspread |= child->hspread();
-      cvspread |= child->vspread();
-      // expand cols with single-column expand children
-      if (left_attach (pi) + 1 == right_attach (pi) && child->hexpand())
-        cols_[left_attach (pi)].expand = true;
-      // expand rows with single-column expand children
-      if (bottom_attach (pi) + 1 == top_attach (pi) && child->vexpand())
-        rows_[bottom_attach (pi)].expand = true;
-    }
-  set_flag (HSPREAD_CONTAINER, chspread);
-  set_flag (VSPREAD_CONTAINER, cvspread);
+  update_cells();
+  set_flag (HSPREAD_CONTAINER, n_hspread_ > 0);
+  set_flag (VSPREAD_CONTAINER, n_vspread_ > 0);
 }
 
 void
 TableLayoutImpl::size_request_pass1()
 {
-  for (auto child : *this)
+  // fetch requisition from single-column and single-row children, as cached by update_cells()
+  for (uint row = 0; row < rows_.size(); row++)
     {
-      if (!child->visible())
-        continue;
-      Requisition crq = child->requisition();
-      const PackInfo &pi = child->pack_info();
-      /* fetch requisition from single-column children */
-      if (left_attach (pi) + 1 == right_attach (pi))
-        {
-          uint width = crq.width + pi.left_spacing + pi.right_spacing;
-          cols_[left_attach (pi)].requisition = MAX (cols_[left_attach (pi)].requisition, width);
-        }
-      /* fetch requisition from single-row children */
-      if (bottom_attach (pi) + 1 == top_attach (pi))
-        {
-          uint height = crq.height + pi.bottom_spacing + pi.top_spacing;
-          rows_[bottom_attach (pi)].requisition = MAX (rows_[bottom_attach (pi)].requisition, height);
-        }
+      rows_[row].requisition = rows_[row].cell_requisition;
+      rows_[row].expand = rows_[row].cell_expand;
+    }
+  for (uint col = 0; col < cols_.size(); col++)
+    {
+      cols_[col].requisition = cols_[col].cell_requisition;
+      cols_[col].expand = cols_[col].cell_expand;
     }
 }
 
@@ -334,41 +497,38 @@ TableLayoutImpl::size_request_pass2()
 void
 TableLayoutImpl::size_request_pass3()
 {
-  for (auto child : *this)
+  for (const TableCell *cellp : multi_span_cells_)
     {
-      if (!child->visible())
-        continue;
-      const PackInfo &pi = child->pack_info();
+      const TableCell &cell = *cellp;
       /* request remaining space for multi-column children */
-      if (left_attach (pi) + 1 != right_attach (pi))
+      if (cell.left + 1 != cell.right)
         {
-          Requisition crq = child->requisition();
           /* Check and see if there is already enough space for the child. */
           int width = 0;
-          for (uint col = left_attach (pi); col < right_attach (pi); col++)
+          for (uint col = cell.left; col < cell.right; col++)
             {
               width += cols_[col].requisition;
-              if (col + 1 < right_attach (pi))
+              if (col + 1 < cell.right)
                 width += cols_[col].spacing;
             }
           /* If we need to request more space for this child to fill
            *  its requisition, then divide up the needed space amongst the
            *  columns it spans, favoring expandable columns if any.
            */
-          if (width < crq.width + pi.left_spacing + pi.right_spacing)
+          if (width < int (cell.width))
             {
               bool force_expand = false;
               uint n_expand = 0;
-              width = crq.width + pi.left_spacing + pi.right_spacing - width;
-              for (uint col = left_attach (pi); col < right_attach (pi); col++)
+              width = cell.width - width;
+              for (uint col = cell.left; col < cell.right; col++)
                 if (cols_[col].expand)
                   n_expand++;
               if (n_expand == 0)
                 {
-                  n_expand = right_attach (pi) - left_attach (pi);
+                  n_expand = cell.right - cell.left;
                   force_expand = true;
                 }
-              for (uint col = left_attach (pi); col < right_attach (pi); col++)
+              for (uint col = cell.left; col < cell.right; col++)
                 if (force_expand || cols_[col].expand)
                   {
                     uint extra = width / n_expand;
@@ -379,35 +539,34 @@ TableLayoutImpl::size_request_pass3()
             }
         }
       /* request remaining space for multi-row children */
-      if (bottom_attach (pi) + 1 != top_attach (pi))
+      if (cell.bottom + 1 != cell.top)
         {
-          Requisition crq = child->requisition();
           /* Check and see if there is already enough space for the child. */
           int height = 0;
-          for (uint row = bottom_attach (pi); row < top_attach (pi); row++)
+          for (uint row = cell.bottom; row < cell.top; row++)
             {
               height += rows_[row].requisition;
-              if (row + 1 < top_attach (pi))
+              if (row + 1 < cell.top)
                 height += rows_[row].spacing;
             }
           /* If we need to request more space for this child to fill
            *  its requisition, then divide up the needed space amongst the
            *  rows it spans, favoring expandable rows if any.
            */
-          if (height < crq.height + pi.bottom_spacing + pi.top_spacing)
+          if (height < int (cell.height))
             {
               bool force_expand = false;
               uint n_expand = 0;
-              height = crq.height + pi.bottom_spacing + pi.top_spacing - height;
-              for (uint row = bottom_attach (pi); row < top_attach (pi); row++)
+              height = cell.height - height;
+              for (uint row = cell.bottom; row < cell.top; row++)
                 if (rows_[row].expand)
                   n_expand++;
               if (n_expand == 0)
                 {
-                  n_expand = top_attach (pi) - bottom_attach (pi);
+                  n_expand = cell.top - cell.bottom;
                   force_expand = true;
                 }
-              for (uint row = bottom_attach (pi); row < top_attach (pi); row++)
+              for (uint row = cell.bottom; row < cell.top; row++)
                 if (force_expand || rows_[row].expand)
                   {
                     uint extra = height / n_expand;
@@ -423,6 +582,24 @@ TableLayoutImpl::size_request_pass3()
 void
 TableLayoutImpl::size_allocate_init()
 {
+  if (!cells_valid_)
+    update_cells();
+  for (uint col = 0; col < cols_.size(); col++)
+    cols_[col].allocation = cols_[col].requisition;
+  for (uint row = 0; row < rows_.size(); row++)
+    rows_[row].allocation = rows_[row].requisition;
+  // reuse row and col flags unless children changed since the last allocation
+  if (!layout_flags_dirty_)
+    {
+      for (auto *rcv : { &rows_, &cols_ })
+        for (RowCol &rc : *rcv)
+          {
+            rc.expand = rc.layout_expand;
+            rc.shrink = rc.layout_shrink;
+            rc.empty = rc.layout_empty;
+          }
+      return;
+    }
   /* Initialize the rows and cols.
    *  By default, rows and cols do not expand and do shrink.
    *  Those values are modified by the children that occupy
@@ -430,7 +607,6 @@ TableLayoutImpl::size_allocate_init()
    */
   for (uint col = 0; col < cols_.size(); col++)
     {
-      cols_[col].allocation = cols_[col].requisition;
       cols_[col].need_expand = false;
       cols_[col].need_shrink = true;
       cols_[col].expand = false;
@@ -439,7 +615,6 @@ TableLayoutImpl::size_allocate_init()
     }
   for (uint row = 0; row < rows_.size(); row++)
     {
-      rows_[row].allocation = rows_[row].requisition;
       rows_[row].need_expand = false;
       rows_[row].need_shrink = true;
       rows_[row].expand = false;
@@ -548,6 +723,14 @@ TableLayoutImpl::size_allocate_init()
         rows_[row].expand |= rows_[row].need_expand;
         rows_[row].shrink &= rows_[row].need_shrink;
       }
+  for (auto *rcv : { &rows_, &cols_ })
+    for (RowCol &rc : *rcv)
+      {
+        rc.layout_expand = rc.expand;
+        rc.layout_shrink = rc.shrink;
+        rc.layout_empty = rc.empty;
+      }
+  layout_flags_dirty_ = false;
 }
 
 void
@@ -784,32 +967,28 @@ void
 TableLayoutImpl::size_allocate_pass2 ()
 {
   Allocation area = allocation(), child_area;
+  // row and col offsets, so children spans are located in constant time
+  for (auto *rcv : { &rows_, &cols_ })
+    {
+      uint position = 0;
+      for (RowCol &rc : *rcv)
+        {
+          rc.position = position;
+          position += rc.allocation + rc.spacing;
+        }
+    }
   for (auto child : *this)
     {
       if (!child->visible())
         continue;
       const PackInfo &pi = child->pack_info();
       Requisition crq = child->requisition();
-      int x = area.x;
-      for (uint col = 0; col < left_attach (pi); col++)
-        x += cols_[col].allocation + cols_[col].spacing;
-      int max_width = 0;
-      for (uint col = left_attach (pi); col < right_attach (pi); col++)
-        {
-          max_width += cols_[col].allocation;
-          if (col + 1 < right_attach (pi))
-            max_width += cols_[col].spacing;
-        }
-      int y = area.y;
-      for (uint row = 0; row < bottom_attach (pi); row++)
-        y += rows_[row].allocation + rows_[row].spacing;
-      int max_height = 0;
-      for (uint row = bottom_attach (pi); row < top_attach (pi); row++)
-        {
-          max_height += rows_[row].allocation;
-          if (row + 1 < top_attach (pi))
-            max_height += rows_[row].spacing;
-        }
+      const RowCol &lcol = cols_[left_attach (pi)], &rcol = cols_[right_attach (pi) - 1];
+      const int x = area.x + lcol.position;
+      const int max_width = rcol.position + rcol.allocation - lcol.position;
+      const RowCol &brow = rows_[bottom_attach (pi)], &trow = rows_[top_attach (pi) - 1];
+      const int y = area.y + brow.position;
+      const int max_height = trow.position + trow.allocation - brow.position;
       /* max possible child size */
       child_area.width = max_width;
       child_area.x = x;
@@ -3,18 +3,42 @@
 #define __RAPICORN_TABLE_HH__
 
 #include <ui/container.hh>
+#include <unordered_map>
 
 namespace Rapicorn {
 
 class TableLayoutImpl : public virtual MultiContainerImpl {
+  /// Cached layout contribution of a child.
+  struct TableCell {
+    uint   left, right, bottom, top;
+    uint   width, height;       // child requisition including spacing
+    uint   visible : 1, hexpand : 1, vexpand : 1, hshrink : 1, vshrink : 1, hspread : 1, vspread : 1;
+    uint   dirty : 1;           // queued in dirty_cells_, not part of the comparison
+    explicit    TableCell       ()                      { memset (this, 0, sizeof (*this)); }
+    bool        operator==      (const TableCell &o) const;
+    bool        operator!=      (const TableCell &o) const { return !operator== (o); }
+    bool        multi_span      () const                { return visible && (left + 1 != right || bottom + 1 != top); }
+  };
   uint16         default_col_spacing_, default_row_spacing_;
   uint           homogeneous_widgets_ : 1;
+  uint           cells_valid_ : 1, need_rescan_ : 1, multi_span_dirty_ : 1, layout_flags_dirty_ : 1;
+  uint           n_hspread_, n_vspread_;
+  std::unordered_map<WidgetImpl*,TableCell> cells_;
+  vector<const TableCell*> multi_span_cells_;  // in child order
+  vector<WidgetImpl*> dirty_cells_;           // children whose requisition or packing changed
+  TableCell      child_cell          (WidgetImpl &child);
+  void           update_cell         (WidgetImpl &child, const TableCell &cell);
+  void           update_cells        ();
+  void           invalidate_cells    ()                 { cells_valid_ = false; }
 protected:
   explicit       TableLayoutImpl     ();
   virtual       ~TableLayoutImpl     ();
   virtual void   size_request        (Requisition &requisition);
   virtual void   size_allocate       (Allocation area);
   virtual void   repack_child        (WidgetImpl &widget, const PackInfo &orig, const PackInfo &pnew);
+  virtual String add_child           (WidgetImplP widget) override;
+  virtual void   remove_child        (WidgetImpl &widget) override;
+  virtual void   child_requisition_changed (WidgetImpl &child) override;
   void           size_request_init   ();
   void           size_request_pass1  ();
   void           size_request_pass2  ();
@@ -37,12 +61,19 @@ protected:
   struct RowCol {
     uint   requisition;
     uint   allocation;
+    uint   position;            // allocation offset within the table
+    uint   cell_requisition;    // maximum requisition of single-span children
     uint16 spacing;
     uint   need_expand : 1;
     uint   need_shrink : 1;
     uint   expand : 1;
     uint   shrink : 1;
     uint   empty : 1;
+    uint   cell_expand : 1;     // any single-span child expands
+    uint   rescan : 1;          // cell_requisition or cell_expand need recalculation
+    uint   layout_expand : 1;   // cached expand, shrink and empty flags for allocation
+    uint   layout_shrink : 1;
+    uint   layout_empty : 1;
     explicit    RowCol            ()                                 { memset (this, 0, sizeof (*this)); }
     static bool lesser_allocation (const RowCol *a, const RowCol *b) { return a->allocation < b->allocation; }
   };
@@ -3,6 +3,7 @@
 #include "container.hh"
 #include "painter.hh"
 #include "window.hh"
+#include "image.hh"
 #include "factory.hh"
 #include "selector.hh"
 #include "selob.hh"
@@ -363,6 +364,17 @@ void
 TestBoxImpl::make_snapshot ()
 {
   WindowImpl *wwidget = get_window();
+  if (snapshot_file_ != "" && wwidget && ImageImpl::loads_pending())
+    {
+      EventLoop *loop = wwidget->get_loop();
+      if (loop)
+        {
+          // delay the snapshot until images that are being decoded asynchronously have arrived
+          remove_exec (handler_id_);
+          handler_id_ = loop->exec_timer (Aida::slot (*this, &TestBoxImpl::make_snapshot), 5);
+          return;
+        }
+    }
   if (snapshot_file_ != "" && wwidget)
     {
       cairo_surface_t *isurface = wwidget->create_snapshot (rect_to_viewport (allocation()));
@@ -181,9 +181,14 @@ class LayoutCache {
   PangoContext*
   retrieve_context (ContextKey key)
   {
+    static Metrics::Counter &cache_hits = Metrics::counter ("rapicorn_layout_cache_hits", "Number of PangoContext lookups served by LayoutCache");
+    static Metrics::Counter &cache_misses = Metrics::counter ("rapicorn_layout_cache_misses", "Number of PangoContext creations by LayoutCache");
     PangoContext *pcontext = context_cache[key];
-    if (!pcontext)
+    if (pcontext)
+      cache_hits.add();
+    else
       {
+        cache_misses.add();
         PangoFontMap *fontmap = pango_cairo_font_map_new ();
         pango_cairo_font_map_set_resolution (PANGO_CAIRO_FONT_MAP (fontmap), key.dpi.x);
         pcontext = pango_font_map_create_context (fontmap);
@@ -629,12 +634,13 @@ class XmlToPango : Rapicorn::MarkupParser {
       }
   }
   void
-  apply_tags (const vector<XmlNodeP> &nodes)
+  apply_tags (XmlNode::ConstNodes &nodes)
   {
     /* apply nodes */
-    for (vector<XmlNodeP>::const_iterator it = nodes.begin(); it != nodes.end(); it++)
+    for (XmlNode::ConstChildIter it = nodes.begin(); it != nodes.end(); it++)
       {
-        const XmlNode &xnode = **it;
+        const XmlNodeP xnodep = *it;
+        const XmlNode &xnode = *xnodep;
         if (!xnode.istext())
           handle_tag (xnode);
         else /* text */
@@ -6,7 +6,7 @@
 
 #define EDEBUG(...)           RAPICORN_KEY_DEBUG ("Events", __VA_ARGS__)
 #define DEBUG_RESIZE(...)     RAPICORN_KEY_DEBUG ("Resize", __VA_ARGS__)
-#define DEBUG_RENDER(...)     RAPICORN_KEY_DEBUG ("Render", __VA_ARGS__)
+#define DEBUG_RENDER(...)     RAPICORN_KEY_DEBUG_LITERAL ("Render", __VA_ARGS__)
 
 namespace Rapicorn {
 
@@ -15,7 +15,7 @@ ViewportImpl::ViewportImpl() :
   display_window_ (NULL), immediate_event_hash_ (0),
   tunable_requisition_counter_ (0),
   auto_focus_ (true), entered_ (false), pending_win_size_ (false), pending_expose_ (true),
-  need_resize_ (false)
+  need_resize_ (false), selector_index_valid_ (false)
 {
   inherited_state_ = 0;
   dw_config_.title = application_name();
@@ -62,6 +62,39 @@ ViewportImpl::hierarchy_changed (WindowImpl *old_toplevel)
     }
 }
 
+void
+ViewportImpl::index_selector_widget (WidgetImpl &widget)
+{
+  // preorder walk, so the index vectors keep widgets in selector traversal order
+  id_index_[widget.id()].push_back (&widget);
+  type_index_[Factory::factory_context_type (widget.factory_context())].push_back (&widget);
+  ContainerImpl *container = widget.as_container_impl();
+  if (container)
+    for (auto child : *container)
+      index_selector_widget (*child);
+}
+
+void
+ViewportImpl::build_selector_index ()
+{
+  id_index_.clear();
+  type_index_.clear();
+  index_selector_widget (*this);
+  selector_index_valid_ = true;
+}
+
+/// Lookup the widgets within this viewport that have id or type @a ident, in tree order.
+const vector<WidgetImpl*>*
+ViewportImpl::selector_index_lookup (Selector::Kind kind, const String &ident)
+{
+  assert_return (kind == Selector::ID || kind == Selector::TYPE, NULL);
+  if (!selector_index_valid_)
+    build_selector_index();
+  WidgetIndex &index = kind == Selector::ID ? id_index_ : type_index_;
+  auto it = index.find (ident);
+  return it != index.end() ? &it->second : NULL;
+}
+
 String
 ViewportImpl::title () const
 {
@@ -195,6 +228,44 @@ ViewportImpl::expose_region (const Region &region)
     }
 }
 
+/** Move the displayed contents of @a area by @a dx, @a dy.
+ * This moves already rendered pixels on the display window and exposes just the parts of
+ * @a area that are not covered by the moved contents. Pending exposes inside @a area are
+ * moved along. The caller must ensure that widgets covering @a area have been moved accordingly.
+ */
+void
+ViewportImpl::scroll_area (const IRect &area, int dx, int dy)
+{
+  const IRect rect = area.intersection (allocation());
+  return_unless (rect.empty() == false);
+  return_unless (dx || dy);
+  // determine destination of the contents that stay within rect
+  IRect dest = rect;
+  dest.x += dx;
+  dest.y += dy;
+  dest.intersect (rect);
+  if (dest.empty() || !has_display_window() || pending_win_size_)
+    {
+      expose_region (Region (rect));
+      return;
+    }
+  // stale contents (pending exposes) are moved along
+  Region pending = peek_expose_region();
+  pending.intersect (Region (rect));
+  if (!pending.empty())
+    {
+      expose_region_.subtract (Region (rect));
+      pending.translate (dx, dy);
+      pending.intersect (Region (rect));
+      expose_region_.add (pending);
+    }
+  display_window_->copy_area (IRect (dest.x - dx, dest.y - dy, dest.width, dest.height), dest.x, dest.y);
+  // expose areas uncovered by the move
+  Region uncovered = Region (rect);
+  uncovered.subtract (Region (dest));
+  expose_region (uncovered);
+}
+
 void
 ViewportImpl::collapse_expose_region ()
 {
@@ -232,7 +303,8 @@ ViewportImpl::draw_now ()
   EventLoop *loop = get_loop();
   if (loop && has_display_window())
     {
-      const uint64 start = timestamp_realtime();
+      static Metrics::Histogram &frame_latency = Metrics::histogram ("rapicorn_viewport_frame_ns", "Time needed to compose and blit a frame in nanoseconds");
+      Metrics::Histogram::Latency frame_latency_scope (frame_latency);
       IRect area = allocation();
       assert_return (area.x == 0 && area.y == 0);
       // determine invalidated rendering region
@@ -254,9 +326,14 @@ ViewportImpl::draw_now ()
       // compose into region rectangles
       vector<IRect> irects;
       region.list_rects (irects);
+      Trace::begin ("Viewport::compose");
       compose_into (cr, irects);
+      Trace::end ("Viewport::compose");
+      Trace::counter ("Viewport::composed_pixels", (x2 - x1) * (y2 - y1));
       // and blit contents onto the screen
+      Trace::begin ("Viewport::blit");
       display_window_->blit_surface (surface, region);
+      Trace::end ("Viewport::blit");
       cairo_destroy (cr);
       cairo_surface_destroy (surface);
       // notify "displayed" at PRIORITY_UPDATE, so other high priority handlers run first
@@ -264,10 +341,6 @@ ViewportImpl::draw_now ()
           if (has_display_window())
             sig_displayed.emit();
         }, EventLoop::PRIORITY_UPDATE);
-      const uint64 stop = timestamp_realtime();
-      DEBUG_RENDER ("%+d%+d%+dx%d coverage=%.1f%% elapsed=%.3fms",
-                    x1, y1, x2 - x1, y2 - y1, ((x2 - x1) * (y2 - y1)) * 100.0 / (area.width*area.height),
-                    (stop - start) / 1000.0);
     }
   else
     discard_expose_region(); // nuke stale exposes
@@ -443,7 +516,6 @@ ViewportImpl::can_resize_redraw()
 void
 ViewportImpl::resize_redraw (const Allocation *new_viewport_area, bool resize_only)
 {
-  const uint64 resize_start = timestamp_realtime();
   if (new_viewport_area)
     invalidate_allocation();                            // sets need_resize_
   return_unless (can_resize_redraw());                  // check need_resize_
@@ -453,27 +525,29 @@ ViewportImpl::resize_redraw (const Allocation *new_viewport_area, bool resize_on
     check_widget_requisition (*this, true);
   // negotiate ideal size within allocation
   const Allocation current_allocation = allocation();
+  static Metrics::Histogram &layout_latency = Metrics::histogram ("rapicorn_viewport_layout_ns", "Time needed for size negotiation in nanoseconds");
+  const uint64 layout_start = timestamp_benchmark();
+  Trace::begin ("Viewport::layout");
   const uint64 invalidation_flags = negotiate_sizes (new_viewport_area ? new_viewport_area : &current_allocation);
+  Trace::end ("Viewport::layout");
+  layout_latency.record (timestamp_benchmark() - layout_start);
   // check if we fit the display window
   maybe_resize_viewport();
   // redraw resized contents
-  const uint64 redraw_start = timestamp_realtime();
   const String fixme_dbg = peek_expose_region().extents().string();
   if (resize_only)
     need_resize_ = true;                                // must redraw later
   else if (!need_resize_ && !pending_win_size_ && (exposes_pending() || invalidation_flags & INVALID_CONTENT))
     {
+      Trace::begin ("Viewport::render");
       render_widget();
+      Trace::end ("Viewport::render");
       draw_now();
     }
-  const uint64 stop = timestamp_realtime();
-  DEBUG_RESIZE ("request=%s allocate=%s pws=%d expose=%s resize_elapsed=%.3fms redraw_elapsed=%.3fms nresize=%d",
+  DEBUG_RESIZE ("request=%s allocate=%s pws=%d expose=%s nresize=%d",
                 new_viewport_area ? "-" : string_format ("%.0fx%.0f", requisition().width, requisition().height),
                 string_format ("%.0fx%.0f", allocation().width, allocation().height),
-                pending_win_size_, fixme_dbg,
-                (redraw_start - resize_start) / 1000.0,
-                (!resize_only) * (stop - redraw_start) / 1000.0,
-                need_resize_);
+                pending_win_size_, fixme_dbg, need_resize_);
 }
 
 void
@@ -4,6 +4,8 @@
 
 #include <ui/container.hh>
 #include <ui/displaywindow.hh>
+#include <ui/selector.hh>
+#include <unordered_map>
 
 namespace Rapicorn {
 
@@ -16,6 +18,7 @@ class ViewportImpl : public virtual ResizeContainerImpl, public virtual Viewport
   struct                                GrabEntry;
   struct                                ButtonState;
   typedef std::map<ButtonState,uint>    ButtonStateMap;
+  typedef std::unordered_map<String,vector<WidgetImpl*>> WidgetIndex;
   Region                                expose_region_;
   DisplayWindow                        *display_window_;
   vector<WidgetImplP>                   last_entered_children_;
@@ -23,6 +26,7 @@ class ViewportImpl : public virtual ResizeContainerImpl, public virtual Viewport
   ButtonStateMap                        button_state_map_;
   vector<GrabEntry>                     grab_stack_;
   DisplayWindow::Config                 dw_config_;
+  WidgetIndex                           id_index_, type_index_;
   size_t                                immediate_event_hash_;
   uint                                  event_dispatcher_id_, drawing_dispatcher_id_;
   uint                                  tunable_requisition_counter_ : 8;
@@ -31,6 +35,7 @@ class ViewportImpl : public virtual ResizeContainerImpl, public virtual Viewport
   uint                                  pending_win_size_ : 1;
   uint                                  pending_expose_ : 1;
   uint                                  need_resize_ : 1;
+  uint                                  selector_index_valid_ : 1;
   WidgetFlag                   pop_need_resize            ();
   WidgetFlag                   negotiate_sizes            (const Allocation *new_window_area);
   void                         resize_redraw              (const Allocation *new_window_area, bool resize_only = false);
@@ -46,6 +51,8 @@ class ViewportImpl : public virtual ResizeContainerImpl, public virtual Viewport
   void                         uncross_focus              (WidgetImpl &fwidget);
   void                         draw_now                   ();
   void                         show_display_window        ();
+  void                         build_selector_index       ();
+  void                         index_selector_widget      (WidgetImpl &widget);
   bool                         drawing_dispatcher         (const LoopState &state);
 protected:
   virtual const AncestryCache* fetch_ancestry_cache       () override;
@@ -87,10 +94,14 @@ public:
   WidgetImpl*                  get_entered_widget         ()              { return shared_ptr_cast<WidgetImpl> (get_entered()).get(); }
   // resize and draw
   void                         expose_region              (const Region &region);
+  void                         scroll_area                (const IRect &area, int dx, int dy);
   cairo_surface_t*             create_snapshot            (const IRect  &subarea);
   bool                         requisitions_tunable       () const        { return tunable_requisition_counter_ > 0; }
   void                         draw_child                 (WidgetImpl &child);
   void                         queue_resize_redraw        ();
+  // selector index
+  const vector<WidgetImpl*>*   selector_index_lookup      (Selector::Kind kind, const String &ident);
+  void                         invalidate_selector_index  ()              { selector_index_valid_ = false; }
   // internal API
   DisplayWindow*               display_window             (Internal = Internal()) const;
   void                         set_focus                  (WidgetImpl *widget, Internal = Internal());
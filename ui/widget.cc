@@ -291,7 +291,7 @@ WidgetImpl::set_flag (WidgetFlag flag, bool on)
         widget_invalidate (WidgetFlag (invalidation_flags));
       if (parent() && (flag & packing_flags))   // for flags affecting parent
         {
-          parent()->invalidate_requisition();   // it must check requisition
+          invalidate_parent_requisition();      // it must check requisition
           invalidate_requisition();
         }
       changed ("flags");
@@ -717,11 +717,61 @@ WidgetImpl::match_selector (const String &selector)
   return Selector::Matcher::query_selector_bool (selector, *sallocator.widget_selob (*this));
 }
 
+/// Collect the Selob candidates for @a selector below @a root from the viewport selector index, if possible.
+static bool
+query_selector_index (WidgetImpl &root, const String &selector, Selector::SelobAllocator &sallocator, vector<Selector::Selob*> &candidates)
+{
+  Selector::Kind kind;
+  String ident;
+  ViewportImpl *viewport = root.get_viewport();
+  if (!viewport || !Selector::Matcher::query_selector_index_key (selector, &kind, &ident))
+    return false;
+  const vector<WidgetImpl*> *widgets = viewport->selector_index_lookup (kind, ident);
+  if (widgets)
+    for (WidgetImpl *widget : *widgets)
+      if (widget->has_ancestor (root))
+        candidates.push_back (sallocator.widget_selob (*widget));
+  return true;
+}
+
+template<class OutputIter> static size_t
+query_selector_widgets (WidgetImpl &root, const String &selector, Selector::SelobAllocator &sallocator,
+                        OutputIter oiter, size_t max_results)
+{
+  vector<Selector::Selob*> candidates;
+  if (query_selector_index (root, selector, sallocator, candidates))
+    return Selector::Matcher::query_selector_candidates (selector, candidates.begin(), candidates.end(), oiter, max_results);
+  Selector::Selob &selob = *sallocator.widget_selob (root);
+  Selector::Selob *result;
+  switch (max_results)
+    {
+    case 1:
+      result = Selector::Matcher::query_selector_first (selector, selob);
+      if (!result)
+        return 0;
+      *oiter++ = result;
+      return 1;
+    case 2:     // query_selector_unique() only yields a result if it's exactly one
+      result = Selector::Matcher::query_selector_unique (selector, selob);
+      if (!result)
+        return 0;
+      *oiter++ = result;
+      return 1;
+    default:
+      {
+        const vector<Selector::Selob*> results = Selector::Matcher::query_selector_all (selector, selob);
+        std::copy (results.begin(), results.end(), oiter);
+        return results.size();
+      }
+    }
+}
+
 WidgetIfaceP
 WidgetImpl::query_selector (const String &selector)
 {
   Selector::SelobAllocator sallocator;
-  Selector::Selob *selob = Selector::Matcher::query_selector_first (selector, *sallocator.widget_selob (*this));
+  Selector::Selob *selob = NULL;
+  query_selector_widgets (*this, selector, sallocator, &selob, 1);
   return shared_ptr_cast<WidgetIface*> (selob ? sallocator.selob_widget (*selob) : NULL);
 }
 
@@ -729,7 +779,8 @@ WidgetSeq
 WidgetImpl::query_selector_all (const String &selector)
 {
   Selector::SelobAllocator sallocator;
-  vector<Selector::Selob*> result = Selector::Matcher::query_selector_all (selector, *sallocator.widget_selob (*this));
+  vector<Selector::Selob*> result;
+  query_selector_widgets (*this, selector, sallocator, std::back_inserter (result), 0);
   WidgetSeq widgets;
   for (vector<Selector::Selob*>::const_iterator it = result.begin(); it != result.end(); it++)
     {
@@ -744,7 +795,9 @@ WidgetIfaceP
 WidgetImpl::query_selector_unique (const String &selector)
 {
   Selector::SelobAllocator sallocator;
-  Selector::Selob *selob = Selector::Matcher::query_selector_unique (selector, *sallocator.widget_selob (*this));
+  Selector::Selob *selobs[2] = { NULL, NULL };
+  const size_t n_found = query_selector_widgets (*this, selector, sallocator, selobs, 2);
+  Selector::Selob *selob = n_found == 1 ? selobs[0] : NULL;
   return shared_ptr_cast<WidgetIface*> (selob ? sallocator.selob_widget (*selob) : NULL);
 }
 
@@ -1159,6 +1212,14 @@ WidgetImpl::rect_to_viewport (IRect widget_rect) const
   return IRect (iround (viewport_point.x), iround (viewport_point.y), widget_rect.width, widget_rect.height);
 }
 
+/// Mark selector indexes of all viewports containing @a widget as outdated.
+static void
+invalidate_selector_indexes (WidgetImpl &widget)
+{
+  for (ViewportImpl *viewport = widget.get_viewport(); viewport; viewport = viewport->parent() ? viewport->parent()->get_viewport() : NULL)
+    viewport->invalidate_selector_index();
+}
+
 void
 WidgetImpl::set_parent (ContainerImpl *pcontainer)
 {
@@ -1184,6 +1245,7 @@ WidgetImpl::set_parent (ContainerImpl *pcontainer)
     {
       assert_return (pcontainer == NULL);
       WindowImpl *old_toplevel = get_window();
+      invalidate_selector_indexes (*this);
       invalidate_all();
       old_parent->unparent_child (*this);
       parent_ = NULL;
@@ -1205,6 +1267,7 @@ WidgetImpl::set_parent (ContainerImpl *pcontainer)
       widget_propagate_state (old_state);
       if (parent_->anchored() && !anchored())
         sig_hierarchy_changed.emit (NULL);
+      invalidate_selector_indexes (*this);
       invalidate_all();
     }
 }
@@ -1442,7 +1505,11 @@ WidgetImpl::widget_invalidate (WidgetFlag mask)
   if (test_any (INVALID_CONTENT))
     expose();
   if (!had_invalid_requisition && test_any (INVALID_REQUISITION))
-    WidgetGroup::invalidate_widget (*this);
+    {
+      WidgetGroup::invalidate_widget (*this);
+      if (parent())
+        parent()->child_requisition_changed (*this);
+    }
   WindowImpl *window = get_window();
   if (window)
     window->queue_resize_redraw();
@@ -1478,14 +1545,24 @@ WidgetImpl::inner_size_request()
         {
           requisition_ = inner;
           widget_invalidate (INVALID_ALLOCATION);
-          WidgetImpl *p = parent();
-          if (p)
-            p->invalidate_requisition(); // parent needs to recheck size once a child changed size
+          invalidate_parent_requisition(); // parent needs to recheck size once a child changed size
         }
     }
   return visible() ? requisition_ : Requisition();
 }
 
+/// Notify the parent that the requisition of this widget changed, so it rechecks its own size.
+void
+WidgetImpl::invalidate_parent_requisition ()
+{
+  ContainerImpl *p = parent();
+  if (p)
+    {
+      p->child_requisition_changed (*this);
+      p->invalidate_requisition();
+    }
+}
+
 /** Get the size requisition of a widget.
  *
  * Determines the size requisition of a widget if its not already calculated.
@@ -1888,6 +1965,7 @@ WidgetImpl::id (const String &str)
     delete_data (&widget_id_key);
   else
     set_data (&widget_id_key, str);
+  invalidate_selector_indexes (*this);
   changed ("id");
 }
 
@@ -1965,7 +2043,7 @@ WidgetImpl::tune_requisition (int new_width, int new_height)
 bool
 WidgetImpl::tune_requisition (Requisition requisition)
 {
-  WidgetImpl *p = parent();
+  ContainerImpl *p = parent();
   if (p && !test_any (INVALID_REQUISITION))
     {
       WindowImpl *rc = get_window();
@@ -1981,6 +2059,7 @@ WidgetImpl::tune_requisition (Requisition requisition)
                * - check the parent size, it might have changed
                * - reallocate the child, possibly changing the previous allocation
                */
+              p->child_requisition_changed (*this);
               p->invalidate_size();
               return true;
             }
@@ -2019,6 +2098,8 @@ WidgetImpl::set_child_allocation (const Allocation &area)
         }
       // move and resize new allocation
       child_allocation_ = sarea;
+      if (allocation_changed && parent())
+        parent()->child_allocation_changed (*this);
       size_allocate (allocation());             // causes re-layout of immediate children
       // re-render new area
       if (allocation_changed)
@@ -2029,6 +2110,22 @@ WidgetImpl::set_child_allocation (const Allocation &area)
     }
 }
 
+/** Shift the parent-relative allocation by @a dx, @a dy without re-layouting.
+ * Since allocations of descendants are relative to their parents, moving a widget does not
+ * affect the size allocation or rendered contents of its descendants. No exposes are issued,
+ * the caller needs to take care of updating the affected viewport areas, e.g. via
+ * ViewportImpl::scroll_area().
+ */
+void
+WidgetImpl::move_child_allocation (int dx, int dy)
+{
+  return_unless (!test_any (INVALID_ALLOCATION));
+  child_allocation_.x += dx;
+  child_allocation_.y += dy;
+  if (parent())
+    parent()->child_allocation_changed (*this);
+}
+
 // == rendering ==
 class WidgetImpl::RenderContext {
   friend class WidgetImpl;
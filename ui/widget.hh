@@ -76,6 +76,7 @@ private:
   PackInfo                   *pack_info_;
   cairo_surface_t            *cached_surface_;
   Requisition                 inner_size_request (); // ungrouped size requisition
+  void                        invalidate_parent_requisition ();
   void                        acache_check       () const;
   void                        widget_adjust_state       (WidgetState state, bool on);
   void                        expose_unclipped   (const Region &region); // expose region on ancestry Viewport
@@ -307,6 +308,7 @@ public:
   /* public size accessors */
   virtual Requisition        requisition          ();                              // effective size requisition
   void                       set_child_allocation (const Allocation &area); // assign parent-relative allocation
+  void                       move_child_allocation (int dx, int dy);        // shift parent-relative allocation, keeps layout and contents
   const Allocation&          child_allocation     () const { return child_allocation_; } ///< Parent relative allocation, see also allocation().
   Allocation                 allocation           () const { return Allocation (0, 0, child_allocation_.width, child_allocation_.height); } ///< Widget relative allocation.
   // theming & appearance